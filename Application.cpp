@@ -16,6 +16,7 @@
 
 #include "MainWindow.h"
 #include "ResultWindow.h"
+#include "Trace.h"
 
 /**
  * \brief    Win32- (UNICODE).
@@ -36,8 +37,21 @@
  * 5.   ,       .
  */
 int WINAPI wWinMain(HINSTANCE hInst, HINSTANCE, PWSTR, int) {
-  //   
+  //   CHEM_TRACE=<>    ;
+  //        
   MainWindow mainWin;
+  if (const char* tracePath = std::getenv("CHEM_TRACE")) {
+    if (*tracePath) {
+      Trace::Enable(true);
+      mainWin.SetTracePath(tracePath);
+    }
+  }
+  // CHEM_LIVE=<>    (. LiveAcquisition)
+  if (const char* liveSource = std::getenv("CHEM_LIVE")) {
+    if (*liveSource) mainWin.SetLiveSource(liveSource);
+  }
+
+  //   
   if (!mainWin.Create(hInst)) {
     MessageBox(nullptr, L"    !", L"",
                MB_ICONERROR);
@@ -0,0 +1,279 @@
+/**
+ * \file BatchCalculation.cpp
+ * \brief   :   , , .
+ */
+
+#include "BatchCalculation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "LaneMath.h"
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace {
+
+///       .
+constexpr size_t kBlockGrain = 16;
+///       .
+constexpr size_t kDispersionGrain = 8;
+///       .
+constexpr size_t kMaxLengthSpread = 4096;
+
+/**
+ *       L  ( \a index): 
+ *      ,   .
+ * \a soa      .
+ */
+template <size_t L>
+void FitBlock(const SeriesView* series, const size_t* index, size_t count,
+              BatchFitResult* out, std::vector<double>& soa) {
+  size_t len[L];
+  alignas(64) double lenD[L];
+  size_t maxLen = 1;
+  for (size_t l = 0; l < L; l++) {
+    len[l] = (l < count) ? series[index[l]].count : 0;
+    lenD[l] = static_cast<double>(len[l]);
+    if (len[l] > maxLen) maxLen = len[l];
+  }
+
+  // :  i    i  .   
+  //    ,   ,  
+  //   ;   
+  soa.resize(2 * maxLen * L);
+  double* conc = soa.data();
+  double* time = conc + maxLen * L;
+  for (size_t l = 0; l < L; l++) {
+    const double* ca = (len[l] > 0) ? series[index[l]].Ca : nullptr;
+    const double* tm = (len[l] > 0) ? series[index[l]].Tm : nullptr;
+    for (size_t i = 0; i < len[l]; i++) {
+      conc[i * L + l] = ca[i];
+      time[i * L + l] = tm[i];
+    }
+    const double lastC = (len[l] > 0) ? ca[len[l] - 1] : 1.0;
+    const double lastT = (len[l] > 0) ? tm[len[l] - 1] : 0.0;
+    for (size_t i = len[l]; i < maxLen; i++) {
+      conc[i * L + l] = lastC;
+      time[i * L + l] = lastT + static_cast<double>(i - len[l] + 1);
+    }
+  }
+
+  alignas(64) double cVal[L], rate[L], x[L], y[L];
+  alignas(64) double negative[L], badTime[L];
+  alignas(64) double s1[L], s2[L], s3[L], s4[L], s5[L], s6[L];
+  for (size_t l = 0; l < L; l++) {
+    negative[l] = (conc[l] < 0.0) ? 1.0 : 0.0;
+    badTime[l] = 0.0;
+    s1[l] = s2[l] = s3[l] = s4[l] = s5[l] = s6[l] = 0.0;
+  }
+
+  for (size_t i = 1; i < maxLen; i++) {
+    const double* c0 = conc + (i - 1) * L;
+    const double* c1 = conc + i * L;
+    const double* t0 = time + (i - 1) * L;
+    const double* t1 = time + i * L;
+    for (size_t l = 0; l < L; l++) {
+      //    :  
+      negative[l] += (c1[l] < 0.0) ? 1.0 : 0.0;
+      badTime[l] += (t1[l] <= t0[l]) ? 1.0 : 0.0;
+
+      double dt = t1[l] - t0[l];
+      dt = (dt <= 1e-15) ? 1e-15 : dt;
+      const double w = std::fabs((c1[l] - c0[l]) / dt);
+      rate[l] = (w < 1e-15) ? 1e-15 : w;
+      cVal[l] = (c0[l] < 1e-15) ? 1e-15 : c0[l];
+    }
+    LaneLog(cVal, x, L);
+    LaneLog(rate, y, L);
+    const double pos = static_cast<double>(i);
+    for (size_t l = 0; l < L; l++) {
+      //   :     
+      const bool active = pos < lenD[l];
+      const double xl = active ? x[l] : 0.0;
+      const double yl = active ? y[l] : 0.0;
+      s1[l] += active ? 1.0 : 0.0;
+      s2[l] += xl;
+      s3[l] += yl;
+      s4[l] += xl * xl;
+      s5[l] += xl * yl;
+      s6[l] += yl * yl;
+    }
+  }
+
+  //     ,   ChemCalculation::FitLogLog
+  for (size_t l = 0; l < count; l++) {
+    BatchFitResult& res = out[index[l]];
+    res.fit = {0.0, 0.0, 0.0, 0.0};
+    res.logResidual = 0.0;
+    if (negative[l] != 0.0) {
+      res.status = BatchStatus::NegativeConcentration;
+      continue;
+    }
+    if (len[l] < 2) {
+      res.status = BatchStatus::TooFewPoints;
+      continue;
+    }
+    if (badTime[l] != 0.0) {
+      res.status = BatchStatus::NonIncreasingTime;
+      continue;
+    }
+    const double denom = s1[l] * s4[l] - s2[l] * s2[l];
+    if (std::fabs(denom) < 1e-15) {
+      res.status = BatchStatus::Degenerate;
+      continue;
+    }
+    const double slope = s1[l] * s5[l] - s2[l] * s3[l];
+    res.fit.n = slope / denom;
+    res.fit.k = std::exp((s3[l] * s4[l] - s2[l] * s5[l]) / denom);
+    const double syy = s1[l] * s6[l] - s3[l] * s3[l];
+    const double denomR = denom * syy;
+    if (denomR < 1e-15) {
+      res.fit.r = 0.0;
+    } else {
+      res.fit.r = slope / std::sqrt(denomR);
+      if (res.fit.r > 1.0) res.fit.r = 1.0;
+      if (res.fit.r < -1.0) res.fit.r = -1.0;
+    }
+    //   : (Syy - n * Sxy) / s1
+    if (s1[l] > 2.0) {
+      double sse = (syy - slope * res.fit.n) / s1[l];
+      if (sse < 0.0) sse = 0.0;
+      res.logResidual = sse / (s1[l] - 2.0);
+    }
+    const bool finite = std::isfinite(res.fit.n) && std::isfinite(res.fit.k) &&
+                        std::isfinite(res.fit.r) &&
+                        std::isfinite(res.logResidual);
+    if (!finite) {
+      res.fit = {0.0, 0.0, 0.0, 0.0};
+      res.logResidual = 0.0;
+      res.status = BatchStatus::NonFinite;
+      continue;
+    }
+    res.status = BatchStatus::Ok;
+  }
+}
+
+/**
+ *   :    ( ),
+ *            .
+ *    \c BatchWorkspace::order.
+ */
+void OrderByLength(const SeriesView* series, size_t count,
+                   BatchWorkspace& workspace) {
+  std::vector<size_t>& order = workspace.order;
+  order.resize(count);
+  size_t minLen = 0;
+  size_t maxLen = 0;
+  for (size_t i = 0; i < count; i++) {
+    minLen = (i == 0 || series[i].count < minLen) ? series[i].count : minLen;
+    maxLen = (series[i].count > maxLen) ? series[i].count : maxLen;
+  }
+  if (count == 0 || maxLen - minLen > kMaxLengthSpread) {
+    //     ,   
+    // ,    
+    for (size_t i = 0; i < count; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return series[a].count != series[b].count
+                 ? series[a].count < series[b].count
+                 : a < b;
+    });
+    return;
+  }
+  std::vector<size_t>& start = workspace.start;
+  start.assign(maxLen - minLen + 2, 0);
+  for (size_t i = 0; i < count; i++) start[series[i].count - minLen + 1]++;
+  for (size_t j = 1; j < start.size(); j++) start[j] += start[j - 1];
+  for (size_t i = 0; i < count; i++) {
+    order[start[series[i].count - minLen]++] = i;
+  }
+}
+
+///      (,   ).
+template <class T>
+T TakeBuffer(BatchWorkspace& workspace, std::vector<T>& pool) {
+  std::lock_guard<std::mutex> lock(workspace.mutex);
+  if (pool.empty()) return {};
+  T buffer = std::move(pool.back());
+  pool.pop_back();
+  return buffer;
+}
+
+///         .
+template <class T>
+void ReturnBuffer(BatchWorkspace& workspace, std::vector<T>& pool,
+                  T&& buffer) {
+  std::lock_guard<std::mutex> lock(workspace.mutex);
+  pool.push_back(std::move(buffer));
+}
+
+template <size_t L>
+void FitAll(const SeriesView* series, size_t count, BatchFitResult* out,
+            BatchWorkspace& workspace) {
+  OrderByLength(series, count, workspace);
+  const size_t* order = workspace.order.data();
+  const size_t blocks = (count + L - 1) / L;
+  ParallelFor(blocks, kBlockGrain, [&](size_t begin, size_t end) {
+    std::vector<double> soa = TakeBuffer(workspace, workspace.buffers);
+    for (size_t b = begin; b < end; b++) {
+      const size_t first = b * L;
+      const size_t n = (count - first < L) ? count - first : L;
+      FitBlock<L>(series, order + first, n, out, soa);
+    }
+    ReturnBuffer(workspace, workspace.buffers, std::move(soa));
+  });
+}
+
+}  // namespace
+
+void CalculateBatch(const SeriesView* series, size_t count,
+                    BatchFitResult* out, size_t lanes, bool dispersion) {
+  BatchWorkspace workspace;
+  CalculateBatch(series, count, out, lanes, dispersion, workspace);
+}
+
+void CalculateBatch(const SeriesView* series, size_t count,
+                    BatchFitResult* out, size_t lanes, bool dispersion,
+                    BatchWorkspace& workspace) {
+  TRACE_SCOPE("CalculateBatch");
+  TRACE_COUNTER("CalculateBatch.series", count);
+  switch (lanes) {
+    case 4:
+      FitAll<4>(series, count, out, workspace);
+      break;
+    case 8:
+      FitAll<8>(series, count, out, workspace);
+      break;
+    case 16:
+      FitAll<16>(series, count, out, workspace);
+      break;
+    default:
+      throw std::runtime_error("    4, 8  16!");
+  }
+  if (!dispersion) return;
+
+  ParallelFor(count, kDispersionGrain, [&](size_t begin, size_t end) {
+    std::vector<double> sq = TakeBuffer(workspace, workspace.buffers);
+    ReductionScratch reduction = TakeBuffer(workspace, workspace.reductions);
+    for (size_t i = begin; i < end; i++) {
+      BatchFitResult& res = out[i];
+      if (res.status != BatchStatus::Ok) continue;
+      const SeriesView& sv = series[i];
+      if (sq.size() < sv.count) sq.resize(sv.count);
+      res.fit.disp = ChemCalculation::ComputeDispersion(
+          sv.Ca, sv.Tm, sv.count, res.fit.k, res.fit.n, nullptr, sq.data(),
+          &reduction);
+      if (!std::isfinite(res.fit.disp)) {
+        res.fit = {0.0, 0.0, 0.0, 0.0};
+        res.logResidual = 0.0;
+        res.status = BatchStatus::NonFinite;
+      }
+    }
+    ReturnBuffer(workspace, workspace.buffers, std::move(sq));
+    ReturnBuffer(workspace, workspace.reductions, std::move(reduction));
+  });
+}
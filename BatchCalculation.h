@@ -0,0 +1,108 @@
+#ifndef BATCHCALCULATION_H
+#define BATCHCALCULATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ChemCalculation.h"
+
+/**
+ * \file BatchCalculation.h
+ * \brief       .
+ *
+ *    1050 ,      
+ *   .     :   4, 8 
+ * 16    ,   
+ * ln|dCa/dt| = ln(k) + n * ln(Ca)    n, k, r  
+ * ,   .      :
+ *          .
+ *
+ *          , 
+ *     SIMD-;  
+ *    (  1 ulp).
+ *    ,       ;
+ *     \c ParallelFor.
+ */
+
+/**
+ * \brief      (  ,  
+ *        \c ChemCalculation::TryCalculate; \c CalcStatus::NegativeInitial
+ *           ).
+ */
+using BatchStatus = CalcStatus;
+
+/**
+ * \brief    (  ).
+ */
+struct SeriesView {
+  const double* Ca = nullptr;  ///<   A.
+  const double* Tm = nullptr;  ///<  .
+  size_t count = 0;            ///<  .
+};
+
+/**
+ * \brief     .
+ */
+struct BatchFitResult {
+  /// n, k, r; disp     ,  0.
+  CalculationResult fit;
+  ///    ln W  ln A (  ).
+  double logResidual;
+  BatchStatus status;  ///<  ;      0.
+};
+
+/**
+ * \brief    ;  ,  \c CalcStatusMessage.
+ */
+inline const char* BatchStatusMessage(BatchStatus status) {
+  return CalcStatusMessage(status);
+}
+
+/**
+ * \brief    .
+ *
+ *    \c CalculateBatch:    
+ *     .     
+ *  .
+ */
+struct BatchWorkspace {
+  std::vector<size_t> order;  ///<    .
+  std::vector<size_t> start;  ///<   .
+  ///    ( , ).
+  std::vector<std::vector<double>> buffers;
+  ///      .
+  std::vector<ReductionScratch> reductions;
+  std::mutex mutex;  ///<  \c buffers  \c reductions.
+};
+
+/**
+ * \brief  n, k, r   .
+ *
+ *      \c ChemCalculation::Calculate 
+ *    ulp (   ).
+ *    :    \c BatchFitResult::status.
+ *   Cb  Cc        .
+ *
+ * \param series .
+ * \param count  .
+ * \param out  (\a count ).
+ * \param lanes  : 4, 8  16 .
+ * \param dispersion     (
+ *        \c ChemCalculation::ComputeDispersion);    
+ *            ,    .
+ * \throw std::runtime_error  \a lanes   4, 8  16.
+ */
+void CalculateBatch(const SeriesView* series, size_t count,
+                    BatchFitResult* out, size_t lanes = 16,
+                    bool dispersion = false);
+
+/**
+ * \brief \c CalculateBatch    (. \c BatchWorkspace).
+ */
+void CalculateBatch(const SeriesView* series, size_t count,
+                    BatchFitResult* out, size_t lanes, bool dispersion,
+                    BatchWorkspace& workspace);
+
+#endif  // BATCHCALCULATION_H
@@ -0,0 +1,491 @@
+/**
+ * \file Benchmark.cpp
+ * \brief        .
+ *
+ *     ;    
+ *   ,      ~20 .  
+ *         :  , 
+ * , , ,     
+ *  (. \c PerfCounters.h;    ). 
+ *         (
+ *  ,  ).
+ *
+ *      (BenchmarkBaseline.json):
+ *       ,  
+ *    1.      (
+ *  ),         
+ * ,     :    ,
+ *        .  
+ *      ,   .
+ * ,       ,  :
+ *     .
+ *
+ * :
+ *   chem_bench [--baseline FILE] [--out FILE] [--threshold 0.10]
+ *              [--filter TEXT] [--update]
+ * --update       .
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BatchCalculation.h"
+#include "ChemCalculation.h"
+#include "Json.h"
+#include "KineticModels.h"
+#include "PerfCounters.h"
+#include "Trajectory.h"
+#ifdef _WIN32
+#include "ChartDrawer.h"
+#endif
+
+namespace {
+
+///    .
+constexpr int kRepetitions = 7;
+///    , .
+constexpr double kMinRepetitionTime = 0.02;
+///     ().
+constexpr double kDefaultThreshold = 0.10;
+///        .
+constexpr double kMinComparable = 1.0;
+///         .
+constexpr double kNoiseFactor = 3.0;
+///           .
+constexpr double kMaxNoiseLimit = 2.0;
+///       .
+constexpr int kConfirmRuns = 2;
+
+///      .
+volatile double g_sink = 0.0;
+
+struct Benchmark {
+  std::string name;
+  std::function<void()> body;
+};
+
+///   :     .
+struct Measurement {
+  std::string name;
+  long long iterations = 0;
+  bool scaled = false;  ///<   ().
+  std::vector<std::pair<std::string, double>> metrics;
+
+  const double* Find(const std::string& metric) const {
+    for (const auto& m : metrics) {
+      if (m.first == metric) return &m.second;
+    }
+    return nullptr;
+  }
+};
+
+///   W = k * A^n    .
+void MakeSeries(size_t points, double k, double n, std::vector<double>& Ca,
+                std::vector<double>& Tm) {
+  Ca.resize(points);
+  Tm.resize(points);
+  double A = 2.0;
+  const double dt = 10.0 / static_cast<double>(points);
+  for (size_t i = 0; i < points; i++) {
+    Tm[i] = static_cast<double>(i) * dt;
+    const double noise =
+        1.0 + 0.002 * std::sin(static_cast<double>(i) * 12.9898);
+    Ca[i] = A * noise;
+    for (int s = 0; s < 10; s++) A -= k * std::pow(A, n) * dt / 10.0;
+    if (A < 1e-9) A = 1e-9;
+  }
+}
+
+std::vector<Benchmark> MakeBenchmarks() {
+  std::vector<Benchmark> list;
+
+  auto small = std::make_shared<std::pair<std::vector<double>,
+                                          std::vector<double>>>();
+  MakeSeries(20, 0.3, 1.5, small->first, small->second);
+  auto large = std::make_shared<std::pair<std::vector<double>,
+                                          std::vector<double>>>();
+  MakeSeries(10000, 0.3, 1.5, large->first, large->second);
+
+  list.push_back({"Calculate/20", [small] {
+                    g_sink = ChemCalculation::Calculate(small->first,
+                                                        small->second, 0.0,
+                                                        0.0).k;
+                  }});
+  list.push_back({"Calculate/10000", [large] {
+                    g_sink = ChemCalculation::Calculate(large->first,
+                                                        large->second, 0.0,
+                                                        0.0).k;
+                  }});
+  list.push_back({"ScreenModels/20", [small] {
+                    g_sink = ScreenModels(small->first, small->second)[0].aic;
+                  }});
+  list.push_back({"BuildTrajectory/20/sensitivities", [small] {
+                    const Trajectory t =
+                        BuildTrajectory(small->first, small->second, 0.0, 0.0,
+                                        0.3, 1.5, 20, true);
+                    g_sink = t.A.back();
+                  }});
+
+  //     
+  auto batch = std::make_shared<std::vector<std::vector<double>>>();
+  auto views = std::make_shared<std::vector<SeriesView>>();
+  const size_t kSeries = 4096;
+  batch->resize(2 * kSeries);
+  for (size_t s = 0; s < kSeries; s++) {
+    MakeSeries(30, 0.1 + 0.0001 * static_cast<double>(s), 1.2,
+               (*batch)[2 * s], (*batch)[2 * s + 1]);
+  }
+  for (size_t s = 0; s < kSeries; s++) {
+    views->push_back({(*batch)[2 * s].data(), (*batch)[2 * s + 1].data(),
+                      (*batch)[2 * s].size()});
+  }
+  list.push_back({"CalculateBatch/4096x30", [batch, views] {
+                    std::vector<BatchFitResult> out(views->size());
+                    CalculateBatch(views->data(), views->size(), out.data());
+                    g_sink = out.back().fit.k;
+                  }});
+
+#ifdef _WIN32
+  //     
+  list.push_back({"DrawChart/800x600", [small] {
+                    static ChartScene scene;
+                    static bool ready = false;
+                    if (!ready) {
+                      scene.Ca = small->first;
+                      scene.Tm = small->second;
+                      scene.traj = BuildTrajectory(scene.Ca, scene.Tm, 0.0,
+                                                   0.0, 0.3, 1.5);
+                      scene.bounds =
+                          ComputeDataBounds(scene.Ca, scene.Tm, 0.0, 0.0);
+                      scene.BuildLevels();
+                      ready = true;
+                    }
+                    const RECT rc = {0, 0, 800, 600};
+                    HDC screen = GetDC(nullptr);
+                    HDC mem = CreateCompatibleDC(screen);
+                    HBITMAP bmp = CreateCompatibleBitmap(screen, 800, 600);
+                    HGDIOBJ old = SelectObject(mem, bmp);
+                    DrawChart(mem, rc, MakeChartLayout(rc, scene.bounds),
+                              scene);
+                    SelectObject(mem, old);
+                    DeleteObject(bmp);
+                    DeleteDC(mem);
+                    ReleaseDC(nullptr, screen);
+                  }});
+#endif
+  return list;
+}
+
+double Median(std::vector<double> v) {
+  std::sort(v.begin(), v.end());
+  return v[v.size() / 2];
+}
+
+///  :   ,  .
+double RelativeSpread(const std::vector<double>& v) {
+  const double median = Median(v);
+  if (!(median > 0.0)) return 0.0;
+  std::vector<double> deviations;
+  for (double x : v) deviations.push_back(std::fabs(x - median));
+  return Median(deviations) / median;
+}
+
+Measurement Run(const Benchmark& bench, PerfCounters& counters) {
+  //       
+  const auto t0 = std::chrono::steady_clock::now();
+  bench.body();
+  const double once = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - t0).count();
+  long long iterations = 1;
+  if (once < kMinRepetitionTime) {
+    iterations = static_cast<long long>(
+        std::ceil(kMinRepetitionTime / std::max(once, 1e-9)));
+  }
+
+  std::vector<double> perOp[1 + PERF_COUNTER_COUNT];
+  bool valid[PERF_COUNTER_COUNT] = {};
+  bool scaled = false;
+  for (int r = 0; r < kRepetitions; r++) {
+    counters.Start();
+    for (long long i = 0; i < iterations; i++) bench.body();
+    const PerfSample s = counters.Stop();
+    const double n = static_cast<double>(iterations);
+    perOp[0].push_back(s.seconds * 1e9 / n);
+    for (size_t c = 0; c < PERF_COUNTER_COUNT; c++) {
+      if (!s.valid[c]) continue;
+      valid[c] = true;
+      scaled = scaled || s.scaled[c];
+      perOp[1 + c].push_back(static_cast<double>(s.values[c]) / n);
+    }
+  }
+
+  Measurement m;
+  m.name = bench.name;
+  m.iterations = iterations;
+  m.scaled = scaled;
+  m.metrics.emplace_back("ns_per_op", Median(perOp[0]));
+  m.metrics.emplace_back(
+      "ns_per_op_min", *std::min_element(perOp[0].begin(), perOp[0].end()));
+  m.metrics.emplace_back("ns_per_op_noise", RelativeSpread(perOp[0]));
+  for (size_t c = 0; c < PERF_COUNTER_COUNT; c++) {
+    if (valid[c] && perOp[1 + c].size() == kRepetitions) {
+      m.metrics.emplace_back(std::string(PerfCounters::Name(c)) + "_per_op",
+                             Median(perOp[1 + c]));
+    }
+  }
+  return m;
+}
+
+std::vector<Measurement> ReadReport(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) throw std::runtime_error("cannot open " + path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  const std::string text = ss.str();
+  const JsonValue root = ParseJson(text);
+  const JsonValue* list = root.Find("benchmarks");
+  if (list == nullptr || list->kind != JsonValue::Array) {
+    throw std::runtime_error(path + ": no \"benchmarks\" array");
+  }
+  std::vector<Measurement> out;
+  for (const JsonValue& item : list->items) {
+    const JsonValue* name = item.Find("name");
+    if (name == nullptr || name->kind != JsonValue::String) continue;
+    Measurement m;
+    m.name = name->text;
+    for (const auto& f : item.fields) {
+      if (f.second.kind != JsonValue::Number) continue;
+      if (f.first == "iterations") {
+        m.iterations = static_cast<long long>(f.second.number);
+      } else if (f.first == "counters_scaled") {
+        m.scaled = f.second.number != 0.0;
+      } else {
+        m.metrics.emplace_back(f.first, f.second.number);
+      }
+    }
+    out.push_back(std::move(m));
+  }
+  return out;
+}
+
+void WriteReport(const std::string& path,
+                 const std::vector<Measurement>& results) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) throw std::runtime_error("cannot write " + path);
+  char buf[64];
+  // JSON  :      , 
+  // ReadReport 
+  bool counters = false;
+  for (const Measurement& m : results) {
+    for (const auto& metric : m.metrics) {
+      counters = counters || metric.first.compare(0, 9, "ns_per_op") != 0;
+    }
+  }
+  out << "{\n";
+  if (!counters) {
+    out << "  \"comment\": \"Recorded without hardware counters (no PMU "
+           "access), so only time is compared against this file; re-record "
+           "it with --update where counters are available to compare them "
+           "too.\",\n";
+  }
+  out << "  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const Measurement& m = results[i];
+    out << "    {\"name\": \"" << m.name << "\", \"iterations\": "
+        << m.iterations;
+    if (m.scaled) out << ", \"counters_scaled\": 1";
+    for (const auto& metric : m.metrics) {
+      std::snprintf(buf, sizeof(buf), "%.6g", metric.second);
+      out << ", \"" << metric.first << "\": " << buf;
+    }
+    out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+  if (!out) throw std::runtime_error("cannot write " + path);
+}
+
+///     .
+struct Verdict {
+  std::string metric;  ///<   .
+  double base = 0.0;
+  double current = 0.0;
+  double limit = 0.0;  ///<   ().
+  bool regressed = false;
+};
+
+const Measurement* FindBaseline(const std::vector<Measurement>& baseline,
+                                const std::string& name) {
+  for (const Measurement& b : baseline) {
+    if (b.name == name) return &b;
+  }
+  return nullptr;
+}
+
+///        .
+std::vector<Verdict> Judge(const Measurement& cur, const Measurement& base,
+                           double threshold) {
+  std::vector<Verdict> out;
+  for (const auto& metric : cur.metrics) {
+    if (metric.first == "ns_per_op_min" || metric.first == "ns_per_op_noise") {
+      continue;  //    ns_per_op
+    }
+    const double* b = base.Find(metric.first);
+    if (b == nullptr) continue;
+    Verdict v;
+    v.metric = metric.first;
+    v.base = *b;
+    v.current = metric.second;
+    v.limit = threshold;
+    if (metric.first == "ns_per_op") {
+      //  ;        
+      const double* curMin = cur.Find("ns_per_op_min");
+      const double* baseMin = base.Find("ns_per_op_min");
+      if (curMin != nullptr) {
+        v.metric = "ns_per_op(min)";
+        v.current = *curMin;
+        if (baseMin != nullptr) v.base = *baseMin;
+      }
+      //       (  
+      // )   
+      const double* curNoise = cur.Find("ns_per_op_noise");
+      const double noise = curNoise != nullptr ? *curNoise : 0.0;
+      v.limit = std::max(threshold, std::min(kNoiseFactor * noise,
+                                             kMaxNoiseLimit * threshold));
+    } else if (*b < kMinComparable) {
+      continue;
+    }
+    if (!(v.base > 0.0)) continue;
+    v.regressed = v.current / v.base - 1.0 > v.limit;
+    out.push_back(v);
+  }
+  return out;
+}
+
+bool TimeRegressed(const Measurement& cur, const Measurement* base,
+                   double threshold) {
+  if (base == nullptr) return false;
+  for (const Verdict& v : Judge(cur, *base, threshold)) {
+    if (v.regressed && v.metric.compare(0, 9, "ns_per_op") == 0) return true;
+  }
+  return false;
+}
+
+///   ;   .
+int Compare(const std::vector<Measurement>& current,
+            const std::vector<Measurement>& baseline, double threshold) {
+  int regressions = 0;
+  std::printf("%-36s %-22s %12s %12s %8s %7s\n", "benchmark", "metric",
+              "baseline", "current", "change", "limit");
+  for (const Measurement& cur : current) {
+    const Measurement* base = FindBaseline(baseline, cur.name);
+    if (base == nullptr) {
+      std::printf("%-36s (no baseline)\n", cur.name.c_str());
+      continue;
+    }
+    for (const Verdict& v : Judge(cur, *base, threshold)) {
+      if (v.regressed) regressions++;
+      std::printf("%-36s %-22s %12.4g %12.4g %+7.1f%% %6.1f%%%s\n",
+                  cur.name.c_str(), v.metric.c_str(), v.base, v.current,
+                  100.0 * (v.current / v.base - 1.0), 100.0 * v.limit,
+                  v.regressed ? "  REGRESSION" : "");
+    }
+    if (cur.scaled || base->scaled) {
+      std::printf("%-36s (counters multiplexed, values scaled)\n",
+                  cur.name.c_str());
+    }
+  }
+  return regressions;
+}
+
+void PrintUsage() {
+  std::fprintf(stderr,
+               "usage: chem_bench [--baseline FILE] [--out FILE] "
+               "[--threshold FRACTION] [--filter TEXT] [--update]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string baselinePath = "BenchmarkBaseline.json";
+  std::string outPath;
+  std::string filter;
+  double threshold = kDefaultThreshold;
+  bool update = false;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--baseline" && hasValue) {
+      baselinePath = argv[++i];
+    } else if (arg == "--out" && hasValue) {
+      outPath = argv[++i];
+    } else if (arg == "--threshold" && hasValue) {
+      threshold = std::atof(argv[++i]);
+    } else if (arg == "--filter" && hasValue) {
+      filter = argv[++i];
+    } else if (arg == "--update") {
+      update = true;
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  try {
+    //   ParallelFor:    
+    PerfCounters counters;
+    if (!counters.Available()) {
+      std::fprintf(stderr,
+                   "hardware counters unavailable; measuring time only\n");
+    }
+    const std::vector<Measurement> baseline =
+        update ? std::vector<Measurement>() : ReadReport(baselinePath);
+    std::vector<Measurement> results;
+    for (const Benchmark& bench : MakeBenchmarks()) {
+      if (!filter.empty() && bench.name.find(filter) == std::string::npos) {
+        continue;
+      }
+      Measurement m = Run(bench, counters);
+      //     :  
+      const Measurement* base = FindBaseline(baseline, bench.name);
+      for (int retry = 0;
+           retry < kConfirmRuns && TimeRegressed(m, base, threshold);
+           retry++) {
+        Measurement again = Run(bench, counters);
+        if (*again.Find("ns_per_op_min") < *m.Find("ns_per_op_min")) {
+          m = std::move(again);
+        }
+      }
+      results.push_back(std::move(m));
+      std::fprintf(stderr, "%-36s %12.1f ns/op\n", bench.name.c_str(),
+                   results.back().metrics[0].second);
+    }
+    if (!outPath.empty()) WriteReport(outPath, results);
+    if (update) {
+      WriteReport(baselinePath, results);
+      return 0;
+    }
+    const int regressions = Compare(results, baseline, threshold);
+    if (regressions > 0) {
+      std::printf("%d regression(s) above limit (%.0f%% or %.0fx spread, "
+                  "at most %.0f%%)\n",
+                  regressions, 100.0 * threshold, kNoiseFactor,
+                  100.0 * kMaxNoiseLimit * threshold);
+      return 1;
+    }
+    return 0;
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "chem_bench: %s\n", e.what());
+    return 2;
+  }
+}
@@ -1,36 +1,46 @@
 #include "ChartDrawer.h"
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <vector>
 
 #include "Constants.h"
+#include "Trace.h"
 #include "Utils.h"
 
-///    ,   DrawChart   .
-void DrawChart(HDC hdc, const RECT& rcClient, const std::vector<double>& Ca,
-               const std::vector<double>& Tm, double Cb, double Cc, double k,
-               double n) {
-  const int nPoints = static_cast<int>(Ca.size());
-  int left = rcClient.left;
-  int top = rcClient.top;
-  int width = rcClient.right - rcClient.left;
-  int height = rcClient.bottom - rcClient.top;
+//       ().
+static constexpr double kOffsetX = 40.0;
+static constexpr double kOffsetY = 40.0;
 
-  //  
-  HPEN hPenAxis = CreatePen(PS_SOLID, 2, RGB(0, 0, 0));
-  HPEN hPenOld = (HPEN)SelectObject(hdc, hPenAxis);
+int ChartLayout::ToX(double t) const {
+  return static_cast<int>(left + kOffsetX +
+                          (t - Tmin) / (Tmax - Tmin) * (plotW - 20));
+}
 
-  //  X
-  MoveToEx(hdc, left + 40, top + height - 40, nullptr);
-  LineTo(hdc, left + width - 10, top + height - 40);
+int ChartLayout::ToY(double c) const {
+  return static_cast<int>(top + plotH -
+                          (c - Cmin) / (Cmax - Cmin) * (plotH - kOffsetY));
+}
 
-  //  Y
-  MoveToEx(hdc, left + 40, top + height - 40, nullptr);
-  LineTo(hdc, left + 40, top + 10);
+double ChartLayout::FromX(int x) const {
+  double pxChart = x - (left + kOffsetX);
+  if (pxChart < 0) pxChart = 0;
+  if (pxChart > (plotW - 20)) pxChart = (plotW - 20);
+  return Tmin + (pxChart / (plotW - 20)) * (Tmax - Tmin);
+}
 
-  //  
-  TextOut(hdc, left + width - 60, top + height - 50, L"Time", 4);
-  TextOut(hdc, left + 50, top + 10, L"Concentration", 13);
+double ChartLayout::FromY(int y) const {
+  double pyChart = static_cast<double>(y - top);
+  double v = (plotH - pyChart) / (plotH - kOffsetY);
+  double c = Cmin + v * (Cmax - Cmin);
+  return (c < 0) ? 0 : c;
+}
+
+ChartBounds ComputeDataBounds(const std::vector<double>& Ca,
+                              const std::vector<double>& Tm, double Cb,
+                              double Cc) {
+  const int nPoints = static_cast<int>(Ca.size());
 
   //   
   double Tmin = 1e9, Tmax = -1e9, Cmin = 1e9, Cmax = -1e9;
@@ -59,22 +69,125 @@ void DrawChart(HDC hdc, const RECT& rcClient, const std::vector<double>& Ca,
   if (Cmin < 0) Cmin = 0;
   if (Tmin < 0) Tmin = 0;
 
-  double offsetX = 40.0, offsetY = 40.0;
-  double plotW = static_cast<double>(width - 50);
-  double plotH = static_cast<double>(height - 50);
+  return {Tmin, Tmax, Cmin, Cmax};
+}
+
+ChartLayout MakeChartLayout(const RECT& rcClient, const ChartBounds& bounds) {
+  ChartLayout layout;
+  layout.left = rcClient.left;
+  layout.top = rcClient.top;
+  layout.plotW = static_cast<double>(rcClient.right - rcClient.left - 50);
+  layout.plotH = static_cast<double>(rcClient.bottom - rcClient.top - 50);
+  layout.Tmin = bounds.Tmin;
+  layout.Tmax = bounds.Tmax;
+  layout.Cmin = bounds.Cmin;
+  layout.Cmax = bounds.Cmax;
+  return layout;
+}
 
-  //         
-  auto fx = [=](double t) -> int {
-    return static_cast<int>(left + offsetX +
-                            (t - Tmin) / (Tmax - Tmin) * (plotW - 20));
-  };
-  auto fy = [=](double c) -> int {
-    return static_cast<int>(top + plotH -
-                            (c - Cmin) / (Cmax - Cmin) * (plotH - offsetY));
-  };
+void ChartScene::BuildLevels() {
+  TRACE_SCOPE("ChartScene::BuildLevels");
+  tmSorted = true;
+  for (size_t i = 0; i + 1 < Tm.size(); i++) {
+    if (Tm[i + 1] <= Tm[i]) {
+      tmSorted = false;
+      break;
+    }
+  }
+  //    ;  
+  //  
+  if (tmSorted) {
+    lodExp.Build(Tm, Ca);
+  } else {
+    lodExp.Clear();
+  }
+  lodA.Build(traj.t, traj.A);
+  lodB.Build(traj.t, traj.B);
+  lodC.Build(traj.t, traj.C);
+  for (ModelCurve& m : models) {
+    m.lod.Build(m.t, m.A);
+  }
+  if (info.size() == traj.t.size() && !info.empty()) {
+    lodInfo.Build(traj.t, info);
+  } else {
+    lodInfo.Clear();
+  }
+}
+
+/// \brief          \a step.
+static int TickPrecision(double step) {
+  if (!(step > 0.0)) return 1;
+  int prec = static_cast<int>(std::ceil(-std::log10(step)));
+  if (prec < 1) prec = 1;
+  if (prec > 6) prec = 6;
+  return prec;
+}
+
+/// \brief     .
+///
+///       ;    
+///  ,       ,  
+///     .
+static void BucketsToPolyline(const std::vector<LodBucket>& buckets,
+                              int level, const ChartLayout& layout,
+                              std::vector<POINT>& pts) {
+  pts.clear();
+  if (level == 0) {
+    pts.reserve(buckets.size());
+    for (const LodBucket& b : buckets) {
+      pts.push_back({layout.ToX(b.tFirst), layout.ToY(b.vFirst)});
+    }
+    return;
+  }
+  pts.reserve(buckets.size() * 4);
+  for (const LodBucket& b : buckets) {
+    const int X0 = layout.ToX(b.tFirst);
+    const int X1 = layout.ToX(b.tLast);
+    const bool falling = b.vFirst >= b.vLast;
+    pts.push_back({X0, layout.ToY(b.vFirst)});
+    pts.push_back({X0, layout.ToY(falling ? b.vMax : b.vMin)});
+    pts.push_back({X1, layout.ToY(falling ? b.vMin : b.vMax)});
+    pts.push_back({X1, layout.ToY(b.vLast)});
+  }
+}
+
+///    ,   DrawChart   .
+void DrawChart(HDC hdc, const RECT& rcClient, const ChartLayout& layout,
+               const ChartScene& scene) {
+  TRACE_SCOPE("DrawChart");
+  const std::vector<double>& Ca = scene.Ca;
+  const std::vector<double>& Tm = scene.Tm;
+  const int nPoints = static_cast<int>(Ca.size());
+  int left = rcClient.left;
+  int top = rcClient.top;
+  int width = rcClient.right - rcClient.left;
+  int height = rcClient.bottom - rcClient.top;
+
+  //  
+  HPEN hPenAxis = CreatePen(PS_SOLID, 2, RGB(0, 0, 0));
+  HPEN hPenOld = (HPEN)SelectObject(hdc, hPenAxis);
+
+  //  X
+  MoveToEx(hdc, left + 40, top + height - 40, nullptr);
+  LineTo(hdc, left + width - 10, top + height - 40);
+
+  //  Y
+  MoveToEx(hdc, left + 40, top + height - 40, nullptr);
+  LineTo(hdc, left + 40, top + 10);
+
+  //  
+  TextOut(hdc, left + width - 60, top + height - 50, L"Time", 4);
+  TextOut(hdc, left + 50, top + 10, L"Concentration", 13);
+
+  const double Tmin = layout.Tmin, Tmax = layout.Tmax;
+  const double Cmin = layout.Cmin, Cmax = layout.Cmax;
+  auto fx = [&layout](double t) { return layout.ToX(t); };
+  auto fy = [&layout](double c) { return layout.ToY(c); };
 
   //    
   int nTicks = 5;
+  const int precT = TickPrecision((Tmax - Tmin) / nTicks);
+  const int precC = TickPrecision((Cmax - Cmin) / nTicks);
   for (int i = 0; i <= nTicks; i++) {
     double tx = Tmin + (Tmax - Tmin) * i / nTicks;
     int X = fx(tx);
@@ -82,7 +195,7 @@ void DrawChart(HDC hdc, const RECT& rcClient, const std::vector<double>& Ca,
     LineTo(hdc, X, top + height - 35);
 
     wchar_t buf[32];
-    swprintf_s(buf, L"%.1f", tx);
+    swprintf_s(buf, L"%.*f", precT, tx);
     TextOut(hdc, X - 10, top + height - 30, buf, lstrlen(buf));
   }
   for (int i = 0; i <= nTicks; i++) {
@@ -92,78 +205,114 @@ void DrawChart(HDC hdc, const RECT& rcClient, const std::vector<double>& Ca,
     LineTo(hdc, left + 45, Y);
 
     wchar_t buf[32];
-    swprintf_s(buf, L"%.1f", cc);
+    swprintf_s(buf, L"%.*f", precC, cc);
     TextOut(hdc, left + 5, Y - 8, buf, lstrlen(buf));
   }
 
+  //     :    
+  //     
+  SaveDC(hdc);
+  IntersectClipRect(hdc, left + 41, top + 10, left + width - 10,
+                    top + height - 41);
+
+  //         
+  const size_t maxBuckets =
+      static_cast<size_t>(layout.AxisWidth() > 1 ? layout.AxisWidth() : 1);
+  std::vector<LodBucket> buckets;
+  std::vector<POINT> pts;
+
   //    ( )
   HPEN hPenExp = CreatePen(PS_SOLID, 1, RGB(255, 0, 0));
+  HPEN hPenRejected = CreatePen(PS_SOLID, 1, RGB(160, 160, 160));
   SelectObject(hdc, hPenExp);
-  for (int i = 0; i < nPoints; i++) {
-    int X = fx(Tm[i]);
-    int Y = fy(Ca[i]);
-    MoveToEx(hdc, X - 3, Y, nullptr);
-    LineTo(hdc, X + 3, Y);
-    MoveToEx(hdc, X, Y - 3, nullptr);
-    LineTo(hdc, X, Y + 3);
-  }
-
-  //   A(t), B(t), C(t)  
-  if (nPoints >= 2) {
-    std::vector<POINT> arrA;
-    std::vector<POINT> arrB;
-    std::vector<POINT> arrC;
-
-    double Acur = Ca[0];
-    double Bcur = Cb;
-    double Ccur = Cc;
-    double tcur = Tm[0];
-
-    arrA.push_back({fx(tcur), fy(Acur)});
-    arrB.push_back({fx(tcur), fy(Bcur)});
-    arrC.push_back({fx(tcur), fy(Ccur)});
-
-    for (int i = 1; i < nPoints; i++) {
-      double dtFull = Tm[i] - Tm[i - 1];
-      if (dtFull < 0) dtFull = 0;
-      int subSteps = 20;
-      double dtSub = dtFull / subSteps;
-
-      for (int s = 0; s < subSteps; s++) {
-        double rate = k * pow(Acur, n);
-        Acur -= rate * dtSub;
-        Bcur += (7.0 / 3.0) * rate * dtSub;            // 7 / 3   (     7/3 B)
-        Ccur += rate * dtSub;                          // 1 / 1 == 1 (, 1/1 C    )
-        tcur += dtSub;
-
-        arrA.push_back({fx(tcur), fy(Acur)});
-        arrB.push_back({fx(tcur), fy(Bcur)});
-        arrC.push_back({fx(tcur), fy(Ccur)});
+  auto isRejected = [&scene](size_t i) {
+    return i < scene.inliers.size() && !scene.inliers[i];
+  };
+  if (scene.tmSorted) {
+    int level = scene.lodExp.Query(Tmin, Tmax, maxBuckets, buckets);
+    for (const LodBucket& b : buckets) {
+      int X = fx(b.tFirst);
+      if (level == 0) {
+        int Y = fy(b.vFirst);
+        // ,   ,  
+        const bool rejected = isRejected(b.iFirst);
+        if (rejected) SelectObject(hdc, hPenRejected);
+        MoveToEx(hdc, X - 3, Y, nullptr);
+        LineTo(hdc, X + 3, Y);
+        MoveToEx(hdc, X, Y - 3, nullptr);
+        LineTo(hdc, X, Y + 3);
+        if (rejected) SelectObject(hdc, hPenExp);
+      } else {
+        //  :      
+        MoveToEx(hdc, X, fy(b.vMax) - 1, nullptr);
+        LineTo(hdc, X, fy(b.vMin) + 2);
       }
     }
+  } else {
+    for (int i = 0; i < nPoints; i++) {
+      int X = fx(Tm[i]);
+      int Y = fy(Ca[i]);
+      SelectObject(hdc, isRejected(i) ? hPenRejected : hPenExp);
+      MoveToEx(hdc, X - 3, Y, nullptr);
+      LineTo(hdc, X + 3, Y);
+      MoveToEx(hdc, X, Y - 3, nullptr);
+      LineTo(hdc, X, Y + 3);
+    }
+  }
 
-    //  
-    HPEN hPenA = CreatePen(PS_SOLID, 1, RGB(0, 0, 255));
-    SelectObject(hdc, hPenA);
-    Polyline(hdc, arrA.data(), static_cast<int>(arrA.size()));
-    DeleteObject(hPenA);
+  //  A(t), B(t), C(t)    
+  if (!scene.traj.Empty()) {
+    const LodPyramid* lods[3] = {&scene.lodA, &scene.lodB, &scene.lodC};
+    const COLORREF colors[3] = {RGB(0, 0, 255), RGB(0, 128, 0),
+                                RGB(255, 128, 0)};
+    for (int c = 0; c < 3; c++) {
+      int level = lods[c]->Query(Tmin, Tmax, maxBuckets, buckets);
+      BucketsToPolyline(buckets, level, layout, pts);
+      HPEN hPenCurve = CreatePen(PS_SOLID, 1, colors[c]);
+      SelectObject(hdc, hPenCurve);
+      Polyline(hdc, pts.data(), static_cast<int>(pts.size()));
+      SelectObject(hdc, hPenAxis);
+      DeleteObject(hPenCurve);
+    }
+  }
 
-    HPEN hPenB = CreatePen(PS_SOLID, 1, RGB(0, 128, 0));
-    SelectObject(hdc, hPenB);
-    Polyline(hdc, arrB.data(), static_cast<int>(arrB.size()));
-    DeleteObject(hPenB);
+  //     
+  static const COLORREF kModelColors[] = {RGB(128, 0, 128), RGB(0, 128, 128),
+                                          RGB(128, 64, 0)};
+  const size_t nModels =
+      std::min(scene.models.size(), std::size(kModelColors));
+  for (size_t m = 0; m < nModels; m++) {
+    int level = scene.models[m].lod.Query(Tmin, Tmax, maxBuckets, buckets);
+    BucketsToPolyline(buckets, level, layout, pts);
+    HPEN hPenModel = CreatePen(PS_DASH, 1, kModelColors[m]);
+    SelectObject(hdc, hPenModel);
+    Polyline(hdc, pts.data(), static_cast<int>(pts.size()));
+    SelectObject(hdc, hPenAxis);
+    DeleteObject(hPenModel);
+  }
 
-    HPEN hPenC = CreatePen(PS_SOLID, 1, RGB(255, 128, 0));
-    SelectObject(hdc, hPenC);
-    Polyline(hdc, arrC.data(), static_cast<int>(arrC.size()));
-    DeleteObject(hPenC);
+  //     
+  const bool hasInfo = !scene.info.empty();
+  if (hasInfo) {
+    int level = scene.lodInfo.Query(Tmin, Tmax, maxBuckets, buckets);
+    BucketsToPolyline(buckets, level, layout, pts);
+    HPEN hPenInfo = CreatePen(PS_DOT, 1, RGB(128, 128, 128));
+    SelectObject(hdc, hPenInfo);
+    Polyline(hdc, pts.data(), static_cast<int>(pts.size()));
+    SelectObject(hdc, hPenAxis);
+    DeleteObject(hPenInfo);
   }
 
-  //  
+  RestoreDC(hdc, -1);
+
+  //   (  ,     )
   SelectObject(hdc, hPenAxis);
-  int legendX = left + width - 140;
+  const int extraRows = static_cast<int>(nModels) + (hasInfo ? 1 : 0);
+  const int legendW = extraRows > 0 ? 260 : 130;
+  int legendX = left + width - legendW - 10;
   int legendY = top + 10;
-  RECT rcLeg = {legendX, legendY, legendX + 130, legendY + 80};
+  RECT rcLeg = {legendX, legendY, legendX + legendW,
+                legendY + 80 + 15 * extraRows};
   HBRUSH hBrWhite = CreateSolidBrush(RGB(255, 255, 255));
   FillRect(hdc, &rcLeg, hBrWhite);
   DeleteObject(hBrWhite);
@@ -207,8 +356,35 @@ void DrawChart(HDC hdc, const RECT& rcClient, const std::vector<double>& Ca,
   SelectObject(hdc, hPenAxis);
   DeleteObject(hPenExp2);
 
+  int rowY = legendY + 75;
+  if (hasInfo) {
+    HPEN hPenInfo = CreatePen(PS_DOT, 1, RGB(128, 128, 128));
+    SelectObject(hdc, hPenInfo);
+    MoveToEx(hdc, legendX + 10, rowY, nullptr);
+    LineTo(hdc, legendX + 30, rowY);
+    SelectObject(hdc, hPenAxis);
+    DeleteObject(hPenInfo);
+    TextOut(hdc, legendX + 35, rowY - 7, L"", 15);
+    rowY += 15;
+  }
+
+  //    
+  for (size_t m = 0; m < nModels; m++) {
+    const int y = rowY + 15 * static_cast<int>(m);
+    HPEN hPenModel = CreatePen(PS_DASH, 1, kModelColors[m]);
+    SelectObject(hdc, hPenModel);
+    MoveToEx(hdc, legendX + 10, y, nullptr);
+    LineTo(hdc, legendX + 30, y);
+    SelectObject(hdc, hPenAxis);
+    DeleteObject(hPenModel);
+    const std::wstring& label = scene.models[m].label;
+    TextOut(hdc, legendX + 35, y - 7, label.c_str(),
+            static_cast<int>(label.size()));
+  }
+
   //  
   SelectObject(hdc, hPenOld);
   DeleteObject(hPenAxis);
   DeleteObject(hPenExp);
+  DeleteObject(hPenRejected);
 }
@@ -3,21 +3,117 @@
 
 #include <windows.h>
 
+#include <string>
 #include <vector>
 
-/// \brief       
-/// .
+#include "LodPyramid.h"
+#include "Trajectory.h"
+
+/// \brief      .
+struct ChartBounds {
+  double Tmin = 0.0;  ///<    .
+  double Tmax = 1.0;  ///<    .
+  double Cmin = 0.0;  ///<    .
+  double Cmax = 1.0;  ///<    .
+};
+
+/// \brief      .
+///
+///        ,  
+///        .
+struct ChartLayout {
+  int left = 0;          ///<     ().
+  int top = 0;           ///<     ().
+  double plotW = 0.0;    ///<   .
+  double plotH = 0.0;    ///<   .
+  double Tmin = 0.0;     ///<    .
+  double Tmax = 1.0;     ///<    .
+  double Cmin = 0.0;     ///<    .
+  double Cmax = 1.0;     ///<    .
+
+  /// \brief   X    \a t.
+  int ToX(double t) const;
+  /// \brief   Y   \a c.
+  int ToY(double c) const;
+  /// \brief      X (   ).
+  double FromX(int x) const;
+  /// \brief     Y (  ).
+  double FromY(int y) const;
+  /// \brief     .
+  double AxisWidth() const { return plotW - 20; }
+  /// \brief     .
+  double AxisHeight() const { return plotH - 40; }
+  /// \brief   .
+  ChartBounds Bounds() const { return {Tmin, Tmax, Cmin, Cmax}; }
+};
+
+/// \brief  A(t)   .
+struct ModelCurve {
+  std::wstring label;      ///<   .
+  std::vector<double> t;   ///<  .
+  std::vector<double> A;   ///<  A(t).
+  LodPyramid lod;          ///<  .
+};
+
+/// \brief   .
+///
+///        
+/// ;       
+///      .
+struct ChartScene {
+  std::vector<double> Ca;  ///<    A.
+  std::vector<double> Tm;  ///<    .
+  bool tmSorted = false;   ///< \c true,  \c Tm  .
+  ///      (   );
+  ///    .
+  std::vector<unsigned char> inliers;
+  Trajectory traj;         ///<   A(t), B(t), C(t).
+  ChartBounds bounds;      ///<   .
+  LodPyramid lodExp;       ///<   .
+  LodPyramid lodA;         ///<   A(t).
+  LodPyramid lodB;         ///<   B(t).
+  LodPyramid lodC;         ///<   C(t).
+  ///     ( ).
+  std::vector<ModelCurve> models;
+  ///     \c traj.t,   
+  ///  (   ).
+  std::vector<double> info;
+  LodPyramid lodInfo;      ///<   .
+
+  /// \brief  \c tmSorted      
+  /// .
+  void BuildLevels();
+};
+
+/// \brief       .
 ///
-/// \param hdc    .
-/// \param rcClient   ,   .
 /// \param Ca     A.
 /// \param Tm   .
 /// \param Cb   B.
 /// \param Cc   C.
-/// \param k   .
-/// \param n   .
-void DrawChart(HDC hdc, const RECT& rcClient, const std::vector<double>& Ca,
-               const std::vector<double>& Tm, double Cb, double Cc, double k,
-               double n);
+/// \return  .
+ChartBounds ComputeDataBounds(const std::vector<double>& Ca,
+                              const std::vector<double>& Tm, double Cb,
+                              double Cc);
+
+/// \brief       .
+///
+/// \param rcClient   .
+/// \param bounds   (    ).
+/// \return  .
+ChartLayout MakeChartLayout(const RECT& rcClient, const ChartBounds& bounds);
+
+/// \brief       
+/// .
+///
+///    min/max-,   
+///     ,    .
+///
+/// \param hdc    .
+/// \param rcClient   ,   .
+/// \param layout   (. \c MakeChartLayout).
+/// \param scene   .
+void DrawChart(HDC hdc, const RECT& rcClient, const ChartLayout& layout,
+               const ChartScene& scene);
 
 #endif  // CHARTDRAWER_H
@@ -0,0 +1,185 @@
+/**
+ * \file ChemApi.cpp
+ * \brief   C  \c ChemCalculation,  
+ *         .
+ */
+
+#include "ChemApi.h"
+
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "BatchCalculation.h"
+#include "ChemCalculation.h"
+#include "StreamingFit.h"
+
+static_assert(static_cast<int>(CalcStatus::NegativeConcentration) ==
+                      CHEM_STATUS_NEGATIVE_CONCENTRATION &&
+                  static_cast<int>(CalcStatus::TooFewPoints) ==
+                      CHEM_STATUS_TOO_FEW_POINTS &&
+                  static_cast<int>(CalcStatus::NonIncreasingTime) ==
+                      CHEM_STATUS_NON_INCREASING_TIME &&
+                  static_cast<int>(CalcStatus::Degenerate) ==
+                      CHEM_STATUS_DEGENERATE &&
+                  static_cast<int>(CalcStatus::NonFinite) ==
+                      CHEM_STATUS_NON_FINITE &&
+                  static_cast<int>(CalcStatus::NegativeInitial) ==
+                      CHEM_STATUS_NEGATIVE_INITIAL,
+              " CHEM_STATUS_*    CalcStatus");
+
+struct chem_context {
+  CalcWorkspace calc;
+  BatchWorkspace batch;
+  std::vector<SeriesView> views;  ///<   ( ).
+  std::vector<BatchFitResult> results;
+};
+
+struct chem_stream {
+  StreamingFit fit;
+};
+
+namespace {
+
+///    .
+constexpr size_t kBatchLanes = 16;
+
+void StoreOutcome(const CalcOutcome& outcome, chem_result* out) {
+  out->n = outcome.value.n;
+  out->k = outcome.value.k;
+  out->r = outcome.value.r;
+  out->disp = outcome.value.disp;
+  out->log_residual = 0.0;
+  out->status = static_cast<int32_t>(outcome.status);
+  out->index = outcome.index;
+}
+
+}  // namespace
+
+uint32_t chem_abi_version(void) { return CHEM_ABI_VERSION; }
+
+const char* chem_status_name(int32_t status) {
+  switch (status) {
+    case CHEM_STATUS_OK:
+      return "ok";
+    case CHEM_STATUS_NEGATIVE_CONCENTRATION:
+      return "negative_concentration";
+    case CHEM_STATUS_TOO_FEW_POINTS:
+      return "too_few_points";
+    case CHEM_STATUS_NON_INCREASING_TIME:
+      return "non_increasing_time";
+    case CHEM_STATUS_DEGENERATE:
+      return "degenerate";
+    case CHEM_STATUS_NON_FINITE:
+      return "non_finite";
+    case CHEM_STATUS_NEGATIVE_INITIAL:
+      return "negative_initial";
+    case CHEM_STATUS_INVALID_ARGUMENT:
+      return "invalid_argument";
+    case CHEM_STATUS_INTERNAL_ERROR:
+      return "internal_error";
+  }
+  return "unknown";
+}
+
+chem_context* chem_context_create(void) {
+  return new (std::nothrow) chem_context();
+}
+
+void chem_context_destroy(chem_context* context) { delete context; }
+
+int32_t chem_fit(chem_context* context, const double* tm, const double* ca,
+                 size_t count, double cb, double cc, chem_result* out) {
+  if (context == nullptr || out == nullptr ||
+      (count > 0 && (tm == nullptr || ca == nullptr)) ||
+      count > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    return CHEM_STATUS_INVALID_ARGUMENT;
+  }
+  try {
+    StoreOutcome(
+        ChemCalculation::TryCalculate(ca, tm, count, cb, cc, context->calc),
+        out);
+  } catch (...) {
+    //      
+    return CHEM_STATUS_INTERNAL_ERROR;
+  }
+  return out->status;
+}
+
+int32_t chem_fit_batch(chem_context* context, const chem_series* series,
+                       size_t count, chem_result* out, uint32_t flags) {
+  if (context == nullptr ||
+      (count > 0 && (series == nullptr || out == nullptr)) ||
+      (flags & ~CHEM_BATCH_DISPERSION) != 0) {
+    return CHEM_STATUS_INVALID_ARGUMENT;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (series[i].count > 0 &&
+        (series[i].ca == nullptr || series[i].tm == nullptr)) {
+      return CHEM_STATUS_INVALID_ARGUMENT;
+    }
+  }
+  try {
+    context->views.resize(count);
+    context->results.resize(count);
+    for (size_t i = 0; i < count; i++) {
+      context->views[i].Ca = series[i].ca;
+      context->views[i].Tm = series[i].tm;
+      context->views[i].count = series[i].count;
+    }
+    CalculateBatch(context->views.data(), count, context->results.data(),
+                   kBatchLanes, (flags & CHEM_BATCH_DISPERSION) != 0,
+                   context->batch);
+  } catch (...) {
+    return CHEM_STATUS_INTERNAL_ERROR;
+  }
+  for (size_t i = 0; i < count; i++) {
+    const BatchFitResult& res = context->results[i];
+    out[i].n = res.fit.n;
+    out[i].k = res.fit.k;
+    out[i].r = res.fit.r;
+    out[i].disp = res.fit.disp;
+    out[i].log_residual = res.logResidual;
+    out[i].status = static_cast<int32_t>(res.status);
+    out[i].index = -1;
+  }
+  return CHEM_STATUS_OK;
+}
+
+double chem_dispersion(const double* tm, const double* ca, size_t count,
+                       double k, double n, double* scratch) {
+  if (count < 2) return 0.0;
+  if (tm == nullptr || ca == nullptr || scratch == nullptr) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  //   :      
+  static thread_local ReductionScratch reduction;
+  return ChemCalculation::ComputeDispersion(ca, tm, count, k, n, nullptr,
+                                            scratch, &reduction);
+}
+
+chem_stream* chem_stream_create(void) {
+  return new (std::nothrow) chem_stream();
+}
+
+void chem_stream_destroy(chem_stream* stream) { delete stream; }
+
+void chem_stream_reset(chem_stream* stream) {
+  if (stream != nullptr) stream->fit.Reset();
+}
+
+int32_t chem_stream_push(chem_stream* stream, const double* tm,
+                         const double* ca, size_t count) {
+  if (stream == nullptr || (count > 0 && (tm == nullptr || ca == nullptr))) {
+    return CHEM_STATUS_INVALID_ARGUMENT;
+  }
+  return static_cast<int32_t>(stream->fit.Push(tm, ca, count));
+}
+
+int32_t chem_stream_result(const chem_stream* stream, chem_result* out) {
+  if (stream == nullptr || out == nullptr) {
+    return CHEM_STATUS_INVALID_ARGUMENT;
+  }
+  StoreOutcome(stream->fit.Result(), out);
+  return out->status;
+}
@@ -0,0 +1,192 @@
+#ifndef CHEMAPI_H
+#define CHEMAPI_H
+
+/**
+ * \file ChemApi.h
+ * \brief  C   (libchemkin)  .
+ *
+ *    C99  C++      Win32. 
+ *       (, 
+ * numpy  ctypes):        
+ * .     \c chem_result .
+ *
+ *           
+ *  (   \c ReduceSums   ):
+ *         
+ *     . \c chem_dispersion    
+ *   .     
+ * (   ),     
+ * (\c ParallelFor);  \c CHEM_THREADS=1    
+ * .
+ *
+ *     :    
+ *  .    .
+ *
+ *   \c CHEM_STATUS_*  0  6   \c CalcStatus.
+ *         
+ * \c CHEM_ABI_VERSION.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(CHEM_API_STATIC)
+#define CHEM_API
+#elif defined(_WIN32)
+#if defined(CHEM_API_BUILD)
+#define CHEM_API __declspec(dllexport)
+#else
+#define CHEM_API __declspec(dllimport)
+#endif
+#else
+#define CHEM_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**   . */
+#define CHEM_ABI_VERSION 1
+
+/**  . */
+#define CHEM_STATUS_OK 0
+/**    Ca. */
+#define CHEM_STATUS_NEGATIVE_CONCENTRATION 1
+/**   . */
+#define CHEM_STATUS_TOO_FEW_POINTS 2
+/**    . */
+#define CHEM_STATUS_NON_INCREASING_TIME 3
+/**   (  ). */
+#define CHEM_STATUS_DEGENERATE 4
+/**   NaN/inf. */
+#define CHEM_STATUS_NON_FINITE 5
+/** Cb  Cc . */
+#define CHEM_STATUS_NEGATIVE_INITIAL 6
+/**     . */
+#define CHEM_STATUS_INVALID_ARGUMENT 100
+/**        . */
+#define CHEM_STATUS_INTERNAL_ERROR 101
+
+/**   :   ( ). */
+#define CHEM_BATCH_DISPERSION 1u
+
+/**
+ * \brief    .
+ */
+typedef struct chem_result {
+  double n;     /**<  . */
+  double k;     /**<  . */
+  double r;     /**<  . */
+  double disp;  /**<  (0,   ). */
+  /**   ln W  ln A (  ). */
+  double log_residual;
+  int32_t status; /**< CHEM_STATUS_*;     0. */
+  /**  ,  ,  -1 (   ). */
+  int32_t index;
+} chem_result;
+
+/**
+ * \brief   :    .
+ */
+typedef struct chem_series {
+  const double* ca; /**<   A. */
+  const double* tm; /**<  . */
+  size_t count;     /**<  . */
+} chem_series;
+
+/**  :      . */
+typedef struct chem_context chem_context;
+
+/**  :     . */
+typedef struct chem_stream chem_stream;
+
+/**     (\c CHEM_ABI_VERSION). */
+CHEM_API uint32_t chem_abi_version(void);
+
+/**      ("ok", "degenerate", ...). */
+CHEM_API const char* chem_status_name(int32_t status);
+
+/**  ; NULL   . */
+CHEM_API chem_context* chem_context_create(void);
+
+/**   (NULL ). */
+CHEM_API void chem_context_destroy(chem_context* context);
+
+/**
+ * \brief   ,   \c ChemCalculation::Calculate
+ *          .
+ *
+ * \param context .
+ * \param tm   (\a count ).
+ * \param ca   A (\a count ).
+ * \param count  .
+ * \param cb   B.
+ * \param cc   C.
+ * \param out  (    ).
+ * \return   (  out->status) 
+ *         \c CHEM_STATUS_INVALID_ARGUMENT.
+ */
+CHEM_API int32_t chem_fit(chem_context* context, const double* tm,
+                          const double* ca, size_t count, double cb,
+                          double cc, chem_result* out);
+
+/**
+ * \brief   n, k, r ( \c CalculateBatch,  16 ).
+ *
+ * \param context .
+ * \param series  (\a count ).
+ * \param count  .
+ * \param out  (\a count ).
+ * \param flags 0  \c CHEM_BATCH_DISPERSION.
+ * \return \c CHEM_STATUS_OK,    (   
+ *         \a out),    .
+ */
+CHEM_API int32_t chem_fit_batch(chem_context* context,
+                                const chem_series* series, size_t count,
+                                chem_result* out, uint32_t flags);
+
+/**
+ * \brief   W = k * A^n  .
+ *
+ * \param scratch    count - 1 .
+ * \return   NaN   .
+ *
+ *        ,  
+ *    .
+ */
+CHEM_API double chem_dispersion(const double* tm, const double* ca,
+                                size_t count, double k, double n,
+                                double* scratch);
+
+/**   ; NULL   . */
+CHEM_API chem_stream* chem_stream_create(void);
+
+/**    (NULL ). */
+CHEM_API void chem_stream_destroy(chem_stream* stream);
+
+/**   . */
+CHEM_API void chem_stream_reset(chem_stream* stream);
+
+/**
+ * \brief  \a count ; O(1)  ,   .
+ *
+ * \return     (   
+ *         \c chem_stream_reset).
+ */
+CHEM_API int32_t chem_stream_push(chem_stream* stream, const double* tm,
+                                  const double* ca, size_t count);
+
+/**
+ * \brief  n, k, r (disp = 0; . \c chem_dispersion).
+ *
+ * \return   (  out->status).
+ */
+CHEM_API int32_t chem_stream_result(const chem_stream* stream,
+                                    chem_result* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CHEMAPI_H */
@@ -11,11 +11,36 @@
 
 #include "ChemCalculation.h"
 
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <stdexcept>
 
-#include "Utils.h"
+#include "LaneMath.h"
+#include "RateEstimator.h"
+#include "Reduction.h"
+#include "Trace.h"
+
+const char* CalcStatusMessage(CalcStatus status) {
+  switch (status) {
+    case CalcStatus::Ok:
+      return "";
+    case CalcStatus::NegativeConcentration:
+      return " Ca    !";
+    case CalcStatus::TooFewPoints:
+      return "   !";
+    case CalcStatus::NonIncreasingTime:
+      return "    (t[i+1] > t[i])!";
+    case CalcStatus::Degenerate:
+      return "   (  ).  "
+             "!";
+    case CalcStatus::NonFinite:
+      return "   NaN/inf!  .";
+    case CalcStatus::NegativeInitial:
+      return "  Cb  Cc    !";
+  }
+  return "";
+}
 
 /**
  * \brief     .
@@ -65,34 +90,257 @@
 CalculationResult ChemCalculation::Calculate(const std::vector<double>& Ca,
                                              const std::vector<double>& Tm,
                                              double Cb, double Cc) {
-  CalculationResult result = {0.0, 0.0, 0.0, 0.0};
-  const int nPoints = static_cast<int>(Ca.size());
+  const CalcOutcome outcome = TryCalculate(Ca, Tm, Cb, Cc);
+  if (!outcome) throw std::runtime_error(CalcStatusMessage(outcome.status));
+  return outcome.value;
+}
+
+/**
+ * \brief    .
+ *
+ * \param Ca     A.
+ * \param Tm    .
+ * \param Cb    B.
+ * \param Cc    C.
+ * \return        .
+ */
+CalcOutcome ChemCalculation::TryCalculate(const std::vector<double>& Ca,
+                                          const std::vector<double>& Tm,
+                                          double Cb, double Cc) {
+  CalcWorkspace workspace;
+  return TryCalculate(Ca.data(), Tm.data(), Ca.size(), Cb, Cc, workspace);
+}
+
+/**
+ * \brief  \c TryCalculate     .
+ *
+ * \param Ca   A (\a count ).
+ * \param Tm   (\a count ).
+ * \param count  .
+ * \param Cb    B.
+ * \param Cc    C.
+ * \param workspace  ;     .
+ * \return        .
+ */
+CalcOutcome ChemCalculation::TryCalculate(const double* Ca, const double* Tm,
+                                          size_t count, double Cb, double Cc,
+                                          CalcWorkspace& workspace) {
+  TRACE_SCOPE("ChemCalculation::Calculate");
+  CalcOutcome outcome = {{0.0, 0.0, 0.0, 0.0}, CalcStatus::Ok, -1};
+  TRACE_COUNTER("Calculate.points", count);
 
   // 1.   
-  if (Cb < 0.0 || Cc < 0.0) {
+  outcome.status = CheckInput(Ca, Tm, count, Cb, Cc, outcome.index);
+  if (!outcome) return outcome;
+
+  // 2-4.      
+  const size_t m = count - 1;
+  workspace.x.resize(m);
+  workspace.y.resize(m);
+  workspace.sq.resize(m);
+  BuildLogPoints(Ca, Tm, count, workspace.x.data(), workspace.y.data());
+  LogLogFit fit;
+  outcome.status = TryFitLogLog(workspace.x.data(), workspace.y.data(),
+                                nullptr, m, fit, &workspace.reduction);
+  if (!outcome) return outcome;
+  CalculationResult result = {fit.n, fit.k, fit.r, 0.0};
+
+  // 5.     
+  result.disp = ComputeDispersion(Ca, Tm, count, result.k, result.n, nullptr,
+                                  workspace.sq.data(), &workspace.reduction);
+
+  // 6.    NaN/inf
+  if (!std::isfinite(result.n) || !std::isfinite(result.k) ||
+      !std::isfinite(result.r) || !std::isfinite(result.disp)) {
+    outcome.status = CalcStatus::NonFinite;
+    return outcome;
+  }
+  outcome.value = result;
+  return outcome;
+}
+
+/**
+ * \brief       .
+ *
+ * \param Ca     A.
+ * \param Tm    .
+ * \param Cb    B.
+ * \param Cc    C.
+ * \param rates   .
+ * \param sigma    Ca  \c nullptr.
+ * \return  \c CalculationResult.
+ * \throw std::runtime_error   .
+ */
+CalculationResult ChemCalculation::Calculate(const std::vector<double>& Ca,
+                                             const std::vector<double>& Tm,
+                                             double Cb, double Cc,
+                                             const RateOptions& rates,
+                                             const std::vector<double>* sigma) {
+  std::vector<double> s;
+  const bool weighted = sigma != nullptr && !sigma->empty() &&
+                        PrepareSigma(Ca, *sigma, s);
+  if (!weighted && rates.method == RateMethod::ForwardDifference) {
+    return Calculate(Ca, Tm, Cb, Cc);
+  }
+  TRACE_SCOPE("ChemCalculation::CalculateWeighted");
+  ValidateInput(Ca, Tm, Cb, Cc);
+
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<size_t> source;
+  BuildRateLogPoints(Ca, Tm, rates, x, y, source, weighted ? &s : nullptr);
+  if (x.size() < 2 && rates.method != RateMethod::ForwardDifference) {
     throw std::runtime_error(
-        "  Cb  Cc    !");
+        "      !");
   }
-  for (size_t i = 0; i < Ca.size(); i++) {
-    if (Ca[i] < 0.0) {
-      throw std::runtime_error(" Ca    !");
+  LogLogFit fit = FitLogLog(x, y);
+
+  std::vector<double> pointWeights;
+  if (weighted) {
+    //        ln(Ca), 
+    //     n
+    std::vector<double> weights;
+    BuildLogWeights(Tm, s, rates, x, y, source, fit.n, weights);
+    fit = FitLogLog(x, y, &weights);
+    pointWeights.resize(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+      pointWeights[i] = 1.0 / (s[i] * s[i]);
     }
   }
-  if (nPoints < 2) {
-    throw std::runtime_error("   !");
+
+  CalculationResult result = {fit.n, fit.k, fit.r, 0.0};
+  result.disp = ComputeDispersion(Ca, Tm, result.k, result.n,
+                                  weighted ? &pointWeights : nullptr);
+  CheckFinite(result);
+  return result;
+}
+
+/**
+ * \brief         .
+ *
+ * \param Ca    A.
+ * \param sigma    Ca.
+ * \param out  .
+ * \return \c false,    .
+ * \throw std::runtime_error   .
+ */
+bool ChemCalculation::PrepareSigma(const std::vector<double>& Ca,
+                                   const std::vector<double>& sigma,
+                                   std::vector<double>& out) {
+  if (sigma.size() != Ca.size()) {
+    throw std::runtime_error(
+        "      !");
   }
-  for (int i = 0; i < nPoints - 1; i++) {
-    if (Tm[i + 1] <= Tm[i]) {
+  double minPositive = 0.0;
+  for (double v : sigma) {
+    if (!(v >= 0.0) || !std::isfinite(v)) {
       throw std::runtime_error(
-          "    (t[i+1] > t[i])!");
+          "     !");
     }
+    if (v > 0.0 && (minPositive == 0.0 || v < minPositive)) minPositive = v;
   }
+  if (minPositive == 0.0) return false;
+  out.resize(sigma.size());
+  for (size_t i = 0; i < sigma.size(); i++) {
+    out[i] = (sigma[i] > 0.0) ? sigma[i] : minPositive;
+  }
+  return true;
+}
 
-  // 2.     
-  double s1 = static_cast<double>(nPoints - 1);
-  double s2 = 0.0, s3 = 0.0, s4 = 0.0, s5 = 0.0, s6 = 0.0;
+/**
+ * \brief ,     .
+ *
+ * \param result  .
+ * \throw std::runtime_error   NaN  .
+ */
+void ChemCalculation::CheckFinite(const CalculationResult& result) {
+  //  C++17   std::isfinite,
+  //  MSVC  C++17  _finite(...)  ..
+  if (!std::isfinite(result.n) || !std::isfinite(result.k) ||
+      !std::isfinite(result.r) || !std::isfinite(result.disp)) {
+    throw std::runtime_error(CalcStatusMessage(CalcStatus::NonFinite));
+  }
+}
+
+/**
+ * \brief    .
+ *
+ * \param Ca     A.
+ * \param Tm    .
+ * \param Cb    B.
+ * \param Cc    C.
+ * \throw std::runtime_error   .
+ */
+void ChemCalculation::ValidateInput(const std::vector<double>& Ca,
+                                    const std::vector<double>& Tm, double Cb,
+                                    double Cc) {
+  int32_t index;
+  const CalcStatus status = CheckInput(Ca, Tm, Cb, Cc, index);
+  if (status != CalcStatus::Ok) {
+    throw std::runtime_error(CalcStatusMessage(status));
+  }
+}
+
+/**
+ * \brief     .
+ *
+ * \param Ca     A.
+ * \param Tm    .
+ * \param Cb    B.
+ * \param Cc    C.
+ * \param index  ,  ,  -1.
+ * \return    .
+ */
+CalcStatus ChemCalculation::CheckInput(const std::vector<double>& Ca,
+                                       const std::vector<double>& Tm,
+                                       double Cb, double Cc, int32_t& index) {
+  return CheckInput(Ca.data(), Tm.data(), Ca.size(), Cb, Cc, index);
+}
 
+CalcStatus ChemCalculation::CheckInput(const double* Ca, const double* Tm,
+                                       size_t count, double Cb, double Cc,
+                                       int32_t& index) {
+  const int nPoints = static_cast<int>(count);
+  index = -1;
+  if (Cb < 0.0 || Cc < 0.0) return CalcStatus::NegativeInitial;
+  for (size_t i = 0; i < count; i++) {
+    if (Ca[i] < 0.0) {
+      index = static_cast<int32_t>(i);
+      return CalcStatus::NegativeConcentration;
+    }
+  }
+  if (nPoints < 2) return CalcStatus::TooFewPoints;
   for (int i = 0; i < nPoints - 1; i++) {
+    if (Tm[i + 1] <= Tm[i]) {
+      index = i;
+      return CalcStatus::NonIncreasingTime;
+    }
+  }
+  return CalcStatus::Ok;
+}
+
+/**
+ * \brief    x = ln(Ca[i]), y = ln|dCa/dt|  .
+ *
+ * \param Ca     A.
+ * \param Tm    .
+ * \param x   (   ).
+ * \param y   (   ).
+ */
+void ChemCalculation::BuildLogPoints(const std::vector<double>& Ca,
+                                     const std::vector<double>& Tm,
+                                     std::vector<double>& x,
+                                     std::vector<double>& y) {
+  const size_t m = (Ca.size() > 1) ? Ca.size() - 1 : 0;
+  x.resize(m);
+  y.resize(m);
+  BuildLogPoints(Ca.data(), Tm.data(), Ca.size(), x.data(), y.data());
+}
+
+void ChemCalculation::BuildLogPoints(const double* Ca, const double* Tm,
+                                     size_t count, double* x, double* y) {
+  const int m = (count > 1) ? static_cast<int>(count) - 1 : 0;
+  for (int i = 0; i < m; i++) {
     double dC = Ca[i + 1] - Ca[i];
     double dt = Tm[i + 1] - Tm[i];
     //     dt
@@ -107,42 +355,170 @@ CalculationResult ChemCalculation::Calculate(const std::vector<double>& Ca,
 
     //   (  )
     double cVal = (Ca[i] < 1e-15) ? 1e-15 : Ca[i];
-    double x = std::log(cVal);
-    double y = std::log(w);
+    x[i] = std::log(cVal);
+    y[i] = std::log(w);
+  }
+}
+
+/**
+ * \brief   y = ln(k) + n * x   .
+ *
+ *     s1..s6 ;   
+ *        .
+ *
+ * \param x  .
+ * \param y  .
+ * \param weights    \c nullptr.
+ * \return  ,     .
+ * \throw std::runtime_error   .
+ */
+LogLogFit ChemCalculation::FitLogLog(const std::vector<double>& x,
+                                     const std::vector<double>& y,
+                                     const std::vector<double>* weights) {
+  LogLogFit fit;
+  if (TryFitLogLog(x, y, weights, fit) != CalcStatus::Ok) {
+    throw std::runtime_error(CalcStatusMessage(CalcStatus::Degenerate));
+  }
+  return fit;
+}
 
-    s2 += x;
-    s3 += y;
-    s4 += x * x;
-    s5 += x * y;
-    s6 += y * y;
+/**
+ * \brief   \c FitLogLog  .
+ *
+ * \param x  .
+ * \param y  .
+ * \param weights    \c nullptr.
+ * \param out   (   ).
+ * \return \c CalcStatus::Degenerate,   .
+ */
+CalcStatus ChemCalculation::TryFitLogLog(const std::vector<double>& x,
+                                         const std::vector<double>& y,
+                                         const std::vector<double>* weights,
+                                         LogLogFit& out) {
+  return TryFitLogLog(x.data(), y.data(),
+                      weights != nullptr ? weights->data() : nullptr, x.size(),
+                      out);
+}
+
+CalcStatus ChemCalculation::TryFitLogLog(const double* x, const double* y,
+                                         const double* weights, size_t m,
+                                         LogLogFit& out,
+                                         ReductionScratch* scratch) {
+  double s1 = 0.0;
+  double s2 = 0.0, s3 = 0.0, s4 = 0.0, s5 = 0.0, s6 = 0.0;
+
+  //    ReduceSums:     
+  //  (. Reduction.h)
+  if (weights == nullptr) {
+    double s[5];
+    ReduceSums<5>(m, [&](size_t i, double* v) {
+      v[0] = x[i];
+      v[1] = y[i];
+      v[2] = x[i] * x[i];
+      v[3] = x[i] * y[i];
+      v[4] = y[i] * y[i];
+    }, s, scratch);
+    s1 = static_cast<double>(m);
+    s2 = s[0];
+    s3 = s[1];
+    s4 = s[2];
+    s5 = s[3];
+    s6 = s[4];
+  } else {
+    double s[6];
+    ReduceSums<6>(m, [&](size_t i, double* v) {
+      const double w = weights[i];
+      v[0] = w;
+      v[1] = w * x[i];
+      v[2] = w * y[i];
+      v[3] = w * x[i] * x[i];
+      v[4] = w * x[i] * y[i];
+      v[5] = w * y[i] * y[i];
+    }, s, scratch);
+    s1 = s[0];
+    s2 = s[1];
+    s3 = s[2];
+    s4 = s[3];
+    s5 = s[4];
+    s6 = s[5];
   }
 
-  // 3.    (n)  ln(k)    
+  const double sums[6] = {s1, s2, s3, s4, s5, s6};
+  return FitFromSums(sums, out);
+}
+
+/**
+ * \brief      s1..s6.
+ *
+ * \param sums :  () , x, y, x*x, x*y, y*y.
+ * \param out   (   ).
+ * \return \c CalcStatus::Degenerate,   .
+ */
+CalcStatus ChemCalculation::FitFromSums(const double sums[6],
+                                        LogLogFit& out) {
+  const double s1 = sums[0];
+  const double s2 = sums[1], s3 = sums[2], s4 = sums[3], s5 = sums[4],
+               s6 = sums[5];
+
+  //    (n)  ln(k)    
+  LogLogFit fit = {0.0, 0.0, 0.0};
   double denom = (s1 * s4 - s2 * s2);
-  if (std::fabs(denom) < 1e-15) {
-    throw std::runtime_error(
-        "   (  ).  !");
-  }
+  if (std::fabs(denom) < 1e-15) return CalcStatus::Degenerate;
 
-  result.n = (s1 * s5 - s2 * s3) / denom;    // slope
+  fit.n = (s1 * s5 - s2 * s3) / denom;    // slope
   double t_k = (s3 * s4 - s2 * s5) / denom;  // intercept
-  result.k = std::exp(t_k);  //  
+  fit.k = std::exp(t_k);  //  
 
-  // 4.    r
+  //    r
   double denom_r_val = (s1 * s4 - s2 * s2) * (s1 * s6 - s3 * s3);
   if (denom_r_val < 1e-15) {
     //   (   y ) -> r  
-    result.r = 0.0;
+    fit.r = 0.0;
   } else {
     double denom_r = std::sqrt(denom_r_val);
-    result.r = (s1 * s5 - s2 * s3) / denom_r;
+    fit.r = (s1 * s5 - s2 * s3) / denom_r;
     //    [-1..1]   
-    if (result.r > 1.0) result.r = 1.0;
-    if (result.r < -1.0) result.r = -1.0;
+    if (fit.r > 1.0) fit.r = 1.0;
+    if (fit.r < -1.0) fit.r = -1.0;
   }
+  out = fit;
+  return CalcStatus::Ok;
+}
 
-  // 5.     
-  double sumSq = 0.0;
+/**
+ * \brief      W = k * A^n.
+ *
+ *    Ca[0]   (70   ),
+ *     1..N-1 .   
+ *   .
+ *
+ * \param Ca     A.
+ * \param Tm    .
+ * \param k  .
+ * \param n  .
+ * \param weights   ( \a Ca)  \c nullptr.
+ * \return .
+ */
+double ChemCalculation::ComputeDispersion(const std::vector<double>& Ca,
+                                          const std::vector<double>& Tm,
+                                          double k, double n,
+                                          const std::vector<double>* weights) {
+  if (Ca.size() < 2) return 0.0;
+  std::vector<double> sq(Ca.size() - 1);
+  return ComputeDispersion(Ca.data(), Tm.data(), Ca.size(), k, n,
+                           weights != nullptr ? weights->data() : nullptr,
+                           sq.data());
+}
+
+double ChemCalculation::ComputeDispersion(const double* Ca, const double* Tm,
+                                          size_t count, double k, double n,
+                                          const double* weights, double* sq,
+                                          ReductionScratch* scratch) {
+  const int nPoints = static_cast<int>(count);
+  if (nPoints < 2) return 0.0;
+
+  //  ,     
+  //    ReduceSums
   double Acur = Ca[0];
   double tcur = Tm[0];
 
@@ -161,7 +537,7 @@ CalculationResult ChemCalculation::Calculate(const std::vector<double>& Ca,
       if (Atemp < 1e-15) {
         Atemp = 0.0;  //  /  
       }
-      double rate = result.k * std::pow(Atemp, result.n);
+      double rate = k * std::pow(Atemp, n);
       Atemp -= rate * dtSub;
       if (Atemp < 0.0) {
         Atemp = 0.0;  //     
@@ -170,22 +546,139 @@ CalculationResult ChemCalculation::Calculate(const std::vector<double>& Ca,
 
     double diff = Ca[i] - Atemp;
     // ,     double
-    sumSq += std::round(diff * diff * 1e4) / 1e4;
+    sq[i - 1] = std::round(diff * diff * 1e4) / 1e4;
 
     Acur = Atemp;
     tcur = Tm[i];
   }
-  //   (nPoints - 1)  nPoints > 1 (  )
-  result.disp = sumSq / (nPoints - 1);
+  if (weights == nullptr) {
+    double sumSq = 0.0;
+    ReduceSums<1>(count - 1, [&](size_t i, double* v) { v[0] = sq[i]; },
+                  &sumSq, scratch);
+    //   (nPoints - 1)  nPoints > 1 (  )
+    return sumSq / (nPoints - 1);
+  }
+  double sums[2];
+  ReduceSums<2>(count - 1, [&](size_t i, double* v) {
+    v[0] = weights[i + 1] * sq[i];
+    v[1] = weights[i + 1];
+  }, sums, scratch);
+  return (sums[1] > 0.0) ? sums[0] / sums[1] : 0.0;
+}
 
-  // 6.    NaN/inf
-  //  C++17   std::isfinite,
-  //  MSVC  C++17  _finite(...)  ..
-  if (!std::isfinite(result.n) || !std::isfinite(result.k) ||
-      !std::isfinite(result.r) || !std::isfinite(result.disp)) {
+/**
+ * \brief    .
+ *
+ * \param Ca     A.
+ * \param Tm    ().
+ * \param n  .
+ * \return  \c ArrheniusResult.
+ * \throw std::runtime_error    .
+ */
+ArrheniusResult ChemCalculation::CalculateArrhenius(
+    const std::vector<double>& Ca, const std::vector<double>& Tm, double n) {
+  TRACE_SCOPE("Arrhenius");
+  const int nPoints = static_cast<int>(Ca.size());
+
+  //       k_i  
+  // .
+  std::vector<double> lnK;
+  std::vector<double> invT;
+  //       (Tm  )
+  for (int i = 0; i < nPoints - 1; i++) {
+    double dt = Tm[i + 1] - Tm[i];
+    double dCa = Ca[i + 1] - Ca[i];
+    if (dt <= 1e-15) dt = 1e-15;
+    double w = std::fabs(dCa / dt);
+    //   : k_i = w / (Ca[i]^n)
+    double k_i = w / std::pow(Ca[i], n);
+    double T_avg = (Tm[i] + Tm[i + 1]) / 2.0;
+    lnK.push_back(std::log(k_i));
+    invT.push_back(1.0 / T_avg);
+  }
+
+  //      ln(k) = ln(A) - Ea/(R*T)
+  double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+  int N = static_cast<int>(lnK.size());
+  if (N < 2) {
     throw std::runtime_error(
-        "   NaN/inf!  .");
+        "      "
+        "!");
   }
+  for (int i = 0; i < N; i++) {
+    sumX += invT[i];
+    sumY += lnK[i];
+    sumXX += invT[i] * invT[i];
+    sumXY += invT[i] * lnK[i];
+  }
+  double slope = (N * sumXY - sumX * sumY) / (N * sumXX - sumX * sumX);
+  double intercept = (sumY - slope * sumX) / N;
+  const double R_gas = 8.314;  // /()
 
+  ArrheniusResult result;
+  result.Ea = -slope * R_gas;         //   (/)
+  result.A = std::exp(intercept);     //  
   return result;
 }
+
+namespace {
+
+///    ,  .
+constexpr size_t kPropagateLanes = 64;
+
+}  // namespace
+
+/**
+ * \brief       .
+ *
+ * \param Ca    A.
+ * \param Tm   .
+ * \param k  .
+ * \param n  .
+ * \param count  .
+ * \param A :  A   Tm ( ).
+ */
+void ChemCalculation::PropagateBatch(const std::vector<double>& Ca,
+                                     const std::vector<double>& Tm,
+                                     const double* k, const double* n,
+                                     size_t count, double* A) {
+  const size_t nPoints = Ca.size();
+  if (nPoints == 0 || count == 0) return;
+
+  alignas(64) double a[kPropagateLanes];
+  alignas(64) double lnA[kPropagateLanes];
+  alignas(64) double pw[kPropagateLanes];
+  for (size_t base = 0; base < count; base += kPropagateLanes) {
+    const size_t lanes = std::min(kPropagateLanes, count - base);
+    const double* kk = k + base;
+    const double* nn = n + base;
+    for (size_t l = 0; l < lanes; l++) a[l] = Ca[0];
+    std::copy(a, a + lanes, A + base);
+
+    double tcur = Tm[0];
+    for (size_t i = 1; i < nPoints; i++) {
+      double dtFull = Tm[i] - tcur;
+      if (dtFull < 1e-15) {
+        dtFull = 1e-15;
+      }
+      const int subSteps = 70;
+      const double dtSub = dtFull / subSteps;
+      for (int s = 0; s < subSteps; s++) {
+        //  ComputeDispersion  : A < 1e-15 ,
+        // A^n = exp(n ln A) (      1, 
+        //  0 - k * dt   ,  0^n  n > 0)
+        for (size_t l = 0; l < lanes; l++) a[l] = a[l] < 1e-15 ? 0.0 : a[l];
+        for (size_t l = 0; l < lanes; l++) lnA[l] = a[l] > 0.0 ? a[l] : 1.0;
+        LaneLog(lnA, lnA, lanes);
+        for (size_t l = 0; l < lanes; l++) lnA[l] *= nn[l];
+        LaneExp(lnA, pw, lanes);
+        for (size_t l = 0; l < lanes; l++) {
+          const double rate = kk[l] * pw[l];
+          a[l] = std::max(a[l] - rate * dtSub, 0.0);
+        }
+      }
+      std::copy(a, a + lanes, A + i * count + base);
+      tcur = Tm[i];
+    }
+  }
+}
@@ -1,8 +1,14 @@
 #ifndef CHEMCALCULATION_H
 #define CHEMCALCULATION_H
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
+#include "Reduction.h"
+
+struct RateOptions;
+
 /**
  * \file ChemCalculation.h
  * \brief     ChemCalculation.
@@ -30,6 +36,85 @@ struct CalculationResult {
   double disp;  ///< .
 };
 
+/**
+ * \brief    ln(k) = ln(A) - Ea / (R * T).
+ */
+struct ArrheniusResult {
+  double A;   ///<  .
+  double Ea;  ///<   (/).
+};
+
+/**
+ * \brief   ;     .
+ */
+enum class FitMethod : uint32_t {
+  LeastSquares = 0,  ///<      .
+  Ransac = 1,        ///< RANSAC  /  (. RobustFit.h).
+  Huber = 2,         ///< IRLS    .
+  Tukey = 3,         ///< IRLS     .
+};
+
+/**
+ * \brief   ln|dCa/dt| = ln(k) + n * ln(Ca).
+ */
+struct LogLogFit {
+  double n;  ///<   ().
+  double k;  ///<   (  ).
+  double r;  ///<  .
+};
+
+/**
+ * \brief       .
+ *
+ *     \c ChemCalculation::ValidateInput 
+ *  \c CHEM_STATUS_* (ChemApi.h),   
+ *       : \c CheckInput 
+ *  \c NegativeInitial.
+ */
+enum class CalcStatus : uint8_t {
+  Ok,                     ///<  .
+  NegativeConcentration,  ///<    Ca.
+  TooFewPoints,           ///<   .
+  NonIncreasingTime,      ///<    .
+  Degenerate,             ///<   (  ).
+  NonFinite,              ///<   NaN/inf.
+  NegativeInitial         ///< Cb  Cc .
+};
+
+/**
+ * \brief      (  std::expected).
+ */
+struct CalcOutcome {
+  CalculationResult value;  ///< ;    .
+  CalcStatus status;        ///<  .
+  ///  ,  :   Ca  i, 
+  ///  Tm[i + 1] <= Tm[i]; -1,      .
+  int32_t index;
+
+  bool Ok() const { return status == CalcStatus::Ok; }
+  explicit operator bool() const { return Ok(); }
+};
+
+/**
+ * \brief     .
+ *
+ *          ,
+ *        .
+ */
+struct CalcWorkspace {
+  std::vector<double> x;   ///<  .
+  std::vector<double> y;   ///<  .
+  std::vector<double> sq;  ///<    .
+  ReductionScratch reduction;  ///<     .
+};
+
+/**
+ * \brief     ( ,   
+ *        \c ChemCalculation::Calculate);  \c CalcStatus::Ok  
+ *        .
+ */
+const char* CalcStatusMessage(CalcStatus status);
+
 /**
  * \brief      .
  *
@@ -76,6 +161,241 @@ class ChemCalculation {
   static CalculationResult Calculate(const std::vector<double>& Ca,
                                      const std::vector<double>& Tm,
                                      double Cb, double Cc);
+
+  /**
+   * \brief  \c Calculate  .
+   *
+   *    \c Calculate   ;  
+   *      .   
+   * ,     :   , 
+   *   .   \c Calculate.
+   *
+   * \param Ca     A.
+   * \param Tm   .
+   * \param Cb    B.
+   * \param Cc    C.
+   * \return     .
+   */
+  static CalcOutcome TryCalculate(const std::vector<double>& Ca,
+                                  const std::vector<double>& Tm, double Cb,
+                                  double Cc);
+
+  /**
+   * \brief \c TryCalculate     .
+   *
+   *        .  
+   *     \a workspace.
+   *
+   * \param Ca   A (\a count ).
+   * \param Tm   (\a count ).
+   * \param count  .
+   * \param Cb    B.
+   * \param Cc    C.
+   * \param workspace  .
+   * \return     .
+   */
+  static CalcOutcome TryCalculate(const double* Ca, const double* Tm,
+                                  size_t count, double Cb, double Cc,
+                                  CalcWorkspace& workspace);
+
+  /**
+   * \brief       (. RateEstimator.h).
+   *
+   *  \c RateMethod::ForwardDifference   \c Calculate. 
+   *       ,  
+   *  A .
+   *
+   * \param Ca     A.
+   * \param Tm   .
+   * \param Cb    B.
+   * \param Cc    C.
+   * \param rates   .
+   * \param sigma    Ca  \c nullptr. 
+   *        ,  ln(W)  ln(Ca)  
+   *          (. \c BuildLogWeights),  
+   *        \c disp       1/sigma^2.
+   * \return  \c CalculationResult.
+   * \throw std::runtime_error       
+   *          .
+   */
+  static CalculationResult Calculate(const std::vector<double>& Ca,
+                                     const std::vector<double>& Tm,
+                                     double Cb, double Cc,
+                                     const RateOptions& rates,
+                                     const std::vector<double>* sigma = nullptr);
+
+  /**
+   * \brief    .
+   *
+   *      
+   * k_i = |dCa/dt| / Ca[i]^n     ( \a Tm
+   *     ),    
+   * ln(k_i)  1/T  A  Ea.
+   *
+   * \param Ca     A.
+   * \param Tm    ().
+   * \param n  ,   \c Calculate.
+   *
+   * \return  \c ArrheniusResult.
+   *
+   * \throw std::runtime_error    .
+   */
+  static ArrheniusResult CalculateArrhenius(const std::vector<double>& Ca,
+                                            const std::vector<double>& Tm,
+                                            double n);
+
+  /**
+   * \brief       \c Calculate.
+   *
+   * \throw std::runtime_error   .
+   */
+  static void ValidateInput(const std::vector<double>& Ca,
+                            const std::vector<double>& Tm, double Cb,
+                            double Cc);
+
+  /**
+   * \brief  \c ValidateInput  .
+   *
+   * \param index :  ,  ,  -1.
+   * \return      \c CalcStatus::Ok.
+   */
+  static CalcStatus CheckInput(const std::vector<double>& Ca,
+                               const std::vector<double>& Tm, double Cb,
+                               double Cc, int32_t& index);
+
+  /// \c CheckInput   (\a count ).
+  static CalcStatus CheckInput(const double* Ca, const double* Tm,
+                               size_t count, double Cb, double Cc,
+                               int32_t& index);
+
+  /**
+   * \brief        .
+   *
+   *   i: \a x[i] = ln(Ca[i]), \a y[i] = ln|dCa/dt|
+   * (   ,   \c Calculate).
+   *
+   * \param Ca    A.
+   * \param Tm   .
+   * \param x :   (N-1 ).
+   * \param y :   (N-1 ).
+   */
+  static void BuildLogPoints(const std::vector<double>& Ca,
+                             const std::vector<double>& Tm,
+                             std::vector<double>& x, std::vector<double>& y);
+
+  /// \c BuildLogPoints  : \a x  \a y  count - 1
+  /// .
+  static void BuildLogPoints(const double* Ca, const double* Tm,
+                             size_t count, double* x, double* y);
+
+  /**
+   * \brief  y = ln(k) + n * x,   .
+   *
+   * \param x  .
+   * \param y  .
+   * \param weights    \c nullptr (   1).
+   * \return  .
+   * \throw std::runtime_error   .
+   */
+  static LogLogFit FitLogLog(const std::vector<double>& x,
+                             const std::vector<double>& y,
+                             const std::vector<double>* weights = nullptr);
+
+  /**
+   * \brief  \c FitLogLog  .
+   *
+   * \param fit :   (   ).
+   * \return \c CalcStatus::Ok  \c CalcStatus::Degenerate.
+   */
+  static CalcStatus TryFitLogLog(const std::vector<double>& x,
+                                 const std::vector<double>& y,
+                                 const std::vector<double>* weights,
+                                 LogLogFit& fit);
+
+  /// \c TryFitLogLog   (\a count , \a weights  
+  /// \c nullptr; \a scratch    , . \c ReduceSums).
+  static CalcStatus TryFitLogLog(const double* x, const double* y,
+                                 const double* weights, size_t count,
+                                 LogLogFit& fit,
+                                 ReductionScratch* scratch = nullptr);
+
+  /**
+   * \brief    \c FitLogLog   .
+   *
+   * \param sums  ( )    x, y, x*x, x*y, y*y.
+   * \param fit :   (   ).
+   * \return \c CalcStatus::Ok  \c CalcStatus::Degenerate.
+   */
+  static CalcStatus FitFromSums(const double sums[6], LogLogFit& fit);
+
+  /**
+   * \brief         .
+   *
+   *     :   
+   *   .
+   *
+   * \param Ca    A.
+   * \param sigma    Ca.
+   * \param out  .
+   * \return \c false,     (  ).
+   * \throw std::runtime_error      \a Ca  
+   *           .
+   */
+  static bool PrepareSigma(const std::vector<double>& Ca,
+                           const std::vector<double>& sigma,
+                           std::vector<double>& out);
+
+  /**
+   * \brief ,     .
+   *
+   * \throw std::runtime_error   NaN  .
+   */
+  static void CheckFinite(const CalculationResult& result);
+
+  /**
+   * \brief      .
+   *
+   * \param Ca    A.
+   * \param Tm   .
+   * \param k  .
+   * \param n  .
+   * \param weights   ( \a Ca;   0  )
+   *         \c nullptr     N-1 .
+   * \return .
+   */
+  static double ComputeDispersion(const std::vector<double>& Ca,
+                                  const std::vector<double>& Tm, double k,
+                                  double n,
+                                  const std::vector<double>* weights = nullptr);
+
+  /// \c ComputeDispersion  ; \a sq    count - 1
+  /// , \a scratch     (. \c ReduceSums).
+  static double ComputeDispersion(const double* Ca, const double* Tm,
+                                  size_t count, double k, double n,
+                                  const double* weights, double* sq,
+                                  ReductionScratch* scratch = nullptr);
+
+  /**
+   * \brief   W = k * A^n    .
+   *
+   *   ,   \c ComputeDispersion (70   
+   * ,  A  ).  A^n  
+   * exp(n ln A)  \c LaneLog  \c LaneExp (LaneMath.h), 
+   *   ,     .
+   *    \c std::pow     
+   *  ( ~1e-14   ).
+   *
+   * \param Ca    A ( Ca[0]).
+   * \param Tm   .
+   * \param k   (\a count ).
+   * \param n   (\a count ).
+   * \param count   .
+   * \param A : Tm.size()   \a count , A[i * count + j]
+   *            Tm[i]   j.
+   */
+  static void PropagateBatch(const std::vector<double>& Ca,
+                             const std::vector<double>& Tm, const double* k,
+                             const double* n, size_t count, double* A);
 };
 
 #endif  // CHEMCALCULATION_H
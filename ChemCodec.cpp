@@ -0,0 +1,144 @@
+/**
+ * \file ChemCodec.cpp
+ * \brief   (t, Ca)   (. SeriesCodec.h).
+ *
+ * :
+ *   chem_codec encode INPUT OUTPUT [--max-error E]
+ *   chem_codec decode INPUT OUTPUT.csv
+ *   chem_codec bench INPUT [REPEATS]
+ * encode  ,   ; bench   
+ *          n  k  .
+ */
+
+#include <chrono>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ChemCalculation.h"
+#include "DataImport.h"
+#include "SeriesCodec.h"
+
+namespace {
+
+void PrintUsage() {
+  std::fprintf(stderr,
+               "usage: chem_codec encode INPUT OUTPUT [--max-error E]\n"
+               "       chem_codec decode INPUT OUTPUT\n"
+               "       chem_codec bench INPUT [REPEATS]\n");
+}
+
+std::vector<unsigned char> ReadAll(const char* path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) throw std::runtime_error("   !");
+  return std::vector<unsigned char>(std::istreambuf_iterator<char>(file),
+                                    std::istreambuf_iterator<char>());
+}
+
+int Encode(int argc, char** argv) {
+  SeriesCodecOptions options;
+  for (int i = 4; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--max-error" && i + 1 < argc) {
+      options.maxError = std::atof(argv[++i]);
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+  const ImportedData data = ImportDelimitedFile(argv[2]);
+  const std::vector<unsigned char> packed = EncodeSeries(
+      data.Tm.data(), data.Ca.data(), data.Tm.size(), options);
+  std::ofstream file(argv[3], std::ios::binary);
+  file.write(reinterpret_cast<const char*>(packed.data()),
+             static_cast<std::streamsize>(packed.size()));
+  if (!file) throw std::runtime_error("   !");
+
+  const SeriesCodecInfo info = InspectSeries(packed.data(), packed.size());
+  std::fprintf(stderr,
+               "%zu points, %zu bytes (%.2f bits/point), time %s, Ca %s\n",
+               info.count, packed.size(),
+               info.count ? packed.size() * 8.0 / info.count : 0.0,
+               info.timeTicks ? "ticks" : "xor",
+               info.quantized ? "quantized" : "lossless");
+  return 0;
+}
+
+int Decode(char** argv) {
+  const std::vector<unsigned char> packed = ReadAll(argv[2]);
+  std::vector<double> Tm, Ca;
+  DecodeSeries(packed, Tm, Ca);
+  std::ofstream file(argv[3], std::ios::binary);
+  std::string line;
+  char buf[32];
+  for (size_t i = 0; i < Tm.size(); i++) {
+    line.clear();
+    line.append(buf, std::to_chars(buf, buf + sizeof(buf), Tm[i]).ptr);
+    line.push_back(';');
+    line.append(buf, std::to_chars(buf, buf + sizeof(buf), Ca[i]).ptr);
+    line.push_back('\n');
+    file.write(line.data(), static_cast<std::streamsize>(line.size()));
+  }
+  if (!file) throw std::runtime_error("   !");
+  std::fprintf(stderr, "%zu rows decoded\n", Tm.size());
+  return 0;
+}
+
+int Bench(int argc, char** argv) {
+  const std::vector<unsigned char> packed = ReadAll(argv[2]);
+  const size_t repeats =
+      argc > 3 ? static_cast<size_t>(std::strtoull(argv[3], nullptr, 10))
+               : 20;
+  const SeriesCodecInfo info = InspectSeries(packed.data(), packed.size());
+  std::vector<double> Tm(info.count), Ca(info.count);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t r = 0; r < repeats; r++) {
+    DecodeSeries(packed.data(), packed.size(), Tm.data(), Ca.data());
+  }
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  const double bytes = 16.0 * info.count * repeats;
+  std::printf("decode %zu points x %zu: %.3f s, %.2f GB/s, ratio %.2f\n",
+              info.count, repeats, seconds,
+              bytes / 1e9 / (seconds > 0 ? seconds : 1),
+              packed.empty() ? 0.0 : 16.0 * info.count / packed.size());
+
+  CalcWorkspace workspace;
+  const CalcOutcome fit = ChemCalculation::TryCalculate(
+      Ca.data(), Tm.data(), info.count, 0.0, 0.0, workspace);
+  if (fit.Ok()) {
+    std::printf("n %.6g  k %.6g  r %.6f\n", fit.value.n, fit.value.k,
+                fit.value.r);
+  } else {
+    std::printf("status %d  index %d\n", static_cast<int>(fit.status),
+                static_cast<int>(fit.index));
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    PrintUsage();
+    return 2;
+  }
+  const std::string command = argv[1];
+  try {
+    if (command == "encode" && argc >= 4) return Encode(argc, argv);
+    if (command == "decode" && argc == 4) return Decode(argv);
+    if (command == "bench" && argc <= 4) return Bench(argc, argv);
+    PrintUsage();
+    return 2;
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "chem_codec: %s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,109 @@
+/**
+ * \file ChemLive.cpp
+ * \brief     .
+ *
+ *   "t Ca"  ,  Unix   
+ * (   LiveAcquisition.h),    n, k 
+ *   ,     SIGINT/SIGTERM,
+ *    .
+ *
+ * :
+ *   chem_live [--interval 100] SOURCE
+ * SOURCE      , "-"   .
+ */
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "LiveAcquisition.h"
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void OnSignal(int) { g_stop = 1; }
+
+void PrintUsage() {
+  std::fprintf(stderr, "usage: chem_live [--interval MS] SOURCE\n");
+}
+
+void PrintEstimate(const LiveEstimate& e) {
+  if (e.fit.Ok()) {
+    std::printf("samples %llu  t %.6g  Ca %.6g  n %.6g  k %.6g  r %.6f\n",
+                static_cast<unsigned long long>(e.samples), e.lastT,
+                e.lastCa, e.fit.value.n, e.fit.value.k, e.fit.value.r);
+  } else {
+    std::printf("samples %llu  status %d\n",
+                static_cast<unsigned long long>(e.samples),
+                static_cast<int>(e.fit.status));
+  }
+  std::fflush(stdout);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int intervalMs = 100;
+  std::string source;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--interval" && i + 1 < argc) {
+      intervalMs = std::atoi(argv[++i]);
+    } else if (source.empty() && (arg == "-" || arg[0] != '-')) {
+      source = arg;
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+  if (source.empty() || intervalMs <= 0) {
+    PrintUsage();
+    return 2;
+  }
+
+  std::signal(SIGINT, OnSignal);
+  std::signal(SIGTERM, OnSignal);
+  try {
+    LiveAcquisition live;
+    live.Start(source);
+    uint64_t shown = 0;
+    while (!g_stop && live.Running()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+      const LiveEstimate e = live.Estimate();
+      if (e.version != shown) {
+        PrintEstimate(e);
+        shown = e.version;
+      }
+    }
+    live.Stop();
+    PrintEstimate(live.Estimate());
+    const LiveStats stats = live.Stats();
+    std::fprintf(stderr,
+                 "samples %llu, rejected %llu, bad lines %llu, ring stalls "
+                 "%llu\n",
+                 static_cast<unsigned long long>(stats.samples),
+                 static_cast<unsigned long long>(stats.rejected),
+                 static_cast<unsigned long long>(stats.badLines),
+                 static_cast<unsigned long long>(stats.ringStalls));
+    std::fprintf(stderr,
+                 "updates: %llu, latency us: mean %.1f, p50 %.1f, p90 %.1f, "
+                 "p99 %.1f, max %.1f\n",
+                 static_cast<unsigned long long>(stats.latency.count),
+                 stats.latency.meanUs, stats.latency.p50Us,
+                 stats.latency.p90Us, stats.latency.p99Us,
+                 stats.latency.maxUs);
+    if (!stats.error.empty()) {
+      std::fprintf(stderr, "chem_live: %s\n", stats.error.c_str());
+      return 1;
+    }
+    return 0;
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "chem_live: %s\n", e.what());
+    return 1;
+  }
+}
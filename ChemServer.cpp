@@ -0,0 +1,87 @@
+/**
+ * \file ChemServer.cpp
+ * \brief      .
+ *
+ *   127.0.0.1 (   FitServer.h)  
+ * SIGINT/SIGTERM (Ctrl+C),    .
+ *
+ * :
+ *   chem_server [--port 5555] [--workers N] [--max-in-flight 64]
+ *               [--max-queued-mb 64]
+ * --port 0   ;     .
+ * --workers       ( CHEM_THREADS).
+ */
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "FitServer.h"
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void OnSignal(int) { g_stop = 1; }
+
+void PrintUsage() {
+  std::fprintf(stderr,
+               "usage: chem_server [--port PORT] [--workers N] "
+               "[--max-in-flight N] [--max-queued-mb N]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  FitServerOptions options;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--port" && hasValue) {
+      options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+    } else if (arg == "--workers" && hasValue) {
+      //          
+#if defined(_WIN32)
+      _putenv_s("CHEM_THREADS", argv[++i]);
+#else
+      setenv("CHEM_THREADS", argv[++i], 1);
+#endif
+    } else if (arg == "--max-in-flight" && hasValue) {
+      options.maxInFlight = static_cast<size_t>(std::atoi(argv[++i]));
+    } else if (arg == "--max-queued-mb" && hasValue) {
+      options.maxQueuedBytes = static_cast<size_t>(std::atoi(argv[++i]))
+                               << 20;
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  std::signal(SIGINT, OnSignal);
+  std::signal(SIGTERM, OnSignal);
+  try {
+    FitServer server;
+    server.Start(options);
+    std::printf("listening on 127.0.0.1:%u\n",
+                static_cast<unsigned>(server.Port()));
+    std::fflush(stdout);
+    while (!g_stop) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    server.Stop();
+    const LatencyStats stats = server.Stats();
+    std::fprintf(stderr,
+                 "requests: %llu, latency us: mean %.1f, p50 %.1f, p90 %.1f, "
+                 "p99 %.1f, max %.1f\n",
+                 static_cast<unsigned long long>(stats.count), stats.meanUs,
+                 stats.p50Us, stats.p90Us, stats.p99Us, stats.maxUs);
+    return 0;
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "chem_server: %s\n", e.what());
+    return 1;
+  }
+}
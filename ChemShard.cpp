@@ -0,0 +1,97 @@
+/**
+ * \file ChemShard.cpp
+ * \brief      (. ShardRunner.h).
+ *
+ * :
+ *   chem_shard run MANIFEST WORKDIR [--shard-size N] [--stale 120]
+ *              [--max-shards N] [--no-dispersion]
+ *   chem_shard status MANIFEST WORKDIR
+ *   chem_shard merge MANIFEST WORKDIR OUTPUT
+ *      (  64), 
+ *     .    ( 
+ *       WORKDIR);    
+ *    .
+ *   run: 0    , 3     
+ * .
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include "ShardRunner.h"
+
+namespace {
+
+void PrintUsage() {
+  std::fprintf(stderr,
+               "usage: chem_shard run MANIFEST WORKDIR [--shard-size N] "
+               "[--stale SEC] [--max-shards N] [--no-dispersion]\n"
+               "       chem_shard status MANIFEST WORKDIR\n"
+               "       chem_shard merge MANIFEST WORKDIR OUTPUT\n");
+}
+
+void PrintReport(const ShardReport& report) {
+  std::fprintf(stderr,
+               "runs %zu, shards %zu: finished %zu, busy %zu; this worker: "
+               "processed %zu (reclaimed %zu), failed runs %zu\n",
+               report.runs, report.shards, report.finished, report.busy,
+               report.processed, report.reclaimed, report.failedRuns);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    PrintUsage();
+    return 2;
+  }
+  const std::string command = argv[1];
+  ShardOptions options;
+  options.manifest = argv[2];
+  options.workDir = argv[3];
+  std::string output;
+  int i = 4;
+  if (command == "merge") {
+    if (argc < 5) {
+      PrintUsage();
+      return 2;
+    }
+    output = argv[i++];
+  } else if (command != "run" && command != "status") {
+    PrintUsage();
+    return 2;
+  }
+  for (; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--shard-size" && hasValue) {
+      options.shardSize = static_cast<size_t>(std::atoi(argv[++i]));
+    } else if (arg == "--stale" && hasValue) {
+      options.staleSeconds = std::atoi(argv[++i]);
+    } else if (arg == "--max-shards" && hasValue) {
+      options.maxShards = static_cast<size_t>(std::atoi(argv[++i]));
+    } else if (arg == "--no-dispersion") {
+      options.dispersion = false;
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  try {
+    if (command == "merge") {
+      const size_t rows = MergeShardOutputs(options, output);
+      std::fprintf(stderr, "merged %zu runs into %s\n", rows, output.c_str());
+      return 0;
+    }
+    const ShardReport report = command == "run" ? RunShardWorker(options)
+                                                : QueryShards(options);
+    PrintReport(report);
+    return report.finished == report.shards ? 0 : 3;
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "chem_shard: %s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,144 @@
+/**
+ * \file ChemTraj.cpp
+ * \brief      (. TrajectoryFile.h).
+ *
+ * :
+ *   chem_traj simulate OUTPUT --ca0 A0 --k K --n N --t1 T [--t0 0]
+ *             [--cb 0] [--cc 0] [--steps 1000000] [--chunk 65536]
+ *   chem_traj info FILE
+ *   chem_traj envelope FILE T0 T1 WIDTH [A|B|C]
+ *   chem_traj export FILE OUTPUT.csv
+ * simulate    [t0, t1]    , 
+ *    ;      .
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TrajectoryFile.h"
+
+namespace {
+
+void PrintUsage() {
+  std::fprintf(stderr,
+               "usage: chem_traj simulate OUTPUT --ca0 A0 --k K --n N --t1 T "
+               "[--t0 T0] [--cb CB] [--cc CC] [--steps N] [--chunk N]\n"
+               "       chem_traj info FILE\n"
+               "       chem_traj envelope FILE T0 T1 WIDTH [A|B|C]\n"
+               "       chem_traj export FILE OUTPUT\n");
+}
+
+int Simulate(int argc, char** argv) {
+  const std::string output = argv[2];
+  double ca0 = -1.0, k = 0.0, n = 1.0, t0 = 0.0, t1 = -1.0, cb = 0.0,
+         cc = 0.0;
+  size_t steps = 1000000;
+  uint32_t chunk = TRAJ_CHUNK_POINTS;
+  for (int i = 3; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      PrintUsage();
+      return 2;
+    }
+    const char* value = argv[++i];
+    if (arg == "--ca0") {
+      ca0 = std::atof(value);
+    } else if (arg == "--k") {
+      k = std::atof(value);
+    } else if (arg == "--n") {
+      n = std::atof(value);
+    } else if (arg == "--t0") {
+      t0 = std::atof(value);
+    } else if (arg == "--t1") {
+      t1 = std::atof(value);
+    } else if (arg == "--cb") {
+      cb = std::atof(value);
+    } else if (arg == "--cc") {
+      cc = std::atof(value);
+    } else if (arg == "--steps") {
+      steps = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+    } else if (arg == "--chunk") {
+      chunk = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+  if (ca0 < 0.0 || !(t1 > t0) || steps == 0) {
+    PrintUsage();
+    return 2;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  TrajectoryWriter writer;
+  writer.Open(output, chunk);
+  const size_t points =
+      StreamTrajectory({ca0, ca0}, {t0, t1}, cb, cc, k, n, steps, writer);
+  writer.Close();
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  std::fprintf(stderr, "%zu points written in %.2f s (%.1f MB/s)\n", points,
+               seconds, points * 32.0 / 1e6 / (seconds > 0 ? seconds : 1));
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    PrintUsage();
+    return 2;
+  }
+  const std::string command = argv[1];
+  try {
+    if (command == "simulate") return Simulate(argc, argv);
+
+    TrajectoryReader reader;
+    reader.Open(argv[2]);
+    if (command == "info" && argc == 3) {
+      const TrajectorySummary s = SummarizeTrajectory(reader);
+      std::printf("points %zu  chunks %zu  t %.10g..%.10g  A %.10g -> %.10g"
+                  "  min %.10g  max %.10g  t_half %.10g\n",
+                  s.points, reader.Chunks(), s.tFirst, s.tLast, s.aFirst,
+                  s.aLast, s.aMin, s.aMax, s.tHalf);
+      return 0;
+    }
+    if (command == "envelope" && (argc == 6 || argc == 7)) {
+      TrajColumn column = TrajColumn::A;
+      if (argc == 7) {
+        const std::string name = argv[6];
+        if (name == "B") {
+          column = TrajColumn::B;
+        } else if (name == "C") {
+          column = TrajColumn::C;
+        } else if (name != "A") {
+          PrintUsage();
+          return 2;
+        }
+      }
+      std::vector<LodBucket> buckets;
+      ReduceTrajectory(reader, column, std::atof(argv[3]),
+                       std::atof(argv[4]),
+                       static_cast<size_t>(std::atoi(argv[5])), buckets);
+      for (const LodBucket& b : buckets) {
+        std::printf("%.10g %.10g %.10g %.10g %.10g %.10g\n", b.tFirst,
+                    b.tLast, b.vFirst, b.vLast, b.vMin, b.vMax);
+      }
+      return 0;
+    }
+    if (command == "export" && argc == 4) {
+      const size_t rows = ExportTrajectoryCsv(reader, argv[3]);
+      std::fprintf(stderr, "%zu rows exported\n", rows);
+      return 0;
+    }
+    PrintUsage();
+    return 2;
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "chem_traj: %s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,91 @@
+/**
+ * \file ChemWatch.cpp
+ * \brief       .
+ *
+ *  ,  n, k, r     
+ *     (\c IncrementalDataset)  
+ *  ,     .  
+ * SIGINT/SIGTERM.
+ *
+ * :
+ *   chem_watch FILE
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "FileWatch.h"
+#include "IncrementalDataset.h"
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void OnSignal(int) { g_stop = 1; }
+
+void PrintFit(const IncrementalDataset& dataset) {
+  const CalcOutcome fit = dataset.Fit();
+  const size_t rows = dataset.Data().Tm.size();
+  if (fit.Ok()) {
+    std::printf("rows %zu  n %.6g  k %.6g  r %.6f\n", rows, fit.value.n,
+                fit.value.k, fit.value.r);
+  } else {
+    std::printf("rows %zu  status %d  index %d\n", rows,
+                static_cast<int>(fit.status), static_cast<int>(fit.index));
+  }
+  std::fflush(stdout);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2 || argv[1][0] == '-') {
+    std::fprintf(stderr, "usage: chem_watch FILE\n");
+    return 2;
+  }
+  std::signal(SIGINT, OnSignal);
+  std::signal(SIGTERM, OnSignal);
+  try {
+    IncrementalDataset dataset;
+    dataset.Load(argv[1]);
+    PrintFit(dataset);
+
+    std::atomic<unsigned> changes{0};
+    FileWatcher watcher;
+    watcher.Start(argv[1], [&changes] { changes++; });
+    unsigned seen = 0;
+    while (!g_stop) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      const unsigned now = changes.load();
+      if (now == seen) continue;
+      seen = now;
+      const auto start = std::chrono::steady_clock::now();
+      DatasetChange change;
+      try {
+        change = dataset.Reload();
+      } catch (const std::runtime_error& e) {
+        //     :   
+        std::fprintf(stderr, "chem_watch: %s\n", e.what());
+        continue;
+      }
+      if (!change.changed) continue;
+      const double us = std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+      std::printf("row %zu: -%zu +%zu (%zu bytes parsed, %.1f us)  ",
+                  change.firstRow, change.removedRows, change.insertedRows,
+                  change.parsedBytes, us);
+      PrintFit(dataset);
+    }
+    watcher.Stop();
+    return 0;
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "chem_watch: %s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,238 @@
+/**
+ * \file CodecTest.cpp
+ * \brief   : ,    
+ *          .
+ *
+ *  :   SSE2   
+ * (\c CODEC_NO_SSE2),    \c UnpackBlock   x86.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "SeriesCodec.h"
+
+namespace {
+
+///  : ,  ,   , .
+const size_t kLengths[] = {0, 1, 2, 3, 127, 128, 129, 130, 257, 1000, 5000};
+///     .
+constexpr size_t kCorruptions = 12500;
+
+int g_failed = 0;
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    g_failed++;
+  }
+}
+
+///   (PCG- LCG).
+class Random {
+ public:
+  uint64_t Next() {
+    m_state = m_state * 6364136223846793005ull + 1442695040888963407ull;
+    return m_state >> 11;
+  }
+  double Uniform() { return static_cast<double>(Next()) * 0x1p-53; }
+  size_t Below(size_t n) { return n == 0 ? 0 : Next() % n; }
+
+ private:
+  uint64_t m_state = 0x853C49E6748FEA9Bull;
+};
+
+uint64_t Bits(double v) {
+  uint64_t b;
+  std::memcpy(&b, &v, sizeof(b));
+  return b;
+}
+
+bool SameBits(const std::vector<double>& a, const std::vector<double>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (Bits(a[i]) != Bits(b[i])) return false;
+  }
+  return true;
+}
+
+/// :  (    )  .
+struct Series {
+  std::vector<double> Tm;
+  std::vector<double> Ca;
+};
+
+Series MakeSeries(size_t count, bool decimalTime, bool noisy,
+                  Random& random) {
+  Series s;
+  double t = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    if (decimalTime) {
+      //    10^-3:    
+      t = static_cast<double>(i * 250 + random.Below(40)) / 1000.0;
+    } else {
+      t += 0.01 + 0.37 * random.Uniform();
+    }
+    s.Tm.push_back(t);
+    const double c = 1.0 / (1.0 + 0.4 * t);
+    s.Ca.push_back(noisy ? c * (1.0 + 0.05 * (random.Uniform() - 0.5)) : c);
+  }
+  return s;
+}
+
+///   ; false     .
+bool RoundTrip(const Series& s, const SeriesCodecOptions& options,
+               Series& out, SeriesCodecInfo& info) {
+  try {
+    const std::vector<unsigned char> packed =
+        EncodeSeries(s.Tm.data(), s.Ca.data(), s.Tm.size(), options);
+    info = InspectSeries(packed.data(), packed.size());
+    DecodeSeries(packed, out.Tm, out.Ca);
+  } catch (const std::exception&) {
+    return false;
+  }
+  return out.Tm.size() == s.Tm.size();
+}
+
+void CheckLossless(Random& random) {
+  for (size_t count : kLengths) {
+    for (bool decimalTime : {true, false}) {
+      const Series s = MakeSeries(count, decimalTime, true, random);
+      Series out;
+      SeriesCodecInfo info;
+      Check(RoundTrip(s, {}, out, info), "lossless round trip decodes");
+      Check(SameBits(out.Tm, s.Tm) && SameBits(out.Ca, s.Ca),
+            "lossless round trip is bit-exact");
+      if (count > 0) {
+        Check(info.timeTicks == decimalTime, "time column kind");
+      }
+      Check(!info.quantized, "lossless Ca is not quantized");
+    }
+  }
+
+  //     XOR  
+  Series special = MakeSeries(300, false, false, random);
+  const double values[] = {std::numeric_limits<double>::quiet_NaN(),
+                           std::numeric_limits<double>::infinity(),
+                           -std::numeric_limits<double>::infinity(),
+                           -0.0,
+                           std::numeric_limits<double>::denorm_min(),
+                           std::numeric_limits<double>::max(),
+                           -1e-300};
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    special.Ca[10 + 37 * i] = values[i];
+    special.Tm[20 + 41 * i] = values[i];
+  }
+  Series out;
+  SeriesCodecInfo info;
+  Check(RoundTrip(special, {}, out, info) && SameBits(out.Tm, special.Tm) &&
+            SameBits(out.Ca, special.Ca),
+        "special values survive a round trip");
+  //  NaN  :  Ca   
+  SeriesCodecOptions lossy;
+  lossy.maxError = 1e-4;
+  Check(RoundTrip(special, lossy, out, info) && !info.quantized &&
+            SameBits(out.Ca, special.Ca),
+        "non-finite Ca falls back to lossless");
+}
+
+void CheckLossy(Random& random) {
+  for (double maxError : {1e-2, 1e-4, 1e-7}) {
+    SeriesCodecOptions options;
+    options.maxError = maxError;
+    for (size_t count : kLengths) {
+      const Series s = MakeSeries(count, true, true, random);
+      Series out;
+      SeriesCodecInfo info;
+      Check(RoundTrip(s, options, out, info), "lossy round trip decodes");
+      Check(SameBits(out.Tm, s.Tm), "lossy keeps time bit-exact");
+      bool within = out.Ca.size() == s.Ca.size();
+      for (size_t i = 0; within && i < s.Ca.size(); i++) {
+        within = std::fabs(out.Ca[i] - s.Ca[i]) <= maxError;
+      }
+      Check(within, "lossy error stays within maxError");
+      if (count > 0) {
+        Check(info.quantized && info.maxError == maxError,
+              "lossy Ca is quantized");
+      }
+    }
+  }
+}
+
+///    ,   ; 
+///       AddressSanitizer.
+void CheckCorrupt(Random& random) {
+  SeriesCodecOptions lossy;
+  lossy.maxError = 1e-4;
+  const Series sources[] = {MakeSeries(700, true, true, random),
+                            MakeSeries(700, false, true, random),
+                            MakeSeries(130, true, false, random)};
+  std::vector<double> Tm, Ca;
+  size_t rejected = 0;
+  size_t otherErrors = 0;
+  for (const Series& s : sources) {
+    for (const SeriesCodecOptions& options : {SeriesCodecOptions(), lossy}) {
+      const std::vector<unsigned char> packed =
+          EncodeSeries(s.Tm.data(), s.Ca.data(), s.Tm.size(), options);
+      for (size_t trial = 0; trial < kCorruptions; trial++) {
+        //   :       
+        std::vector<unsigned char> bad(packed);
+        switch (trial % 4) {
+          case 0:  //  
+            bad[random.Below(bad.size())] ^=
+                static_cast<unsigned char>(1u << random.Below(8));
+            break;
+          case 1: {  //  
+            const size_t flips = 2 + random.Below(7);
+            for (size_t k = 0; k < flips; k++) {
+              bad[random.Below(bad.size())] ^=
+                  static_cast<unsigned char>(1u << random.Below(8));
+            }
+            break;
+          }
+          case 2:  // 
+            bad.resize(random.Below(bad.size()));
+            break;
+          default:  //    
+            bad[random.Below(std::min<size_t>(bad.size(), 128))] =
+                static_cast<unsigned char>(random.Next());
+            break;
+        }
+        try {
+          DecodeSeries(bad, Tm, Ca);
+        } catch (const std::runtime_error&) {
+          rejected++;
+        } catch (const std::exception&) {
+          otherErrors++;  // , bad_alloc -   
+        }
+      }
+    }
+  }
+  Check(otherErrors == 0, "corrupt inputs fail only with runtime_error");
+  Check(rejected > 0, "corrupt inputs are detected");
+}
+
+}  // namespace
+
+int main() {
+  Random random;
+  CheckLossless(random);
+  CheckLossy(random);
+  CheckCorrupt(random);
+
+#if defined(CODEC_NO_SSE2)
+  const char* path = "portable";
+#else
+  const char* path = "default";
+#endif
+  if (g_failed == 0) {
+    std::printf("codec (%s unpack): all checks passed\n", path);
+  }
+  return g_failed == 0 ? 0 : 1;
+}
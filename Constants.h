@@ -31,11 +31,56 @@ constexpr int IDC_BUTTON_GRAPH = 104;
  */
 constexpr int IDC_BUTTON_EXIT = 105;
 
+/**
+ * \brief     .
+ */
+constexpr INT_PTR IDC_METHOD_COMBO = 106;
+
+/**
+ * \brief      .
+ */
+constexpr INT_PTR IDC_RATE_COMBO = 107;
+
+/**
+ * \brief    (   ).
+ */
+constexpr int IDC_BUTTON_IMPORT = 108;
+
+/**
+ * \brief    (   ).
+ */
+constexpr int IDC_BUTTON_PASTE = 109;
+
 /**
  * \brief    .
  */
 constexpr int MAX_POINTS = 20;
 
+/**
+ * \brief     ,   .
+ */
+constexpr size_t MAX_SHOWN_MODELS = 3;
+
+/**
+ * \brief       .
+ */
+constexpr UINT_PTR IDT_LIVE_FRAME = 1;
+
+/**
+ * \brief      ,  ( 30 /).
+ */
+constexpr UINT LIVE_FRAME_MS = 33;
+
+/**
+ * \brief   ,      .
+ */
+constexpr size_t LIVE_CHART_POINTS = 16384;
+
+/**
+ * \brief    :   .
+ */
+constexpr UINT WM_DATA_FILE_CHANGED = WM_APP + 1;
+
 /**
  * \brief      Ca.
  */
@@ -46,6 +91,11 @@ constexpr int IDC_BASE_CA = 200;
  */
 constexpr int IDC_BASE_T = 300;
 
+/**
+ * \brief       Ca.
+ */
+constexpr int IDC_BASE_SIGMA = 700;
+
 /**
  * \brief    .
  */
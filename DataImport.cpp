@@ -0,0 +1,371 @@
+/**
+ * \file DataImport.cpp
+ * \brief       .
+ */
+
+#include "DataImport.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace {
+
+///   ,    .
+constexpr size_t kSniffBytes = 64u << 10;
+///      .
+constexpr size_t kMaxNumberLength = 64;
+
+bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+/**
+ *     [p, end)   ,  
+ *   \c LiveAcquisition: , ';',   ;
+ * ','       (   )
+ *       ("1.5, 2"). 0     .
+ */
+char LineDelimiter(const char* p, const char* end) {
+  bool space = false;
+  bool comma = false;
+  bool commaSpace = false;
+  for (const char* q = p; q < end; q++) {
+    if (*q == '\t') return '\t';
+    if (*q == ';') return ';';
+    if (*q == ' ') space = true;
+    if (*q == ',') {
+      comma = true;
+      if (q + 1 < end && IsBlank(q[1])) commaSpace = true;
+    }
+  }
+  if (commaSpace || (comma && !space)) return ',';
+  return space ? ' ' : 0;
+}
+
+/**
+ *       : , 
+ *     (, ),  , 
+ *     "t, Ca"   ','   
+ * .    .
+ */
+char DetectDelimiter(const char* text, size_t size) {
+  const size_t n = size < kSniffBytes ? size : kSniffBytes;
+  const char kOrder[] = {'\t', ';', ',', ' '};
+  size_t votes[4] = {};
+  const char* line = text;
+  const char* const stop = text + n;
+  while (line < stop) {
+    const void* nl = std::memchr(line, '\n', stop - line);
+    // ,   ,  
+    if (nl == nullptr && n < size) break;
+    const char* eol = (nl != nullptr) ? static_cast<const char*>(nl) : stop;
+    const char* p = line;
+    const char* end = eol;
+    line = eol + 1;
+    while (p < end && IsBlank(*p)) p++;
+    while (end > p && IsBlank(end[-1])) end--;
+    if (p == end) continue;
+    const char c = (*p == '"' && p + 1 < end) ? p[1] : *p;
+    if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.')) {
+      continue;
+    }
+    const char d = LineDelimiter(p, end);
+    for (size_t i = 0; i < 4; i++) {
+      if (kOrder[i] == d) votes[i]++;
+    }
+  }
+  size_t best = 3;
+  for (size_t i = 0; i < 4; i++) {
+    if (votes[i] > votes[best]) best = i;
+  }
+  return kOrder[best];
+}
+
+/**
+ *   [line, end)   \a count ;  
+ *  .  ' '   
+ *   .
+ */
+size_t SplitFields(const char* line, const char* end, char delimiter,
+                   size_t count, const char** first, const char** last) {
+  const char* p = line;
+  size_t f = 0;
+  if (delimiter == ' ') {
+    while (f < count) {
+      while (p < end && IsBlank(*p)) p++;
+      if (p == end) break;
+      first[f] = p;
+      while (p < end && !IsBlank(*p)) p++;
+      last[f++] = p;
+    }
+    return f;
+  }
+  while (f < count) {
+    const void* d = std::memchr(p, delimiter, end - p);
+    first[f] = p;
+    if (d == nullptr) {
+      last[f++] = end;
+      break;
+    }
+    last[f++] = static_cast<const char*>(d);
+    p = static_cast<const char*>(d) + 1;
+  }
+  return f;
+}
+
+///    .
+struct ChunkRows {
+  std::vector<double> Tm;
+  std::vector<double> Ca;
+  std::vector<double> sigma;
+  std::vector<size_t> rowStarts;
+  size_t sigmaCount = 0;
+  size_t skipped = 0;
+};
+
+void ParseChunk(const char* origin, const char* begin, const char* end,
+                char delimiter, const ImportOptions& options,
+                ChunkRows& rows) {
+  const size_t tc = options.timeColumn;
+  const size_t cc = options.concColumn;
+  const size_t sc = options.sigmaColumn;
+  const size_t count = std::max(std::max(tc, cc), sc) + 1;
+  std::vector<const char*> first(count);
+  std::vector<const char*> last(count);
+  //      ,    
+  const size_t expected = static_cast<size_t>(end - begin) / 16;
+  rows.Tm.reserve(expected);
+  rows.Ca.reserve(expected);
+  rows.sigma.reserve(expected);
+  if (options.keepRows) rows.rowStarts.reserve(expected);
+
+  const char* line = begin;
+  while (line < end) {
+    const void* nl = std::memchr(line, '\n', end - line);
+    const char* eol = (nl != nullptr) ? static_cast<const char*>(nl) : end;
+    const char* next = (nl != nullptr) ? eol + 1 : end;
+    const char* start = line;
+    const char* p = line;
+    while (p < eol && IsBlank(*p)) p++;
+    line = next;
+    if (p == eol) continue;
+
+    const size_t found =
+        SplitFields(p, eol, delimiter, count, first.data(), last.data());
+    double t;
+    double c;
+    if (tc >= found || cc >= found || !ParseNumber(first[tc], last[tc], t) ||
+        !ParseNumber(first[cc], last[cc], c)) {
+      rows.skipped++;
+      continue;
+    }
+    double s = std::numeric_limits<double>::quiet_NaN();
+    if (sc < found && ParseNumber(first[sc], last[sc], s)) rows.sigmaCount++;
+    rows.Tm.push_back(t);
+    rows.Ca.push_back(c);
+    rows.sigma.push_back(s);
+    if (options.keepRows) {
+      rows.rowStarts.push_back(static_cast<size_t>(start - origin));
+    }
+  }
+}
+
+#if defined(_WIN32)
+/// ,      .
+class MappedFile {
+ public:
+  explicit MappedFile(const std::filesystem::path& path) {
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("    !");
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) ||
+        static_cast<unsigned long long>(size.QuadPart) >
+            static_cast<unsigned long long>(SIZE_MAX)) {
+      CloseHandle(m_file);
+      throw std::runtime_error("   !");
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0) return;
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0,
+                                   nullptr);
+    if (m_mapping != nullptr) {
+      m_data = static_cast<const char*>(
+          MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (m_data == nullptr) {
+      if (m_mapping != nullptr) CloseHandle(m_mapping);
+      CloseHandle(m_file);
+      throw std::runtime_error("      !");
+    }
+  }
+  ~MappedFile() {
+    if (m_data != nullptr) UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr) CloseHandle(m_mapping);
+    CloseHandle(m_file);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* Data() const { return m_data; }
+  size_t Size() const { return m_size; }
+
+ private:
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = nullptr;
+  const char* m_data = nullptr;
+  size_t m_size = 0;
+};
+#else
+/// ,      .
+class MappedFile {
+ public:
+  explicit MappedFile(const std::filesystem::path& path) {
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) throw std::runtime_error("    !");
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) {
+      close(m_fd);
+      throw std::runtime_error("    !");
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0) return;
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED) {
+      close(m_fd);
+      throw std::runtime_error("      !");
+    }
+    //   :     
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const char*>(data);
+  }
+  ~MappedFile() {
+    if (m_data != nullptr) munmap(const_cast<char*>(m_data), m_size);
+    close(m_fd);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* Data() const { return m_data; }
+  size_t Size() const { return m_size; }
+
+ private:
+  int m_fd = -1;
+  const char* m_data = nullptr;
+  size_t m_size = 0;
+};
+#endif
+
+}  // namespace
+
+bool ParseNumber(const char* first, const char* last, double& value) {
+  while (first < last && (IsBlank(*first) || *first == '"')) first++;
+  while (last > first && (IsBlank(last[-1]) || last[-1] == '"')) last--;
+  if (first < last && *first == '+') first++;
+  if (first == last) return false;
+
+  char buf[kMaxNumberLength];
+  const void* comma = std::memchr(first, ',', last - first);
+  if (comma != nullptr) {
+    const size_t n = static_cast<size_t>(last - first);
+    if (n > kMaxNumberLength) return false;
+    for (size_t i = 0; i < n; i++) buf[i] = (first[i] == ',') ? '.' : first[i];
+    first = buf;
+    last = buf + n;
+  }
+  double v;
+  const std::from_chars_result r = std::from_chars(first, last, v);
+  if (r.ec != std::errc() || r.ptr != last) return false;
+  value = v;
+  return true;
+}
+
+ImportedData ImportDelimitedText(const char* text, size_t size,
+                                 const ImportOptions& options) {
+  TRACE_SCOPE("ImportDelimitedText");
+  const char* origin = text;
+  if (size >= 3 && std::memcmp(text, "\xEF\xBB\xBF", 3) == 0) {
+    text += 3;
+    size -= 3;
+  }
+  ImportedData data;
+  data.delimiter = (options.delimiter != 0) ? options.delimiter
+                                            : DetectDelimiter(text, size);
+
+  //       
+  const size_t chunkBytes = options.chunkBytes > 0 ? options.chunkBytes : 1;
+  const size_t chunks = size > 0 ? (size + chunkBytes - 1) / chunkBytes : 0;
+  std::vector<size_t> bounds(chunks + 1, size);
+  bounds[0] = 0;
+  for (size_t i = 1; i < chunks; i++) {
+    size_t pos = i * chunkBytes;
+    if (pos < bounds[i - 1]) pos = bounds[i - 1];
+    const void* nl = std::memchr(text + pos, '\n', size - pos);
+    bounds[i] = (nl != nullptr)
+                    ? static_cast<const char*>(nl) - text + 1
+                    : size;
+  }
+
+  std::vector<ChunkRows> rows(chunks);
+  ParallelFor(chunks, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      ParseChunk(origin, text + bounds[i], text + bounds[i + 1],
+                 data.delimiter, options, rows[i]);
+    }
+  });
+
+  //    :  ,  
+  //     
+  std::vector<size_t> offsets(chunks + 1, 0);
+  size_t sigmaCount = 0;
+  for (size_t i = 0; i < chunks; i++) {
+    offsets[i + 1] = offsets[i] + rows[i].Tm.size();
+    sigmaCount += rows[i].sigmaCount;
+    data.skippedLines += rows[i].skipped;
+  }
+  const size_t total = offsets[chunks];
+  const bool withSigma =
+      options.keepRows || (total > 0 && sigmaCount == total);
+  data.Tm.resize(total);
+  data.Ca.resize(total);
+  if (withSigma) data.sigma.resize(total);
+  if (options.keepRows) data.rowStarts.resize(total);
+  ParallelFor(chunks, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      ChunkRows& r = rows[i];
+      std::copy(r.Tm.begin(), r.Tm.end(), data.Tm.begin() + offsets[i]);
+      std::copy(r.Ca.begin(), r.Ca.end(), data.Ca.begin() + offsets[i]);
+      if (withSigma) {
+        std::copy(r.sigma.begin(), r.sigma.end(),
+                  data.sigma.begin() + offsets[i]);
+      }
+      if (options.keepRows) {
+        std::copy(r.rowStarts.begin(), r.rowStarts.end(),
+                  data.rowStarts.begin() + offsets[i]);
+      }
+      r = ChunkRows();
+    }
+  });
+  return data;
+}
+
+ImportedData ImportDelimitedFile(const std::filesystem::path& path,
+                                 const ImportOptions& options) {
+  const MappedFile file(path);
+  return ImportDelimitedText(file.Data(), file.Size(), options);
+}
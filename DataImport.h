@@ -0,0 +1,101 @@
+#ifndef DATAIMPORT_H
+#define DATAIMPORT_H
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+/**
+ * \file DataImport.h
+ * \brief      .
+ *
+ *   CSV/TSV  ,   
+ * .   \c std::from_chars (    
+ * ),   ,    
+ *  . ,      
+ *   (, ),    
+ * \c ImportedData::skippedLines;     .
+ *
+ *       \c ImportOptions::chunkBytes ,
+ *        , 
+ *    \c ParallelFor,    
+ *   .      , 
+ *  (mmap / MapViewOfFile),   
+ *  .
+ */
+
+///      , .
+constexpr size_t IMPORT_CHUNK_BYTES = 4u << 20;
+
+/**
+ * \brief  .
+ */
+struct ImportOptions {
+  ///  : '\t', ';', ',', ' ' (   )
+  ///  0         ( 
+  ///   ; ','      
+  ///  ,    ).
+  char delimiter = 0;
+  size_t timeColumn = 0;   ///<    ( ).
+  size_t concColumn = 1;   ///<    Ca.
+  ///    Ca;  ,  
+  ///      .
+  size_t sigmaColumn = 2;
+  size_t chunkBytes = IMPORT_CHUNK_BYTES;  ///<   .
+  ///     (\c ImportedData::rowStarts) 
+  ///    (NaN   )    
+  ///   (\c IncrementalDataset).
+  bool keepRows = false;
+};
+
+/**
+ * \brief  .
+ */
+struct ImportedData {
+  std::vector<double> Tm;     ///<  .
+  std::vector<double> Ca;     ///<  A.
+  std::vector<double> sigma;  ///<  Ca (   ).
+  ///        ,  (
+  ///  \c ImportOptions::keepRows).
+  std::vector<size_t> rowStarts;
+  size_t skippedLines = 0;    ///<   .
+  char delimiter = 0;         ///<  .
+};
+
+/**
+ * \brief     [first, last).
+ *
+ *        '+' ,  
+ *  .     .
+ *
+ * \param first  .
+ * \param last  .
+ * \param value  (   ).
+ * \return \c true,    .
+ */
+bool ParseNumber(const char* first, const char* last, double& value);
+
+/**
+ * \brief      (UTF-8  
+ *        ; BOM    CR LF ).
+ *
+ * \param text .
+ * \param size  , .
+ * \param options  .
+ * \return  .
+ */
+ImportedData ImportDelimitedText(const char* text, size_t size,
+                                 const ImportOptions& options = {});
+
+/**
+ * \brief     .
+ *
+ * \param path   .
+ * \param options  .
+ * \return  .
+ * \throw std::runtime_error       .
+ */
+ImportedData ImportDelimitedFile(const std::filesystem::path& path,
+                                 const ImportOptions& options = {});
+
+#endif  // DATAIMPORT_H
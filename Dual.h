@@ -0,0 +1,230 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <cmath>
+#include <cstddef>
+
+/**
+ * \file Dual.h
+ * \brief      .
+ *
+ * \c Dual<N>    N    
+ * .       
+ *    ,   ,
+ *     ,     \c Dual  
+ * ,   (  )   .
+ *  \c double         
+ * .
+ */
+
+/**
+ * \brief    N .
+ *
+ * \tparam N   .
+ */
+template <size_t N>
+struct Dual {
+  //   :     
+  //    16      ,  
+  //  (       )
+  double d[N];  ///<     0..N-1.
+  double v;     ///< .
+
+  Dual() : d{}, v(0.0) {}
+
+  /// :    .
+  Dual(double value) : d{}, v(value) {}
+
+  /**
+   * \brief     \a index.
+   *
+   * \param value .
+   * \param index   (    1).
+   * \return  .
+   */
+  static Dual Variable(double value, size_t index) {
+    Dual x(value);
+    x.d[index] = 1.0;
+    return x;
+  }
+
+  Dual& operator+=(const Dual& o) {
+    v += o.v;
+    for (size_t i = 0; i < N; i++) d[i] += o.d[i];
+    return *this;
+  }
+  Dual& operator-=(const Dual& o) {
+    v -= o.v;
+    for (size_t i = 0; i < N; i++) d[i] -= o.d[i];
+    return *this;
+  }
+  Dual& operator*=(const Dual& o) {
+    for (size_t i = 0; i < N; i++) d[i] = d[i] * o.v + v * o.d[i];
+    v *= o.v;
+    return *this;
+  }
+  Dual& operator/=(const Dual& o) {
+    const double inv = 1.0 / o.v;
+    v *= inv;
+    for (size_t i = 0; i < N; i++) d[i] = (d[i] - v * o.d[i]) * inv;
+    return *this;
+  }
+  Dual& operator+=(double c) {
+    v += c;
+    return *this;
+  }
+  Dual& operator-=(double c) {
+    v -= c;
+    return *this;
+  }
+  Dual& operator*=(double c) {
+    v *= c;
+    for (size_t i = 0; i < N; i++) d[i] *= c;
+    return *this;
+  }
+  Dual& operator/=(double c) { return *this *= 1.0 / c; }
+};
+
+/// \brief   ( \c double   ).
+inline double Value(double x) { return x; }
+
+/// \brief   .
+template <size_t N>
+double Value(const Dual<N>& x) {
+  return x.v;
+}
+
+template <size_t N>
+Dual<N> operator-(const Dual<N>& a) {
+  Dual<N> r(a);
+  r *= -1.0;
+  return r;
+}
+
+template <size_t N>
+Dual<N> operator+(Dual<N> a, const Dual<N>& b) {
+  return a += b;
+}
+template <size_t N>
+Dual<N> operator-(Dual<N> a, const Dual<N>& b) {
+  return a -= b;
+}
+template <size_t N>
+Dual<N> operator*(Dual<N> a, const Dual<N>& b) {
+  return a *= b;
+}
+template <size_t N>
+Dual<N> operator/(Dual<N> a, const Dual<N>& b) {
+  return a /= b;
+}
+
+template <size_t N>
+Dual<N> operator+(Dual<N> a, double c) {
+  return a += c;
+}
+template <size_t N>
+Dual<N> operator+(double c, Dual<N> a) {
+  return a += c;
+}
+template <size_t N>
+Dual<N> operator-(Dual<N> a, double c) {
+  return a -= c;
+}
+template <size_t N>
+Dual<N> operator-(double c, const Dual<N>& a) {
+  Dual<N> r = -a;
+  return r += c;
+}
+template <size_t N>
+Dual<N> operator*(Dual<N> a, double c) {
+  return a *= c;
+}
+template <size_t N>
+Dual<N> operator*(double c, Dual<N> a) {
+  return a *= c;
+}
+template <size_t N>
+Dual<N> operator/(Dual<N> a, double c) {
+  return a /= c;
+}
+template <size_t N>
+Dual<N> operator/(double c, const Dual<N>& a) {
+  return Dual<N>(c) /= a;
+}
+
+//     :   
+template <size_t N>
+bool operator<(const Dual<N>& a, const Dual<N>& b) {
+  return a.v < b.v;
+}
+template <size_t N>
+bool operator>(const Dual<N>& a, const Dual<N>& b) {
+  return a.v > b.v;
+}
+template <size_t N>
+bool operator<(const Dual<N>& a, double c) {
+  return a.v < c;
+}
+template <size_t N>
+bool operator>(const Dual<N>& a, double c) {
+  return a.v > c;
+}
+
+/// \brief   f  f(a.v) = \a fv  f'(a.v) = \a df.
+template <size_t N>
+Dual<N> Chain(const Dual<N>& a, double fv, double df) {
+  Dual<N> r(fv);
+  for (size_t i = 0; i < N; i++) r.d[i] = df * a.d[i];
+  return r;
+}
+
+template <size_t N>
+Dual<N> exp(const Dual<N>& a) {
+  const double e = std::exp(a.v);
+  return Chain(a, e, e);
+}
+
+template <size_t N>
+Dual<N> log(const Dual<N>& a) {
+  return Chain(a, std::log(a.v), 1.0 / a.v);
+}
+
+template <size_t N>
+Dual<N> sqrt(const Dual<N>& a) {
+  const double s = std::sqrt(a.v);
+  return Chain(a, s, 0.5 / s);
+}
+
+template <size_t N>
+Dual<N> fabs(const Dual<N>& a) {
+  return a.v < 0.0 ? -a : a;
+}
+
+/// \brief a^c   .
+template <size_t N>
+Dual<N> pow(const Dual<N>& a, double c) {
+  const double p = std::pow(a.v, c);
+  //  a = 0  c * a^(c-1)  1  c = 1  0  c > 1;
+  //  c < 1     
+  const double dp = (a.v != 0.0) ? c * p / a.v : (c == 1.0 ? 1.0 : 0.0);
+  return Chain(a, p, dp);
+}
+
+/**
+ * \brief a^b  a > 0 ( a = 0     ).
+ */
+template <size_t N>
+Dual<N> pow(const Dual<N>& a, const Dual<N>& b) {
+  if (!(a.v > 0.0)) {
+    return Dual<N>(std::pow(a.v, b.v));
+  }
+  const double p = std::pow(a.v, b.v);
+  const double la = std::log(a.v);
+  Dual<N> r(p);
+  for (size_t i = 0; i < N; i++) {
+    r.d[i] = p * (b.v * a.d[i] / a.v + la * b.d[i]);
+  }
+  return r;
+}
+
+#endif  // DUAL_H
@@ -0,0 +1,469 @@
+/**
+ * \file EnsembleSampler.cpp
+ * \brief   ,    .
+ */
+
+#include "EnsembleSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "ChemCalculation.h"
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace {
+
+///     .
+constexpr size_t kReservoirSize = 4096;
+///         .
+constexpr size_t kMaxTrace = size_t(1) << 15;
+///       .
+constexpr size_t kLaneGrain = 8;
+///   ln k.
+constexpr double kLnKLimit = 50.0;
+///      .
+constexpr double kSokalWindow = 5.0;
+///   : k, n, sigma, A, Ea.
+constexpr size_t kOutputs = 5;
+
+const double kMinusInf = -std::numeric_limits<double>::infinity();
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+inline uint64_t SplitMix64(uint64_t& state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+///    [0, 1).
+inline double Uniform(uint64_t& state) {
+  return static_cast<double>(SplitMix64(state) >> 11) *
+         (1.0 / 9007199254740992.0);
+}
+
+///  N(0, 1) ().
+double Normal(uint64_t& state) {
+  const double u1 = 1.0 - Uniform(state);
+  const double u2 = Uniform(state);
+  return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+}
+
+///    .
+struct Problem {
+  const std::vector<double>* Ca;
+  const std::vector<double>* Tm;
+  std::vector<double> invVar;  ///< 1 / sigma_i^2   (sigma  ).
+  size_t dim;
+  double nMin;
+  double nMax;
+};
+
+/**
+ *     \a count  ( \a pos
+ *  dim ).      .
+ */
+void LogPosteriorBatch(const Problem& pr, const double* pos, size_t count,
+                       double* lp) {
+  const std::vector<double>& Ca = *pr.Ca;
+  const size_t nPoints = Ca.size();
+  std::vector<double> k(count);
+  std::vector<double> n(count);
+  std::vector<unsigned char> inside(count);
+  for (size_t j = 0; j < count; j++) {
+    const double lnk = pos[j * pr.dim];
+    const double nj = pos[j * pr.dim + 1];
+    bool ok = std::fabs(lnk) <= kLnKLimit && nj >= pr.nMin && nj <= pr.nMax;
+    if (pr.dim > 2) ok = ok && std::fabs(pos[j * pr.dim + 2]) <= kLnKLimit;
+    inside[j] = ok ? 1 : 0;
+    //      
+    k[j] = ok ? std::exp(lnk) : 0.0;
+    n[j] = ok ? nj : 1.0;
+  }
+
+  std::vector<double> A(nPoints * count);
+  ChemCalculation::PropagateBatch(Ca, *pr.Tm, k.data(), n.data(), count,
+                                  A.data());
+
+  //        A
+  std::vector<double> sse(count, 0.0);
+  for (size_t i = 1; i < nPoints; i++) {
+    const double w = pr.invVar.empty() ? 1.0 : pr.invVar[i];
+    const double* row = A.data() + i * count;
+    for (size_t j = 0; j < count; j++) {
+      const double r = Ca[i] - row[j];
+      sse[j] += w * r * r;
+    }
+  }
+
+  const double m = static_cast<double>(nPoints - 1);
+  for (size_t j = 0; j < count; j++) {
+    double v = kMinusInf;
+    if (inside[j]) {
+      if (pr.dim > 2) {
+        const double lns = pos[j * pr.dim + 2];
+        v = -m * lns - 0.5 * sse[j] * std::exp(-2.0 * lns);
+      } else {
+        v = -0.5 * sse[j];
+      }
+      if (!std::isfinite(v)) v = kMinusInf;
+    }
+    lp[j] = v;
+  }
+}
+
+///    \a pos    .
+void EvaluateAll(const Problem& pr, const std::vector<double>& pos,
+                 std::vector<double>& lp) {
+  const size_t count = lp.size();
+  ParallelFor(count, kLaneGrain, [&](size_t begin, size_t end) {
+    LogPosteriorBatch(pr, pos.data() + begin * pr.dim, end - begin,
+                      lp.data() + begin);
+  });
+}
+
+/**
+ *      :   
+ *   ,    .
+ */
+struct TraceBuffer {
+  std::vector<double> values;
+  size_t stride = 1;  ///<      .
+  double acc = 0.0;
+  size_t accCount = 0;
+
+  void Add(double x) {
+    acc += x;
+    if (++accCount < stride) return;
+    values.push_back(acc / static_cast<double>(stride));
+    acc = 0.0;
+    accCount = 0;
+    if (values.size() >= kMaxTrace) {
+      for (size_t i = 0; i + 1 < values.size(); i += 2) {
+        values[i / 2] = 0.5 * (values[i] + values[i + 1]);
+      }
+      values.resize(values.size() / 2);
+      stride *= 2;
+    }
+  }
+};
+
+/**
+ *    (    M >= 5 tau),
+ *   .
+ */
+double AutocorrelationTime(const TraceBuffer& trace) {
+  const std::vector<double>& x = trace.values;
+  const size_t N = x.size();
+  if (N < 4) return 0.0;
+  double mean = 0.0;
+  for (double v : x) mean += v;
+  mean /= static_cast<double>(N);
+  double c0 = 0.0;
+  for (double v : x) c0 += (v - mean) * (v - mean);
+  if (!(c0 > 0.0)) return 0.0;
+
+  double tau = 1.0;
+  for (size_t lag = 1; lag < N / 2; lag++) {
+    double c = 0.0;
+    for (size_t i = 0; i + lag < N; i++) {
+      c += (x[i] - mean) * (x[i + lag] - mean);
+    }
+    tau += 2.0 * c / c0;
+    if (static_cast<double>(lag) >= kSokalWindow * tau) break;
+  }
+  return std::max(tau, 1.0) * static_cast<double>(trace.stride);
+}
+
+///     ().
+struct Running {
+  size_t count = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+
+  void Add(double x) {
+    if (!std::isfinite(x)) return;
+    count++;
+    const double d = x - mean;
+    mean += d / static_cast<double>(count);
+    m2 += d * (x - mean);
+  }
+};
+
+double Quantile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) return kNaN;
+  const double pos = q * static_cast<double>(sorted.size() - 1);
+  const size_t lo = static_cast<size_t>(pos);
+  const size_t hi = std::min(lo + 1, sorted.size() - 1);
+  const double w = pos - static_cast<double>(lo);
+  return sorted[lo] * (1.0 - w) + sorted[hi] * w;
+}
+
+ParamSummary Summarize(const Running& run,
+                       const std::vector<double>& reservoir, size_t column) {
+  ParamSummary s;
+  s.count = run.count;
+  if (run.count == 0) {
+    s.mean = s.sd = s.q025 = s.median = s.q975 = kNaN;
+    return s;
+  }
+  s.mean = run.mean;
+  s.sd = run.count > 1
+             ? std::sqrt(run.m2 / static_cast<double>(run.count - 1))
+             : 0.0;
+  std::vector<double> v;
+  for (size_t i = column; i < reservoir.size(); i += kOutputs) {
+    if (std::isfinite(reservoir[i])) v.push_back(reservoir[i]);
+  }
+  std::sort(v.begin(), v.end());
+  s.q025 = Quantile(v, 0.025);
+  s.median = Quantile(v, 0.5);
+  s.q975 = Quantile(v, 0.975);
+  return s;
+}
+
+///  : -    .
+void InitialPoint(const std::vector<double>& Ca, const std::vector<double>& Tm,
+                  const McmcOptions& options, double theta[3]) {
+  double k = 0.0;
+  double n = 1.0;
+  const CalcOutcome res = ChemCalculation::TryCalculate(Ca, Tm, 0.0, 0.0);
+  if (res) {
+    k = res.value.k;
+    n = res.value.n;
+  }  //     
+  if (!(k > 0.0) || !std::isfinite(k)) {
+    const double A1 = Ca.back();
+    const double T = Tm.back() - Tm.front();
+    k = (A1 > 0.0 && A1 < Ca.front()) ? std::log(Ca.front() / A1) / T
+                                      : 1.0 / T;
+    n = 1.0;
+  }
+  const double span = options.nMax - options.nMin;
+  n = std::min(std::max(n, options.nMin + 0.01 * span),
+               options.nMax - 0.01 * span);
+
+  std::vector<double> A(Ca.size());
+  ChemCalculation::PropagateBatch(Ca, Tm, &k, &n, 1, A.data());
+  double sse = 0.0;
+  double cmax = 0.0;
+  for (size_t i = 1; i < Ca.size(); i++) {
+    sse += (Ca[i] - A[i]) * (Ca[i] - A[i]);
+    cmax = std::max(cmax, Ca[i]);
+  }
+  double s = std::sqrt(sse / static_cast<double>(Ca.size() - 1));
+  if (!(s > 0.0) || !std::isfinite(s)) s = 1e-3 * std::max(cmax, 1e-12);
+
+  theta[0] = std::log(k);
+  theta[1] = n;
+  theta[2] = std::log(s);
+}
+
+}  // namespace
+
+McmcResult SamplePosterior(const std::vector<double>& Ca,
+                           const std::vector<double>& Tm,
+                           const McmcOptions& options,
+                           const std::vector<double>* sigma) {
+  TRACE_SCOPE("SamplePosterior");
+  if (Ca.size() != Tm.size()) {
+    throw std::runtime_error(" Ca  Tm  !");
+  }
+  ChemCalculation::ValidateInput(Ca, Tm, 0.0, 0.0);
+  if (Ca.size() < 3) {
+    throw std::runtime_error("     3 !");
+  }
+
+  Problem pr;
+  pr.Ca = &Ca;
+  pr.Tm = &Tm;
+  pr.nMin = options.nMin;
+  pr.nMax = options.nMax;
+  std::vector<double> s;
+  if (sigma != nullptr && !sigma->empty() &&
+      ChemCalculation::PrepareSigma(Ca, *sigma, s)) {
+    pr.invVar.resize(s.size());
+    for (size_t i = 0; i < s.size(); i++) pr.invVar[i] = 1.0 / (s[i] * s[i]);
+  }
+  pr.dim = pr.invVar.empty() ? 3 : 2;
+
+  const size_t W = options.walkers;
+  const size_t dim = pr.dim;
+  if (W % 2 != 0 || W < 2 * dim) {
+    throw std::runtime_error(
+        "          "
+        "!");
+  }
+  if (options.thin == 0 || !(options.stretch > 1.0) ||
+      !(options.nMax > options.nMin)) {
+    throw std::runtime_error("  !");
+  }
+
+  std::ofstream out;
+  if (!options.samplesPath.empty()) {
+    out.open(options.samplesPath, std::ios::out | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("    : " +
+                               options.samplesPath);
+    }
+    out << "step,walker,k,n,sigma,A,Ea,logp\n";
+  }
+
+  //       
+  std::vector<uint64_t> rng(W);
+  for (size_t w = 0; w < W; w++) {
+    uint64_t st = options.seed ^ (0x9E3779B97F4A7C15ull * (w + 1));
+    rng[w] = SplitMix64(st);
+  }
+
+  //      
+  double theta0[3];
+  InitialPoint(Ca, Tm, options, theta0);
+  std::vector<double> pos(W * dim);
+  std::vector<double> lp(W);
+  for (size_t w = 0; w < W; w++) {
+    for (size_t d = 0; d < dim; d++) {
+      pos[w * dim + d] =
+          theta0[d] + 1e-3 * std::max(std::fabs(theta0[d]), 0.1) *
+                          Normal(rng[w]);
+    }
+  }
+  EvaluateAll(pr, pos, lp);
+  for (size_t w = 0; w < W; w++) {
+    if (lp[w] == kMinusInf) {
+      throw std::runtime_error(
+          "      !");
+    }
+  }
+
+  const size_t half = W / 2;
+  std::vector<double> prop(half * dim);
+  std::vector<double> propLp(half);
+  std::vector<double> z(half);
+  size_t accepted = 0;
+  size_t proposed = 0;
+  TraceBuffer traces[3];
+  Running running[kOutputs];
+  std::vector<double> reservoir;
+  reservoir.reserve(kReservoirSize * kOutputs);
+  uint64_t reservoirRng = options.seed ^ 0xA5A5A5A5A5A5A5A5ull;
+  size_t seen = 0;
+  McmcResult result;
+  char line[512];
+
+  const double a = options.stretch;
+  const size_t total = options.burnIn + options.steps;
+  for (size_t step = 0; step < total; step++) {
+    for (size_t h = 0; h < 2; h++) {
+      const size_t first = h * half;
+      const size_t other = (1 - h) * half;
+      //      
+      for (size_t q = 0; q < half; q++) {
+        const size_t w = first + q;
+        const double u = Uniform(rng[w]);
+        z[q] = ((a - 1.0) * u + 1.0) * ((a - 1.0) * u + 1.0) / a;
+        const size_t j = other + static_cast<size_t>(SplitMix64(rng[w]) % half);
+        for (size_t d = 0; d < dim; d++) {
+          const double xj = pos[j * dim + d];
+          prop[q * dim + d] = xj + z[q] * (pos[w * dim + d] - xj);
+        }
+      }
+      EvaluateAll(pr, prop, propLp);
+      for (size_t q = 0; q < half; q++) {
+        const size_t w = first + q;
+        const double logAccept =
+            static_cast<double>(dim - 1) * std::log(z[q]) + propLp[q] - lp[w];
+        if (std::log(Uniform(rng[w])) < logAccept) {
+          std::copy(prop.begin() + q * dim, prop.begin() + (q + 1) * dim,
+                    pos.begin() + w * dim);
+          lp[w] = propLp[q];
+          if (step >= options.burnIn) accepted++;
+        }
+        if (step >= options.burnIn) proposed++;
+      }
+    }
+    if (step < options.burnIn) continue;
+
+    //       
+    for (size_t d = 0; d < dim; d++) {
+      double m = 0.0;
+      for (size_t w = 0; w < W; w++) m += pos[w * dim + d];
+      traces[d].Add(m / static_cast<double>(W));
+    }
+
+    const size_t kept = step - options.burnIn;
+    if (kept % options.thin != 0) continue;
+    for (size_t w = 0; w < W; w++) {
+      double v[kOutputs];
+      v[0] = std::exp(pos[w * dim]);
+      v[1] = pos[w * dim + 1];
+      v[2] = dim > 2 ? std::exp(pos[w * dim + 2]) : kNaN;
+      v[3] = kNaN;
+      v[4] = kNaN;
+      try {
+        const ArrheniusResult arr =
+            ChemCalculation::CalculateArrhenius(Ca, Tm, v[1]);
+        v[3] = arr.A;
+        v[4] = arr.Ea;
+      } catch (const std::runtime_error&) {
+        // A  Ea    
+      }
+      for (size_t c = 0; c < kOutputs; c++) running[c].Add(v[c]);
+
+      //   ( R)  
+      if (seen < kReservoirSize) {
+        reservoir.insert(reservoir.end(), v, v + kOutputs);
+      } else {
+        const size_t r = static_cast<size_t>(SplitMix64(reservoirRng) %
+                                             (seen + 1));
+        if (r < kReservoirSize) {
+          std::copy(v, v + kOutputs, reservoir.begin() + r * kOutputs);
+        }
+      }
+      seen++;
+
+      if (out.is_open()) {
+        std::snprintf(line, sizeof(line),
+                      "%zu,%zu,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g\n", kept,
+                      w, v[0], v[1], v[2], v[3], v[4], lp[w]);
+        out << line;
+      }
+    }
+  }
+  if (out.is_open()) {
+    out.flush();
+    if (!out) {
+      throw std::runtime_error("   : " +
+                               options.samplesPath);
+    }
+  }
+
+  result.k = Summarize(running[0], reservoir, 0);
+  result.n = Summarize(running[1], reservoir, 1);
+  result.sigma = Summarize(running[2], reservoir, 2);
+  result.A = Summarize(running[3], reservoir, 3);
+  result.Ea = Summarize(running[4], reservoir, 4);
+
+  McmcDiagnostics& diag = result.diag;
+  diag.acceptance = proposed > 0 ? static_cast<double>(accepted) /
+                                       static_cast<double>(proposed)
+                                 : 0.0;
+  double tauMax = 0.0;
+  for (size_t d = 0; d < dim; d++) {
+    diag.tau[d] = AutocorrelationTime(traces[d]);
+    tauMax = std::max(tauMax, diag.tau[d]);
+  }
+  const double draws = static_cast<double>(options.steps) *
+                       static_cast<double>(W);
+  diag.ess = tauMax > 0.0 ? draws / tauMax : draws;
+  diag.converged =
+      tauMax > 0.0 && static_cast<double>(options.steps) > 50.0 * tauMax;
+  diag.samples = seen;
+  TRACE_COUNTER("Mcmc.acceptance", diag.acceptance);
+  return result;
+}
@@ -0,0 +1,103 @@
+#ifndef ENSEMBLESAMPLER_H
+#define ENSEMBLESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \file EnsembleSampler.h
+ * \brief   k, n, A  Ea   MCMC.
+ *
+ *  -   ( ):
+ *     ,     
+ * ,       
+ * .    
+ * \c ChemCalculation::PropagateBatch    ,   
+ * ,     .
+ *
+ * : Ca[i] = A(Tm[i]; k, n) + e_i, e_i ~ N(0, sigma_i^2); A0 = Ca[0].
+ *  : ln k, n  (   ) ln sigma.
+ *     ln k, n (  ) 
+ * ln sigma. A  Ea   :  
+ * (\c ChemCalculation::CalculateArrhenius)   n  .
+ *
+ *  :       
+ *   ,       
+ *   .
+ */
+
+/**
+ * \brief  .
+ */
+struct McmcOptions {
+  size_t walkers = 32;     ///<   (,   2 * dim).
+  size_t steps = 4000;     ///<     .
+  size_t burnIn = 1000;    ///<    ( ).
+  size_t thin = 10;        ///<   thin- .
+  double stretch = 2.0;    ///<    a > 1.
+  uint64_t seed = 0x5EED;  ///<   .
+  double nMin = -2.0;      ///<    n.
+  double nMax = 8.0;       ///<    n.
+  ///  CSV    (   ).
+  std::string samplesPath;
+};
+
+/**
+ * \brief     .
+ */
+struct ParamSummary {
+  double mean = 0.0;    ///< .
+  double sd = 0.0;      ///<  .
+  double q025 = 0.0;    ///<  2.5%.
+  double median = 0.0;  ///< .
+  double q975 = 0.0;    ///<  97.5%.
+  size_t count = 0;     ///<   () .
+};
+
+/**
+ * \brief  .
+ */
+struct McmcDiagnostics {
+  double acceptance = 0.0;  ///<    .
+  ///    ( )  ln k, n, ln sigma.
+  double tau[3] = {};
+  double ess = 0.0;        ///<    (  tau).
+  bool converged = false;  ///<     50 * tau.
+  size_t samples = 0;      ///<   .
+};
+
+/**
+ * \brief  .
+ */
+struct McmcResult {
+  ParamSummary k;      ///<  .
+  ParamSummary n;      ///<  .
+  ParamSummary sigma;  ///<   (  ).
+  ParamSummary A;      ///<  .
+  ParamSummary Ea;     ///<  .
+  McmcDiagnostics diag;  ///< .
+};
+
+/**
+ * \brief     .
+ *
+ *       \c ChemCalculation::Calculate.
+ *      :    
+ * ,    .
+ *
+ * \param Ca    A.
+ * \param Tm  .
+ * \param options .
+ * \param sigma  Ca  \c nullptr ( sigma ).
+ * \return     .
+ * \throw std::runtime_error       
+ *          .
+ */
+McmcResult SamplePosterior(const std::vector<double>& Ca,
+                           const std::vector<double>& Tm,
+                           const McmcOptions& options = McmcOptions(),
+                           const std::vector<double>* sigma = nullptr);
+
+#endif  // ENSEMBLESAMPLER_H
@@ -0,0 +1,237 @@
+/**
+ * \file FileWatch.cpp
+ * \brief      .
+ */
+
+#include "FileWatch.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+///      Linux, .
+constexpr int kPollMs = 50;
+///      , .
+constexpr int kMaxSettleMs = 100;
+///   , .
+constexpr size_t kEventBytes = 16u << 10;
+
+#if defined(_WIN32)
+///      ( ).
+class DirectoryEvents {
+ public:
+  ~DirectoryEvents() { Close(); }
+
+  void Open(const std::filesystem::path& dir, const std::wstring& name) {
+    m_name = name;
+    m_dir = CreateFileW(dir.c_str(), FILE_LIST_DIRECTORY,
+                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                        nullptr, OPEN_EXISTING,
+                        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                        nullptr);
+    if (m_dir == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("     !");
+    }
+    m_readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    m_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  }
+
+  /// 1   , 0      \a timeoutMs,
+  /// -1    .
+  int Wait(int timeoutMs) {
+    if (!m_pending) {
+      m_ov = OVERLAPPED();
+      m_ov.hEvent = m_readEvent;
+      ResetEvent(m_readEvent);
+      const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE |
+                           FILE_NOTIFY_CHANGE_SIZE |
+                           FILE_NOTIFY_CHANGE_FILE_NAME;
+      if (!ReadDirectoryChangesW(m_dir, m_buffer, sizeof(m_buffer), FALSE,
+                                 filter, nullptr, &m_ov, nullptr)) {
+        return -1;
+      }
+      m_pending = true;
+    }
+    HANDLE events[2] = {m_readEvent, m_stopEvent};
+    const DWORD wait = WaitForMultipleObjects(
+        2, events, FALSE, static_cast<DWORD>(timeoutMs));
+    if (wait == WAIT_TIMEOUT) return 0;
+    if (wait != WAIT_OBJECT_0) return -1;
+    m_pending = false;
+    DWORD got = 0;
+    if (!GetOverlappedResult(m_dir, &m_ov, &got, FALSE)) return -1;
+    //  :  ,   
+    if (got == 0) return 1;
+    const char* p = reinterpret_cast<const char*>(m_buffer);
+    for (;;) {
+      const FILE_NOTIFY_INFORMATION* info =
+          reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+      const size_t len = info->FileNameLength / sizeof(wchar_t);
+      if (info->Action != FILE_ACTION_REMOVED &&
+          info->Action != FILE_ACTION_RENAMED_OLD_NAME &&
+          CompareStringOrdinal(info->FileName, static_cast<int>(len),
+                               m_name.c_str(),
+                               static_cast<int>(m_name.size()),
+                               TRUE) == CSTR_EQUAL) {
+        return 1;
+      }
+      if (info->NextEntryOffset == 0) break;
+      p += info->NextEntryOffset;
+    }
+    return 0;
+  }
+
+  ///    \c Wait (  ).
+  void Interrupt() {
+    if (m_stopEvent != nullptr) SetEvent(m_stopEvent);
+  }
+
+  void Close() {
+    if (m_pending) {
+      DWORD got = 0;
+      CancelIo(m_dir);
+      GetOverlappedResult(m_dir, &m_ov, &got, TRUE);
+      m_pending = false;
+    }
+    if (m_dir != INVALID_HANDLE_VALUE) CloseHandle(m_dir);
+    if (m_readEvent != nullptr) CloseHandle(m_readEvent);
+    if (m_stopEvent != nullptr) CloseHandle(m_stopEvent);
+    m_dir = INVALID_HANDLE_VALUE;
+    m_readEvent = nullptr;
+    m_stopEvent = nullptr;
+  }
+
+ private:
+  HANDLE m_dir = INVALID_HANDLE_VALUE;
+  HANDLE m_readEvent = nullptr;
+  HANDLE m_stopEvent = nullptr;
+  OVERLAPPED m_ov = {};
+  bool m_pending = false;
+  std::wstring m_name;
+  DWORD m_buffer[kEventBytes / sizeof(DWORD)];
+};
+#else
+///  inotify  ;   poll.
+class DirectoryEvents {
+ public:
+  ~DirectoryEvents() { Close(); }
+
+  void Open(const std::filesystem::path& dir, const std::string& name) {
+    m_name = name;
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0 ||
+        inotify_add_watch(m_fd, dir.c_str(),
+                          IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+      Close();
+      throw std::runtime_error("     !");
+    }
+  }
+
+  /// 1   , 0      \a timeoutMs,
+  /// -1  .
+  int Wait(int timeoutMs) {
+    pollfd pfd = {m_fd, POLLIN, 0};
+    const int ready = poll(&pfd, 1, timeoutMs);
+    if (ready == 0) return 0;
+    if (ready < 0) return errno == EINTR ? 0 : -1;
+    const ssize_t got = read(m_fd, m_buffer, sizeof(m_buffer));
+    if (got < 0) return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    int result = 0;
+    for (ssize_t pos = 0; pos < got;) {
+      const inotify_event* ev =
+          reinterpret_cast<const inotify_event*>(m_buffer + pos);
+      //  :  ,   
+      if ((ev->mask & IN_Q_OVERFLOW) != 0 ||
+          (ev->len > 0 && m_name == ev->name)) {
+        result = 1;
+      }
+      pos += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+    }
+    return result;
+  }
+
+  ///   \c Wait  \c kPollMs:   
+  ///  .
+  void Interrupt() {}
+
+  void Close() {
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+  }
+
+ private:
+  int m_fd = -1;
+  std::string m_name;
+  alignas(inotify_event) char m_buffer[kEventBytes];
+};
+#endif
+
+}  // namespace
+
+struct FileWatcher::Impl {
+  DirectoryEvents events;
+  Callback onChange;
+  std::thread thread;
+  std::atomic<bool> stop{false};
+
+  void Run() {
+    while (!stop.load(std::memory_order_acquire)) {
+      const int result = events.Wait(kPollMs);
+      if (result < 0) break;
+      if (result == 0) continue;
+      //      ,   
+      //         kMaxSettleMs
+      const auto deadline = std::chrono::steady_clock::now() +
+                            std::chrono::milliseconds(kMaxSettleMs);
+      int more;
+      while ((more = events.Wait(FILE_WATCH_SETTLE_MS)) > 0 &&
+             std::chrono::steady_clock::now() < deadline) {
+      }
+      if (more < 0 || stop.load(std::memory_order_acquire)) break;
+      onChange();
+    }
+  }
+};
+
+FileWatcher::FileWatcher() : m_impl(new Impl) {}
+
+FileWatcher::~FileWatcher() { Stop(); }
+
+void FileWatcher::Start(const std::filesystem::path& path,
+                        Callback onChange) {
+  Stop();
+  Impl& impl = *m_impl;
+  std::filesystem::path dir = path.parent_path();
+  if (dir.empty()) dir = ".";
+#if defined(_WIN32)
+  impl.events.Open(dir, path.filename().wstring());
+#else
+  impl.events.Open(dir, path.filename().string());
+#endif
+  impl.onChange = std::move(onChange);
+  impl.stop.store(false, std::memory_order_release);
+  impl.thread = std::thread([&impl] { impl.Run(); });
+}
+
+void FileWatcher::Stop() {
+  Impl& impl = *m_impl;
+  if (!impl.thread.joinable()) return;
+  impl.stop.store(true, std::memory_order_release);
+  impl.events.Interrupt();
+  impl.thread.join();
+  impl.events.Close();
+  impl.onChange = nullptr;
+}
@@ -0,0 +1,54 @@
+#ifndef FILEWATCH_H
+#define FILEWATCH_H
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+/**
+ * \file FileWatch.h
+ * \brief     .
+ *
+ *         
+ * (inotify  Linux, ReadDirectoryChangesW  Windows)   ,
+ *    :     
+ *  (   ).  ,
+ *      \c FILE_WATCH_SETTLE_MS,  
+ *  ; ,   ,   
+ *     100 .
+ */
+
+/// ,    , .
+constexpr int FILE_WATCH_SETTLE_MS = 15;
+
+/**
+ * \brief    .
+ */
+class FileWatcher {
+ public:
+  ///  ;    .
+  using Callback = std::function<void()>;
+
+  FileWatcher();
+  ~FileWatcher();
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  /**
+   * \brief   ( ).
+   *
+   * \param path   ;    .
+   * \param onChange  .
+   * \throw std::runtime_error     .
+   */
+  void Start(const std::filesystem::path& path, Callback onChange);
+
+  ///      .
+  void Stop();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+#endif  // FILEWATCH_H
@@ -0,0 +1,730 @@
+/**
+ * \file FitServer.cpp
+ * \brief ,  ,      
+ *        .
+ */
+
+#include "FitServer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "ChemCalculation.h"
+#include "Json.h"
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace {
+
+#if defined(_WIN32)
+using Socket = SOCKET;
+const Socket kNoSocket = INVALID_SOCKET;
+constexpr int kShutdownBoth = SD_BOTH;
+constexpr int kSendFlags = 0;
+void CloseSocket(Socket s) { closesocket(s); }
+#else
+using Socket = int;
+constexpr Socket kNoSocket = -1;
+constexpr int kShutdownBoth = SHUT_RDWR;
+constexpr int kSendFlags = MSG_NOSIGNAL;
+void CloseSocket(Socket s) { close(s); }
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+///      .
+constexpr size_t kSeriesPerTask = 32;
+///    JSON.
+constexpr size_t kReadBlock = 64u << 10;
+///     send/recv.
+constexpr size_t kMaxIo = 1u << 30;
+
+bool SendAll(Socket s, const char* data, size_t size) {
+  while (size > 0) {
+    const int chunk = static_cast<int>(std::min(size, kMaxIo));
+    const auto sent = send(s, data, chunk, kSendFlags);
+    if (sent <= 0) return false;
+    data += sent;
+    size -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+bool RecvAll(Socket s, char* data, size_t size) {
+  while (size > 0) {
+    const int chunk = static_cast<int>(std::min(size, kMaxIo));
+    const auto got = recv(s, data, chunk, 0);
+    if (got <= 0) return false;
+    data += got;
+    size -= static_cast<size_t>(got);
+  }
+  return true;
+}
+
+template <class T>
+void Put(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+///        .
+class PayloadReader {
+ public:
+  explicit PayloadReader(const std::string& payload)
+      : m_p(payload.data()), m_end(payload.data() + payload.size()) {}
+
+  template <class T>
+  T Get() {
+    T value{};
+    Read(&value, sizeof(T));
+    return value;
+  }
+
+  void Read(void* dst, size_t bytes) {
+    if (!m_ok || static_cast<size_t>(m_end - m_p) < bytes) {
+      m_ok = false;
+      return;
+    }
+    std::memcpy(dst, m_p, bytes);
+    m_p += bytes;
+  }
+
+  size_t Remaining() const { return static_cast<size_t>(m_end - m_p); }
+  bool Ok() const { return m_ok; }
+
+ private:
+  const char* m_p;
+  const char* m_end;
+  bool m_ok = true;
+};
+
+struct SeriesInput {
+  std::vector<double> Ca;
+  std::vector<double> Tm;
+  double Cb = 0.0;
+  double Cc = 0.0;
+};
+
+struct SeriesOutput {
+  uint32_t status = FIT_SERIES_OK;
+  int32_t index = -1;  ///< ,  .
+  CalculationResult fit = {0.0, 0.0, 0.0, 0.0};
+};
+
+///     .
+using Response = std::pair<std::string, Clock::time_point>;
+
+/// : ,    ,    .
+struct Connection {
+  Socket socket = kNoSocket;
+  std::thread reader;
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable slotFreed;
+  std::condition_variable writable;
+  ///  ,  :  -> .
+  std::map<uint64_t, Response> ready;
+  ///   ,    .
+  std::deque<Response> outbox;
+  size_t outboxBytes = 0;  ///<   \c outbox.
+  uint64_t nextSend = 0;  ///<     \c outbox.
+  uint64_t nextSeq = 0;   ///<    ( ).
+  size_t inFlight = 0;    ///< ,      .
+  bool readerDone = false;
+  bool writerDone = false;
+  bool broken = false;    ///<   :  .
+
+  ~Connection() {
+    if (socket != kNoSocket) CloseSocket(socket);
+  }
+};
+
+struct Request {
+  std::shared_ptr<Connection> conn;
+  uint64_t seq = 0;
+  bool json = false;
+  bool hasId = false;
+  double id = 0.0;
+  uint16_t op = FIT_OP_FIT;
+  uint16_t status = FIT_STATUS_OK;
+  std::string error;  ///<  FIT_STATUS_BAD_REQUEST ( JSON).
+  std::vector<SeriesInput> series;
+  std::vector<SeriesOutput> results;
+  std::atomic<size_t> pending{0};  ///<   .
+  Clock::time_point received;
+};
+
+struct Task {
+  std::shared_ptr<Request> request;
+  size_t begin;
+  size_t end;
+};
+
+void ParseBinaryRequest(const std::string& payload, Request& req) {
+  PayloadReader in(payload);
+  req.hasId = payload.size() >= sizeof(uint32_t);
+  req.id = in.Get<uint32_t>();
+  req.op = in.Get<uint16_t>();
+  in.Get<uint16_t>();
+  if (!in.Ok()) {
+    req.status = FIT_STATUS_BAD_REQUEST;
+    return;
+  }
+  if (req.op != FIT_OP_FIT) {
+    if (req.op != FIT_OP_STATS) req.status = FIT_STATUS_UNKNOWN_OP;
+    return;
+  }
+  const uint32_t count = in.Get<uint32_t>();
+  //      24 :    
+  if (!in.Ok() || count > in.Remaining() / 24) {
+    req.status = FIT_STATUS_BAD_REQUEST;
+    return;
+  }
+  req.series.resize(count);
+  for (SeriesInput& s : req.series) {
+    const uint32_t points = in.Get<uint32_t>();
+    in.Get<uint32_t>();
+    s.Cb = in.Get<double>();
+    s.Cc = in.Get<double>();
+    if (!in.Ok() || points > in.Remaining() / (2 * sizeof(double))) {
+      req.status = FIT_STATUS_BAD_REQUEST;
+      return;
+    }
+    s.Tm.resize(points);
+    s.Ca.resize(points);
+    in.Read(s.Tm.data(), points * sizeof(double));
+    in.Read(s.Ca.data(), points * sizeof(double));
+  }
+  if (!in.Ok() || in.Remaining() != 0) req.status = FIT_STATUS_BAD_REQUEST;
+}
+
+bool ReadNumberArray(const JsonValue* value, std::vector<double>& out) {
+  if (value == nullptr || value->kind != JsonValue::Array) return false;
+  out.resize(value->items.size());
+  for (size_t i = 0; i < out.size(); i++) {
+    if (value->items[i].kind != JsonValue::Number) return false;
+    out[i] = value->items[i].number;
+  }
+  return true;
+}
+
+void ParseJsonRequest(const std::string& line, Request& req) {
+  JsonValue root;
+  try {
+    root = ParseJson(line);
+  } catch (const std::runtime_error& e) {
+    req.status = FIT_STATUS_BAD_REQUEST;
+    req.error = e.what();
+    return;
+  }
+  const JsonValue* id = root.Find("id");
+  if (id != nullptr && id->kind == JsonValue::Number) {
+    req.hasId = true;
+    req.id = id->number;
+  }
+  const JsonValue* op = root.Find("op");
+  if (op != nullptr) {
+    if (op->kind == JsonValue::String && op->text == "stats") {
+      req.op = FIT_OP_STATS;
+      return;
+    }
+    if (op->kind != JsonValue::String || op->text != "fit") {
+      req.status = FIT_STATUS_UNKNOWN_OP;
+      req.error = "unknown op";
+      return;
+    }
+  }
+  const JsonValue* series = root.Find("series");
+  if (series == nullptr || series->kind != JsonValue::Array) {
+    req.status = FIT_STATUS_BAD_REQUEST;
+    req.error = "\"series\" must be an array";
+    return;
+  }
+  req.series.resize(series->items.size());
+  for (size_t i = 0; i < req.series.size(); i++) {
+    const JsonValue& item = series->items[i];
+    SeriesInput& s = req.series[i];
+    if (!ReadNumberArray(item.Find("Tm"), s.Tm) ||
+        !ReadNumberArray(item.Find("Ca"), s.Ca) ||
+        s.Tm.size() != s.Ca.size()) {
+      req.status = FIT_STATUS_BAD_REQUEST;
+      req.error = "series " + std::to_string(i) +
+                  ": \"Tm\" and \"Ca\" must be number arrays of equal length";
+      return;
+    }
+    const JsonValue* cb = item.Find("Cb");
+    const JsonValue* cc = item.Find("Cc");
+    if (cb != nullptr && cb->kind == JsonValue::Number) s.Cb = cb->number;
+    if (cc != nullptr && cc->kind == JsonValue::Number) s.Cc = cc->number;
+  }
+}
+
+void AppendJsonString(std::string& out, const std::string& text) {
+  out += '"';
+  for (char c : text) {
+    if (c == '"' || c == '\\') out += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20) out += c;
+  }
+  out += '"';
+}
+
+void AppendStatsJson(std::string& out, const LatencyStats& stats) {
+  out += "{\"count\": " + std::to_string(stats.count) + ", \"mean_us\": ";
+  AppendJsonNumber(out, stats.meanUs);
+  out += ", \"p50_us\": ";
+  AppendJsonNumber(out, stats.p50Us);
+  out += ", \"p90_us\": ";
+  AppendJsonNumber(out, stats.p90Us);
+  out += ", \"p99_us\": ";
+  AppendJsonNumber(out, stats.p99Us);
+  out += ", \"max_us\": ";
+  AppendJsonNumber(out, stats.maxUs);
+  out += '}';
+}
+
+std::string BuildJsonResponse(const Request& req, double latencyUs,
+                              const LatencyStats& stats) {
+  std::string out = "{\"id\": ";
+  if (req.hasId) {
+    AppendJsonNumber(out, req.id);
+  } else {
+    out += "null";
+  }
+  out += ", \"status\": " + std::to_string(req.status);
+  if (req.status != FIT_STATUS_OK) {
+    out += ", \"error\": ";
+    AppendJsonString(out, req.error);
+    out += "}\n";
+    return out;
+  }
+  out += ", \"latency_us\": ";
+  AppendJsonNumber(out, latencyUs);
+  if (req.op == FIT_OP_STATS) {
+    out += ", \"latency\": ";
+    AppendStatsJson(out, stats);
+    out += "}\n";
+    return out;
+  }
+  out += ", \"results\": [";
+  for (size_t i = 0; i < req.results.size(); i++) {
+    const SeriesOutput& r = req.results[i];
+    if (i > 0) out += ", ";
+    out += "{\"status\": " + std::to_string(r.status);
+    if (r.index >= 0) out += ", \"index\": " + std::to_string(r.index);
+    if (r.status == FIT_SERIES_OK) {
+      out += ", \"n\": ";
+      AppendJsonNumber(out, r.fit.n);
+      out += ", \"k\": ";
+      AppendJsonNumber(out, r.fit.k);
+      out += ", \"r\": ";
+      AppendJsonNumber(out, r.fit.r);
+      out += ", \"disp\": ";
+      AppendJsonNumber(out, r.fit.disp);
+    }
+    out += '}';
+  }
+  out += "]}\n";
+  return out;
+}
+
+std::string BuildBinaryResponse(const Request& req, double latencyUs,
+                                const LatencyStats& stats) {
+  std::string out;
+  Put<uint32_t>(out, 0);  //  ,  
+  Put<uint32_t>(out, static_cast<uint32_t>(req.id));
+  Put<uint16_t>(out, req.op);
+  Put<uint16_t>(out, req.status);
+  Put<uint32_t>(out, static_cast<uint32_t>(req.results.size()));
+  Put<uint32_t>(out, 0);
+  Put<double>(out, latencyUs);
+  if (req.status == FIT_STATUS_OK && req.op == FIT_OP_STATS) {
+    Put<uint64_t>(out, stats.count);
+    Put<double>(out, stats.meanUs);
+    Put<double>(out, stats.p50Us);
+    Put<double>(out, stats.p90Us);
+    Put<double>(out, stats.p99Us);
+    Put<double>(out, stats.maxUs);
+  }
+  for (const SeriesOutput& r : req.results) {
+    Put<uint32_t>(out, r.status);
+    Put<int32_t>(out, r.index);
+    Put<double>(out, r.fit.n);
+    Put<double>(out, r.fit.k);
+    Put<double>(out, r.fit.r);
+    Put<double>(out, r.fit.disp);
+  }
+  const uint32_t length = static_cast<uint32_t>(out.size() - sizeof(uint32_t));
+  std::memcpy(&out[0], &length, sizeof(length));
+  return out;
+}
+
+}  // namespace
+
+struct FitServer::Impl {
+  FitServerOptions options;
+  Socket listener = kNoSocket;
+  uint16_t port = 0;
+  bool running = false;
+  std::atomic<bool> stopping{false};
+  std::thread acceptor;
+  std::thread dispatcher;  ///<    ParallelFor.
+
+  std::mutex connMutex;
+  std::vector<std::shared_ptr<Connection>> connections;
+
+  std::mutex queueMutex;
+  std::condition_variable queueReady;
+  std::deque<Task> queue;
+  bool queueClosed = false;
+
+  LatencyHistogram latency;
+
+  void AcceptLoop();
+  void ReadLoop(const std::shared_ptr<Connection>& conn);
+  void DispatchLoop();
+  void RunTask(const Task& task);
+  void Dispatch(const std::shared_ptr<Connection>& conn,
+                const std::shared_ptr<Request>& req);
+  void Finish(Request& req);
+  void Deliver(Connection& conn, uint64_t seq, std::string frame,
+               Clock::time_point received);
+  void WriteLoop(const std::shared_ptr<Connection>& conn);
+};
+
+void FitServer::Impl::AcceptLoop() {
+  while (!stopping.load()) {
+    const Socket s = accept(listener, nullptr, nullptr);
+    if (s == kNoSocket) {
+      if (stopping.load()) break;
+      continue;
+    }
+    //   :   
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY,
+               reinterpret_cast<const char*>(&one), sizeof(one));
+    auto conn = std::make_shared<Connection>();
+    conn->socket = s;
+    std::lock_guard<std::mutex> lock(connMutex);
+    // ,  ,    
+    for (auto it = connections.begin(); it != connections.end();) {
+      std::unique_lock<std::mutex> connLock((*it)->mutex);
+      const bool finished = (*it)->readerDone && (*it)->writerDone;
+      connLock.unlock();
+      if (finished) {
+        (*it)->reader.join();
+        (*it)->writer.join();
+        it = connections.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    conn->reader = std::thread([this, conn] { ReadLoop(conn); });
+    conn->writer = std::thread([this, conn] { WriteLoop(conn); });
+    connections.push_back(conn);
+  }
+}
+
+void FitServer::Impl::ReadLoop(const std::shared_ptr<Connection>& conn) {
+  const Socket s = conn->socket;
+  //    ,      
+  const auto submit = [&](const std::shared_ptr<Request>& req) {
+    {
+      std::unique_lock<std::mutex> lock(conn->mutex);
+      conn->slotFreed.wait(lock, [&] {
+        return conn->inFlight < options.maxInFlight || stopping.load();
+      });
+      if (stopping.load()) return false;
+      conn->inFlight++;
+    }
+    req->seq = conn->nextSeq++;
+    Dispatch(conn, req);
+    return true;
+  };
+
+  char first = 0;
+  const bool json =
+      recv(s, &first, 1, MSG_PEEK) == 1 && first == '{';
+  if (json) {
+    std::string buffer;
+    std::vector<char> block(kReadBlock);
+    bool open = true;
+    while (open) {
+      const auto got = recv(s, block.data(), static_cast<int>(block.size()), 0);
+      open = got > 0;
+      if (open) buffer.append(block.data(), static_cast<size_t>(got));
+      //         
+      //  
+      size_t start = 0;
+      for (;;) {
+        size_t nl = buffer.find('\n', start);
+        if (nl == std::string::npos) {
+          if (open || start == buffer.size()) break;
+          nl = buffer.size();
+        }
+        const std::string line = buffer.substr(start, nl - start);
+        start = std::min(nl + 1, buffer.size());
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        auto req = std::make_shared<Request>();
+        req->json = true;
+        req->received = Clock::now();
+        ParseJsonRequest(line, *req);
+        if (!submit(req)) {
+          open = false;
+          break;
+        }
+      }
+      buffer.erase(0, start);
+      if (buffer.size() > FIT_MAX_FRAME) break;
+    }
+  } else {
+    for (;;) {
+      uint32_t length = 0;
+      if (!RecvAll(s, reinterpret_cast<char*>(&length), sizeof(length)) ||
+          length > FIT_MAX_FRAME) {
+        break;
+      }
+      std::string payload(length, '\0');
+      if (!RecvAll(s, &payload[0], length)) break;
+      auto req = std::make_shared<Request>();
+      req->received = Clock::now();
+      ParseBinaryRequest(payload, *req);
+      if (!submit(req)) break;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(conn->mutex);
+  conn->readerDone = true;
+  conn->writable.notify_all();
+}
+
+void FitServer::Impl::Dispatch(const std::shared_ptr<Connection>& conn,
+                               const std::shared_ptr<Request>& req) {
+  req->conn = conn;
+  if (req->status != FIT_STATUS_OK || req->op != FIT_OP_FIT ||
+      req->series.empty()) {
+    Finish(*req);
+    return;
+  }
+  req->results.resize(req->series.size());
+  const size_t count = req->series.size();
+  const size_t tasks = (count + kSeriesPerTask - 1) / kSeriesPerTask;
+  req->pending.store(tasks);
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (size_t t = 0; t < tasks; t++) {
+      const size_t begin = t * kSeriesPerTask;
+      queue.push_back({req, begin, std::min(begin + kSeriesPerTask, count)});
+    }
+  }
+  queueReady.notify_one();
+}
+
+void FitServer::Impl::DispatchLoop() {
+  //   ,    , 
+  //  ParallelFor:        (  
+  // ),  ParallelFor      
+  std::vector<Task> batch;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      queueReady.wait(lock, [&] { return !queue.empty() || queueClosed; });
+      if (queue.empty()) return;
+      batch.assign(std::make_move_iterator(queue.begin()),
+                   std::make_move_iterator(queue.end()));
+      queue.clear();
+    }
+    ParallelFor(batch.size(), 1, [&](size_t begin, size_t end) {
+      for (size_t t = begin; t < end; t++) RunTask(batch[t]);
+    });
+    batch.clear();
+  }
+}
+
+void FitServer::Impl::RunTask(const Task& task) {
+  TRACE_SCOPE("FitServer::Task");
+  Request& req = *task.request;
+  for (size_t i = task.begin; i < task.end; i++) {
+    const SeriesInput& in = req.series[i];
+    const CalcOutcome outcome =
+        ChemCalculation::TryCalculate(in.Ca, in.Tm, in.Cb, in.Cc);
+    req.results[i].status = static_cast<uint32_t>(outcome.status);
+    req.results[i].index = outcome.index;
+    req.results[i].fit = outcome.value;
+  }
+  if (req.pending.fetch_sub(1) == 1) Finish(req);
+}
+
+void FitServer::Impl::Finish(Request& req) {
+  const double latencyUs =
+      std::chrono::duration<double, std::micro>(Clock::now() - req.received)
+          .count();
+  const LatencyStats stats =
+      req.op == FIT_OP_STATS ? latency.Snapshot() : LatencyStats();
+  std::string frame = req.json ? BuildJsonResponse(req, latencyUs, stats)
+                               : BuildBinaryResponse(req, latencyUs, stats);
+  //     ;    
+  std::shared_ptr<Connection> conn = std::move(req.conn);
+  Deliver(*conn, req.seq, std::move(frame), req.received);
+}
+
+void FitServer::Impl::Deliver(Connection& conn, uint64_t seq,
+                              std::string frame, Clock::time_point received) {
+  std::lock_guard<std::mutex> lock(conn.mutex);
+  conn.ready.emplace(seq, std::make_pair(std::move(frame), received));
+  //       : send  
+  //  ,    
+  for (auto it = conn.ready.begin();
+       it != conn.ready.end() && it->first == conn.nextSend;
+       it = conn.ready.erase(it)) {
+    if (conn.broken) {
+      latency.Record(std::chrono::duration<double, std::micro>(
+                         Clock::now() - it->second.second)
+                         .count());
+    } else {
+      conn.outboxBytes += it->second.first.size();
+      conn.outbox.push_back(std::move(it->second));
+    }
+    conn.nextSend++;
+    conn.inFlight--;
+  }
+  //    :  
+  if (!conn.broken && conn.outboxBytes > options.maxQueuedBytes) {
+    conn.broken = true;
+    conn.outbox.clear();
+    conn.outboxBytes = 0;
+    shutdown(conn.socket, kShutdownBoth);
+  }
+  conn.slotFreed.notify_all();
+  conn.writable.notify_all();
+}
+
+void FitServer::Impl::WriteLoop(const std::shared_ptr<Connection>& conn) {
+  std::unique_lock<std::mutex> lock(conn->mutex);
+  for (;;) {
+    conn->writable.wait(lock, [&] {
+      return !conn->outbox.empty() ||
+             (conn->readerDone && conn->inFlight == 0);
+    });
+    if (conn->outbox.empty()) break;
+    Response response = std::move(conn->outbox.front());
+    conn->outbox.pop_front();
+    conn->outboxBytes -= response.first.size();
+    lock.unlock();
+    const bool sent =
+        SendAll(conn->socket, response.first.data(), response.first.size());
+    latency.Record(std::chrono::duration<double, std::micro>(
+                       Clock::now() - response.second)
+                       .count());
+    lock.lock();
+    if (!sent && !conn->broken) {
+      conn->broken = true;
+      conn->outbox.clear();
+      conn->outboxBytes = 0;
+      shutdown(conn->socket, kShutdownBoth);
+    }
+  }
+  shutdown(conn->socket, kShutdownBoth);
+  conn->writerDone = true;
+}
+
+FitServer::FitServer() : m_impl(new Impl) {}
+
+FitServer::~FitServer() { Stop(); }
+
+void FitServer::Start(const FitServerOptions& options) {
+  Impl& impl = *m_impl;
+  if (impl.running) throw std::runtime_error("  !");
+#if defined(_WIN32)
+  WSADATA wsa;
+  if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+    throw std::runtime_error("   !");
+  }
+#endif
+  impl.options = options;
+  if (impl.options.maxInFlight == 0) impl.options.maxInFlight = 1;
+  impl.listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (impl.listener == kNoSocket) {
+    throw std::runtime_error("    !");
+  }
+  int one = 1;
+  setsockopt(impl.listener, SOL_SOCKET, SO_REUSEADDR,
+             reinterpret_cast<const char*>(&one), sizeof(one));
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(options.port);
+  socklen_t len = sizeof(addr);
+  if (bind(impl.listener, reinterpret_cast<sockaddr*>(&addr), len) != 0 ||
+      listen(impl.listener, SOMAXCONN) != 0 ||
+      getsockname(impl.listener, reinterpret_cast<sockaddr*>(&addr), &len) !=
+          0) {
+    CloseSocket(impl.listener);
+    impl.listener = kNoSocket;
+    throw std::runtime_error("    !");
+  }
+  impl.port = ntohs(addr.sin_port);
+  impl.stopping.store(false);
+  impl.queueClosed = false;
+  impl.dispatcher = std::thread([&impl] { impl.DispatchLoop(); });
+  impl.acceptor = std::thread([&impl] { impl.AcceptLoop(); });
+  impl.running = true;
+}
+
+void FitServer::Stop() {
+  Impl& impl = *m_impl;
+  if (!impl.running) return;
+  impl.stopping.store(true);
+  // shutdown  accept  recv   
+  shutdown(impl.listener, kShutdownBoth);
+  CloseSocket(impl.listener);
+  impl.listener = kNoSocket;
+  impl.acceptor.join();
+  {
+    std::lock_guard<std::mutex> lock(impl.connMutex);
+    for (auto& conn : impl.connections) {
+      std::lock_guard<std::mutex> connLock(conn->mutex);
+      shutdown(conn->socket, kShutdownBoth);
+      conn->slotFreed.notify_all();
+    }
+  }
+  for (auto& conn : impl.connections) conn->reader.join();
+  {
+    std::lock_guard<std::mutex> lock(impl.queueMutex);
+    impl.queueClosed = true;
+  }
+  impl.queueReady.notify_all();
+  impl.dispatcher.join();
+  //   :      
+  for (auto& conn : impl.connections) conn->writer.join();
+  impl.connections.clear();
+  impl.running = false;
+#if defined(_WIN32)
+  WSACleanup();
+#endif
+}
+
+uint16_t FitServer::Port() const { return m_impl->port; }
+
+LatencyStats FitServer::Stats() const { return m_impl->latency.Snapshot(); }
@@ -0,0 +1,127 @@
+#ifndef FITSERVER_H
+#define FITSERVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Latency.h"
+
+/**
+ * \file FitServer.h
+ * \brief  TCP-   .
+ *
+ *      127.0.0.1  
+ * \c ChemCalculation::Calculate    .  
+ *    : '{'  JSON (   ),
+ *    .
+ *
+ *  :    (uint32),   .  
+ *    little-endian, double  IEEE 754.
+ *
+ * :
+ * \code
+ *   uint32 id; uint16 op; uint16 0;
+ *    FIT_OP_FIT: uint32 seriesCount;
+ *     seriesCount : uint32 points; uint32 0; double Cb; double Cc;
+ *                      double Tm[points]; double Ca[points];
+ * \endcode
+ * :
+ * \code
+ *   uint32 id; uint16 op; uint16 status; uint32 seriesCount; uint32 0;
+ *   double latencyUs;
+ *    FIT_OP_FIT, seriesCount : uint32 status; int32 index;
+ *                                    double n, k, r, disp;
+ *    FIT_OP_STATS: uint64 count; double meanUs, p50Us, p90Us, p99Us,
+ *                                    maxUs;
+ * \endcode
+ *
+ * JSON:  {"id": 1, "op": "fit", "series": [{"Tm": [...], "Ca": [...],
+ * "Cb": 0.1, "Cc": 0.7}]} (op   "fit"; Cb  Cc   0),
+ *  {"id": 1, "status": 0, "latency_us": ..., "results": [{"status": 0,
+ * "n": ..., "k": ..., "r": ..., "disp": ...}]}.  {"op": "stats"}
+ *   "latency"   .
+ *
+ *     \c CalcStatus (\c ChemCalculation::TryCalculate),
+ * index   ,  ,  -1 ( JSON  "index"
+ * ,   ).
+ *
+ *     ,   
+ * ():        
+ *  ,      
+ * .      ;   
+ *    \c ParallelFor (    
+ * ,    \c CHEM_THREADS). 
+ *          ;  
+ *   (\c FitServer::Stats).
+ */
+
+///   .
+constexpr uint16_t FIT_SERVER_PORT = 5555;
+
+///      JSON, .
+constexpr size_t FIT_MAX_FRAME = 256u << 20;
+
+/// :  .
+constexpr uint16_t FIT_OP_FIT = 1;
+/// :  .
+constexpr uint16_t FIT_OP_STATS = 2;
+
+///  : .
+constexpr uint16_t FIT_STATUS_OK = 0;
+///  :   .
+constexpr uint16_t FIT_STATUS_BAD_REQUEST = 1;
+///  :  .
+constexpr uint16_t FIT_STATUS_UNKNOWN_OP = 2;
+
+///  :   (\c CalcStatus::Ok);    
+/// \c CalcStatus,    .
+constexpr uint32_t FIT_SERIES_OK = 0;
+
+/**
+ * \brief  .
+ */
+struct FitServerOptions {
+  uint16_t port = FIT_SERVER_PORT;  ///<  (0   ).
+  ///    ,      ;
+  ///    .
+  size_t maxInFlight = 64;
+  ///     ,   
+  /// , ;  ,    ,
+  /// .
+  size_t maxQueuedBytes = 64u << 20;
+};
+
+/**
+ * \brief :   ,     
+ *          ,     \c ParallelFor.
+ */
+class FitServer {
+ public:
+  FitServer();
+  ~FitServer();
+  FitServer(const FitServer&) = delete;
+  FitServer& operator=(const FitServer&) = delete;
+
+  /**
+   * \brief     .
+   *
+   * \throw std::runtime_error     .
+   */
+  void Start(const FitServerOptions& options = {});
+
+  ///     ;   .
+  void Stop();
+
+  ///   ( \c Start).
+  uint16_t Port() const;
+
+  ///     .
+  LatencyStats Stats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+#endif  // FITSERVER_H
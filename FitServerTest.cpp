@@ -0,0 +1,447 @@
+/**
+ * \file FitServerTest.cpp
+ * \brief     127.0.0.1:   JSON-,
+ *        ,    .
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include "ChemCalculation.h"
+#include "FitServer.h"
+#include "Json.h"
+
+namespace {
+
+#if defined(_WIN32)
+using Socket = SOCKET;
+const Socket kNoSocket = INVALID_SOCKET;
+void CloseSocket(Socket s) { closesocket(s); }
+#else
+using Socket = int;
+constexpr Socket kNoSocket = -1;
+void CloseSocket(Socket s) { close(s); }
+#endif
+
+///      , .
+constexpr int kReplyTimeoutSeconds = 30;
+
+int g_failed = 0;
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    g_failed++;
+  }
+}
+
+///    .
+class Client {
+ public:
+  explicit Client(uint16_t port) {
+    m_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (m_socket == kNoSocket) throw std::runtime_error("socket");
+#if defined(_WIN32)
+    const DWORD timeout = kReplyTimeoutSeconds * 1000;
+#else
+    timeval timeout = {kReplyTimeoutSeconds, 0};
+#endif
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO,
+               reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(m_socket, reinterpret_cast<sockaddr*>(&addr),
+                sizeof(addr)) != 0) {
+      CloseSocket(m_socket);
+      throw std::runtime_error("connect");
+    }
+  }
+  ~Client() { CloseSocket(m_socket); }
+  Client(const Client&) = delete;
+  Client& operator=(const Client&) = delete;
+
+  bool Send(const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      const auto n = send(m_socket, data.data() + sent,
+                          static_cast<int>(data.size() - sent), 0);
+      if (n <= 0) return false;
+      sent += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  ///     ;   .
+  std::string ReadFrame() {
+    uint32_t length = 0;
+    if (!Fill(sizeof(length))) return std::string();
+    std::memcpy(&length, m_buffer.data(), sizeof(length));
+    if (!Fill(sizeof(length) + length)) return std::string();
+    std::string payload = m_buffer.substr(sizeof(length), length);
+    m_buffer.erase(0, sizeof(length) + length);
+    return payload;
+  }
+
+  ///   JSON   ;   .
+  std::string ReadLine() {
+    size_t nl;
+    while ((nl = m_buffer.find('\n')) == std::string::npos) {
+      if (!Fill(m_buffer.size() + 1)) return std::string();
+    }
+    std::string line = m_buffer.substr(0, nl);
+    m_buffer.erase(0, nl + 1);
+    return line;
+  }
+
+ private:
+  /// ,     \a size .
+  bool Fill(size_t size) {
+    char block[4096];
+    while (m_buffer.size() < size) {
+      const auto got = recv(m_socket, block, sizeof(block), 0);
+      if (got <= 0) return false;
+      m_buffer.append(block, static_cast<size_t>(got));
+    }
+    return true;
+  }
+
+  Socket m_socket;
+  std::string m_buffer;
+};
+
+///  .
+struct Series {
+  std::vector<double> Tm;
+  std::vector<double> Ca;
+  double Cb = 0.0;
+  double Cc = 0.0;
+};
+
+///    1.5   .
+Series MakeSeries(size_t points, double k, uint32_t seed) {
+  Series s;
+  uint32_t state = seed;
+  for (size_t i = 0; i < points; i++) {
+    state = state * 1664525u + 1013904223u;
+    const double noise = (state >> 8) * (1.0 / 16777216.0) - 0.5;
+    const double t = 0.5 * static_cast<double>(i);
+    s.Tm.push_back(t);
+    s.Ca.push_back((1.0 + 1e-3 * noise) / std::pow(1.0 + 0.5 * k * t, 2.0));
+  }
+  s.Cb = 0.1;
+  s.Cc = 0.7;
+  return s;
+}
+
+template <class T>
+void Put(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+T Get(const std::string& in, size_t& pos) {
+  T value{};
+  if (pos + sizeof(T) <= in.size()) {
+    std::memcpy(&value, in.data() + pos, sizeof(T));
+  }
+  pos += sizeof(T);
+  return value;
+}
+
+///   :   ,  FIT_OP_FIT, .
+std::string Frame(uint32_t id, uint16_t op,
+                  const std::vector<Series>& series) {
+  std::string payload;
+  Put<uint32_t>(payload, id);
+  Put<uint16_t>(payload, op);
+  Put<uint16_t>(payload, 0);
+  if (op == FIT_OP_FIT) {
+    Put<uint32_t>(payload, static_cast<uint32_t>(series.size()));
+    for (const Series& s : series) {
+      Put<uint32_t>(payload, static_cast<uint32_t>(s.Tm.size()));
+      Put<uint32_t>(payload, 0);
+      Put<double>(payload, s.Cb);
+      Put<double>(payload, s.Cc);
+      for (double t : s.Tm) Put<double>(payload, t);
+      for (double c : s.Ca) Put<double>(payload, c);
+    }
+  }
+  std::string frame;
+  Put<uint32_t>(frame, static_cast<uint32_t>(payload.size()));
+  return frame + payload;
+}
+
+std::string JsonArray(const std::vector<double>& values) {
+  std::string out = "[";
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i > 0) out += ", ";
+    AppendJsonNumber(out, values[i]);
+  }
+  return out + "]";
+}
+
+std::string JsonFitLine(uint32_t id, const std::vector<Series>& series) {
+  std::string out = "{\"id\": " + std::to_string(id) + ", \"series\": [";
+  for (size_t i = 0; i < series.size(); i++) {
+    if (i > 0) out += ", ";
+    out += "{\"Tm\": " + JsonArray(series[i].Tm) +
+           ", \"Ca\": " + JsonArray(series[i].Ca) + ", \"Cb\": ";
+    AppendJsonNumber(out, series[i].Cb);
+    out += ", \"Cc\": ";
+    AppendJsonNumber(out, series[i].Cc);
+    out += "}";
+  }
+  return out + "]}\n";
+}
+
+///    .
+struct SeriesReply {
+  uint32_t status = 0;
+  int32_t index = -1;
+  CalculationResult fit = {0.0, 0.0, 0.0, 0.0};
+};
+
+///  .
+struct Reply {
+  uint32_t id = 0;
+  uint16_t op = 0;
+  uint16_t status = 0;
+  uint64_t statsCount = 0;
+  std::vector<SeriesReply> results;
+  bool ok = false;  ///<     .
+};
+
+Reply ParseReply(const std::string& payload) {
+  Reply reply;
+  size_t pos = 0;
+  reply.id = Get<uint32_t>(payload, pos);
+  reply.op = Get<uint16_t>(payload, pos);
+  reply.status = Get<uint16_t>(payload, pos);
+  const uint32_t count = Get<uint32_t>(payload, pos);
+  Get<uint32_t>(payload, pos);
+  Get<double>(payload, pos);  // 
+  if (reply.status == FIT_STATUS_OK && reply.op == FIT_OP_STATS) {
+    reply.statsCount = Get<uint64_t>(payload, pos);
+    for (int i = 0; i < 5; i++) Get<double>(payload, pos);
+  }
+  for (uint32_t i = 0; i < count && pos <= payload.size(); i++) {
+    SeriesReply r;
+    r.status = Get<uint32_t>(payload, pos);
+    r.index = Get<int32_t>(payload, pos);
+    r.fit.n = Get<double>(payload, pos);
+    r.fit.k = Get<double>(payload, pos);
+    r.fit.r = Get<double>(payload, pos);
+    r.fit.disp = Get<double>(payload, pos);
+    reply.results.push_back(r);
+  }
+  reply.ok = !payload.empty() && pos == payload.size();
+  return reply;
+}
+
+bool Same(double a, double b) { return std::memcmp(&a, &b, sizeof(a)) == 0; }
+
+///          ?
+bool MatchesCalculate(const Series& s, const SeriesReply& r) {
+  const CalcOutcome expected =
+      ChemCalculation::TryCalculate(s.Ca, s.Tm, s.Cb, s.Cc);
+  if (r.status != static_cast<uint32_t>(expected.status) ||
+      r.index != expected.index) {
+    return false;
+  }
+  if (!expected.Ok()) return true;
+  const CalculationResult fit =
+      ChemCalculation::Calculate(s.Ca, s.Tm, s.Cb, s.Cc);
+  return Same(r.fit.n, fit.n) && Same(r.fit.k, fit.k) &&
+         Same(r.fit.r, fit.r) && Same(r.fit.disp, fit.disp);
+}
+
+bool MatchesAll(const std::vector<Series>& series, const Reply& reply) {
+  if (reply.results.size() != series.size()) return false;
+  for (size_t i = 0; i < series.size(); i++) {
+    if (!MatchesCalculate(series[i], reply.results[i])) return false;
+  }
+  return true;
+}
+
+///   :       Ca.
+std::vector<Series> MakeRequestSeries(uint32_t seed) {
+  std::vector<Series> series = {MakeSeries(40, 0.3, seed),
+                                MakeSeries(300, 0.05, seed + 1),
+                                MakeSeries(10, 0.8, seed + 2)};
+  series[2].Ca[4] = -0.5;
+  return series;
+}
+
+void CheckBinary(uint16_t port, size_t& answered) {
+  Client client(port);
+  const std::vector<Series> series = MakeRequestSeries(1);
+  Check(client.Send(Frame(7, FIT_OP_FIT, series)), "binary request sent");
+  const Reply reply = ParseReply(client.ReadFrame());
+  answered++;
+  Check(reply.ok && reply.id == 7 && reply.op == FIT_OP_FIT &&
+            reply.status == FIT_STATUS_OK,
+        "binary fit reply");
+  Check(MatchesAll(series, reply), "binary fit equals Calculate");
+
+  // :    send,    
+  std::string batch;
+  std::vector<std::vector<Series>> requests;
+  for (uint32_t i = 0; i < 5; i++) {
+    requests.push_back({MakeSeries(i == 0 ? 20000 : 30 + i, 0.2, 10 + i)});
+    batch += Frame(100 + i, FIT_OP_FIT, requests.back());
+  }
+  Check(client.Send(batch), "pipelined requests sent");
+  for (uint32_t i = 0; i < 5; i++) {
+    const Reply r = ParseReply(client.ReadFrame());
+    answered++;
+    Check(r.ok && r.id == 100 + i, "pipelined replies come back in order");
+    Check(MatchesAll(requests[i], r), "pipelined fit equals Calculate");
+  }
+
+  //  :   ,    
+  std::string bad;
+  Put<uint32_t>(bad, 12);
+  Put<uint32_t>(bad, 55);
+  Put<uint16_t>(bad, FIT_OP_FIT);
+  Put<uint16_t>(bad, 0);
+  Put<uint32_t>(bad, 1000);
+  Check(client.Send(bad), "malformed frame sent");
+  const Reply badReply = ParseReply(client.ReadFrame());
+  answered++;
+  Check(badReply.ok && badReply.id == 55 &&
+            badReply.status == FIT_STATUS_BAD_REQUEST &&
+            badReply.results.empty(),
+        "malformed frame gets status 1");
+  Check(client.Send(Frame(56, 77, {})), "unknown op sent");
+  const Reply unknown = ParseReply(client.ReadFrame());
+  answered++;
+  Check(unknown.ok && unknown.id == 56 &&
+            unknown.status == FIT_STATUS_UNKNOWN_OP,
+        "unknown op gets status 2");
+
+  //     
+  Check(client.Send(Frame(57, FIT_OP_FIT, series)), "request after error");
+  const Reply after = ParseReply(client.ReadFrame());
+  answered++;
+  Check(after.ok && after.id == 57 && MatchesAll(series, after),
+        "connection works after a malformed frame");
+
+  //    N   ,     
+  //  N - 1,      answered - 1 
+  Check(client.Send(Frame(58, FIT_OP_STATS, {})), "stats request sent");
+  const Reply stats = ParseReply(client.ReadFrame());
+  Check(stats.ok && stats.id == 58 && stats.op == FIT_OP_STATS &&
+            stats.status == FIT_STATUS_OK && stats.statsCount + 1 >= answered,
+        "binary stats reply");
+  answered++;
+}
+
+///  JSON-   .
+Reply ParseJsonReply(const std::string& line) {
+  Reply reply;
+  try {
+    const JsonValue root = ParseJson(line);
+    const JsonValue* id = root.Find("id");
+    const JsonValue* status = root.Find("status");
+    if (status == nullptr) return reply;
+    if (id != nullptr) reply.id = static_cast<uint32_t>(id->number);
+    reply.status = static_cast<uint16_t>(status->number);
+    if (const JsonValue* latency = root.Find("latency")) {
+      const JsonValue* count = latency->Find("count");
+      if (count == nullptr) return reply;
+      reply.op = FIT_OP_STATS;
+      reply.statsCount = static_cast<uint64_t>(count->number);
+    }
+    if (const JsonValue* results = root.Find("results")) {
+      reply.op = FIT_OP_FIT;
+      for (const JsonValue& item : results->items) {
+        SeriesReply r;
+        const JsonValue* value = item.Find("status");
+        r.status = value ? static_cast<uint32_t>(value->number) : 999;
+        if ((value = item.Find("index")) != nullptr) {
+          r.index = static_cast<int32_t>(value->number);
+        }
+        if ((value = item.Find("n")) != nullptr) r.fit.n = value->number;
+        if ((value = item.Find("k")) != nullptr) r.fit.k = value->number;
+        if ((value = item.Find("r")) != nullptr) r.fit.r = value->number;
+        if ((value = item.Find("disp")) != nullptr) r.fit.disp = value->number;
+        reply.results.push_back(r);
+      }
+    }
+    reply.ok = true;
+  } catch (const std::runtime_error&) {
+  }
+  return reply;
+}
+
+void CheckJson(uint16_t port) {
+  Client client(port);
+  //   ,    :  JSON  
+  // double,      
+  const std::vector<Series> series = MakeRequestSeries(1);
+  Check(client.Send(JsonFitLine(3, series)), "json request sent");
+  const Reply reply = ParseJsonReply(client.ReadLine());
+  Check(reply.ok && reply.id == 3 && reply.status == FIT_STATUS_OK &&
+            reply.op == FIT_OP_FIT,
+        "json fit reply");
+  Check(MatchesAll(series, reply), "json fit equals Calculate");
+
+  // ,   ,    id
+  Check(client.Send("{\"id\": 4, \"series\": [1, 2\n"), "bad json sent");
+  const Reply bad = ParseJsonReply(client.ReadLine());
+  Check(bad.ok && bad.status == FIT_STATUS_BAD_REQUEST,
+        "malformed json gets status 1");
+  Check(client.Send("{\"id\": 6, \"series\": [{\"Tm\": [1], \"Ca\": []}]}\n"),
+        "mismatched series sent");
+  const Reply mismatched = ParseJsonReply(client.ReadLine());
+  Check(mismatched.ok && mismatched.id == 6 &&
+            mismatched.status == FIT_STATUS_BAD_REQUEST,
+        "mismatched series gets status 1");
+
+  Check(client.Send("{\"id\": 5, \"op\": \"stats\"}\n"), "json stats sent");
+  const Reply stats = ParseJsonReply(client.ReadLine());
+  Check(stats.ok && stats.id == 5 && stats.status == FIT_STATUS_OK &&
+            stats.op == FIT_OP_STATS && stats.statsCount > 0,
+        "json stats reply");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    FitServer server;
+    FitServerOptions options;
+    options.port = 0;  //   
+    server.Start(options);
+    size_t answered = 0;
+    CheckBinary(server.Port(), answered);
+    CheckJson(server.Port());
+    server.Stop();
+    Check(server.Stats().count >= answered, "latency histogram counts");
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "FAILED: %s\n", e.what());
+    g_failed++;
+  }
+
+  if (g_failed == 0) std::printf("server: all checks passed\n");
+  return g_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+/**
+ * \file GlobalFit.cpp
+ * \brief      A0 .
+ */
+
+#include "GlobalFit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "ChemCalculation.h"
+#include "KineticModels.h"
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace {
+
+///  4     (  \c FitModel).
+constexpr int kSubSteps = 20;
+///   SSE,     .
+constexpr double kRelTolerance = 1e-10;
+///   .
+constexpr double kMaxLambda = 1e12;
+
+///   .
+struct RunData {
+  const ReplicateRun* run;
+  std::vector<double> weights;  ///< 1 / sigma^2   ( 1).
+
+  double Weight(size_t i) const { return weights.empty() ? 1.0 : weights[i]; }
+};
+
+/**
+ *        (ln k, n)  A0 :
+ * H = J^T W J, g = J^T W r.
+ */
+struct RunTerms {
+  double sse = 0.0;
+  double Hss[2][2] = {};  ///<   (ln k, n).
+  double Hsr[2] = {};     ///<     A0 .
+  double hrr = 0.0;       ///<   A0 .
+  double gs[2] = {};      ///<   (ln k, n).
+  double gr = 0.0;        ///<   A0 .
+};
+
+/**
+ *   ,  \a jacobian,     
+ *    .
+ *
+ * \return \c false,     .
+ */
+bool EvaluateRun(const KineticModel& model, const RunData& data, double k,
+                 double n, double A0, bool jacobian, RunTerms& terms) {
+  const ReplicateRun& run = *data.run;
+  const double p[2] = {k, n};
+  std::vector<double> A;
+  std::vector<double> J;
+  if (jacobian) {
+    IntegrateModelJacobian(model, p, A0, run.Tm, kSubSteps, A, J);
+  } else {
+    IntegrateModel(model, p, A0, run.Tm, kSubSteps, A);
+  }
+
+  terms = RunTerms();
+  for (size_t i = 0; i < run.Ca.size(); i++) {
+    const double w = data.Weight(i);
+    const double r = A[i] - run.Ca[i];
+    terms.sse += w * r * r;
+    if (!jacobian) continue;
+    //   ln k  k * dA/dk
+    const double js[2] = {J[i * 3] * k, J[i * 3 + 1]};
+    const double jr = J[i * 3 + 2];
+    for (int a = 0; a < 2; a++) {
+      terms.gs[a] += w * js[a] * r;
+      terms.Hsr[a] += w * js[a] * jr;
+      for (int b = 0; b < 2; b++) {
+        terms.Hss[a][b] += w * js[a] * js[b];
+      }
+    }
+    terms.hrr += w * jr * jr;
+    terms.gr += w * jr * r;
+  }
+  if (!std::isfinite(terms.sse)) return false;
+  if (jacobian) {
+    const double check = terms.Hss[0][0] + terms.Hss[1][1] + terms.hrr +
+                         terms.gs[0] + terms.gs[1] + terms.gr;
+    if (!std::isfinite(check)) return false;
+  }
+  return true;
+}
+
+///   .
+struct State {
+  double lnk = 0.0;
+  double n = 0.0;
+  std::vector<double> A0;
+};
+
+/**
+ *     .
+ *
+ * \return \c false,        .
+ */
+bool EvaluateAll(const KineticModel& model, const std::vector<RunData>& data,
+                 const State& s, bool jacobian, std::vector<RunTerms>& terms) {
+  terms.resize(data.size());
+  std::vector<unsigned char> ok(data.size(), 0);
+  const double k = std::exp(s.lnk);
+  ParallelFor(data.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t r = begin; r < end; r++) {
+      ok[r] = EvaluateRun(model, data[r], k, s.n, s.A0[r], jacobian, terms[r])
+                  ? 1
+                  : 0;
+    }
+  });
+  return std::all_of(ok.begin(), ok.end(), [](unsigned char v) { return v; });
+}
+
+///      (     ).
+double TotalSse(const std::vector<RunTerms>& terms) {
+  double sse = 0.0;
+  for (const RunTerms& t : terms) sse += t.sse;
+  return sse;
+}
+
+/**
+ *    : S = Hss - sum Hsr Hsr^T / hrr 
+ * b = -gs + sum Hsr gr / hrr (  A0).  
+ *  (1 + lambda).
+ */
+void ReduceShared(const std::vector<RunTerms>& terms, bool fitA0,
+                  double lambda, double S[2][2], double b[2]) {
+  S[0][0] = S[0][1] = S[1][0] = S[1][1] = 0.0;
+  b[0] = b[1] = 0.0;
+  for (const RunTerms& t : terms) {
+    for (int a = 0; a < 2; a++) {
+      b[a] -= t.gs[a];
+      for (int c = 0; c < 2; c++) S[a][c] += t.Hss[a][c];
+    }
+  }
+  for (int a = 0; a < 2; a++) {
+    S[a][a] += lambda * std::max(S[a][a], 1e-300);
+  }
+  if (!fitA0) return;
+  for (const RunTerms& t : terms) {
+    const double h = t.hrr * (1.0 + lambda) + 1e-300;
+    for (int a = 0; a < 2; a++) {
+      b[a] += t.Hsr[a] * t.gr / h;
+      for (int c = 0; c < 2; c++) S[a][c] -= t.Hsr[a] * t.Hsr[c] / h;
+    }
+  }
+}
+
+///   2x2; \c false  .
+bool Solve2(const double S[2][2], const double b[2], double d[2]) {
+  const double det = S[0][0] * S[1][1] - S[0][1] * S[1][0];
+  if (!(std::fabs(det) > 1e-300) || !std::isfinite(det)) return false;
+  d[0] = (b[0] * S[1][1] - S[0][1] * b[1]) / det;
+  d[1] = (S[0][0] * b[1] - b[0] * S[1][0]) / det;
+  return true;
+}
+
+double Median(std::vector<double> v) {
+  std::sort(v.begin(), v.end());
+  const size_t m = v.size() / 2;
+  return (v.size() % 2 != 0) ? v[m] : 0.5 * (v[m - 1] + v[m]);
+}
+
+///  :   .
+void InitialGuess(const std::vector<ReplicateRun>& runs, State& s) {
+  std::vector<double> ks;
+  std::vector<double> ns;
+  std::vector<double> k1;
+  for (const ReplicateRun& run : runs) {
+    // ,    ,   
+    // 
+    const CalcOutcome res =
+        ChemCalculation::TryCalculate(run.Ca, run.Tm, run.Cb, run.Cc);
+    if (res && res.value.k > 0.0 && std::isfinite(res.value.n)) {
+      ks.push_back(res.value.k);
+      ns.push_back(res.value.n);
+    }
+    const double A1 = run.Ca.back();
+    const double T = run.Tm.back() - run.Tm.front();
+    if (A1 > 0.0 && A1 < run.Ca.front()) {
+      k1.push_back(std::log(run.Ca.front() / A1) / T);
+    }
+  }
+  if (!ks.empty()) {
+    s.lnk = std::log(Median(ks));
+    s.n = Median(ns);
+  } else {
+    s.lnk = std::log(k1.empty() ? 1.0 : Median(k1));
+    s.n = 1.0;
+  }
+  s.A0.resize(runs.size());
+  for (size_t r = 0; r < runs.size(); r++) {
+    s.A0[r] = runs[r].Ca.front();
+  }
+}
+
+}  // namespace
+
+GlobalFitResult GlobalFit(const std::vector<ReplicateRun>& runs,
+                          const GlobalFitOptions& options) {
+  TRACE_SCOPE("GlobalFit");
+  if (runs.empty()) {
+    throw std::runtime_error("    !");
+  }
+
+  //      
+  std::vector<RunData> data(runs.size());
+  size_t total = 0;
+  for (size_t r = 0; r < runs.size(); r++) {
+    const ReplicateRun& run = runs[r];
+    if (run.Ca.size() != run.Tm.size()) {
+      throw std::runtime_error(" Ca  Tm   !");
+    }
+    ChemCalculation::ValidateInput(run.Ca, run.Tm, run.Cb, run.Cc);
+    if (!(run.Ca.front() > 0.0)) {
+      throw std::runtime_error(
+          "  Ca    !");
+    }
+    data[r].run = &run;
+    std::vector<double> s;
+    if (!run.sigma.empty() &&
+        ChemCalculation::PrepareSigma(run.Ca, run.sigma, s)) {
+      data[r].weights.resize(s.size());
+      for (size_t i = 0; i < s.size(); i++) {
+        data[r].weights[i] = 1.0 / (s[i] * s[i]);
+      }
+    }
+    total += run.Ca.size();
+  }
+  const size_t nParams = 2 + (options.fitA0 ? runs.size() : 0);
+  //   A0      
+  const size_t nResiduals = options.fitA0 ? total : total - runs.size();
+  if (nResiduals <= nParams) {
+    throw std::runtime_error("    !");
+  }
+
+  const KineticModel& model = FindModel("power");
+  State s;
+  InitialGuess(runs, s);
+
+  std::vector<RunTerms> terms;
+  std::vector<RunTerms> trialTerms;
+  if (!EvaluateAll(model, data, s, true, terms)) {
+    throw std::runtime_error(
+        "    !");
+  }
+  double sse = TotalSse(terms);
+
+  GlobalFitResult res;
+  double lambda = 1e-3;
+  int iter = 0;
+  for (; iter < options.maxIterations; iter++) {
+    bool improved = false;
+    double newSse = sse;
+    State trial;
+    while (lambda < kMaxLambda) {
+      double S[2][2];
+      double b[2];
+      double ds[2];
+      ReduceShared(terms, options.fitA0, lambda, S, b);
+      if (Solve2(S, b, ds)) {
+        trial.lnk = s.lnk + ds[0];
+        trial.n = s.n + ds[1];
+        trial.A0 = s.A0;
+        if (options.fitA0) {
+          //  :  A0     
+          for (size_t r = 0; r < runs.size(); r++) {
+            const RunTerms& t = terms[r];
+            const double h = t.hrr * (1.0 + lambda) + 1e-300;
+            trial.A0[r] +=
+                (-t.gr - t.Hsr[0] * ds[0] - t.Hsr[1] * ds[1]) / h;
+          }
+        }
+        if (EvaluateAll(model, data, trial, false, trialTerms)) {
+          newSse = TotalSse(trialTerms);
+          if (newSse < sse) {
+            improved = true;
+            lambda = std::max(lambda / 3.0, 1e-12);
+            break;
+          }
+        }
+      }
+      lambda *= 4.0;
+    }
+    if (!improved) {
+      res.converged = true;
+      break;
+    }
+    const double drop = sse - newSse;
+    s = trial;
+    sse = newSse;
+    if (!EvaluateAll(model, data, s, true, terms)) {
+      throw std::runtime_error("  !");
+    }
+    if (drop <= kRelTolerance * sse) {
+      iter++;
+      res.converged = true;
+      break;
+    }
+  }
+
+  res.k = std::exp(s.lnk);
+  res.n = s.n;
+  res.A0 = s.A0;
+  res.sse = sse;
+  res.runSse.resize(runs.size());
+  for (size_t r = 0; r < runs.size(); r++) {
+    res.runSse[r] = terms[r].sse;
+  }
+  res.iterations = iter;
+  res.disp = sse / static_cast<double>(nResiduals - nParams);
+
+  //         
+  double S[2][2];
+  double b[2];
+  ReduceShared(terms, options.fitA0, 0.0, S, b);
+  const double det = S[0][0] * S[1][1] - S[0][1] * S[1][0];
+  if (det > 0.0 && std::isfinite(det)) {
+    const double vLnk = res.disp * S[1][1] / det;
+    const double vN = res.disp * S[0][0] / det;
+    const double cv = -res.disp * S[0][1] / det;
+    res.seK = res.k * std::sqrt(vLnk);
+    res.seN = std::sqrt(vN);
+    res.corrKN = cv / std::sqrt(vLnk * vN);
+  }
+  if (!std::isfinite(res.k) || !std::isfinite(res.n)) {
+    throw std::runtime_error("  !");
+  }
+  TRACE_COUNTER("GlobalFit.iterations", res.iterations);
+  return res;
+}
@@ -0,0 +1,78 @@
+#ifndef GLOBALFIT_H
+#define GLOBALFIT_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * \file GlobalFit.h
+ * \brief   k  n    .
+ *
+ *      (Ca, t)    .
+ *   k   n    , 
+ *  A0     ,   
+ * .  W = k * A^n   4 (.
+ * \c KineticModels.h),     A(t) 
+ *   .
+ *
+ *      ( ,    )
+ *    .    
+ *  :   2x2    A0  , 
+ *     A0 ( ) 
+ * O(R)  R .
+ */
+
+/**
+ * \brief   .
+ */
+struct ReplicateRun {
+  std::vector<double> Ca;     ///<   A.
+  std::vector<double> Tm;     ///<   ( ).
+  double Cb = 0.0;            ///<   B.
+  double Cc = 0.0;            ///<   C.
+  std::vector<double> sigma;  ///<  Ca (   ).
+};
+
+/**
+ * \brief   .
+ */
+struct GlobalFitOptions {
+  int maxIterations = 100;  ///<   .
+  ///  A0 ; \c false  A0 = Ca[0]  .
+  bool fitA0 = true;
+};
+
+/**
+ * \brief   .
+ */
+struct GlobalFitResult {
+  double k = 0.0;              ///<   .
+  double n = 0.0;              ///<   .
+  std::vector<double> A0;      ///<    .
+  double sse = 0.0;            ///<    .
+  std::vector<double> runSse;  ///<     \c sse.
+  double disp = 0.0;           ///<   (  ).
+  double seK = 0.0;            ///<   k.
+  double seN = 0.0;            ///<   n.
+  double corrKN = 0.0;         ///<    k  n.
+  int iterations = 0;          ///<  .
+  bool converged = false;      ///<   .
+};
+
+/**
+ * \brief   k  n   .
+ *
+ *     k  n  
+ * \c ChemCalculation::Calculate   .
+ *
+ * \param runs  (  ).
+ * \param options .
+ * \return  k, n, A0    .
+ * \throw std::runtime_error      
+ *         .
+ */
+GlobalFitResult GlobalFit(const std::vector<ReplicateRun>& runs,
+                          const GlobalFitOptions& options =
+                              GlobalFitOptions());
+
+#endif  // GLOBALFIT_H
@@ -0,0 +1,263 @@
+/**
+ * \file IncrementalDataset.cpp
+ * \brief       .
+ */
+
+#include "IncrementalDataset.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "Trace.h"
+
+namespace {
+
+///   , .
+constexpr size_t kCompareBlock = 4096;
+
+size_t Intervals(size_t rows) { return rows > 0 ? rows - 1 : 0; }
+
+///  \a pos    .
+bool IsLineStart(const std::string& text, size_t pos) {
+  return pos == 0 || text[pos - 1] == '\n';
+}
+
+///   [first, last)  \a v  \a items.
+template <typename T>
+void Splice(std::vector<T>& v, size_t first, size_t last,
+            const std::vector<T>& items) {
+  const size_t common = std::min(last - first, items.size());
+  std::copy(items.begin(), items.begin() + common, v.begin() + first);
+  if (items.size() > common) {
+    v.insert(v.begin() + last, items.begin() + common, items.end());
+  } else {
+    v.erase(v.begin() + first + common, v.begin() + last);
+  }
+}
+
+///    \a a  \a b (   memcmp).
+size_t CommonPrefix(const char* a, const char* b, size_t size) {
+  size_t pos = 0;
+  while (pos + kCompareBlock <= size &&
+         std::memcmp(a + pos, b + pos, kCompareBlock) == 0) {
+    pos += kCompareBlock;
+  }
+  while (pos < size && a[pos] == b[pos]) pos++;
+  return pos;
+}
+
+///    \a a  \a b,   \a limit.
+size_t CommonSuffix(const char* aEnd, const char* bEnd, size_t limit) {
+  size_t len = 0;
+  while (len + kCompareBlock <= limit &&
+         std::memcmp(aEnd - len - kCompareBlock, bEnd - len - kCompareBlock,
+                     kCompareBlock) == 0) {
+    len += kCompareBlock;
+  }
+  while (len < limit && aEnd[-1 - static_cast<ptrdiff_t>(len)] ==
+                            bEnd[-1 - static_cast<ptrdiff_t>(len)]) {
+    len++;
+  }
+  return len;
+}
+
+size_t CountNaN(const double* values, size_t count) {
+  size_t n = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (std::isnan(values[i])) n++;
+  }
+  return n;
+}
+
+}  // namespace
+
+void IncrementalDataset::Load(const std::filesystem::path& path,
+                              const ImportOptions& options) {
+  std::string text;
+  m_path = path;
+  ReadText(text);
+  m_options = options;
+  m_options.keepRows = true;
+  ImportedData data = ImportDelimitedText(text.data(), text.size(), m_options);
+  m_options.delimiter = data.delimiter;
+
+  m_text.swap(text);
+  m_sigma.swap(data.sigma);
+  m_rowStarts.swap(data.rowStarts);
+  m_data = std::move(data);
+  m_sigmaMissing = CountNaN(m_sigma.data(), m_sigma.size());
+  PublishSigma();
+
+  const size_t m = Intervals(m_data.Tm.size());
+  m_x.resize(m);
+  m_y.resize(m);
+  ChemCalculation::BuildLogPoints(m_data.Ca.data(), m_data.Tm.data(),
+                                  m_data.Tm.size(), m_x.data(), m_y.data());
+  RecomputeSums();
+}
+
+DatasetChange IncrementalDataset::Reload() {
+  TRACE_SCOPE("IncrementalDataset::Reload");
+  DatasetChange change;
+  //     :   
+  std::string& text = m_next;
+  ReadText(text);
+
+  //     
+  const std::string& old = m_text;
+  const size_t common = std::min(old.size(), text.size());
+  const size_t prefix = CommonPrefix(old.data(), text.data(), common);
+  if (prefix == old.size() && prefix == text.size()) return change;
+  change.changed = true;
+  const size_t suffix = CommonSuffix(old.data() + old.size(),
+                                     text.data() + text.size(),
+                                     common - prefix);
+
+  //         
+  size_t begin = prefix;
+  while (begin > 0 && old[begin - 1] != '\n') begin--;
+  size_t oldEnd = old.size() - suffix;
+  size_t newEnd = text.size() - suffix;
+  while (oldEnd < old.size() &&
+         !(IsLineStart(old, oldEnd) && IsLineStart(text, newEnd))) {
+    oldEnd++;
+    newEnd++;
+  }
+
+  ImportOptions options = m_options;
+  const ImportedData parsed =
+      ImportDelimitedText(text.data() + begin, newEnd - begin, options);
+  options.keepRows = false;
+  const size_t oldSkipped =
+      ImportDelimitedText(old.data() + begin, oldEnd - begin, options)
+          .skippedLines;
+
+  const size_t a = static_cast<size_t>(
+      std::lower_bound(m_rowStarts.begin(), m_rowStarts.end(), begin) -
+      m_rowStarts.begin());
+  const size_t b = static_cast<size_t>(
+      std::lower_bound(m_rowStarts.begin() + a, m_rowStarts.end(), oldEnd) -
+      m_rowStarts.begin());
+  const size_t inserted = parsed.Tm.size();
+  change.firstRow = a;
+  change.removedRows = b - a;
+  change.insertedRows = inserted;
+  change.parsedBytes = newEnd - begin;
+
+  //  ,  , 
+  const size_t rows = m_data.Tm.size();
+  const size_t lo = a > 0 ? a - 1 : 0;
+  const size_t hiOld = std::max(lo, std::min(b, Intervals(rows)));
+  AddIntervals(lo, hiOld, true);
+  m_churn += hiOld - lo;
+
+  //  ;     
+  m_sigmaMissing -= CountNaN(m_sigma.data() + a, b - a);
+  m_sigmaMissing += CountNaN(parsed.sigma.data(), inserted);
+  std::vector<size_t> starts = parsed.rowStarts;
+  for (size_t& s : starts) s += begin;
+  for (size_t i = b; i < rows; i++) {
+    m_rowStarts[i] = m_rowStarts[i] - old.size() + text.size();
+  }
+  Splice(m_data.Tm, a, b, parsed.Tm);
+  Splice(m_data.Ca, a, b, parsed.Ca);
+  Splice(m_sigma, a, b, parsed.sigma);
+  Splice(m_rowStarts, a, b, starts);
+  m_data.skippedLines = m_data.skippedLines - oldSkipped + parsed.skippedLines;
+  PublishSigma();
+
+  //  
+  const size_t hiNew =
+      std::max(lo, std::min(a + inserted, Intervals(m_data.Tm.size())));
+  std::vector<double> x(hiNew - lo);
+  std::vector<double> y(hiNew - lo);
+  if (hiNew > lo) {
+    ChemCalculation::BuildLogPoints(m_data.Ca.data() + lo,
+                                    m_data.Tm.data() + lo, hiNew - lo + 1,
+                                    x.data(), y.data());
+  }
+  Splice(m_x, lo, hiOld, x);
+  Splice(m_y, lo, hiOld, y);
+  if (m_churn > m_x.size()) {
+    RecomputeSums();
+  } else {
+    AddIntervals(lo, hiNew, false);
+  }
+  m_text.swap(text);
+  return change;
+}
+
+CalcOutcome IncrementalDataset::Fit() const {
+  CalcOutcome outcome = {{0.0, 0.0, 0.0, 0.0}, CalcStatus::Ok, -1};
+  const size_t count = m_data.Tm.size();
+  outcome.status = ChemCalculation::CheckInput(
+      m_data.Ca.data(), m_data.Tm.data(), count, 0.0, 0.0, outcome.index);
+  if (!outcome) return outcome;
+  if (m_nonFinite > 0) {
+    outcome.status = CalcStatus::NonFinite;
+    return outcome;
+  }
+  const double sums[6] = {static_cast<double>(count - 1), m_sums[0],
+                          m_sums[1], m_sums[2], m_sums[3], m_sums[4]};
+  LogLogFit fit;
+  outcome.status = ChemCalculation::FitFromSums(sums, fit);
+  if (!outcome) return outcome;
+  if (!std::isfinite(fit.n) || !std::isfinite(fit.k) ||
+      !std::isfinite(fit.r)) {
+    outcome.status = CalcStatus::NonFinite;
+    return outcome;
+  }
+  outcome.value = {fit.n, fit.k, fit.r, 0.0};
+  return outcome;
+}
+
+void IncrementalDataset::ReadText(std::string& text) const {
+  std::ifstream in(m_path, std::ios::binary | std::ios::ate);
+  if (!in) throw std::runtime_error("    !");
+  const std::streamoff size = in.tellg();
+  text.resize(size > 0 ? static_cast<size_t>(size) : 0);
+  in.seekg(0);
+  if (!text.empty() && !in.read(&text[0], size)) {
+    throw std::runtime_error("    !");
+  }
+}
+
+void IncrementalDataset::RecomputeSums() {
+  std::fill(m_sums, m_sums + 5, 0.0);
+  m_nonFinite = 0;
+  m_churn = 0;
+  AddIntervals(0, m_x.size(), false);
+}
+
+void IncrementalDataset::AddIntervals(size_t begin, size_t end, bool remove) {
+  const double sign = remove ? -1.0 : 1.0;
+  for (size_t i = begin; i < end; i++) {
+    const double x = m_x[i];
+    const double y = m_y[i];
+    //      :   
+    if (!std::isfinite(x) || !std::isfinite(y)) {
+      if (remove) {
+        m_nonFinite--;
+      } else {
+        m_nonFinite++;
+      }
+      continue;
+    }
+    m_sums[0] += sign * x;
+    m_sums[1] += sign * y;
+    m_sums[2] += sign * (x * x);
+    m_sums[3] += sign * (x * y);
+    m_sums[4] += sign * (y * y);
+  }
+}
+
+void IncrementalDataset::PublishSigma() {
+  if (m_sigmaMissing == 0 && !m_sigma.empty()) {
+    m_data.sigma = m_sigma;
+  } else {
+    m_data.sigma.clear();
+  }
+}
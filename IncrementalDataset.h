@@ -0,0 +1,105 @@
+#ifndef INCREMENTALDATASET_H
+#define INCREMENTALDATASET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "ChemCalculation.h"
+#include "DataImport.h"
+
+/**
+ * \file IncrementalDataset.h
+ * \brief          .
+ *
+ *       :   
+ *     ,  \c ImportDelimitedText 
+ *    .     , 
+ *        .
+ *
+ *   ln|dCa/dt|  ln Ca (  \c StreamingFit) 
+ *      :  ,
+ *  , ,  .  ,
+ *          
+ * O( );        
+ *   (memcmp)   \c ChemCalculation::CheckInput.
+ *     ,   ,
+ *       .
+ */
+
+/**
+ * \brief    .
+ */
+struct DatasetChange {
+  bool changed = false;      ///<   .
+  size_t firstRow = 0;       ///<    .
+  size_t removedRows = 0;    ///<      firstRow.
+  size_t insertedRows = 0;   ///<      firstRow.
+  size_t parsedBytes = 0;    ///<   .
+};
+
+/**
+ * \brief ,    .
+ */
+class IncrementalDataset {
+ public:
+  /**
+   * \brief   .
+   *
+   *        
+   *   .
+   *
+   * \param path   .
+   * \param options   (\c keepRows   ).
+   * \throw std::runtime_error     .
+   */
+  void Load(const std::filesystem::path& path,
+            const ImportOptions& options = {});
+
+  /**
+   * \brief       .
+   *
+   * \return   (\c changed = false    ).
+   * \throw std::runtime_error      (,
+   *            );   .
+   */
+  DatasetChange Reload();
+
+  ///   (       ).
+  const ImportedData& Data() const { return m_data; }
+
+  ///   .
+  const std::filesystem::path& Path() const { return m_path; }
+
+  /**
+   * \brief n, k, r    (value.disp  0).
+   *
+   * \return    ,   \c ChemCalculation::Calculate
+   *          Cb = Cc = 0.
+   */
+  CalcOutcome Fit() const;
+
+ private:
+  void ReadText(std::string& text) const;
+  void RecomputeSums();
+  void AddIntervals(size_t begin, size_t end, bool remove);
+  void PublishSigma();
+
+  std::filesystem::path m_path;
+  ImportOptions m_options;
+  std::string m_text;                ///<   .
+  std::string m_next;                ///<   .
+  ImportedData m_data;               ///<  (  . \c Data).
+  std::vector<double> m_sigma;       ///<  (NaN   ).
+  std::vector<size_t> m_rowStarts;   ///<     m_text.
+  std::vector<double> m_x;           ///< ln Ca  .
+  std::vector<double> m_y;           ///< ln|dCa/dt|  .
+  double m_sums[5] = {0.0, 0.0, 0.0, 0.0, 0.0};  ///< x, y, x*x, x*y, y*y.
+  size_t m_sigmaMissing = 0;  ///<   .
+  size_t m_nonFinite = 0;     ///<    x  y.
+  size_t m_churn = 0;         ///<     .
+};
+
+#endif  // INCREMENTALDATASET_H
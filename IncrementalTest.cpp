@@ -0,0 +1,264 @@
+/**
+ * \file IncrementalTest.cpp
+ * \brief  \c IncrementalDataset::Reload    .
+ *
+ *       (,
+ *    ,  ,   CRLF,
+ * ,     ).   
+ *     \c Reload    \c Load  
+ *  .
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "IncrementalDataset.h"
+
+namespace {
+
+///   .
+constexpr size_t kEdits = 6000;
+///        .
+constexpr size_t kRegenerateEvery = 100;
+///     .
+constexpr size_t kInitialRows = 200;
+///    n, k, r:    
+///       .
+constexpr double kFitTolerance = 1e-9;
+
+int g_failed = 0;
+
+void Check(bool ok, const char* what, size_t edit) {
+  if (!ok) {
+    std::fprintf(stderr, "FAILED after edit %zu: %s\n", edit, what);
+    g_failed++;
+  }
+}
+
+///   (LCG).
+class Random {
+ public:
+  uint64_t Next() {
+    m_state = m_state * 6364136223846793005ull + 1442695040888963407ull;
+    return m_state >> 11;
+  }
+  double Uniform() { return static_cast<double>(Next()) * 0x1p-53; }
+  size_t Below(size_t n) { return n == 0 ? 0 : Next() % n; }
+
+ private:
+  uint64_t m_state = 0x9E3779B97F4A7C15ull;
+};
+
+///   "t;Ca[;sigma]"   .
+std::string MakeRow(double t, Random& random) {
+  const double ca = std::exp(-0.3 * t) * (1.0 + 0.02 * random.Uniform());
+  char line[96];
+  if (random.Below(10) == 0) {
+    std::snprintf(line, sizeof(line), "%.6g;%.9g", t, ca);
+  } else {
+    std::snprintf(line, sizeof(line), "%.6g;%.9g;%.3g", t, ca,
+                  1e-3 * (1.0 + random.Uniform()));
+  }
+  return std::string(line) + (random.Below(8) == 0 ? "\r\n" : "\n");
+}
+
+std::string MakeFile(Random& random) {
+  std::string text = "t;Ca;sigma\n# initial data\n";
+  for (size_t i = 0; i < kInitialRows; i++) {
+    text += MakeRow(0.1 * static_cast<double>(i + 1), random);
+  }
+  return text;
+}
+
+///   .
+std::vector<size_t> LineStarts(const std::string& text) {
+  std::vector<size_t> starts;
+  for (size_t pos = 0; pos < text.size();) {
+    starts.push_back(pos);
+    const size_t nl = text.find('\n', pos);
+    pos = nl == std::string::npos ? text.size() : nl + 1;
+  }
+  return starts;
+}
+
+///  ,   \a pos,  NaN.
+double RowTime(const std::string& text, size_t pos) {
+  char* end = nullptr;
+  const double t = std::strtod(text.c_str() + pos, &end);
+  return end != text.c_str() + pos ? t : std::nan("");
+}
+
+///    .
+void Edit(std::string& text, Random& random) {
+  const std::vector<size_t> starts = LineStarts(text);
+  const size_t lines = starts.size();
+  const size_t line = random.Below(lines + 1);
+  const size_t at = line < lines ? starts[line] : text.size();
+  const size_t lineEnd = line + 1 < lines ? starts[line + 1] : text.size();
+  static const char kBytes[] = "0123456789.;,-+eE \t\r\n#x";
+  switch (random.Below(9)) {
+    case 0:
+    case 1: {  //  ;     
+      double t = lines > 0 ? RowTime(text, starts[lines - 1]) : 0.0;
+      if (!std::isfinite(t)) t = 0.0;
+      if (!text.empty() && text.back() != '\n') text += '\n';
+      for (size_t k = 1 + random.Below(5); k > 0; k--) {
+        t += 0.05 + 0.1 * random.Uniform();
+        text += MakeRow(t, random);
+      }
+      if (random.Below(4) == 0) {
+        while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) {
+          text.pop_back();
+        }
+      }
+      break;
+    }
+    case 2: {  //      
+      const double prev = line > 0 ? RowTime(text, starts[line - 1]) : 0.0;
+      const double next = line < lines ? RowTime(text, at) : prev + 0.2;
+      double t = 0.5 * (prev + next);
+      if (!std::isfinite(t)) t = 10.0 * random.Uniform();
+      text.insert(at, MakeRow(t, random));
+      break;
+    }
+    case 3:  //  
+      if (line < lines) {
+        const size_t count = 1 + random.Below(3);
+        const size_t last = std::min(lines, line + count);
+        const size_t end = last < lines ? starts[last] : text.size();
+        text.erase(at, end - at);
+      }
+      break;
+    case 4:
+    case 5:  // ,    
+      if (!text.empty()) {
+        const size_t pos = random.Below(text.size());
+        const char c = kBytes[random.Below(sizeof(kBytes) - 1)];
+        const size_t kind = random.Below(3);
+        if (kind == 0) {
+          text[pos] = c;
+        } else if (kind == 1) {
+          text.insert(pos, 1, c);
+        } else {
+          text.erase(pos, 1);
+        }
+      }
+      break;
+    case 6:  // LF <-> CRLF   
+      if (line < lines && lineEnd > at && text[lineEnd - 1] == '\n') {
+        if (lineEnd - at >= 2 && text[lineEnd - 2] == '\r') {
+          text.erase(lineEnd - 2, 1);
+        } else {
+          text.insert(lineEnd - 1, 1, '\r');
+        }
+      }
+      break;
+    case 7:  //      
+      if (line < lines && random.Below(2) == 0) {
+        text.insert(at, "# ");
+      } else {
+        text.insert(at, "# note\n");
+      }
+      break;
+    default:  //     (   )
+      if (line < lines) {
+        const size_t semi = text.find(';', at);
+        if (semi != std::string::npos && semi < lineEnd) {
+          text[semi + 1 < lineEnd ? semi + 1 : semi] =
+              static_cast<char>('0' + random.Below(10));
+        }
+      }
+      break;
+  }
+}
+
+void WriteText(const std::filesystem::path& path, const std::string& text) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+bool SameValues(const std::vector<double>& a, const std::vector<double>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (std::memcmp(&a[i], &b[i], sizeof(double)) != 0) return false;
+  }
+  return true;
+}
+
+bool Close(double a, double b) {
+  return std::fabs(a - b) <= kFitTolerance * std::max(1.0, std::fabs(b));
+}
+
+void Compare(const IncrementalDataset& inc, const IncrementalDataset& full,
+             size_t edit) {
+  const ImportedData& a = inc.Data();
+  const ImportedData& b = full.Data();
+  Check(SameValues(a.Tm, b.Tm), "Tm", edit);
+  Check(SameValues(a.Ca, b.Ca), "Ca", edit);
+  Check(SameValues(a.sigma, b.sigma), "sigma", edit);
+  Check(a.skippedLines == b.skippedLines, "skipped lines", edit);
+
+  const CalcOutcome fa = inc.Fit();
+  const CalcOutcome fb = full.Fit();
+  Check(fa.status == fb.status && fa.index == fb.index, "fit status", edit);
+  if (fa.Ok() && fb.Ok()) {
+    Check(Close(fa.value.n, fb.value.n) && Close(fa.value.k, fb.value.k) &&
+              Close(fa.value.r, fb.value.r),
+          "n, k, r", edit);
+  }
+}
+
+}  // namespace
+
+int main() {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() /
+      ("chem_incremental_test_" + std::to_string(std::random_device{}()) +
+       ".csv");
+  Random random;
+  std::string text = MakeFile(random);
+  WriteText(path, text);
+
+  IncrementalDataset inc;
+  inc.Load(path);
+  // Reload    ;    
+  // ,        
+  ImportOptions options;
+  options.delimiter = inc.Data().delimiter;
+  size_t changed = 0;
+  size_t fitted = 0;
+  for (size_t edit = 1; edit <= kEdits && g_failed == 0; edit++) {
+    if (edit % kRegenerateEvery == 0) {
+      text = MakeFile(random);
+    } else {
+      Edit(text, random);
+    }
+    WriteText(path, text);
+    if (inc.Reload().changed) changed++;
+    IncrementalDataset full;
+    full.Load(path, options);
+    Compare(inc, full, edit);
+    if (inc.Fit().Ok()) fitted++;
+  }
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+
+  //       ,   
+  //   
+  Check(changed > kEdits / 2, "edits change the file", kEdits);
+  Check(fitted > kEdits / 10, "fits succeed often enough", kEdits);
+  if (g_failed == 0) {
+    std::printf("incremental: %zu edits (%zu fitted), all checks passed\n",
+                kEdits, fitted);
+  }
+  return g_failed == 0 ? 0 : 1;
+}
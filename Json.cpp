@@ -0,0 +1,165 @@
+/**
+ * \file Json.cpp
+ * \brief   JSON   .
+ */
+
+#include "Json.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+class JsonReader {
+ public:
+  explicit JsonReader(const std::string& text) : m_text(text) {}
+
+  JsonValue Parse() {
+    JsonValue v = ParseValue();
+    SkipSpace();
+    if (m_pos != m_text.size()) Fail("trailing characters");
+    return v;
+  }
+
+ private:
+  [[noreturn]] void Fail(const char* what) const {
+    throw std::runtime_error("JSON parse error at offset " +
+                             std::to_string(m_pos) + ": " + what);
+  }
+
+  void SkipSpace() {
+    while (m_pos < m_text.size() &&
+           std::strchr(" \t\r\n", m_text[m_pos]) != nullptr) {
+      m_pos++;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipSpace();
+    if (m_pos < m_text.size() && m_text[m_pos] == c) {
+      m_pos++;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(char c) {
+    if (!Consume(c)) Fail("unexpected character");
+  }
+
+  std::string ParseString() {
+    Expect('"');
+    std::string out;
+    while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+      char c = m_text[m_pos++];
+      if (c == '\\') {
+        if (m_pos >= m_text.size()) Fail("bad escape");
+        c = m_text[m_pos++];
+        switch (c) {
+          case 'n': c = '\n'; break;
+          case 't': c = '\t'; break;
+          case 'r': c = '\r'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case '"': case '\\': case '/': break;
+          default: Fail("unsupported escape");
+        }
+      }
+      out.push_back(c);
+    }
+    if (m_pos >= m_text.size()) Fail("unterminated string");
+    m_pos++;
+    return out;
+  }
+
+  JsonValue ParseObject() {
+    JsonValue v;
+    v.kind = JsonValue::Object;
+    if (Consume('}')) return v;
+    do {
+      SkipSpace();
+      std::string key = ParseString();
+      Expect(':');
+      v.fields.emplace_back(std::move(key), ParseValue());
+    } while (Consume(','));
+    Expect('}');
+    return v;
+  }
+
+  JsonValue ParseArray() {
+    JsonValue v;
+    v.kind = JsonValue::Array;
+    if (Consume(']')) return v;
+    do {
+      v.items.push_back(ParseValue());
+    } while (Consume(','));
+    Expect(']');
+    return v;
+  }
+
+  JsonValue ParseValue() {
+    SkipSpace();
+    if (m_pos >= m_text.size()) Fail("unexpected end");
+    const char c = m_text[m_pos];
+    if (c == '{' || c == '[') {
+      //  :     
+      if (m_depth == JSON_MAX_DEPTH) Fail("nesting too deep");
+      m_depth++;
+      m_pos++;
+      JsonValue v = c == '{' ? ParseObject() : ParseArray();
+      m_depth--;
+      return v;
+    }
+    JsonValue v;
+    if (c == '"') {
+      v.kind = JsonValue::String;
+      v.text = ParseString();
+    } else if (m_text.compare(m_pos, 4, "true") == 0 ||
+               m_text.compare(m_pos, 5, "false") == 0) {
+      v.kind = JsonValue::Bool;
+      v.number = (c == 't') ? 1.0 : 0.0;
+      m_pos += (c == 't') ? 4 : 5;
+    } else if (m_text.compare(m_pos, 4, "null") == 0) {
+      m_pos += 4;
+    } else {
+      // from_chars         '+'
+      const char* begin = m_text.data() + m_pos;
+      const char* end = m_text.data() + m_text.size();
+      v.kind = JsonValue::Number;
+      const std::from_chars_result r = std::from_chars(begin, end, v.number);
+      if (r.ec != std::errc()) Fail("bad value");
+      m_pos += static_cast<size_t>(r.ptr - begin);
+    }
+    return v;
+  }
+
+  const std::string& m_text;
+  size_t m_pos = 0;
+  size_t m_depth = 0;  ///<    .
+};
+
+}  // namespace
+
+const JsonValue* JsonValue::Find(const std::string& key) const {
+  for (const auto& f : fields) {
+    if (f.first == key) return &f.second;
+  }
+  return nullptr;
+}
+
+JsonValue ParseJson(const std::string& text) {
+  return JsonReader(text).Parse();
+}
+
+void AppendJsonNumber(std::string& out, double value) {
+  if (!std::isfinite(value)) {
+    out += "null";
+    return;
+  }
+  //  ,    ;   
+  char buf[32];
+  const std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, r.ptr);
+}
@@ -0,0 +1,47 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \file Json.h
+ * \brief   JSON      .
+ *
+ *  , ,  ( \\u-),
+ * , true/false/null.     .
+ */
+
+///     ;    .
+constexpr size_t JSON_MAX_DEPTH = 64;
+
+/**
+ * \brief  JSON.
+ */
+struct JsonValue {
+  enum Kind { Null, Bool, Number, String, Array, Object } kind = Null;
+  double number = 0.0;  ///<  ( Bool  0  1).
+  std::string text;     ///< .
+  std::vector<JsonValue> items;  ///<  .
+  std::vector<std::pair<std::string, JsonValue>> fields;  ///<  .
+
+  ///     \a key  \c nullptr.
+  const JsonValue* Find(const std::string& key) const;
+};
+
+/**
+ * \brief   JSON .
+ *
+ * \throw std::runtime_error     
+ *         \c JSON_MAX_DEPTH ( ).
+ */
+JsonValue ParseJson(const std::string& text);
+
+/**
+ * \brief     JSON (nan  inf   null).
+ */
+void AppendJsonNumber(std::string& out, double value);
+
+#endif  // JSON_H
@@ -0,0 +1,63 @@
+/**
+ * \file JsonTest.cpp
+ * \brief   JSON: ,    .
+ */
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "Json.h"
+
+namespace {
+
+int g_failed = 0;
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    g_failed++;
+  }
+}
+
+///  ; \c false,    .
+bool Parses(const std::string& text, std::string* error = nullptr) {
+  try {
+    ParseJson(text);
+    return true;
+  } catch (const std::runtime_error& e) {
+    if (error != nullptr) *error = e.what();
+    return false;
+  }
+}
+
+std::string Nested(size_t depth, char open, char close) {
+  return std::string(depth, open) + std::string(depth, close);
+}
+
+}  // namespace
+
+int main() {
+  const JsonValue v = ParseJson(
+      "{\"id\": 3, \"series\": [{\"Tm\": [0, 1.5], \"Ca\": [2, -1e-3]}]}");
+  const JsonValue* series = v.Find("series");
+  Check(series != nullptr && series->items.size() == 1, "request parsed");
+  Check(v.Find("id") != nullptr && v.Find("id")->number == 3.0, "id");
+
+  Check(Parses(Nested(JSON_MAX_DEPTH, '[', ']')), "max depth accepted");
+  Check(!Parses(Nested(JSON_MAX_DEPTH + 1, '[', ']')), "depth + 1 rejected");
+  std::string objects;
+  for (size_t i = 0; i <= JSON_MAX_DEPTH; i++) objects += "{\"a\": ";
+  objects += "0" + std::string(JSON_MAX_DEPTH + 1, '}');
+  Check(!Parses(objects), "nested objects rejected");
+
+  //          
+  std::string error;
+  Check(!Parses(std::string(2000000, '['), &error) &&
+            error.find("nesting too deep") != std::string::npos,
+        "deep nesting is a parse error");
+  Check(!Parses("[1, 2"), "unterminated array rejected");
+
+  if (g_failed == 0) std::printf("json: all checks passed\n");
+  return g_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,480 @@
+/**
+ * \file KineticModels.cpp
+ * \brief  ,  4   .
+ */
+
+#include "KineticModels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "ChemCalculation.h"
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace {
+
+///  4      .
+constexpr int kSubSteps = 20;
+///    .
+constexpr int kMaxIterations = 200;
+///   SSE,     .
+constexpr double kRelTolerance = 1e-10;
+///   :     SSE.
+constexpr double kMaxLambda = 1e12;
+
+///        4.
+template <typename T>
+T Clamp0(const T& A) {
+  return A > 0.0 ? A : T(0.0);
+}
+
+template <typename T>
+T PowerLawRate(const T& A, const T&, const T* p) {
+  using std::pow;
+  const T a = Clamp0(A);
+  return a > 0.0 ? T(p[0] * pow(a, p[1])) : T(0.0);
+}
+
+template <typename T>
+T FirstOrderRate(const T& A, const T&, const T* p) {
+  return p[0] * Clamp0(A);
+}
+
+template <typename T>
+T SecondOrderRate(const T& A, const T&, const T* p) {
+  const T a = Clamp0(A);
+  return p[0] * a * a;
+}
+
+template <typename T>
+T ReversibleRate(const T& A, const T& A0, const T* p) {
+  const T a = Clamp0(A);
+  return p[0] * a - p[1] * (A0 - a);
+}
+
+template <typename T>
+T AutocatalyticRate(const T& A, const T& A0, const T* p) {
+  const T a = Clamp0(A);
+  return p[0] * a * (A0 - a + p[1]);
+}
+
+template <typename T>
+T MichaelisMentenRate(const T& A, const T&, const T* p) {
+  const T a = Clamp0(A);
+  return p[0] * a / (p[1] + a);
+}
+
+/**
+ *  4,      :  \c ModelDual
+ *   A(t)      A0.
+ */
+template <typename T>
+void Integrate(T (*rate)(const T&, const T&, const T*), const T* p,
+               const T& A0, const std::vector<double>& t, int subSteps,
+               std::vector<T>& A) {
+  A.resize(t.size());
+  if (t.empty()) {
+    return;
+  }
+  A[0] = A0;
+  T a = A0;
+  for (size_t i = 1; i < t.size(); i++) {
+    const double h = (t[i] - t[i - 1]) / subSteps;
+    for (int s = 0; s < subSteps; s++) {
+      const T k1 = -rate(a, A0, p);
+      const T k2 = -rate(a + 0.5 * h * k1, A0, p);
+      const T k3 = -rate(a + 0.5 * h * k2, A0, p);
+      const T k4 = -rate(a + h * k3, A0, p);
+      a += h / 6.0 * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+    }
+    A[i] = a;
+  }
+}
+
+void PowerLawGuess(double, double k1, double* p) {
+  p[0] = k1;
+  p[1] = 1.0;
+}
+
+void FirstOrderGuess(double, double k1, double* p) { p[0] = k1; }
+
+void SecondOrderGuess(double A0, double k1, double* p) { p[0] = k1 / A0; }
+
+void ReversibleGuess(double, double k1, double* p) {
+  p[0] = k1;
+  p[1] = 0.1 * k1;
+}
+
+void AutocatalyticGuess(double A0, double k1, double* p) {
+  //   k * A * (A0 / 2 + p0) ~ k1 * A  p0 = 0.1 * A0
+  p[0] = k1 / (0.6 * A0);
+  p[1] = 0.1 * A0;
+}
+
+void MichaelisMentenGuess(double A0, double k1, double* p) {
+  //  Km = A0   Vmax / 2   k1 * A0
+  p[0] = 2.0 * k1 * A0;
+  p[1] = A0;
+}
+
+/**
+ *          
+ *      .
+ */
+double ApparentFirstOrder(const std::vector<double>& Ca,
+                          const std::vector<double>& Tm) {
+  const double A0 = Ca.front();
+  const double A1 = Ca.back();
+  const double T = Tm.back() - Tm.front();
+  if (A1 > 0.0 && A1 < A0) {
+    return std::log(A0 / A1) / T;
+  }
+  return 1.0 / T;
+}
+
+///      ( ).
+void ToParams(const KineticModel& model, const double* theta, double* p) {
+  for (size_t j = 0; j < model.paramCount; j++) {
+    p[j] = model.positive[j] ? std::exp(theta[j]) : theta[j];
+  }
+}
+
+/**
+ *  A(t_i) - Ca[i]  i >= 1 (A0 = Ca[0]  ).
+ *
+ * \return \c false,     .
+ */
+bool ComputeResiduals(const KineticModel& model, const double* theta,
+                      const std::vector<double>& Ca,
+                      const std::vector<double>& Tm, std::vector<double>& A,
+                      std::vector<double>& r) {
+  double p[3];
+  ToParams(model, theta, p);
+  IntegrateModel(model, p, Ca.front(), Tm, kSubSteps, A);
+  r.resize(Ca.size() - 1);
+  for (size_t i = 1; i < Ca.size(); i++) {
+    r[i - 1] = A[i] - Ca[i];
+    if (!std::isfinite(r[i - 1])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ *     : J[j][i - 1] = dA(t_i)/dtheta_j.
+ *    dA/dtheta = p * dA/dp.
+ *
+ * \return \c false,     .
+ */
+bool ComputeJacobian(const KineticModel& model, const double* theta,
+                     const std::vector<double>& Ca,
+                     const std::vector<double>& Tm, std::vector<double> J[3]) {
+  const size_t m = model.paramCount;
+  double p[3];
+  ToParams(model, theta, p);
+  std::vector<double> A;
+  std::vector<double> dA;
+  IntegrateModelJacobian(model, p, Ca.front(), Tm, kSubSteps, A, dA);
+  for (size_t j = 0; j < m; j++) {
+    const double scale = model.positive[j] ? p[j] : 1.0;
+    J[j].resize(Ca.size() - 1);
+    for (size_t i = 1; i < Ca.size(); i++) {
+      J[j][i - 1] = dA[i * (m + 1) + j] * scale;
+      if (!std::isfinite(J[j][i - 1])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+double SumSquares(const std::vector<double>& r) {
+  double s = 0.0;
+  for (size_t i = 0; i < r.size(); i++) {
+    s += r[i] * r[i];
+  }
+  return s;
+}
+
+/**
+ *   M * d = b  m <= 3    
+ *  .
+ *
+ * \return \c false   .
+ */
+bool SolveSmall(double M[3][3], double b[3], size_t m, double d[3]) {
+  for (size_t c = 0; c < m; c++) {
+    size_t piv = c;
+    for (size_t i = c + 1; i < m; i++) {
+      if (std::fabs(M[i][c]) > std::fabs(M[piv][c])) {
+        piv = i;
+      }
+    }
+    if (std::fabs(M[piv][c]) < 1e-300) {
+      return false;
+    }
+    if (piv != c) {
+      for (size_t j = 0; j < m; j++) {
+        std::swap(M[c][j], M[piv][j]);
+      }
+      std::swap(b[c], b[piv]);
+    }
+    for (size_t i = c + 1; i < m; i++) {
+      const double f = M[i][c] / M[c][c];
+      for (size_t j = c; j < m; j++) {
+        M[i][j] -= f * M[c][j];
+      }
+      b[i] -= f * b[c];
+    }
+  }
+  for (size_t c = m; c-- > 0;) {
+    double s = b[c];
+    for (size_t j = c + 1; j < m; j++) {
+      s -= M[c][j] * d[j];
+    }
+    d[c] = s / M[c][c];
+  }
+  return true;
+}
+
+///  AIC  BIC  SSE  N   p .
+void FillCriteria(ModelFit& fit, size_t N, size_t p) {
+  //    SSE = 0;    
+  //       
+  const double mse =
+      std::max(fit.sse / static_cast<double>(N),
+               std::numeric_limits<double>::min());
+  const double logL = static_cast<double>(N) * std::log(mse);
+  fit.aic = logL + 2.0 * static_cast<double>(p);
+  fit.bic = logL + static_cast<double>(p) * std::log(static_cast<double>(N));
+}
+
+}  // namespace
+
+const std::vector<KineticModel>& ModelRegistry() {
+  static const std::vector<KineticModel> models = {
+      {"power", L" ", 2, {"k", "n", nullptr},
+       {true, false, false}, PowerLawRate<double>,
+       PowerLawRate<ModelDual>, PowerLawGuess},
+      {"first", L"  (A -> I -> P)", 1, {"k", nullptr, nullptr},
+       {true, false, false}, FirstOrderRate<double>,
+       FirstOrderRate<ModelDual>, FirstOrderGuess},
+      {"second", L" ", 1, {"k", nullptr, nullptr},
+       {true, false, false}, SecondOrderRate<double>,
+       SecondOrderRate<ModelDual>, SecondOrderGuess},
+      {"reversible", L"  ", 2, {"k1", "k2", nullptr},
+       {true, true, false}, ReversibleRate<double>,
+       ReversibleRate<ModelDual>, ReversibleGuess},
+      {"autocatalytic", L"", 2, {"k", "P0", nullptr},
+       {true, true, false}, AutocatalyticRate<double>,
+       AutocatalyticRate<ModelDual>, AutocatalyticGuess},
+      {"michaelis", L"", 2, {"Vmax", "Km", nullptr},
+       {true, true, false}, MichaelisMentenRate<double>,
+       MichaelisMentenRate<ModelDual>, MichaelisMentenGuess},
+  };
+  return models;
+}
+
+const KineticModel& FindModel(const std::string& id) {
+  for (const KineticModel& model : ModelRegistry()) {
+    if (id == model.id) {
+      return model;
+    }
+  }
+  throw std::runtime_error("  : " + id);
+}
+
+void IntegrateModel(const KineticModel& model, const double* p, double A0,
+                    const std::vector<double>& t, int subSteps,
+                    std::vector<double>& A) {
+  Integrate(model.rate, p, A0, t, subSteps, A);
+}
+
+void IntegrateModelJacobian(const KineticModel& model, const double* p,
+                            double A0, const std::vector<double>& t,
+                            int subSteps, std::vector<double>& A,
+                            std::vector<double>& J) {
+  const size_t m = model.paramCount;
+  ModelDual pd[3];
+  for (size_t j = 0; j < m; j++) {
+    pd[j] = ModelDual::Variable(p[j], j);
+  }
+  std::vector<ModelDual> Ad;
+  Integrate(model.rateDual, pd, ModelDual::Variable(A0, m), t, subSteps, Ad);
+  A.resize(t.size());
+  J.resize(t.size() * (m + 1));
+  for (size_t i = 0; i < t.size(); i++) {
+    A[i] = Ad[i].v;
+    for (size_t j = 0; j <= m; j++) {
+      J[i * (m + 1) + j] = Ad[i].d[j];
+    }
+  }
+}
+
+ModelFit FitModel(size_t modelIndex, const std::vector<double>& Ca,
+                  const std::vector<double>& Tm) {
+  const KineticModel& model = ModelRegistry().at(modelIndex);
+  const size_t m = model.paramCount;
+  const size_t N = Ca.size() - 1;
+
+  ModelFit fit;
+  fit.model = modelIndex;
+  if (N <= m) {
+    fit.error = "   ";
+    return fit;
+  }
+
+  double p0[3];
+  model.guess(Ca.front(), ApparentFirstOrder(Ca, Tm), p0);
+  double theta[3] = {};
+  for (size_t j = 0; j < m; j++) {
+    theta[j] = model.positive[j] ? std::log(p0[j]) : p0[j];
+  }
+
+  std::vector<double> A;
+  std::vector<double> r;
+  if (!ComputeResiduals(model, theta, Ca, Tm, A, r)) {
+    fit.error = "    ";
+    return fit;
+  }
+  double sse = SumSquares(r);
+
+  //        
+  std::vector<double> J[3];
+  std::vector<double> rTrial;
+  double lambda = 1e-3;
+  int iter = 0;
+  for (; iter < kMaxIterations; iter++) {
+    if (!ComputeJacobian(model, theta, Ca, Tm, J)) {
+      break;
+    }
+
+    double H[3][3] = {};
+    double g[3] = {};
+    for (size_t a = 0; a < m; a++) {
+      for (size_t i = 0; i < N; i++) {
+        g[a] += J[a][i] * r[i];
+      }
+      for (size_t b = 0; b <= a; b++) {
+        double s = 0.0;
+        for (size_t i = 0; i < N; i++) {
+          s += J[a][i] * J[b][i];
+        }
+        H[a][b] = s;
+        H[b][a] = s;
+      }
+    }
+
+    bool improved = false;
+    double newSse = sse;
+    while (lambda < kMaxLambda) {
+      double M[3][3];
+      double b[3];
+      for (size_t a = 0; a < m; a++) {
+        for (size_t c = 0; c < m; c++) {
+          M[a][c] = H[a][c];
+        }
+        M[a][a] += lambda * std::max(H[a][a], 1e-12);
+        b[a] = -g[a];
+      }
+      double d[3] = {};
+      double trial[3] = {theta[0], theta[1], theta[2]};
+      if (SolveSmall(M, b, m, d)) {
+        for (size_t j = 0; j < m; j++) {
+          trial[j] += d[j];
+        }
+        if (ComputeResiduals(model, trial, Ca, Tm, A, rTrial)) {
+          newSse = SumSquares(rTrial);
+          if (newSse < sse) {
+            std::copy(trial, trial + m, theta);
+            r.swap(rTrial);
+            lambda = std::max(lambda / 3.0, 1e-12);
+            improved = true;
+            break;
+          }
+        }
+      }
+      lambda *= 4.0;
+    }
+    if (!improved) {
+      break;
+    }
+    const double drop = sse - newSse;
+    sse = newSse;
+    if (drop <= kRelTolerance * sse) {
+      iter++;
+      break;
+    }
+  }
+
+  fit.params.resize(m);
+  ToParams(model, theta, fit.params.data());
+  fit.sse = sse;
+  fit.iterations = iter;
+  bool finite = std::isfinite(sse);
+  for (size_t j = 0; j < m; j++) {
+    finite = finite && std::isfinite(fit.params[j]);
+  }
+  if (!finite) {
+    fit.error = " ";
+    return fit;
+  }
+  fit.ok = true;
+  FillCriteria(fit, N, m);
+  return fit;
+}
+
+std::vector<ModelFit> ScreenModels(const std::vector<double>& Ca,
+                                   const std::vector<double>& Tm,
+                                   ModelCriterion criterion) {
+  TRACE_SCOPE("ScreenModels");
+  if (Ca.size() != Tm.size()) {
+    throw std::runtime_error(" Ca  Tm  !");
+  }
+  ChemCalculation::ValidateInput(Ca, Tm, 0.0, 0.0);
+  if (Ca.size() < 3) {
+    throw std::runtime_error("      3 !");
+  }
+  if (!(Ca.front() > 0.0)) {
+    throw std::runtime_error(
+        "  Ca   !");
+  }
+
+  const std::vector<KineticModel>& models = ModelRegistry();
+  std::vector<ModelFit> fits(models.size());
+  ParallelFor(models.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      fits[i] = FitModel(i, Ca, Tm);
+    }
+  });
+
+  auto value = [criterion](const ModelFit& f) {
+    return criterion == ModelCriterion::Aic ? f.aic : f.bic;
+  };
+  //  :      
+  std::stable_sort(fits.begin(), fits.end(),
+                   [&](const ModelFit& a, const ModelFit& b) {
+                     if (a.ok != b.ok) {
+                       return a.ok;
+                     }
+                     return a.ok && value(a) < value(b);
+                   });
+
+  //  : exp(-delta / 2),    
+  if (!fits.empty() && fits.front().ok) {
+    const double best = value(fits.front());
+    double total = 0.0;
+    for (size_t i = 0; i < fits.size() && fits[i].ok; i++) {
+      fits[i].weight = std::exp(-0.5 * (value(fits[i]) - best));
+      total += fits[i].weight;
+    }
+    for (size_t i = 0; i < fits.size() && fits[i].ok; i++) {
+      fits[i].weight /= total;
+    }
+  }
+  return fits;
+}
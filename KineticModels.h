@@ -0,0 +1,155 @@
+#ifndef KINETICMODELS_H
+#define KINETICMODELS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Dual.h"
+
+/**
+ * \file KineticModels.h
+ * \brief         AIC/BIC.
+ *
+ *      A    
+ *  : dA/dt = -W(A, A0; p).  
+ *   4-   A0 = Ca[0],  
+ *       A(t) 
+ *  .      :
+ *   \c ModelDual     A(t)  
+ *     A0,     .
+ * \c ScreenModels    
+ *       .
+ *
+ *    A,   
+ * A -> I -> P  A      ( 
+ *   Ca  )       .
+ */
+
+///        ( )  A0.
+using ModelDual = Dual<4>;
+
+/**
+ * \brief   .
+ */
+struct KineticModel {
+  const char* id;              ///<   ().
+  const wchar_t* name;         ///<   .
+  size_t paramCount;           ///<   (  3).
+  const char* paramNames[3];   ///<  .
+  bool positive[3];            ///<   .
+  ///   A: W(A, A0, p).
+  double (*rate)(const double& A, const double& A0, const double* p);
+  ///      .
+  ModelDual (*rateDual)(const ModelDual& A, const ModelDual& A0,
+                        const ModelDual* p);
+  ///    A0      k1.
+  void (*guess)(double A0, double k1, double* p);
+};
+
+/**
+ * \brief   .
+ */
+enum class ModelCriterion {
+  Aic,  ///<   .
+  Bic,  ///<   .
+};
+
+/**
+ * \brief    .
+ */
+struct ModelFit {
+  size_t model = 0;            ///<   \c ModelRegistry.
+  bool ok = false;             ///<     .
+  std::string error;           ///<   ( \c ok == false).
+  std::vector<double> params;  ///<  .
+  double sse = 0.0;            ///<   .
+  double aic = 0.0;            ///< AIC = N ln(SSE/N) + 2p.
+  double bic = 0.0;            ///< BIC = N ln(SSE/N) + p ln N.
+  double weight = 0.0;         ///<   ( )  .
+  int iterations = 0;          ///<   .
+};
+
+/**
+ * \brief  .
+ *
+ * \return     ( ).
+ */
+const std::vector<KineticModel>& ModelRegistry();
+
+/**
+ * \brief     .
+ *
+ * \param id   (\c KineticModel::id).
+ * \return .
+ * \throw std::runtime_error      .
+ */
+const KineticModel& FindModel(const std::string& id);
+
+/**
+ * \brief     A    .
+ *
+ * \param model .
+ * \param p  .
+ * \param A0   (  \a t[0]).
+ * \param t   .
+ * \param subSteps   4     .
+ * \param A :  A(t).
+ */
+void IntegrateModel(const KineticModel& model, const double* p, double A0,
+                    const std::vector<double>& t, int subSteps,
+                    std::vector<double>& A);
+
+/**
+ * \brief      A(t)    A0.
+ *
+ *      ;   
+ * \c IntegrateModel.
+ *
+ * \param model .
+ * \param p  .
+ * \param A0   (  \a t[0]).
+ * \param t   .
+ * \param subSteps   4     .
+ * \param A :  A(t).
+ * \param J :     t.size()  
+ *        (paramCount + 1) : dA/dp[0..paramCount-1],  dA/dA0.
+ */
+void IntegrateModelJacobian(const KineticModel& model, const double* p,
+                            double A0, const std::vector<double>& t,
+                            int subSteps, std::vector<double>& A,
+                            std::vector<double>& J);
+
+/**
+ * \brief    .
+ *
+ * \param modelIndex    .
+ * \param Ca    A.
+ * \param Tm   ( ).
+ * \return  ;   \c ok == false.
+ *
+ *     \c IntegrateModelJacobian,  
+ *       paramCount + 1
+ *   .
+ */
+ModelFit FitModel(size_t modelIndex, const std::vector<double>& Ca,
+                  const std::vector<double>& Tm);
+
+/**
+ * \brief        .
+ *
+ * ,     ,    , 
+ *      .
+ *
+ * \param Ca    A.
+ * \param Tm   ( ).
+ * \param criterion  .
+ * \return ,    .
+ * \throw std::runtime_error    (  ).
+ */
+std::vector<ModelFit> ScreenModels(const std::vector<double>& Ca,
+                                   const std::vector<double>& Tm,
+                                   ModelCriterion criterion =
+                                       ModelCriterion::Aic);
+
+#endif  // KINETICMODELS_H
@@ -0,0 +1,155 @@
+#ifndef LANEMATH_H
+#define LANEMATH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * \file LaneMath.h
+ * \brief        .
+ *
+ *  fdlibm (e_log.c, e_exp.c),  ,     
+ *     ,     
+ * SIMD- (  SSE2);    1 ulp.
+ *
+ *     ,    ?:.
+ *    ,      ?:, GCC (
+ * -fno-trapping-math)        
+ *       ;    double
+ *  64-   SSE4  .   
+ *      .
+ */
+
+///  ln(1 + f)  exp(r)  fdlibm.
+struct LaneMathConst {
+  static constexpr double LN2_HI = 6.93147180369123816490e-01;
+  static constexpr double LN2_LO = 1.90821492927058770002e-10;
+  static constexpr double INV_LN2 = 1.44269504088896338700e+00;
+  static constexpr double LG1 = 6.666666666666735130e-01;
+  static constexpr double LG2 = 3.999999999940941908e-01;
+  static constexpr double LG3 = 2.857142874366239149e-01;
+  static constexpr double LG4 = 2.222219843214978396e-01;
+  static constexpr double LG5 = 1.818357216161805012e-01;
+  static constexpr double LG6 = 1.531383769920937332e-01;
+  static constexpr double LG7 = 1.479819860511658591e-01;
+  static constexpr double P1 = 1.66666666666666019037e-01;
+  static constexpr double P2 = -2.77777777770155933842e-03;
+  static constexpr double P3 = 6.61375632143793436117e-05;
+  static constexpr double P4 = -1.65339022054652515390e-06;
+  static constexpr double P5 = 4.13813679705723846039e-08;
+  ///   sqrt(2).
+  static constexpr uint64_t SQRT2_MANT = 0x6A09E667F3BCDull;
+  ///  exp  : e^710   double.
+  static constexpr double EXP_HI = 710.0;
+  ///  exp  : e^-1000   .
+  static constexpr double EXP_LO = -1000.0;
+  /// 1.5 * 2^52:       .
+  static constexpr double ROUND_MAGIC = 6755399441055744.0;
+};
+
+///  \a a ,  \a mask  ,   \a b.
+inline double LaneBlend(uint64_t mask, double a, double b) {
+  uint64_t aBits, bBits;
+  std::memcpy(&aBits, &a, sizeof(aBits));
+  std::memcpy(&bBits, &b, sizeof(bBits));
+  const uint64_t bits = (aBits & mask) | (bBits & ~mask);
+  double r;
+  std::memcpy(&r, &bits, sizeof(r));
+  return r;
+}
+
+/**
+ * \brief   L   .
+ *
+ *   NaN   ; ,  
+ *        
+ *   .
+ *
+ * \param in .
+ * \param out  (   \a in).
+ * \param count  .
+ */
+inline void LaneLog(const double* in, double* out, size_t count) {
+  using C = LaneMathConst;
+  for (size_t l = 0; l < count; l++) {
+    const double x = in[l];
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    //    [sqrt(2)/2, sqrt(2)):   
+    // sqrt(2)         
+    const uint64_t mant = bits & 0x000FFFFFFFFFFFFFull;
+    const uint64_t high = (C::SQRT2_MANT - mant) >> 63;
+    //    double  2^52 + e,  
+    // ,    AVX2
+    const uint64_t expBits = ((bits >> 52) + high) | 0x4330000000000000ull;
+    double e;
+    std::memcpy(&e, &expBits, sizeof(e));
+    e -= 4503599627370496.0 + 1023.0;
+    const uint64_t mantBits = mant | ((0x3FFull - high) << 52);
+    double m;
+    std::memcpy(&m, &mantBits, sizeof(m));
+
+    const double f = m - 1.0;
+    const double s = f / (2.0 + f);
+    const double z = s * s;
+    const double w = z * z;
+    const double t1 = w * (C::LG2 + w * (C::LG4 + w * C::LG6));
+    const double t2 = z * (C::LG1 + w * (C::LG3 + w * (C::LG5 + w * C::LG7)));
+    const double R = t2 + t1;
+    const double hfsq = 0.5 * f * f;
+    const double r =
+        e * C::LN2_HI - ((hfsq - (s * (hfsq + R) + e * C::LN2_LO)) - f);
+    //  0x7FF (, NaN): 0x7FF + 1   11
+    const uint64_t special = (((bits >> 52) & 0x7FFull) + 1) >> 11;
+    out[l] = LaneBlend(0 - special, x, r);
+  }
+}
+
+/**
+ * \brief  L .
+ *
+ *   ,    
+ *   ,   \c std::exp; NaN .
+ *
+ * \param in .
+ * \param out  (   \a in).
+ * \param count  .
+ */
+inline void LaneExp(const double* in, double* out, size_t count) {
+  using C = LaneMathConst;
+  //     ( out):    GCC
+  //      ,   .
+  // NaN   std::max  std::min (   )
+  for (size_t l = 0; l < count; l++) {
+    out[l] = std::min(std::max(in[l], C::EXP_LO), C::EXP_HI);
+  }
+  for (size_t l = 0; l < count; l++) {
+    const double xc = out[l];
+    // x = k * ln2 + r, |r| <= ln2 / 2; k    
+    const double shifted = xc * C::INV_LN2 + C::ROUND_MAGIC;
+    const double k = shifted - C::ROUND_MAGIC;
+    const double hi = xc - k * C::LN2_HI;
+    const double lo = k * C::LN2_LO;
+    const double r = hi - lo;
+    const double t = r * r;
+    const double c =
+        r - t * (C::P1 + t * (C::P2 + t * (C::P3 + t * (C::P4 + t * C::P5))));
+    const double y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+    // 2^k = 2^k1 * 2^k2,      k 
+    //  ;    
+    //   . k     shifted
+    uint64_t kBits;
+    std::memcpy(&kBits, &shifted, sizeof(kBits));
+    const uint64_t biased = kBits - 0x4338000000000000ull + 2 * 1023;
+    const uint64_t scale1Bits = (biased >> 1) << 52;
+    const uint64_t scale2Bits = (biased - (biased >> 1)) << 52;
+    double scale1, scale2;
+    std::memcpy(&scale1, &scale1Bits, sizeof(scale1));
+    std::memcpy(&scale2, &scale2Bits, sizeof(scale2));
+    out[l] = y * scale1 * scale2;
+  }
+}
+
+#endif  // LANEMATH_H
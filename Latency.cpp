@@ -0,0 +1,54 @@
+/**
+ * \file Latency.cpp
+ * \brief      .
+ */
+
+#include "Latency.h"
+
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto& b : m_buckets) b.store(0);
+}
+
+void LatencyHistogram::Record(double us) {
+  int b = (us <= 1.0) ? 0 : static_cast<int>(4.0 * std::log2(us)) + 1;
+  if (b >= LATENCY_BUCKETS) b = LATENCY_BUCKETS - 1;
+  m_buckets[b].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  const uint64_t ns = static_cast<uint64_t>(us * 1000.0);
+  m_sumNs.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t prev = m_maxNs.load(std::memory_order_relaxed);
+  while (ns > prev && !m_maxNs.compare_exchange_weak(prev, ns)) {
+  }
+}
+
+LatencyStats LatencyHistogram::Snapshot() const {
+  LatencyStats stats;
+  uint64_t counts[LATENCY_BUCKETS];
+  uint64_t total = 0;
+  for (int b = 0; b < LATENCY_BUCKETS; b++) {
+    counts[b] = m_buckets[b].load(std::memory_order_relaxed);
+    total += counts[b];
+  }
+  if (total == 0) return stats;
+  stats.count = total;
+  stats.maxUs = m_maxNs.load() / 1000.0;
+  stats.meanUs = m_sumNs.load() / 1000.0 / m_count.load();
+  //     ,   
+  const auto quantile = [&](double q) {
+    const uint64_t target =
+        std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total)));
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+      seen += counts[b];
+      if (seen >= target) return std::min(std::exp2(b / 4.0), stats.maxUs);
+    }
+    return stats.maxUs;
+  };
+  stats.p50Us = quantile(0.50);
+  stats.p90Us = quantile(0.90);
+  stats.p99Us = quantile(0.99);
+  return stats;
+}
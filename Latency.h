@@ -0,0 +1,50 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * \file Latency.h
+ * \brief       .
+ */
+
+///   : 2^(i/4) ,    70 .
+constexpr int LATENCY_BUCKETS = 128;
+
+/**
+ * \brief   ().
+ *
+ *       2^(1/4),  
+ *     19%.
+ */
+struct LatencyStats {
+  uint64_t count = 0;  ///<  .
+  double meanUs = 0.0;
+  double p50Us = 0.0;
+  double p90Us = 0.0;
+  double p99Us = 0.0;
+  double maxUs = 0.0;
+};
+
+/**
+ * \brief  :      .
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  ///   \a us .
+  void Record(double us);
+
+  ///    .
+  LatencyStats Snapshot() const;
+
+ private:
+  std::atomic<uint64_t> m_buckets[LATENCY_BUCKETS];
+  std::atomic<uint64_t> m_count{0};
+  std::atomic<uint64_t> m_sumNs{0};
+  std::atomic<uint64_t> m_maxNs{0};
+};
+
+#endif  // LATENCY_H
@@ -0,0 +1,493 @@
+/**
+ * \file LiveAcquisition.cpp
+ * \brief    ,     .
+ */
+
+#include "LiveAcquisition.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "DataImport.h"
+#include "SpscRing.h"
+#include "StreamingFit.h"
+#include "Trace.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+///   .
+constexpr size_t kReadBlock = 64u << 10;
+///      .
+constexpr size_t kPushBatch = 256;
+///       .
+constexpr size_t kFitBatch = 4096;
+///         .
+constexpr int kSpinRounds = 64;
+///      (   1 ).
+constexpr auto kIdleSleep = std::chrono::microseconds(100);
+///      , .
+constexpr int kPollMs = 50;
+
+///      .
+struct LiveSample {
+  double t;
+  double ca;
+  int64_t arrivalNs;
+};
+
+///  .
+struct ChartPoint {
+  double t;
+  double ca;
+};
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+///  : , ';', ; ','    
+///  (   ).
+bool IsSeparator(char c, bool comma) {
+  return c == '\t' || c == ';' || c == ' ' || (comma && c == ',');
+}
+
+/**
+ *   "t Ca".  false  ,   
+ * ; \a empty      ('#').
+ */
+bool ParseLine(const char* p, const char* end, double& t, double& ca,
+               bool& empty) {
+  while (p < end && IsBlank(*p)) p++;
+  while (end > p && IsBlank(end[-1])) end--;
+  empty = (p == end || *p == '#');
+  if (empty) return false;
+  bool comma = true;
+  for (const char* q = p; q < end; q++) {
+    if (IsSeparator(*q, false)) {
+      comma = false;
+      break;
+    }
+  }
+  const char* first = p;
+  while (p < end && !IsSeparator(*p, comma)) p++;
+  const char* firstEnd = p;
+  while (p < end && IsSeparator(*p, comma)) p++;
+  const char* second = p;
+  while (p < end && !IsSeparator(*p, comma)) p++;
+  return ParseNumber(first, firstEnd, t) && ParseNumber(second, p, ca);
+}
+
+#if defined(_WIN32)
+///      .
+class Source {
+ public:
+  ~Source() { Close(); }
+
+  void Open(const std::string& path) {
+    if (path == "-") {
+      throw std::runtime_error(
+          " Windows      !");
+    }
+    const int len = MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1,
+                                        nullptr, 0);
+    std::wstring wide(len > 0 ? len : 1, L'\0');
+    MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, &wide[0], len);
+    m_pipe = CreateFileW(wide.c_str(), GENERIC_READ, 0, nullptr,
+                         OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+    if (m_pipe == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("    !");
+    }
+    m_readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    m_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  }
+
+  /// > 0   , 0   , -1  , -2  .
+  long Read(char* buffer, size_t size) {
+    OVERLAPPED ov = {};
+    ov.hEvent = m_readEvent;
+    ResetEvent(m_readEvent);
+    DWORD got = 0;
+    const DWORD want = static_cast<DWORD>(size < kReadBlock ? size
+                                                            : kReadBlock);
+    if (!ReadFile(m_pipe, buffer, want, &got, &ov)) {
+      const DWORD err = GetLastError();
+      if (err == ERROR_BROKEN_PIPE) return 0;
+      if (err != ERROR_IO_PENDING) return -2;
+      HANDLE events[2] = {m_readEvent, m_stopEvent};
+      if (WaitForMultipleObjects(2, events, FALSE, INFINITE) !=
+          WAIT_OBJECT_0) {
+        CancelIo(m_pipe);
+        GetOverlappedResult(m_pipe, &ov, &got, TRUE);
+        return -1;
+      }
+      if (!GetOverlappedResult(m_pipe, &ov, &got, FALSE)) {
+        return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -2;
+      }
+    }
+    //       (  ERROR_BROKEN_PIPE)
+    return got > 0 ? static_cast<long>(got) : -1;
+  }
+
+  ///    \c Read (  ).
+  void Interrupt() {
+    if (m_stopEvent != nullptr) SetEvent(m_stopEvent);
+  }
+
+  void Close() {
+    if (m_pipe != INVALID_HANDLE_VALUE) CloseHandle(m_pipe);
+    if (m_readEvent != nullptr) CloseHandle(m_readEvent);
+    if (m_stopEvent != nullptr) CloseHandle(m_stopEvent);
+    m_pipe = INVALID_HANDLE_VALUE;
+    m_readEvent = nullptr;
+    m_stopEvent = nullptr;
+  }
+
+ private:
+  HANDLE m_pipe = INVALID_HANDLE_VALUE;
+  HANDLE m_readEvent = nullptr;
+  HANDLE m_stopEvent = nullptr;
+};
+#else
+/// ,  Unix   ;   poll.
+class Source {
+ public:
+  ~Source() { Close(); }
+
+  void Open(const std::string& path) {
+    if (path == "-") {
+      m_fd = STDIN_FILENO;
+      m_owned = false;
+      return;
+    }
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+      throw std::runtime_error("    !");
+    }
+    if (S_ISSOCK(st.st_mode)) {
+      sockaddr_un addr = {};
+      addr.sun_family = AF_UNIX;
+      if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("    !");
+      }
+      std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+      m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (m_fd >= 0 && connect(m_fd, reinterpret_cast<sockaddr*>(&addr),
+                               sizeof(addr)) != 0) {
+        close(m_fd);
+        m_fd = -1;
+      }
+    } else {
+      //     ; poll   
+      m_fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+    }
+    if (m_fd < 0) {
+      throw std::runtime_error("    !");
+    }
+    m_owned = true;
+  }
+
+  /// > 0   , 0   , -1   , -2  .
+  long Read(char* buffer, size_t size) {
+    pollfd pfd = {m_fd, POLLIN, 0};
+    const int ready = poll(&pfd, 1, kPollMs);
+    if (ready == 0) return -1;
+    if (ready < 0) return errno == EINTR ? -1 : -2;
+    const ssize_t got = read(m_fd, buffer, size);
+    if (got < 0) return (errno == EAGAIN || errno == EINTR) ? -1 : -2;
+    return static_cast<long>(got);
+  }
+
+  ///   \c Read  \c kPollMs:   
+  ///  .
+  void Interrupt() {}
+
+  void Close() {
+    if (m_owned && m_fd >= 0) close(m_fd);
+    m_fd = -1;
+    m_owned = false;
+  }
+
+ private:
+  int m_fd = -1;
+  bool m_owned = false;
+};
+#endif
+
+}  // namespace
+
+struct LiveAcquisition::Impl {
+  Source source;
+  std::unique_ptr<SpscRing<LiveSample>> samples;
+  std::unique_ptr<SpscRing<ChartPoint>> chart;
+  std::thread reader;
+  std::thread fitter;
+  std::atomic<bool> stop{false};
+  std::atomic<bool> readerDone{false};
+  bool started = false;
+
+  // :   ,     
+  std::atomic<uint64_t> version{0};
+  std::atomic<int> status{static_cast<int>(CalcStatus::TooFewPoints)};
+  std::atomic<double> n{0.0};
+  std::atomic<double> k{0.0};
+  std::atomic<double> r{0.0};
+  std::atomic<double> lastT{0.0};
+  std::atomic<double> lastCa{0.0};
+  std::atomic<uint64_t> accepted{0};
+
+  std::atomic<uint64_t> rejected{0};
+  std::atomic<uint64_t> badLines{0};
+  std::atomic<uint64_t> ringStalls{0};
+  std::atomic<uint64_t> chartDropped{0};
+  LatencyHistogram latency;
+  mutable std::mutex errorMutex;
+  std::string error;
+
+  void SetError(const char* text) {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    error = text;
+  }
+
+  ///    ;    .
+  bool PushSamples(const LiveSample* items, size_t count) {
+    size_t done = samples->Push(items, count);
+    while (done < count) {
+      if (stop.load(std::memory_order_relaxed)) return false;
+      ringStalls.fetch_add(1, std::memory_order_relaxed);
+      std::this_thread::yield();
+      done += samples->Push(items + done, count - done);
+    }
+    return true;
+  }
+
+  void ReaderLoop() {
+    //         
+    std::vector<char> buffer(2 * kReadBlock + 1);
+    const size_t capacity = 2 * kReadBlock;
+    LiveSample batch[kPushBatch];
+    size_t have = 0;
+    bool eof = false;
+    while (!eof && !stop.load(std::memory_order_relaxed)) {
+      if (have == capacity) {
+        //   :  
+        badLines.fetch_add(1, std::memory_order_relaxed);
+        have = 0;
+      }
+      const long got = source.Read(buffer.data() + have, capacity - have);
+      if (got == -1) continue;
+      if (got < -1) SetError("   !");
+      eof = got <= 0;
+      const int64_t arrival = NowNs();
+      if (got > 0) have += static_cast<size_t>(got);
+      if (eof && have > 0 && buffer[have - 1] != '\n') {
+        buffer[have++] = '\n';  //     
+      }
+
+      size_t start = 0;
+      size_t count = 0;
+      const char* data = buffer.data();
+      while (start < have) {
+        const void* nl = std::memchr(data + start, '\n', have - start);
+        if (nl == nullptr) break;
+        const size_t end = static_cast<const char*>(nl) - data;
+        LiveSample& s = batch[count];
+        bool empty;
+        if (ParseLine(data + start, data + end, s.t, s.ca, empty)) {
+          s.arrivalNs = arrival;
+          if (++count == kPushBatch) {
+            if (!PushSamples(batch, count)) return;
+            count = 0;
+          }
+        } else if (!empty) {
+          badLines.fetch_add(1, std::memory_order_relaxed);
+        }
+        start = end + 1;
+      }
+      if (count > 0 && !PushSamples(batch, count)) return;
+      std::memmove(buffer.data(), data + start, have - start);
+      have -= start;
+    }
+  }
+
+  void Publish(const StreamingFit& fit, double t, double ca) {
+    const CalcOutcome outcome = fit.Result();
+    const uint64_t v = version.load(std::memory_order_relaxed);
+    version.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    status.store(static_cast<int>(outcome.status), std::memory_order_relaxed);
+    n.store(outcome.value.n, std::memory_order_relaxed);
+    k.store(outcome.value.k, std::memory_order_relaxed);
+    r.store(outcome.value.r, std::memory_order_relaxed);
+    lastT.store(t, std::memory_order_relaxed);
+    lastCa.store(ca, std::memory_order_relaxed);
+    accepted.store(fit.Count(), std::memory_order_relaxed);
+    version.store(v + 2, std::memory_order_release);
+  }
+
+  void FitterLoop() {
+    StreamingFit fit;
+    std::vector<LiveSample> batch(kFitBatch);
+    std::vector<ChartPoint> points(kFitBatch);
+    double t = 0.0;
+    double ca = 0.0;
+    int idle = 0;
+    while (true) {
+      //    :       
+      const bool done = readerDone.load(std::memory_order_acquire);
+      const size_t got = samples->Pop(batch.data(), kFitBatch);
+      if (got == 0) {
+        if (done || stop.load(std::memory_order_relaxed)) break;
+        if (++idle < kSpinRounds) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(kIdleSleep);
+        }
+        continue;
+      }
+      idle = 0;
+      size_t kept = 0;
+      for (size_t i = 0; i < got; i++) {
+        const LiveSample& s = batch[i];
+        if (s.ca < 0.0 || (fit.Count() > 0 && !(s.t > t))) {
+          rejected.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        fit.Push(s.t, s.ca);
+        t = s.t;
+        ca = s.ca;
+        points[kept++] = {s.t, s.ca};
+      }
+      if (kept == 0) continue;
+      Publish(fit, t, ca);
+      latency.Record((NowNs() - batch[0].arrivalNs) / 1000.0);
+      const size_t shown = chart->Push(points.data(), kept);
+      if (shown < kept) {
+        chartDropped.fetch_add(kept - shown, std::memory_order_relaxed);
+      }
+    }
+  }
+};
+
+LiveAcquisition::LiveAcquisition() : m_impl(new Impl) {}
+
+LiveAcquisition::~LiveAcquisition() { Stop(); }
+
+void LiveAcquisition::Start(const std::string& source) {
+  Impl& impl = *m_impl;
+  if (impl.started) throw std::runtime_error("   !");
+  impl.source.Open(source);
+  impl.samples.reset(new SpscRing<LiveSample>(LIVE_RING_CAPACITY));
+  impl.chart.reset(new SpscRing<ChartPoint>(LIVE_CHART_CAPACITY));
+  impl.stop = false;
+  impl.readerDone = false;
+  impl.version = 0;
+  impl.status = static_cast<int>(CalcStatus::TooFewPoints);
+  impl.accepted = 0;
+  impl.rejected = 0;
+  impl.badLines = 0;
+  impl.ringStalls = 0;
+  impl.chartDropped = 0;
+  impl.error.clear();
+  impl.started = true;
+  impl.fitter = std::thread([&impl] { impl.FitterLoop(); });
+  impl.reader = std::thread([&impl] {
+    impl.ReaderLoop();
+    impl.readerDone.store(true, std::memory_order_release);
+  });
+}
+
+void LiveAcquisition::Stop() {
+  Impl& impl = *m_impl;
+  if (!impl.started) return;
+  impl.stop = true;
+  impl.source.Interrupt();
+  impl.reader.join();
+  impl.fitter.join();
+  impl.source.Close();
+  impl.started = false;
+}
+
+bool LiveAcquisition::Running() const {
+  return m_impl->started && !m_impl->readerDone.load();
+}
+
+LiveEstimate LiveAcquisition::Estimate() const {
+  const Impl& impl = *m_impl;
+  LiveEstimate e;
+  while (true) {
+    const uint64_t v1 = impl.version.load(std::memory_order_acquire);
+    if (v1 % 2 != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    e.fit.status = static_cast<CalcStatus>(
+        impl.status.load(std::memory_order_relaxed));
+    e.fit.index = -1;
+    e.fit.value = {impl.n.load(std::memory_order_relaxed),
+                   impl.k.load(std::memory_order_relaxed),
+                   impl.r.load(std::memory_order_relaxed), 0.0};
+    e.lastT = impl.lastT.load(std::memory_order_relaxed);
+    e.lastCa = impl.lastCa.load(std::memory_order_relaxed);
+    e.samples = impl.accepted.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (impl.version.load(std::memory_order_relaxed) == v1) {
+      e.version = v1 / 2;
+      return e;
+    }
+  }
+}
+
+LiveStats LiveAcquisition::Stats() const {
+  const Impl& impl = *m_impl;
+  LiveStats stats;
+  stats.samples = impl.accepted.load();
+  stats.rejected = impl.rejected.load();
+  stats.badLines = impl.badLines.load();
+  stats.ringStalls = impl.ringStalls.load();
+  stats.chartDropped = impl.chartDropped.load();
+  stats.finished = impl.readerDone.load();
+  stats.latency = impl.latency.Snapshot();
+  std::lock_guard<std::mutex> lock(impl.errorMutex);
+  stats.error = impl.error;
+  return stats;
+}
+
+size_t LiveAcquisition::DrainChart(std::vector<double>& Tm,
+                                   std::vector<double>& Ca) {
+  Impl& impl = *m_impl;
+  if (!impl.chart) return 0;
+  TRACE_SCOPE("LiveAcquisition::DrainChart");
+  ChartPoint points[kPushBatch];
+  size_t total = 0;
+  size_t got;
+  while ((got = impl.chart->Pop(points, kPushBatch)) > 0) {
+    for (size_t i = 0; i < got; i++) {
+      Tm.push_back(points[i].t);
+      Ca.push_back(points[i].ca);
+    }
+    total += got;
+  }
+  return total;
+}
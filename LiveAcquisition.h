@@ -0,0 +1,112 @@
+#ifndef LIVEACQUISITION_H
+#define LIVEACQUISITION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChemCalculation.h"
+#include "Latency.h"
+
+/**
+ * \file LiveAcquisition.h
+ * \brief        n, k.
+ *
+ *      "t Ca" (: , ,
+ * ';'  ',';   ):  (FIFO),  Unix
+ *  "-" ( );  Windows   
+ * (\\\\.\\pipe\\). ,    , .
+ *
+ *          
+ * \c SpscRing;    \c StreamingFit  O(1)   
+ *      (seqlock).     
+ * ,   .    
+ *    ,   .
+ *
+ *          , 
+ *     (\c LiveStats::latency,   
+ *     ).
+ *
+ *       
+ * (\c DrainChart),     ; 
+ *       .
+ */
+
+///        .
+constexpr size_t LIVE_RING_CAPACITY = 1u << 16;
+///    .
+constexpr size_t LIVE_CHART_CAPACITY = 1u << 18;
+
+/**
+ * \brief   ( ).
+ */
+struct LiveEstimate {
+  CalcOutcome fit;       ///< n, k, r (disp = 0)   .
+  uint64_t samples = 0;  ///<   .
+  uint64_t version = 0;  ///<   (   ).
+  double lastT = 0.0;    ///<   .
+  double lastCa = 0.0;   ///<   .
+};
+
+/**
+ * \brief  .
+ */
+struct LiveStats {
+  uint64_t samples = 0;       ///<  .
+  uint64_t rejected = 0;      ///<  (Ca < 0  t  ).
+  uint64_t badLines = 0;      ///< ,    .
+  uint64_t ringStalls = 0;    ///<     .
+  uint64_t chartDropped = 0;  ///< ,   .
+  bool finished = false;      ///<  .
+  std::string error;          ///<     ( ).
+  LatencyStats latency;       ///<  -.
+};
+
+/**
+ * \brief       .
+ */
+class LiveAcquisition {
+ public:
+  LiveAcquisition();
+  ~LiveAcquisition();
+  LiveAcquisition(const LiveAcquisition&) = delete;
+  LiveAcquisition& operator=(const LiveAcquisition&) = delete;
+
+  /**
+   * \brief     .
+   *
+   * \param source     , "-"   .
+   * \throw std::runtime_error       
+   *         .
+   */
+  void Start(const std::string& source);
+
+  ///  ;   .
+  void Stop();
+
+  ///    (     ).
+  bool Running() const;
+
+  ///   ;  ,   .
+  LiveEstimate Estimate() const;
+
+  ///    .
+  LiveStats Stats() const;
+
+  /**
+   * \brief     (  ,  ).
+   *
+   * \param Tm ;    .
+   * \param Ca ;    .
+   * \return   .
+   */
+  size_t DrainChart(std::vector<double>& Tm, std::vector<double>& Ca);
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+#endif  // LIVEACQUISITION_H
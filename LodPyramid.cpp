@@ -0,0 +1,90 @@
+/**
+ * \file LodPyramid.cpp
+ * \brief  min/max-    .
+ */
+
+#include "LodPyramid.h"
+
+#include <algorithm>
+
+void LodPyramid::Build(const std::vector<double>& t,
+                       const std::vector<double>& v) {
+  Clear();
+  const size_t n = std::min(t.size(), v.size());
+  m_t.assign(t.begin(), t.begin() + n);
+  m_v.assign(v.begin(), v.begin() + n);
+
+  //  1    ,     
+  const std::vector<double>* srcMin = &m_v;
+  const std::vector<double>* srcMax = &m_v;
+  size_t size = n;
+  while (size > 1) {
+    const size_t next = (size + 1) / 2;
+    std::vector<double> lvMin(next);
+    std::vector<double> lvMax(next);
+    for (size_t b = 0; b < size / 2; b++) {
+      lvMin[b] = std::min((*srcMin)[2 * b], (*srcMin)[2 * b + 1]);
+      lvMax[b] = std::max((*srcMax)[2 * b], (*srcMax)[2 * b + 1]);
+    }
+    if (size % 2 != 0) {
+      lvMin[next - 1] = (*srcMin)[size - 1];
+      lvMax[next - 1] = (*srcMax)[size - 1];
+    }
+    m_min.push_back(std::move(lvMin));
+    m_max.push_back(std::move(lvMax));
+    srcMin = &m_min.back();
+    srcMax = &m_max.back();
+    size = next;
+  }
+}
+
+void LodPyramid::Clear() {
+  m_t.clear();
+  m_v.clear();
+  m_min.clear();
+  m_max.clear();
+}
+
+int LodPyramid::Query(double t0, double t1, size_t maxBuckets,
+                      std::vector<LodBucket>& out) const {
+  out.clear();
+  const size_t n = m_t.size();
+  if (n == 0 || t1 < t0) return 0;
+  if (maxBuckets < 1) maxBuckets = 1;
+
+  //           
+  size_t i0 = static_cast<size_t>(
+      std::lower_bound(m_t.begin(), m_t.end(), t0) - m_t.begin());
+  size_t i1 = static_cast<size_t>(
+      std::upper_bound(m_t.begin(), m_t.end(), t1) - m_t.begin());
+  if (i0 > 0) i0--;
+  if (i1 < n) i1++;
+  if (i1 <= i0) return 0;
+
+  //   ,      maxBuckets 
+  size_t level = 0;
+  while (level < m_min.size() &&
+         ((i1 - 1) >> level) - (i0 >> level) + 1 > maxBuckets) {
+    level++;
+  }
+
+  const size_t bFirst = i0 >> level;
+  const size_t bLast = (i1 - 1) >> level;
+  out.reserve(bLast - bFirst + 1);
+
+  if (level == 0) {
+    for (size_t i = i0; i < i1; i++) {
+      out.push_back({m_t[i], m_t[i], m_v[i], m_v[i], m_v[i], m_v[i], i});
+    }
+    return 0;
+  }
+
+  const std::vector<double>& lvMin = m_min[level - 1];
+  const std::vector<double>& lvMax = m_max[level - 1];
+  for (size_t b = bFirst; b <= bLast; b++) {
+    const size_t s = b << level;
+    const size_t e = std::min((b + 1) << level, n) - 1;
+    out.push_back({m_t[s], m_t[e], m_v[s], m_v[e], lvMin[b], lvMax[b], s});
+  }
+  return static_cast<int>(level);
+}
@@ -0,0 +1,80 @@
+#ifndef LODPYRAMID_H
+#define LODPYRAMID_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * \file LodPyramid.h
+ * \brief  min/max-    .
+ *
+ *  0   ,  L     
+ *    2^L  .     
+ * ,          ,
+ *        .
+ */
+
+/**
+ * \brief   ,  .
+ *
+ *           .
+ */
+struct LodBucket {
+  double tFirst;  ///<    .
+  double tLast;   ///<    .
+  double vFirst;  ///<     .
+  double vLast;   ///<     .
+  double vMin;    ///<    .
+  double vMax;    ///<    .
+  size_t iFirst;  ///<       .
+};
+
+/**
+ * \brief Min/max-   (t, v)   .
+ *
+ *          
+ *    .
+ */
+class LodPyramid {
+ public:
+  /**
+   * \brief    O(N).
+   *
+   * \param t   ().
+   * \param v     .
+   */
+  void Build(const std::vector<double>& t, const std::vector<double>& v);
+
+  /// \brief  .
+  void Clear();
+
+  /// \brief    .
+  size_t Size() const { return m_t.size(); }
+
+  /**
+   * \brief  ,    [t0, t1].
+   *
+   *     ,   
+   *  ,        
+   * \a maxBuckets .   0     .
+   *           , 
+   *     .
+   *
+   * \param t0   .
+   * \param t1   .
+   * \param maxBuckets    (   ).
+   * \param out   (  ).
+   * \return   .
+   */
+  int Query(double t0, double t1, size_t maxBuckets,
+            std::vector<LodBucket>& out) const;
+
+ private:
+  std::vector<double> m_t;  ///<    .
+  std::vector<double> m_v;  ///<   .
+  ///  1..L:  (min, max)    2^L .
+  std::vector<std::vector<double>> m_min;
+  std::vector<std::vector<double>> m_max;
+};
+
+#endif  // LODPYRAMID_H
@@ -12,13 +12,19 @@
 
 #include "MainWindow.h"
 
+#include <cmath>
+#include <commdlg.h>
+#include <cstdlib>
 #include <cwchar>
 #include <sstream>
 #include <stdexcept>
 #include <windowsx.h>
 
 #include "ChartDrawer.h"
+#include "DataImport.h"
 #include "ResultWindow.h"
+#include "RobustFit.h"
+#include "Trace.h"
 #include "Utils.h"
 
 /**
@@ -43,11 +49,20 @@ MainWindow::MainWindow()
       m_k(0.0),
       m_r(0.0),
       m_disp(0.0),
+      m_sceneDirty(true),
+      m_zoomed(false),
+      m_panning(false),
+      m_snapVisible(false),
       m_inChartArea(false),
       m_initializing(true)  //   
 {
     m_EditsCa.resize(MAX_POINTS, nullptr);
     m_EditsTm.resize(MAX_POINTS, nullptr);
+    m_EditsSigma.resize(MAX_POINTS, nullptr);
+    m_snapPt.x = 0;
+    m_snapPt.y = 0;
+    m_panStart.x = 0;
+    m_panStart.y = 0;
 }
 
 /**
@@ -55,6 +70,25 @@ MainWindow::MainWindow()
  */
 MainWindow::~MainWindow() {}
 
+/**
+ * \brief    .
+ *
+ *   CHEM_CACHE_DIR    ( "off"
+ *   );   
+ * %LOCALAPPDATA%\ChemRegression\cache.
+ *
+ * \return      ,    .
+ */
+static std::string DefaultCacheDirectory() {
+  if (const char* dir = std::getenv("CHEM_CACHE_DIR")) {
+    return (std::string(dir) == "off") ? std::string() : std::string(dir);
+  }
+  if (const char* local = std::getenv("LOCALAPPDATA")) {
+    return std::string(local) + "\\ChemRegression\\cache";
+  }
+  return std::string();
+}
+
 /**
  * \brief        .
  *
@@ -70,6 +104,9 @@ bool MainWindow::Create(HINSTANCE hInstance) {
   if (!RegisterWindowClass(hInstance))
     return false;
 
+  //     :    
+  m_cache.SetDiskDirectory(DefaultCacheDirectory());
+
   m_hWnd = CreateWindowEx(
       0, L"ChemConstMainClass",
       L"   (3A = 7B + 3C)  . ",
@@ -105,10 +142,27 @@ bool MainWindow::RegisterWindowClass(HINSTANCE hInstance) {
  *
  *       Windows, 
  *  ,       .
+ *
+ *  Ctrl+Shift+T      
+ * :    ,  
+ *   (. \c DumpTrace).
  */
 void MainWindow::MessageLoop() {
   MSG msg;
   while (GetMessage(&msg, nullptr, 0, 0)) {
+    if (msg.message == WM_KEYDOWN && msg.wParam == 'T' &&
+        (GetKeyState(VK_CONTROL) & 0x8000) &&
+        (GetKeyState(VK_SHIFT) & 0x8000)) {
+      if (Trace::IsEnabled()) {
+        DumpTrace(true);
+      } else {
+        Trace::Enable(true);
+        MessageBox(m_hWnd, L" .   "
+                           L"Ctrl+Shift+T    .",
+                   L"", MB_ICONINFORMATION);
+      }
+      continue;
+    }
     TranslateMessage(&msg);
     DispatchMessage(&msg);
   }
@@ -147,9 +201,12 @@ LRESULT CALLBACK MainWindow::StaticWndProc(HWND hwnd, UINT msg, WPARAM wParam, L
  *
  *    :
  * - \c WM_CREATE:   .
- * - \c WM_MOUSEMOVE:   .
+ * - \c WM_MOUSEMOVE:      .
+ * - \c WM_MOUSEWHEEL, \c WM_LBUTTONDOWN/UP, \c WM_RBUTTONUP:   .
  * - \c WM_COMMAND:     .
  * - \c WM_PAINT:  .
+ * - \c WM_TIMER:     .
+ * - \c WM_DATA_FILE_CHANGED:   .
  * - \c WM_DESTROY:   .
  *
  * \param msg  .
@@ -161,17 +218,55 @@ LRESULT MainWindow::WndProc(UINT msg, WPARAM wParam, LPARAM lParam) {
   switch (msg) {
     case WM_CREATE:
       CreateChildControls();
+      StartLive();
+      break;
+
+    case WM_TIMER:
+      if (wParam == IDT_LIVE_FRAME && m_live) {
+        OnLiveFrame();
+      }
+      break;
+
+    case WM_DATA_FILE_CHANGED:
+      OnDataFileChanged();
       break;
 
     case WM_MOUSEMOVE:
       OnMouseMove(wParam, lParam);
       break;
 
+    case WM_MOUSEWHEEL:
+      OnMouseWheel(wParam, lParam);
+      break;
+
+    case WM_LBUTTONDOWN:
+      OnLButtonDown(lParam);
+      break;
+
+    case WM_LBUTTONUP:
+      if (m_panning) {
+        ReleaseCapture();
+      }
+      break;
+
+    case WM_CAPTURECHANGED:
+      m_panning = false;
+      break;
+
+    case WM_RBUTTONUP:
+      //      
+      if (m_zoomed) {
+        m_zoomed = false;
+        InvalidateChart();
+      }
+      break;
+
     case WM_COMMAND:
       OnCommand(wParam, lParam);
       break;
 
     case WM_PAINT: {
+      TRACE_SCOPE("WM_PAINT");
       PAINTSTRUCT ps;
       HDC hdc = BeginPaint(m_hWnd, &ps);
       RECT rcClient;
@@ -182,21 +277,23 @@ LRESULT MainWindow::WndProc(UINT msg, WPARAM wParam, LPARAM lParam) {
       rcChart.left += 250;
       FillRect(hdc, &rcChart, (HBRUSH)(COLOR_WINDOW + 1));
 
-      //      
-      std::vector<double> Ca;
-      std::vector<double> Tm;
-      for (int i = 0; i < m_nPoints; i++) {
-        Ca.push_back(GetEditDouble(m_EditsCa[i]));
-        Tm.push_back(GetEditDouble(m_EditsTm[i]));
-      }
-
-      //      DrawChart
-      DrawChart(hdc, rcChart, Ca, Tm, m_Cb, m_Cc, m_k, m_n);
+      //   ,       
+      RefreshChartCache(rcChart);
+      DrawChart(hdc, rcChart, m_layout, m_scene);
       EndPaint(m_hWnd, &ps);
     }
       break;
 
     case WM_DESTROY:
+      m_fileWatch.Stop();
+      if (m_live) {
+        KillTimer(m_hWnd, IDT_LIVE_FRAME);
+        m_live->Stop();
+      }
+      //    CHEM_TRACE   
+      if (Trace::IsEnabled() && !m_tracePath.empty()) {
+        DumpTrace(false);
+      }
       PostQuitMessage(0);
       break;
 
@@ -212,7 +309,7 @@ LRESULT MainWindow::WndProc(UINT msg, WPARAM wParam, LPARAM lParam) {
  *          :
  * -     ,  , Cb, Cc.
  * -     , Cb, Cc.
- * -  ""  "".
+ * -  "", "", "..."  "".
  * -     .
  * -      Ca  t.
  *
@@ -258,25 +355,65 @@ void MainWindow::CreateChildControls() {
 
   //  ""
   CreateWindowEx(0, L"BUTTON", L"",
-                 WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON, 20, 130, 100, 30, m_hWnd,
+                 WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON, 20, 122, 100, 24, m_hWnd,
                  (HMENU) static_cast<INT_PTR>(IDC_BUTTON_GRAPH), nullptr,
                  nullptr);
 
   //  ""
   CreateWindowEx(0, L"BUTTON", L"", WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
-                 140, 130, 100, 30, m_hWnd,
+                 140, 122, 100, 24, m_hWnd,
                  (HMENU) static_cast<INT_PTR> (IDC_BUTTON_EXIT), nullptr,
                  nullptr);
 
+  //     CSV/TSV      
+  CreateWindowEx(0, L"BUTTON", L"...",
+                 WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON, 20, 149, 100, 24, m_hWnd,
+                 (HMENU) static_cast<INT_PTR>(IDC_BUTTON_IMPORT), nullptr,
+                 nullptr);
+  CreateWindowEx(0, L"BUTTON", L"",
+                 WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON, 140, 149, 100, 24,
+                 m_hWnd, (HMENU) static_cast<INT_PTR>(IDC_BUTTON_PASTE),
+                 nullptr, nullptr);
+
+  //   :       
+  CreateWindowEx(0, L"STATIC", L":", WS_CHILD | WS_VISIBLE | SS_LEFT, 20,
+                 181, 50, 20, m_hWnd, nullptr, nullptr, nullptr);
+  m_hMethodCombo = CreateWindowEx(
+      0, L"COMBOBOX", L"", WS_CHILD | WS_VISIBLE | WS_VSCROLL | CBS_DROPDOWNLIST,
+      70, 178, 170, 120, m_hWnd,
+      (HMENU) static_cast<INT_PTR>(IDC_METHOD_COMBO), nullptr, nullptr);
+  const wchar_t* methods[] = {L"", L"RANSAC", L"IRLS ()",
+                              L"IRLS ()"};
+  for (const wchar_t* name : methods) {
+    SendMessage(m_hMethodCombo, CB_ADDSTRING, 0,
+                reinterpret_cast<LPARAM>(name));
+  }
+  SendMessage(m_hMethodCombo, CB_SETCURSEL, 0, 0);
+
+  //   :      
+  CreateWindowEx(0, L"STATIC", L":", WS_CHILD | WS_VISIBLE | SS_LEFT,
+                 20, 206, 60, 20, m_hWnd, nullptr, nullptr, nullptr);
+  m_hRateCombo = CreateWindowEx(
+      0, L"COMBOBOX", L"", WS_CHILD | WS_VISIBLE | WS_VSCROLL | CBS_DROPDOWNLIST,
+      80, 203, 160, 120, m_hWnd,
+      (HMENU) static_cast<INT_PTR>(IDC_RATE_COMBO), nullptr, nullptr);
+  const wchar_t* rateMethods[] = {L"", L"",
+                                  L" "};
+  for (const wchar_t* name : rateMethods) {
+    SendMessage(m_hRateCombo, CB_ADDSTRING, 0,
+                reinterpret_cast<LPARAM>(name));
+  }
+  SendMessage(m_hRateCombo, CB_SETCURSEL, 0, 0);
+
   //    
   m_hCoordLabel =
       CreateWindowEx(0, L"STATIC", L"", WS_CHILD | WS_VISIBLE | SS_LEFT, 460,
-                     10, 200, 20, m_hWnd, nullptr, nullptr, nullptr);
+                     10, 400, 20, m_hWnd, nullptr, nullptr, nullptr);
 
   // -------------------------
   //   (Ca, t) + 
   // -------------------------
-  int startY = 180;    //   
+  int startY = 232;    //   
   int rowHeight = 25;  //   
   double defaultCa[5] = {2.0, 1.8, 1.6, 1.4, 1.2};
   double defaultT[5] = {0.0, 1.0, 2.0, 3.0, 4.0};
@@ -289,6 +426,10 @@ void MainWindow::CreateChildControls() {
   CreateWindowEx(0, L"STATIC", L"t, ", WS_CHILD | WS_VISIBLE | SS_CENTER, 90,
                  startY, 60, 20, m_hWnd, nullptr, nullptr, nullptr);
 
+  //     ()
+  CreateWindowEx(0, L"STATIC", L"Ca", WS_CHILD | WS_VISIBLE | SS_CENTER, 160,
+                 startY, 60, 20, m_hWnd, nullptr, nullptr, nullptr);
+
   //     
   for (int i = 0; i < MAX_POINTS; i++) {
     int fieldY = startY + i * rowHeight + 20;
@@ -307,10 +448,17 @@ void MainWindow::CreateChildControls() {
         fieldY, 60, 20, m_hWnd, (HMENU) static_cast<INT_PTR>(IDC_BASE_T + i),
         nullptr, nullptr);
 
+    //    Ca (    )
+    m_EditsSigma[i] = CreateWindowEx(
+        WS_EX_CLIENTEDGE, L"EDIT", L"", WS_CHILD | WS_VISIBLE | ES_LEFT, 160,
+        fieldY, 60, 20, m_hWnd,
+        (HMENU) static_cast<INT_PTR>(IDC_BASE_SIGMA + i), nullptr, nullptr);
+
     // /    m_nPoints
     if (i < m_nPoints) {
       ShowWindow(m_EditsCa[i], SW_SHOW);
       ShowWindow(m_EditsTm[i], SW_SHOW);
+      ShowWindow(m_EditsSigma[i], SW_SHOW);
 
       //   (  5)
       if (i < 5) {
@@ -324,6 +472,7 @@ void MainWindow::CreateChildControls() {
     } else {
       ShowWindow(m_EditsCa[i], SW_HIDE);
       ShowWindow(m_EditsTm[i], SW_HIDE);
+      ShowWindow(m_EditsSigma[i], SW_HIDE);
     }
   }
 
@@ -338,6 +487,8 @@ void MainWindow::CreateChildControls() {
  *        .
  * -   "" (IDC_BUTTON_GRAPH):      .
  * -   "" (IDC_BUTTON_EXIT):    .
+ * -   "..."  "":     
+ *       .
  *
  * \param wParam       .
  * \param lParam     ( ).
@@ -357,14 +508,20 @@ void MainWindow::OnCommand(WPARAM wParam, LPARAM) {
         if (val > MAX_POINTS)
           val = MAX_POINTS;
         m_nPoints = val;
+        m_sceneDirty = true;
+        m_fitInliers.clear();
+        m_fitSigma.clear();
+        m_modelFits.clear();
         //           m_nPoints
         for (int i = 0; i < MAX_POINTS; i++) {
           if (i < m_nPoints) {
             ShowWindow(m_EditsCa[i], SW_SHOW);
             ShowWindow(m_EditsTm[i], SW_SHOW);
+            ShowWindow(m_EditsSigma[i], SW_SHOW);
           } else {
             ShowWindow(m_EditsCa[i], SW_HIDE);
             ShowWindow(m_EditsTm[i], SW_HIDE);
+            ShowWindow(m_EditsSigma[i], SW_HIDE);
           }
         }
       }
@@ -377,6 +534,28 @@ void MainWindow::OnCommand(WPARAM wParam, LPARAM) {
     case IDC_BUTTON_EXIT:
       PostMessage(m_hWnd, WM_CLOSE, 0, 0);
       break;
+
+    case IDC_BUTTON_IMPORT:
+      OnImportFile();
+      break;
+
+    case IDC_BUTTON_PASTE:
+      OnPasteTable();
+      break;
+
+    default:
+      //    Ca, t     
+      // 
+      if (wmEvent == EN_CHANGE &&
+          ((wmId >= IDC_BASE_CA && wmId < IDC_BASE_CA + MAX_POINTS) ||
+           (wmId >= IDC_BASE_T && wmId < IDC_BASE_T + MAX_POINTS) ||
+           (wmId >= IDC_BASE_SIGMA && wmId < IDC_BASE_SIGMA + MAX_POINTS))) {
+        m_sceneDirty = true;
+        m_fitInliers.clear();
+        m_fitSigma.clear();
+        m_modelFits.clear();
+      }
+      break;
   }
 }
 
@@ -385,7 +564,9 @@ void MainWindow::OnCommand(WPARAM wParam, LPARAM) {
  *
  *       ,    
  *    (     ) ,      ,
- *   ,     .
+ *            
+ *     A(t)     .  
+ * ,   ,     O(log N).
  *
  * \param wParam      ( ).
  * \param lParam      .
@@ -413,78 +594,491 @@ void MainWindow::OnMouseMove(WPARAM, LPARAM lParam) {
     SetCursor(LoadCursor(nullptr, IDC_ARROW));
   }
 
+  //      
+  if (m_panning) {
+    double dt = (xPos - m_panStart.x) * (m_panView.Tmax - m_panView.Tmin) /
+                m_layout.AxisWidth();
+    double dc = (yPos - m_panStart.y) * (m_panView.Cmax - m_panView.Cmin) /
+                m_layout.AxisHeight();
+    m_view.Tmin = m_panView.Tmin - dt;
+    m_view.Tmax = m_panView.Tmax - dt;
+    m_view.Cmin = m_panView.Cmin + dc;
+    m_view.Cmax = m_panView.Cmax + dc;
+    m_zoomed = true;
+    InvalidateChart();
+    return;
+  }
+
+  //   ,    
+  if (m_snapVisible) {
+    DrawSnapMarker(m_snapPt);
+    m_snapVisible = false;
+  }
+
   //      ,   
+  //  ,    : O(log N)  .
   if (nowInChart) {
-    std::vector<double> Ca;
-    std::vector<double> Tm;
-    for (int i = 0; i < m_nPoints; i++) {
-      Ca.push_back(GetEditDouble(m_EditsCa[i]));
-      Tm.push_back(GetEditDouble(m_EditsTm[i]));
-    }
-    double Tmin = 1e9, Tmax = -1e9, Cmin = 1e9, Cmax = -1e9;
-    for (int i = 0; i < m_nPoints; i++) {
-      if (Tm[i] < Tmin)
-        Tmin = Tm[i];
-      if (Tm[i] > Tmax)
-        Tmax = Tm[i];
-      if (Ca[i] < Cmin)
-        Cmin = Ca[i];
-      if (Ca[i] > Cmax)
-        Cmax = Ca[i];
-    }
-    if (m_Cb < Cmin)
-      Cmin = m_Cb;
-    if (m_Cb > Cmax)
-      Cmax = m_Cb;
-    if (m_Cc < Cmin)
-      Cmin = m_Cc;
-    if (m_Cc > Cmax)
-      Cmax = m_Cc;
-    if (Tmin > 1e8) {
-      Tmin = 0;
-      Tmax = 1;
-    }
-    if (fabs(Tmax - Tmin) < 1e-6) {
-      Tmax = Tmin + 1;
+    double tData = m_layout.FromX(xPos);
+    double cData = m_layout.FromY(yPos);
+
+    wchar_t buf[160];
+    const std::vector<double>& Ca = m_scene.Ca;
+    const std::vector<double>& Tm = m_scene.Tm;
+    if (m_scene.tmSorted && !Tm.empty()) {
+      //      ( )
+      size_t idx = FindNearestIndex(Tm, tData);
+      //       
+      double aModel = m_scene.traj.ValueAt(tData);
+      if (m_scene.traj.Empty()) {
+        swprintf_s(buf, L" %d: t=%.3f, Ca=%.3f", static_cast<int>(idx) + 1,
+                   Tm[idx], Ca[idx]);
+      } else {
+        swprintf_s(buf, L" %d: t=%.3f, Ca=%.3f | A(%.3f)=%.3f",
+                   static_cast<int>(idx) + 1, Tm[idx], Ca[idx], tData,
+                   aModel);
+      }
+
+      m_snapPt.x = m_layout.ToX(Tm[idx]);
+      m_snapPt.y = m_layout.ToY(Ca[idx]);
+      DrawSnapMarker(m_snapPt);
+      m_snapVisible = true;
+    } else {
+      swprintf_s(buf, L"x=%.3f, y=%.3f", tData, cData);
     }
-    if (fabs(Cmax - Cmin) < 1e-6) {
-      Cmax = Cmin + 1;
+    SetWindowText(m_hCoordLabel, buf);
+  }
+}
+
+/**
+ * \brief        .
+ */
+void MainWindow::ReadSeries() {
+  TRACE_SCOPE("ReadSeries");
+  m_scene.Ca.resize(m_nPoints);
+  m_scene.Tm.resize(m_nPoints);
+  for (int i = 0; i < m_nPoints; i++) {
+    m_scene.Ca[i] = GetEditDouble(m_EditsCa[i]);
+    m_scene.Tm[i] = GetEditDouble(m_EditsTm[i]);
+  }
+}
+
+/**
+ * \brief   .
+ *
+ *        ;
+ *        .
+ *
+ * \param rcChart   .
+ */
+void MainWindow::RefreshChartCache(const RECT& rcChart) {
+  if (m_sceneDirty) {
+    TRACE_SCOPE("RebuildChartScene");
+    if (m_live) {
+      //         :
+      //      
+      m_scene.Ca = m_liveCa;
+      m_scene.Tm = m_liveTm;
+      m_scene.inliers.clear();
+      m_scene.traj = BuildTrajectory(m_scene.Ca, m_scene.Tm, m_Cb, m_Cc, m_k,
+                                     m_n, 20, false);
+      m_scene.models.clear();
+      m_scene.bounds = ComputeDataBounds(m_scene.Ca, m_scene.Tm, m_Cb, m_Cc);
+      m_scene.info.clear();
+    } else {
+      ReadSeries();
+      m_scene.inliers = m_fitInliers;
+      m_scene.traj = BuildTrajectory(m_scene.Ca, m_scene.Tm, m_Cb, m_Cc, m_k,
+                                     m_n, 20, true);
+      BuildModelCurves();
+      m_scene.bounds = ComputeDataBounds(m_scene.Ca, m_scene.Tm, m_Cb, m_Cc);
+      BuildSamplingInfo();
     }
-    if (Cmin < 0)
-      Cmin = 0;
-    if (Tmin < 0)
-      Tmin = 0;
-
-    double offsetX = 40.0, offsetY = 40.0;
-    double plotW = (rcChart.right - rcChart.left) - 50.0;
-    double plotH = (rcChart.bottom - rcChart.top) - 50.0;
-
-    double px = static_cast<double>(xPos);
-    double py = static_cast<double>(yPos);
-
-    double tData = 0.0, cData = 0.0;
-    {
-      double pxChart = px - (rcChart.left + offsetX);
-      if (pxChart < 0)
-        pxChart = 0;
-      if (pxChart > (plotW - 20))
-        pxChart = (plotW - 20);
-      tData = Tmin + (pxChart / (plotW - 20)) * (Tmax - Tmin);
+    m_scene.BuildLevels();
+    m_sceneDirty = false;
+  }
+  m_layout = MakeChartLayout(rcChart, m_zoomed ? m_view : m_scene.bounds);
+  //        
+  m_snapVisible = false;
+}
+
+/**
+ * \brief      .
+ *
+ *       ;  
+ *  , AIC   .
+ */
+void MainWindow::BuildModelCurves() {
+  m_scene.models.clear();
+  if (m_scene.traj.Empty() || m_scene.Ca.empty()) return;
+  const std::vector<KineticModel>& registry = ModelRegistry();
+  for (size_t i = 0; i < m_modelFits.size() && i < MAX_SHOWN_MODELS; i++) {
+    const ModelFit& fit = m_modelFits[i];
+    if (!fit.ok) break;
+    ModelCurve curve;
+    curve.t = m_scene.traj.t;
+    IntegrateModel(registry[fit.model], fit.params.data(), m_scene.Ca[0],
+                   curve.t, 1, curve.A);
+    wchar_t buf[128];
+    swprintf_s(buf, L"%ls: AIC=%.1f, w=%.2f", registry[fit.model].name,
+               fit.aic, fit.weight);
+    curve.label = buf;
+    m_scene.models.push_back(std::move(curve));
+  }
+}
+
+/**
+ * \brief      .
+ *
+ *        
+ *     ;   ,
+ *        .
+ */
+void MainWindow::BuildSamplingInfo() {
+  m_scene.info.clear();
+  if (m_scene.traj.Empty()) return;
+  const bool weighted =
+      !m_fitSigma.empty() && m_fitSigma.size() == m_scene.Tm.size();
+  const FisherInfo fisher = ComputeFisherInfo(
+      m_scene.traj, m_scene.Tm, weighted ? &m_fitSigma : nullptr);
+  ComputeSamplingInfo(m_scene.traj, fisher, m_scene.info);
+  double vmax = 0.0;
+  for (double v : m_scene.info) {
+    if (std::isfinite(v) && v > vmax) vmax = v;
+  }
+  if (!(vmax > 0.0)) {
+    m_scene.info.clear();
+    return;
+  }
+  const double scale = m_scene.bounds.Cmax / vmax;
+  for (double& v : m_scene.info) {
+    v = std::isfinite(v) ? v * scale : 0.0;
+  }
+}
+
+/**
+ * \brief        .
+ *
+ * \param wParam     .
+ * \param lParam   .
+ */
+void MainWindow::OnMouseWheel(WPARAM wParam, LPARAM lParam) {
+  POINT pt = {GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)};
+  ScreenToClient(m_hWnd, &pt);
+  RECT rcChart = GetChartRect();
+  if (pt.x < rcChart.left || pt.x > rcChart.right || pt.y < rcChart.top ||
+      pt.y > rcChart.bottom) {
+    return;
+  }
+
+  //     ( )   20%
+  const int delta = GET_WHEEL_DELTA_WPARAM(wParam);
+  const double factor = std::pow(0.8, static_cast<double>(delta) / WHEEL_DELTA);
+  const bool timeOnly = (GET_KEYSTATE_WPARAM(wParam) & MK_SHIFT) != 0;
+
+  ChartBounds v = m_layout.Bounds();
+  const double tAnchor = m_layout.FromX(pt.x);
+  const double cAnchor = m_layout.Cmin +
+                         (m_layout.ToY(m_layout.Cmin) - pt.y) *
+                             (m_layout.Cmax - m_layout.Cmin) /
+                             m_layout.AxisHeight();
+
+  //        double
+  const double fullT = m_scene.bounds.Tmax - m_scene.bounds.Tmin;
+  const double fullC = m_scene.bounds.Cmax - m_scene.bounds.Cmin;
+  if ((v.Tmax - v.Tmin) * factor < fullT * 1e-9) return;
+
+  v.Tmin = tAnchor - (tAnchor - v.Tmin) * factor;
+  v.Tmax = tAnchor + (v.Tmax - tAnchor) * factor;
+  if (!timeOnly && (v.Cmax - v.Cmin) * factor >= fullC * 1e-9) {
+    v.Cmin = cAnchor - (cAnchor - v.Cmin) * factor;
+    v.Cmax = cAnchor + (v.Cmax - cAnchor) * factor;
+  }
+  m_view = v;
+  m_zoomed = true;
+  InvalidateChart();
+}
+
+/**
+ * \brief    .
+ *
+ * \param lParam     .
+ */
+void MainWindow::OnLButtonDown(LPARAM lParam) {
+  POINT pt = {GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)};
+  RECT rcChart = GetChartRect();
+  if (pt.x < rcChart.left || pt.x > rcChart.right || pt.y < rcChart.top ||
+      pt.y > rcChart.bottom) {
+    return;
+  }
+  //    ,     
+  SetFocus(m_hWnd);
+  m_panning = true;
+  m_panStart = pt;
+  m_panView = m_layout.Bounds();
+  SetCapture(m_hWnd);
+}
+
+/**
+ * \brief     (  ).
+ */
+RECT MainWindow::GetChartRect() const {
+  RECT rcChart;
+  GetClientRect(m_hWnd, &rcChart);
+  rcChart.left += 250;
+  return rcChart;
+}
+
+/**
+ * \brief     .
+ *
+ * \param notify     .
+ */
+void MainWindow::DumpTrace(bool notify) {
+  std::string path = m_tracePath;
+  if (path.empty()) {
+    path = "chem_trace_" + std::to_string(GetCurrentProcessId()) + ".json";
+  }
+  const bool ok = Trace::DumpChromeJson(path);
+  if (!notify) return;
+  if (ok) {
+    std::wstring msg = L"   :\n" + s2ws(path);
+    MessageBox(m_hWnd, msg.c_str(), L"", MB_ICONINFORMATION);
+  } else {
+    ShowError(m_hWnd, L"    !");
+  }
+}
+
+/**
+ * \brief   ,   .
+ */
+void MainWindow::StartLive() {
+  if (m_liveSource.empty()) return;
+  m_live.reset(new LiveAcquisition);
+  try {
+    m_live->Start(m_liveSource);
+  } catch (const std::exception& e) {
+    m_live.reset();
+    std::wstring msg = L"    :\n" + s2ws(e.what());
+    ShowError(m_hWnd, msg.c_str());
+    return;
+  }
+  m_liveTm.reserve(2 * LIVE_CHART_POINTS);
+  m_liveCa.reserve(2 * LIVE_CHART_POINTS);
+  SetTimer(m_hWnd, IDT_LIVE_FRAME, LIVE_FRAME_MS, nullptr);
+}
+
+/**
+ * \brief     .
+ */
+void MainWindow::OnLiveFrame() {
+  TRACE_SCOPE("OnLiveFrame");
+  if (m_live->DrainChart(m_liveTm, m_liveCa) > 0) {
+    //   ,     
+    if (m_liveTm.size() > 2 * LIVE_CHART_POINTS) {
+      const size_t drop = m_liveTm.size() - LIVE_CHART_POINTS;
+      m_liveTm.erase(m_liveTm.begin(), m_liveTm.begin() + drop);
+      m_liveCa.erase(m_liveCa.begin(), m_liveCa.begin() + drop);
     }
-    {
-      double pyChart = py - rcChart.top;
-      double v = (plotH - (pyChart)) / (plotH - offsetY);
-      cData = Cmin + v * (Cmax - Cmin);
-      if (cData < 0)
-        cData = 0;
+    m_sceneDirty = true;
+  }
+  const LiveEstimate estimate = m_live->Estimate();
+  if (estimate.fit.Ok()) {
+    m_n = estimate.fit.value.n;
+    m_k = estimate.fit.value.k;
+    m_r = estimate.fit.value.r;
+  }
+  const LiveStats stats = m_live->Stats();
+  wchar_t title[192];
+  swprintf_s(title,
+             L": n = %.4g, k = %.4g,  %llu,  p99 %.0f %s",
+             m_n, m_k, static_cast<unsigned long long>(estimate.samples),
+             stats.latency.p99Us, stats.finished ? L" ( )" : L"");
+  SetWindowText(m_hWnd, title);
+  if (m_sceneDirty) {
+    InvalidateChart();
+  } else if (stats.finished) {
+    //   :    
+    KillTimer(m_hWnd, IDT_LIVE_FRAME);
+    if (!stats.error.empty()) ShowError(m_hWnd, s2ws(stats.error).c_str());
+  }
+}
+
+/**
+ * \brief     CSV/TSV,  .
+ */
+void MainWindow::OnImportFile() {
+  wchar_t fileName[MAX_PATH] = {0};
+  OPENFILENAME ofn = {};
+  ofn.lStructSize = sizeof(ofn);
+  ofn.hwndOwner = m_hWnd;
+  ofn.lpstrFilter = L" (*.csv;*.tsv;*.txt)\0*.csv;*.tsv;*.txt\0"
+                    L"  (*.*)\0*.*\0";
+  ofn.lpstrFile = fileName;
+  ofn.nMaxFile = MAX_PATH;
+  ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
+  if (!GetOpenFileName(&ofn)) return;
+  m_fileWatch.Stop();
+  try {
+    m_watched.Load(fileName);
+    ApplyImportedData(m_watched.Data());
+    const HWND hwnd = m_hWnd;
+    m_fileWatch.Start(fileName, [hwnd] {
+      PostMessage(hwnd, WM_DATA_FILE_CHANGED, 0, 0);
+    });
+  } catch (const std::runtime_error& e) {
+    ShowError(m_hWnd, s2ws(e.what()).c_str());
+  }
+}
+
+/**
+ * \brief      .
+ */
+void MainWindow::OnDataFileChanged() {
+  TRACE_SCOPE("OnDataFileChanged");
+  if (m_watched.Path().empty()) return;
+  DatasetChange change;
+  try {
+    change = m_watched.Reload();
+  } catch (const std::runtime_error&) {
+    //     :   
+    return;
+  }
+  if (!change.changed) return;
+  ApplyImportedData(m_watched.Data(), false);
+
+  const CalcOutcome fit = m_watched.Fit();
+  wchar_t title[192];
+  if (fit.Ok()) {
+    m_n = fit.value.n;
+    m_k = fit.value.k;
+    m_r = fit.value.r;
+    swprintf_s(title, L" : n = %.4g, k = %.4g, r = %.4f, "
+                      L" %zu",
+               m_n, m_k, m_r, m_watched.Data().Tm.size());
+  } else {
+    swprintf_s(title, L" : %ls",
+               s2ws(CalcStatusMessage(fit.status)).c_str());
+  }
+  SetWindowText(m_hWnd, title);
+}
+
+/**
+ * \brief     .
+ *
+ *          ;
+ *    UTF-8 (     ASCII) 
+ *   ,  .
+ */
+void MainWindow::OnPasteTable() {
+  if (!IsClipboardFormatAvailable(CF_UNICODETEXT) || !OpenClipboard(m_hWnd)) {
+    ShowError(m_hWnd, L"    !");
+    return;
+  }
+  std::string text;
+  HANDLE hData = GetClipboardData(CF_UNICODETEXT);
+  const wchar_t* wide =
+      hData ? static_cast<const wchar_t*>(GlobalLock(hData)) : nullptr;
+  if (wide != nullptr) {
+    const int wideLen = static_cast<int>(wcslen(wide));
+    const int len = WideCharToMultiByte(CP_UTF8, 0, wide, wideLen, nullptr, 0,
+                                        nullptr, nullptr);
+    if (len > 0) {
+      text.resize(len);
+      WideCharToMultiByte(CP_UTF8, 0, wide, wideLen, &text[0], len, nullptr,
+                          nullptr);
     }
+    GlobalUnlock(hData);
+  }
+  CloseClipboard();
+  //       :  
+  m_fileWatch.Stop();
+  m_watched = IncrementalDataset();
+  ApplyImportedData(ImportDelimitedText(text.data(), text.size()));
+}
 
-    wchar_t buf[128];
-    swprintf_s(buf, L"x=%.3f, y=%.3f", tData, cData);
-    SetWindowText(m_hCoordLabel, buf);
+/**
+ * \brief      .
+ *
+ * \param data  .
+ * \param interactive       .
+ */
+void MainWindow::ApplyImportedData(const ImportedData& data,
+                                   bool interactive) {
+  const size_t total = data.Tm.size();
+  if (total == 0) {
+    if (!interactive) return;
+    ShowError(m_hWnd, L"         "
+                      L"!");
+    return;
+  }
+  const size_t count = total < MAX_POINTS ? total : MAX_POINTS;
+
+  //       ( EN_CHANGE)
+  wchar_t buf[64];
+  swprintf_s(buf, L"%d", static_cast<int>(count));
+  SetWindowText(m_hPointsEdit, buf);
+  for (size_t i = 0; i < count; i++) {
+    //     ;   src == i
+    const size_t src = (count > 1) ? i * (total - 1) / (count - 1) : 0;
+    swprintf_s(buf, L"%.10g", data.Ca[src]);
+    SetWindowText(m_EditsCa[i], buf);
+    swprintf_s(buf, L"%.10g", data.Tm[src]);
+    SetWindowText(m_EditsTm[i], buf);
+    buf[0] = L'\0';
+    if (!data.sigma.empty()) swprintf_s(buf, L"%.10g", data.sigma[src]);
+    SetWindowText(m_EditsSigma[i], buf);
+  }
+  m_sceneDirty = true;
+  m_fitInliers.clear();
+  m_fitSigma.clear();
+  m_modelFits.clear();
+  InvalidateChart();
+
+  if (interactive && total > count) {
+    std::wstringstream ws;
+    ws << L"  " << total << L" ;     "
+       << count << L" ,     .";
+    MessageBox(m_hWnd, ws.str().c_str(), L"", MB_ICONINFORMATION);
   }
 }
 
+/**
+ * \brief    .
+ */
+void MainWindow::InvalidateChart() {
+  RECT rcChart = GetChartRect();
+  InvalidateRect(m_hWnd, &rcChart, FALSE);
+}
+
+/**
+ * \brief    (  )   XOR.
+ *
+ * \param pt   .
+ */
+void MainWindow::DrawSnapMarker(POINT pt) {
+  HDC hdc = GetDC(m_hWnd);
+  int oldRop = SetROP2(hdc, R2_NOTXORPEN);
+  HPEN hPen = CreatePen(PS_SOLID, 1, RGB(0, 0, 0));
+  HPEN hPenOld = (HPEN)SelectObject(hdc, hPen);
+  HBRUSH hBrOld = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
+
+  Rectangle(hdc, pt.x - 6, pt.y - 6, pt.x + 7, pt.y + 7);
+  MoveToEx(hdc, pt.x - 10, pt.y, nullptr);
+  LineTo(hdc, pt.x - 6, pt.y);
+  MoveToEx(hdc, pt.x + 7, pt.y, nullptr);
+  LineTo(hdc, pt.x + 11, pt.y);
+  MoveToEx(hdc, pt.x, pt.y - 10, nullptr);
+  LineTo(hdc, pt.x, pt.y - 6);
+  MoveToEx(hdc, pt.x, pt.y + 7, nullptr);
+  LineTo(hdc, pt.x, pt.y + 11);
+
+  SelectObject(hdc, hBrOld);
+  SelectObject(hdc, hPenOld);
+  DeleteObject(hPen);
+  SetROP2(hdc, oldRop);
+  ReleaseDC(m_hWnd, hdc);
+}
+
 /**
  * \brief       .
  *
@@ -504,67 +1098,90 @@ void MainWindow::OnCalculateAndRedraw() {
   }
   std::vector<double> Ca;
   std::vector<double> Tm;
-  for (int i = 0; i < m_nPoints; i++) {
-    Ca.push_back(GetEditDouble(m_EditsCa[i]));
-    Tm.push_back(GetEditDouble(m_EditsTm[i]));
+  std::vector<double> sigma;
+  int sigmaCount = 0;
+  {
+    TRACE_SCOPE("ParseEdits");
+    for (int i = 0; i < m_nPoints; i++) {
+      Ca.push_back(GetEditDouble(m_EditsCa[i]));
+      Tm.push_back(GetEditDouble(m_EditsTm[i]));
+      sigma.push_back(GetEditDouble(m_EditsSigma[i]));
+      if (GetWindowTextLength(m_EditsSigma[i]) > 0) sigmaCount++;
+    }
   }
-
-  //     ChemCalculation (n, k, r, disp)
-  CalculationResult res;
-  try {
-    res = ChemCalculation::Calculate(Ca, Tm, m_Cb, m_Cc);
-    m_n = res.n;
-    m_k = res.k;
-    m_r = res.r;
-    m_disp = res.disp;
-  } catch (const std::runtime_error& e) {
-    std::wstringstream ws;
-    ws << L" :\n" << s2ws(e.what());            //   RU     
-    ShowError(m_hWnd, ws.str().c_str());
+  //      ,    
+  if (sigmaCount == 0) {
+    sigma.clear();
+  } else if (sigmaCount != m_nPoints) {
+    ShowError(m_hWnd, L" Ca       "
+                      L"   !");
     return;
   }
 
-  //     :
-  //       k_i  
-  // .
-  std::vector<double> lnK;
-  std::vector<double> invT;
-  //       (Tm  )
-  for (int i = 0; i < m_nPoints - 1; i++) {
-    double dt = Tm[i + 1] - Tm[i];
-    double dCa = Ca[i + 1] - Ca[i];
-    if (dt <= 1e-15) dt = 1e-15;
-    double w = std::fabs(dCa / dt);
-    //   : k_i = w / (Ca[i]^n)
-    double k_i = w / std::pow(Ca[i], m_n);
-    double T_avg = (Tm[i] + Tm[i + 1]) / 2.0;
-    lnK.push_back(std::log(k_i));
-    invT.push_back(1.0 / T_avg);
-  }
-
-  //      ln(k) = ln(A) - Ea/(R*T)
-  double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
-  int N = static_cast<int>(lnK.size());
-  if (N < 2) {
-    //     
-    ShowError(m_hWnd,
-              L"      "
-              L"!");
-    return;
+  //  :       FitMethod
+  RobustOptions options;
+  const LRESULT sel = SendMessage(m_hMethodCombo, CB_GETCURSEL, 0, 0);
+  options.method = static_cast<FitMethod>(sel > 0 ? sel : 0);
+  const LRESULT rateSel = SendMessage(m_hRateCombo, CB_GETCURSEL, 0, 0);
+  options.rates.method = static_cast<RateMethod>(rateSel > 0 ? rateSel : 0);
+
+  //          
+  const CacheKey key = ResultCache::MakeKey(
+      Ca, Tm, m_Cb, m_Cc, options.method, HashOptions(options), sigma);
+  CachedFit cached;
+  if (!m_cache.Lookup(key, cached)) {
+    try {
+      if (options.method == FitMethod::LeastSquares &&
+          options.rates.method == RateMethod::ForwardDifference &&
+          sigma.empty()) {
+        //     ChemCalculation (n, k, r, disp)
+        cached.fit = ChemCalculation::Calculate(Ca, Tm, m_Cb, m_Cc);
+      } else {
+        //   /  ;  
+        // ,    
+        RobustResult robust =
+            RobustCalculate(Ca, Tm, m_Cb, m_Cc, options, &sigma);
+        cached.fit = robust.fit;
+        cached.pointInliers = std::move(robust.pointInliers);
+      }
+    } catch (const std::runtime_error& e) {
+      std::wstringstream ws;
+      ws << L" :\n" << s2ws(e.what());            //   RU     
+      ShowError(m_hWnd, ws.str().c_str());
+      return;
+    }
+    try {
+      //     
+      cached.arrhenius =
+          ChemCalculation::CalculateArrhenius(Ca, Tm, cached.fit.n);
+    } catch (const std::runtime_error& e) {
+      ShowError(m_hWnd, s2ws(e.what()).c_str());
+      return;
+    }
+    m_cache.Store(key, cached);
   }
-  for (int i = 0; i < N; i++) {
-    sumX += invT[i];
-    sumY += lnK[i];
-    sumXX += invT[i] * invT[i];
-    sumXY += invT[i] * lnK[i];
+  m_n = cached.fit.n;
+  m_k = cached.fit.k;
+  m_r = cached.fit.r;
+  m_disp = cached.fit.disp;
+  m_fitInliers = cached.pointInliers;
+  m_fitSigma = sigma;
+  //      Ca  t,   
+  //   ;    ,   
+  // (,   )    
+  if (m_modelFits.empty()) {
+    try {
+      m_modelFits = ScreenModels(Ca, Tm);
+    } catch (const std::runtime_error&) {
+      m_modelFits.clear();
+    }
   }
-  double slope = (N * sumXY - sumX * sumY) / (N * sumXX - sumX * sumX);
-  double intercept = (sumY - slope * sumX) / N;
-  const double R_gas = 8.314;  // /()
-  double Ea = -slope * R_gas;  //   (/)
-  double A = std::exp(intercept);  //  
+  const double A = cached.arrhenius.A;
+  const double Ea = cached.arrhenius.Ea;
 
-  //   ( )
+  //   ( )      
+  m_sceneDirty = true;
+  m_zoomed = false;
   InvalidateRect(m_hWnd, nullptr, TRUE);
 
   //      ,  A  Ea.
@@ -3,10 +3,20 @@
 
 #include <windows.h>
 
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "ChartDrawer.h"
 #include "ChemCalculation.h"
 #include "Constants.h"
+#include "DataImport.h"
+#include "FileWatch.h"
+#include "IncrementalDataset.h"
+#include "KineticModels.h"
+#include "LiveAcquisition.h"
+#include "ResultCache.h"
+#include "Trajectory.h"
 
 /**
  * \file MainWindow.h
@@ -78,16 +88,41 @@ class MainWindow {
    */
   HWND GetHwnd() const { return m_hWnd; }
 
+  /**
+   * \brief      .
+   *
+   *    ,      
+   *     (. \c Trace::DumpChromeJson).
+   *
+   * \param path   JSON- .
+   */
+  void SetTracePath(const std::string& path) { m_tracePath = path; }
+
+  /**
+   * \brief        .
+   *
+   *    ,     \c LiveAcquisition:
+   *    \c LIVE_CHART_POINTS   
+   *     \c LIVE_FRAME_MS,  n  k   .
+   *
+   * \param source      (. \c LiveAcquisition::Start).
+   */
+  void SetLiveSource(const std::string& source) { m_liveSource = source; }
+
   // ,     :
   std::vector<HWND>
       m_EditsCa;  ///<       Ca.
   std::vector<HWND>
       m_EditsTm;  ///<       t.
+  std::vector<HWND>
+      m_EditsSigma;  ///<    Ca (   ).
 
   HWND m_hPointsEdit;  ///<     .
   HWND m_hCbEdit;  ///<      Cb.
   HWND m_hCcEdit;  ///<      Cc.
   HWND m_hCoordLabel;  ///<     .
+  HWND m_hMethodCombo;  ///<    .
+  HWND m_hRateCombo;  ///<     .
 
   //   ()
   double m_n;  ///<   .
@@ -191,6 +226,159 @@ class MainWindow {
    */
   void OnMouseMove(WPARAM wParam, LPARAM lParam);
 
+  /**
+   * \brief        .
+   *
+   *  \c m_scene.Ca  \c m_scene.Tm   \c m_nPoints
+   * .
+   */
+  void ReadSeries();
+
+  /**
+   * \brief   .
+   *
+   *    (\c m_sceneDirty),    ,
+   *      .  
+   *       .  
+   *         .
+   *
+   * \param rcChart   .
+   */
+  void RefreshChartCache(const RECT& rcChart);
+
+  /**
+   * \brief      .
+   *
+   *  \c m_scene.models  \c m_modelFits   .
+   */
+  void BuildModelCurves();
+
+  /**
+   * \brief    .
+   *
+   *  \c m_scene.info     
+   *  (. \c ComputeSamplingInfo).
+   */
+  void BuildSamplingInfo();
+
+  /**
+   * \brief  WM_MOUSEWHEEL:  .
+   *
+   *      ;   Shift
+   *    .
+   *
+   * \param wParam     .
+   * \param lParam   .
+   */
+  void OnMouseWheel(WPARAM wParam, LPARAM lParam);
+
+  /**
+   * \brief       Chrome trace.
+   *
+   *  ,  \c SetTracePath,  
+   * chem_trace_<pid>.json   .
+   *
+   * \param notify     .
+   */
+  void DumpTrace(bool notify);
+
+  /// \brief     \c m_liveSource (WM_CREATE).
+  void StartLive();
+
+  /**
+   * \brief      (WM_TIMER).
+   *
+   *   ,   ,   n, k 
+   *     .
+   */
+  void OnLiveFrame();
+
+  /**
+   * \brief     CSV/TSV,  .
+   *
+   *      \c FileWatcher:  
+   *         
+   *  (\c OnDataFileChanged).
+   */
+  void OnImportFile();
+
+  /**
+   * \brief     (WM_DATA_FILE_CHANGED).
+   *
+   *     (\c IncrementalDataset); n, k, r
+   *          .
+   *     ,    .
+   */
+  void OnDataFileChanged();
+
+  /**
+   * \brief  ,     (, 
+   *  ).
+   */
+  void OnPasteTable();
+
+  /**
+   * \brief      .
+   *
+   *    \c MAX_POINTS,    \c MAX_POINTS ,
+   *      (   ), 
+   *     .
+   *
+   * \param data  .
+   * \param interactive      
+   *         (false      ).
+   */
+  void ApplyImportedData(const ImportedData& data, bool interactive = true);
+
+  /**
+   * \brief     (WM_LBUTTONDOWN).
+   *
+   * \param lParam     .
+   */
+  void OnLButtonDown(LPARAM lParam);
+
+  /// \brief    .
+  RECT GetChartRect() const;
+
+  /// \brief    .
+  void InvalidateChart();
+
+  /**
+   * \brief  ( )     XOR.
+   *
+   *          .
+   *
+   * \param pt   .
+   */
+  void DrawSnapMarker(POINT pt);
+
+  ChartScene m_scene;  ///< ,    .
+  bool m_sceneDirty;   ///<      .
+  ChartLayout m_layout;  ///<     .
+  bool m_zoomed;       ///<    .
+  ChartBounds m_view;  ///<     .
+  bool m_panning;      ///<     .
+  POINT m_panStart;    ///<   .
+  ChartBounds m_panView;  ///<     .
+  bool m_snapVisible;  ///<     .
+  POINT m_snapPt;      ///<    .
+  std::string m_tracePath;  ///<    .
+  std::string m_liveSource;  ///<    (  ).
+  std::unique_ptr<LiveAcquisition> m_live;  ///<   .
+  std::vector<double> m_liveTm;  ///<    ().
+  std::vector<double> m_liveCa;  ///<   ().
+  IncrementalDataset m_watched;  ///<    .
+  FileWatcher m_fileWatch;       ///<    .
+  ResultCache m_cache;  ///<    ( + ).
+  /// ,    (   ); 
+  ///   .
+  std::vector<unsigned char> m_fitInliers;
+  ///     (   ).
+  std::vector<double> m_fitSigma;
+  /// ,    (   
+  /// );    Ca  t     .
+  std::vector<ModelFit> m_modelFits;
+
   bool m_inChartArea;  ///< , ,     
                        ///< .
   bool m_initializing;  ///< , ,     
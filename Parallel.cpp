@@ -0,0 +1,392 @@
+/**
+ * \file Parallel.cpp
+ * \brief  \c ParallelFor       .
+ */
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "Trace.h"
+
+namespace {
+
+///     ( ).
+constexpr size_t kDequeCapacity = 1024;
+///   ,     ( ).
+constexpr size_t kSplitsPerWorker = 8;
+///         .
+constexpr int kSpinRounds = 64;
+///     .
+constexpr size_t kExternalSlot = static_cast<size_t>(-1);
+
+///   \c ParallelFor.
+struct Job {
+  const RangeBody* body = nullptr;
+  size_t leaf = 1;  ///<  ,    .
+  std::atomic<size_t> remaining{0};  ///<    .
+  std::mutex errorMutex;
+  std::exception_ptr error;  ///<     .
+  size_t errorBegin = 0;
+};
+
+///  [begin, end)  \a job.
+struct Task {
+  Job* job;
+  size_t begin;
+  size_t end;
+};
+
+/**
+ *   :        (
+ * ,      ),    
+ *  (  ).  :   
+ *    .
+ */
+class alignas(64) TaskDeque {
+ public:
+  bool Push(const Task& task) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_bottom - m_top == kDequeCapacity) return false;
+    m_items[m_bottom++ & (kDequeCapacity - 1)] = task;
+    return true;
+  }
+
+  bool Pop(Task& task) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_bottom == m_top) return false;
+    task = m_items[--m_bottom & (kDequeCapacity - 1)];
+    return true;
+  }
+
+  bool Steal(Task& task) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_bottom == m_top) return false;
+    task = m_items[m_top++ & (kDequeCapacity - 1)];
+    return true;
+  }
+
+ private:
+  std::mutex m_mutex;
+  size_t m_top = 0;
+  size_t m_bottom = 0;
+  Task m_items[kDequeCapacity];
+};
+
+///      NUMA.
+struct CpuSlot {
+  unsigned group;  ///<   (Windows),  0.
+  unsigned cpu;    ///<   ( ).
+  unsigned node;   ///<  NUMA.
+};
+
+#if defined(__linux__)
+///     "0-3,8-11".
+std::vector<unsigned> ParseCpuList(const char* text) {
+  std::vector<unsigned> cpus;
+  while (*text != '\0' && *text != '\n') {
+    char* end = nullptr;
+    const unsigned long first = std::strtoul(text, &end, 10);
+    if (end == text) break;
+    unsigned long last = first;
+    text = end;
+    if (*text == '-') {
+      last = std::strtoul(text + 1, &end, 10);
+      text = end;
+    }
+    for (unsigned long c = first; c <= last; c++) {
+      cpus.push_back(static_cast<unsigned>(c));
+    }
+    if (*text == ',') text++;
+  }
+  return cpus;
+}
+#endif
+
+/**
+ *   ,    NUMA: 
+ *      .
+ */
+std::vector<CpuSlot> NumaOrderedCpus() {
+  std::vector<CpuSlot> slots;
+#if defined(_WIN32)
+  ULONG highest = 0;
+  if (!GetNumaHighestNodeNumber(&highest)) return slots;
+  for (ULONG node = 0; node <= highest; node++) {
+    GROUP_AFFINITY affinity = {};
+    if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity)) {
+      continue;
+    }
+    for (unsigned bit = 0; bit < sizeof(ULONG_PTR) * 8; bit++) {
+      if (affinity.Mask & (static_cast<ULONG_PTR>(1) << bit)) {
+        slots.push_back({affinity.Group, bit, static_cast<unsigned>(node)});
+      }
+    }
+  }
+#elif defined(__linux__)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return slots;
+  std::vector<unsigned char> seen(CPU_SETSIZE, 0);
+  for (unsigned node = 0; node < 1024; node++) {
+    char path[64];
+    std::snprintf(path, sizeof(path),
+                  "/sys/devices/system/node/node%u/cpulist", node);
+    FILE* f = std::fopen(path, "r");
+    if (!f) {
+      if (node > 0) break;  //   
+      continue;
+    }
+    char text[4096] = {0};
+    const bool ok = std::fgets(text, sizeof(text), f) != nullptr;
+    std::fclose(f);
+    if (!ok) continue;
+    for (unsigned cpu : ParseCpuList(text)) {
+      if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed) && !seen[cpu]) {
+        seen[cpu] = 1;
+        slots.push_back({0, cpu, node});
+      }
+    }
+  }
+  //         
+  for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed) && !seen[cpu]) slots.push_back({0, cpu, 0});
+  }
+#endif
+  return slots;
+}
+
+///     .
+void PinCurrentThread(const CpuSlot& slot) {
+#if defined(_WIN32)
+  GROUP_AFFINITY affinity = {};
+  affinity.Group = static_cast<WORD>(slot.group);
+  affinity.Mask = static_cast<ULONG_PTR>(1) << slot.cpu;
+  SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+#elif defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(slot.cpu, &set);
+  sched_setaffinity(0, sizeof(set), &set);
+#else
+  (void)slot;
+#endif
+}
+
+///      (CHEM_PIN=1).
+bool PinningRequested() {
+  const char* env = std::getenv("CHEM_PIN");
+  return env != nullptr && std::strtol(env, nullptr, 10) > 0;
+}
+
+///      .
+thread_local size_t t_slot = kExternalSlot;
+
+/**
+ *  : \c ParallelWorkerCount() - 1    .
+ *      ;       .
+ */
+class TaskPool {
+ public:
+  static TaskPool& Instance() {
+    static TaskPool pool(ParallelWorkerCount() - 1);
+    return pool;
+  }
+
+  size_t Threads() const { return m_workers.size() + 1; }
+
+  void Run(size_t count, size_t leaf, const RangeBody& body) {
+    Job job;
+    job.body = &body;
+    job.leaf = leaf;
+    job.remaining.store(count, std::memory_order_relaxed);
+    const size_t self = Slot();
+    //     ,   ;
+    //    ,     
+    Execute(self, {&job, 0, count});
+    int idle = 0;
+    while (job.remaining.load(std::memory_order_acquire) != 0) {
+      Task task;
+      if (FindTask(self, task)) {
+        Execute(self, task);
+        idle = 0;
+      } else if (++idle > kSpinRounds) {
+        std::this_thread::yield();
+      }
+    }
+    if (job.error) std::rethrow_exception(job.error);
+  }
+
+ private:
+  explicit TaskPool(size_t workers) : m_deques(workers + 1) {
+    for (auto& deque : m_deques) deque.reset(new TaskDeque);
+    std::vector<CpuSlot> cpus;
+    if (PinningRequested()) cpus = NumaOrderedCpus();
+    //    ()    
+    m_nodes.assign(workers + 1, 0);
+    for (size_t i = 0; i < workers && !cpus.empty(); i++) {
+      m_nodes[i] = cpus[(i + 1) % cpus.size()].node;
+    }
+    //  :     ,   
+    // ,        
+    m_victims.resize(workers + 1);
+    for (size_t self = 0; self <= workers; self++) {
+      std::vector<size_t>& order = m_victims[self];
+      for (int pass = 0; pass < 2; pass++) {
+        for (size_t d = 1; d <= workers; d++) {
+          const size_t v = (self + d) % (workers + 1);
+          if (v == workers || v == self) continue;
+          const bool near = self == workers || m_nodes[v] == m_nodes[self];
+          if (near == (pass == 0)) order.push_back(v);
+        }
+      }
+      if (self != workers) order.push_back(workers);
+    }
+    m_workers.reserve(workers);
+    for (size_t i = 0; i < workers; i++) {
+      const bool pin = !cpus.empty();
+      const CpuSlot cpu = pin ? cpus[(i + 1) % cpus.size()] : CpuSlot{};
+      m_workers.emplace_back([this, i, pin, cpu] {
+        if (pin) PinCurrentThread(cpu);
+        WorkerLoop(i);
+      });
+    }
+  }
+
+  ~TaskPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_sleepMutex);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& th : m_workers) th.join();
+  }
+
+  size_t Slot() const {
+    return t_slot == kExternalSlot ? m_workers.size() : t_slot;
+  }
+
+  bool Push(size_t self, const Task& task) {
+    //    :    
+    m_queued.fetch_add(1, std::memory_order_seq_cst);
+    if (!m_deques[self]->Push(task)) {
+      m_queued.fetch_sub(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (m_sleeping.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock(m_sleepMutex);
+      m_wake.notify_one();
+    }
+    return true;
+  }
+
+  bool FindTask(size_t self, Task& task) {
+    bool found = m_deques[self]->Pop(task);
+    for (size_t i = 0; !found && i < m_victims[self].size(); i++) {
+      found = m_deques[m_victims[self][i]]->Steal(task);
+    }
+    if (found) m_queued.fetch_sub(1, std::memory_order_relaxed);
+    return found;
+  }
+
+  ///   ,    \c Job::leaf,   .
+  void Execute(size_t self, Task task) {
+    Job& job = *task.job;
+    while (task.end - task.begin > job.leaf) {
+      const size_t mid = task.begin + (task.end - task.begin) / 2;
+      //  :   
+      if (!Push(self, {&job, mid, task.end})) break;
+      task.end = mid;
+    }
+    try {
+      (*job.body)(task.begin, task.end);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(job.errorMutex);
+      if (!job.error || task.begin < job.errorBegin) {
+        job.error = std::current_exception();
+        job.errorBegin = task.begin;
+      }
+    }
+    //    job:     
+    job.remaining.fetch_sub(task.end - task.begin, std::memory_order_acq_rel);
+  }
+
+  void WorkerLoop(size_t self) {
+    t_slot = self;
+    int idle = 0;
+    while (true) {
+      Task task;
+      if (FindTask(self, task)) {
+        Execute(self, task);
+        idle = 0;
+        continue;
+      }
+      if (++idle < kSpinRounds) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(m_sleepMutex);
+      m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+      m_wake.wait(lock, [this] {
+        return m_stop || m_queued.load(std::memory_order_seq_cst) != 0;
+      });
+      m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+      if (m_stop) return;
+      idle = 0;
+    }
+  }
+
+  std::vector<std::unique_ptr<TaskDeque>> m_deques;
+  std::vector<unsigned> m_nodes;                 ///<  NUMA .
+  std::vector<std::vector<size_t>> m_victims;    ///<  .
+  std::vector<std::thread> m_workers;
+  std::atomic<size_t> m_queued{0};   ///<    .
+  std::atomic<size_t> m_sleeping{0};  ///<   .
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake;
+  bool m_stop = false;
+};
+
+}  // namespace
+
+size_t ParallelWorkerCount() {
+  static const size_t count = [] {
+    if (const char* env = std::getenv("CHEM_THREADS")) {
+      const long v = std::strtol(env, nullptr, 10);
+      if (v > 0) return static_cast<size_t>(v);
+    }
+    const unsigned hw = std::thread::hardware_concurrency();
+    return static_cast<size_t>(hw > 0 ? hw : 1);
+  }();
+  return count;
+}
+
+void ParallelFor(size_t count, size_t grain, const RangeBody& body) {
+  if (count == 0) return;
+  if (grain == 0) grain = 1;
+  if (count <= grain || ParallelWorkerCount() <= 1) {
+    body(0, count);
+    return;
+  }
+
+  TRACE_SCOPE("ParallelFor");
+  TaskPool& pool = TaskPool::Instance();
+  const size_t parts = pool.Threads() * kSplitsPerWorker;
+  const size_t leaf = std::max(grain, (count + parts - 1) / parts);
+  pool.Run(count, leaf, body);
+}
@@ -0,0 +1,76 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * \file Parallel.h
+ * \brief      .
+ *
+ *       \c ParallelFor, 
+ *          .
+ *
+ *     ,    . 
+ *    :    , 
+ *         ,  
+ *       .  , 
+ *  ,     ,  
+ *  ( ,     )  
+ *     .
+ *
+ *  \c CHEM_PIN=1       
+ *  NUMA       .   
+ * :      (, 
+ * \c chem_shard)        .
+ */
+
+/**
+ * \brief  :    [begin, end).
+ *
+ *      : \c ParallelFor  
+ *    ,    (   
+ * ,  \c std::function)  .
+ */
+class RangeBody {
+ public:
+  template <class F, class = std::enable_if_t<
+                         !std::is_same<std::decay_t<F>, RangeBody>::value>>
+  RangeBody(const F& body)  // : ParallelFor(n, grain, [&](...) {})
+      : m_body(&body), m_call([](const void* b, size_t begin, size_t end) {
+          (*static_cast<const F*>(b))(begin, end);
+        }) {}
+
+  void operator()(size_t begin, size_t end) const {
+    m_call(m_body, begin, end);
+  }
+
+ private:
+  const void* m_body;
+  void (*m_call)(const void*, size_t, size_t);
+};
+
+/**
+ * \brief   ,  \c ParallelFor.
+ *
+ *      ;  
+ * \c CHEM_THREADS    (1   ).
+ */
+size_t ParallelWorkerCount();
+
+/**
+ * \brief  \a body   [0, count)  .
+ *
+ *       \a grain    
+ * 1/8    (count / (8 *  )).   
+ * \a grain    .    
+ * \c ParallelFor .   \a body 
+ *      (   ).
+ *
+ * \param count  .
+ * \param grain   .
+ * \param body  .
+ */
+void ParallelFor(size_t count, size_t grain, const RangeBody& body);
+
+#endif  // PARALLEL_H
@@ -0,0 +1,119 @@
+/**
+ * \file PerfCounters.cpp
+ * \brief   perf_event_open (Linux)  .
+ */
+
+#include "PerfCounters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace {
+
+#if defined(__linux__)
+int OpenEvent(uint64_t config, int groupFd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = (groupFd == -1) ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // ,   ( ParallelFor),   
+  // ;       
+  attr.inherit = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+#endif
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  for (size_t c = 0; c < PERF_COUNTER_COUNT; c++) m_fd[c] = -1;
+#if defined(__linux__)
+  static const uint64_t kConfig[PERF_COUNTER_COUNT] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  //      
+  for (size_t c = 0; c < PERF_COUNTER_COUNT; c++) {
+    m_fd[c] = OpenEvent(kConfig[c], m_leader);
+    if (m_fd[c] >= 0 && m_leader < 0) m_leader = m_fd[c];
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+  for (size_t c = 0; c < PERF_COUNTER_COUNT; c++) {
+    if (m_fd[c] >= 0) close(m_fd[c]);
+  }
+#endif
+}
+
+bool PerfCounters::Available() const { return m_leader >= 0; }
+
+void PerfCounters::Start() {
+#if defined(__linux__)
+  if (m_leader >= 0) {
+    ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#endif
+  m_start = std::chrono::steady_clock::now();
+}
+
+PerfSample PerfCounters::Stop() {
+  const auto end = std::chrono::steady_clock::now();
+  PerfSample sample;
+#if defined(__linux__)
+  if (m_leader >= 0) {
+    ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // ,     ;    
+    //    
+    for (size_t c = 0; c < PERF_COUNTER_COUNT; c++) {
+      if (m_fd[c] < 0) continue;
+      uint64_t buf[3] = {};
+      if (read(m_fd[c], buf, sizeof(buf)) !=
+              static_cast<ssize_t>(sizeof(buf)) ||
+          buf[2] == 0) {
+        continue;  //       
+      }
+      sample.values[c] = buf[0];
+      if (buf[2] < buf[1]) {
+        sample.values[c] = static_cast<uint64_t>(
+            static_cast<double>(buf[0]) * static_cast<double>(buf[1]) /
+            static_cast<double>(buf[2]));
+        sample.scaled[c] = true;
+      }
+      sample.valid[c] = true;
+    }
+  }
+#endif
+  sample.seconds = std::chrono::duration<double>(end - m_start).count();
+  return sample;
+}
+
+const char* PerfCounters::Name(size_t counter) {
+  switch (counter) {
+    case PERF_CYCLES:
+      return "cycles";
+    case PERF_INSTRUCTIONS:
+      return "instructions";
+    case PERF_CACHE_MISSES:
+      return "cache_misses";
+    case PERF_BRANCH_MISSES:
+      return "branch_misses";
+    default:
+      return "";
+  }
+}
@@ -0,0 +1,77 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \file PerfCounters.h
+ * \brief     .
+ *
+ *  Linux      perf_event_open (
+ *  ),        
+ *  .   ,   
+ * ,    :     
+ * \c ParallelFor,        .  
+ * ,   ,      
+ * ;        
+ *   \c PerfSample::scaled.
+ *
+ *     (perf_event_paranoid, )  
+ *   ,   
+ * ,    .    
+ *  .
+ */
+
+/**
+ * \brief   .
+ */
+enum PerfCounter : size_t {
+  PERF_CYCLES,         ///<  .
+  PERF_INSTRUCTIONS,   ///<  .
+  PERF_CACHE_MISSES,   ///<    .
+  PERF_BRANCH_MISSES,  ///<   .
+  PERF_COUNTER_COUNT
+};
+
+/**
+ * \brief   .
+ */
+struct PerfSample {
+  double seconds = 0.0;                        ///<  .
+  uint64_t values[PERF_COUNTER_COUNT] = {};    ///<  .
+  bool valid[PERF_COUNTER_COUNT] = {};         ///<  .
+  ///      :  .
+  bool scaled[PERF_COUNTER_COUNT] = {};
+};
+
+/**
+ * \brief  ;     \c Start / \c Stop.
+ */
+class PerfCounters {
+ public:
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  /// \c true,       .
+  bool Available() const;
+
+  ///      .
+  void Start();
+
+  ///     .
+  PerfSample Stop();
+
+  ///     ("cycles", "instructions", ...).
+  static const char* Name(size_t counter);
+
+ private:
+  int m_fd[PERF_COUNTER_COUNT];
+  int m_leader = -1;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+#endif  // PERFCOUNTERS_H
@@ -0,0 +1,393 @@
+/**
+ * \file RateEstimator.cpp
+ * \brief        dCa/dt.
+ */
+
+#include "RateEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RATE_USE_SSE2 1
+#endif
+
+#include "ChemCalculation.h"
+#include "Trace.h"
+
+namespace {
+
+///  :    i    [i, i+1].
+void ForwardDifference(const std::vector<double>& Ca,
+                       const std::vector<double>& Tm,
+                       std::vector<double>& d) {
+  const size_t n = Ca.size();
+  d.assign(n, 0.0);
+  if (n < 2) return;
+  for (size_t i = 0; i + 1 < n; i++) {
+    d[i] = (Ca[i + 1] - Ca[i]) / (Tm[i + 1] - Tm[i]);
+  }
+  d[n - 1] = d[n - 2];
+}
+
+/**
+ *     \a order,   
+ *   \a w     -m..m.  o (0..w-1)
+ *       o - m.
+ */
+std::vector<std::vector<double>> SavitzkyGolayCoefficients(int w, int order) {
+  const int m = w / 2;
+  const int p = order + 1;
+  //   G * X = A^T,  A[j][q] = (j - m)^q
+  std::vector<double> G(p * p, 0.0);
+  std::vector<double> X(p * w, 0.0);
+  for (int j = 0; j < w; j++) {
+    double pw[16];
+    pw[0] = 1.0;
+    for (int q = 1; q < p; q++) pw[q] = pw[q - 1] * (j - m);
+    for (int a = 0; a < p; a++) {
+      for (int b = 0; b < p; b++) G[a * p + b] += pw[a] * pw[b];
+      X[a * w + j] = pw[a];
+    }
+  }
+  //      
+  for (int c = 0; c < p; c++) {
+    int piv = c;
+    for (int r = c + 1; r < p; r++) {
+      if (std::fabs(G[r * p + c]) > std::fabs(G[piv * p + c])) piv = r;
+    }
+    if (piv != c) {
+      for (int k = 0; k < p; k++) std::swap(G[c * p + k], G[piv * p + k]);
+      for (int k = 0; k < w; k++) std::swap(X[c * w + k], X[piv * w + k]);
+    }
+    const double inv = 1.0 / G[c * p + c];
+    for (int k = 0; k < p; k++) G[c * p + k] *= inv;
+    for (int k = 0; k < w; k++) X[c * w + k] *= inv;
+    for (int r = 0; r < p; r++) {
+      if (r == c) continue;
+      const double f = G[r * p + c];
+      if (f == 0.0) continue;
+      for (int k = 0; k < p; k++) G[r * p + k] -= f * G[c * p + k];
+      for (int k = 0; k < w; k++) X[r * w + k] -= f * X[c * w + k];
+    }
+  }
+  //   sum a_q s^q   s = o - m
+  std::vector<std::vector<double>> coef(w, std::vector<double>(w, 0.0));
+  for (int o = 0; o < w; o++) {
+    const double s = o - m;
+    double sp = 1.0;  // s^(q-1)
+    for (int q = 1; q < p; q++) {
+      for (int j = 0; j < w; j++) coef[o][j] += q * sp * X[q * w + j];
+      sp *= s;
+    }
+  }
+  return coef;
+}
+
+///   : out[i] = scale * sum_j c[j] * v[i - m + j].
+void Convolve(const std::vector<double>& v, const std::vector<double>& c,
+              double scale, size_t begin, size_t end,
+              std::vector<double>& out) {
+  const size_t w = c.size();
+  const size_t m = w / 2;
+  size_t i = begin;
+#ifdef RATE_USE_SSE2
+  //     :     , 
+  //  ,      
+  const __m128d vs = _mm_set1_pd(scale);
+  for (; i + 2 <= end; i += 2) {
+    __m128d acc = _mm_setzero_pd();
+    const double* src = v.data() + (i - m);
+    for (size_t j = 0; j < w; j++) {
+      acc = _mm_add_pd(acc,
+                       _mm_mul_pd(_mm_set1_pd(c[j]), _mm_loadu_pd(src + j)));
+    }
+    _mm_storeu_pd(out.data() + i, _mm_mul_pd(acc, vs));
+  }
+#endif
+  for (; i < end; i++) {
+    double acc = 0.0;
+    const double* src = v.data() + (i - m);
+    for (size_t j = 0; j < w; j++) acc += c[j] * src[j];
+    out[i] = acc * scale;
+  }
+}
+
+///      n:     
+/// ,    .
+std::vector<std::vector<double>> SavitzkyGolayFilter(size_t n, int window,
+                                                     int order) {
+  int w = std::max(window, 3);
+  if (static_cast<size_t>(w) > n) w = static_cast<int>(n);
+  if (w % 2 == 0) w--;
+  const int p = std::min(std::max(order, 1), std::min(w - 1, 14));
+  return SavitzkyGolayCoefficients(w, p);
+}
+
+///  :       ,
+///     /    .
+void ApplyFilter(const std::vector<double>& v,
+                 const std::vector<std::vector<double>>& coef, double scale,
+                 std::vector<double>& out) {
+  const size_t n = v.size();
+  const size_t w = coef.size();
+  const size_t m = w / 2;
+  out.assign(n, 0.0);
+  Convolve(v, coef[m], scale, m, n - m, out);
+  for (size_t i = 0; i < m; i++) {
+    double head = 0.0, tail = 0.0;
+    for (size_t j = 0; j < w; j++) {
+      head += coef[i][j] * v[j];
+      tail += coef[w - m + i][j] * v[n - w + j];
+    }
+    out[i] = head * scale;
+    out[n - m + i] = tail * scale;
+  }
+}
+
+void SavitzkyGolay(const std::vector<double>& Ca, const std::vector<double>& Tm,
+                   int window, int order, std::vector<double>& d) {
+  TRACE_SCOPE("Rate::SavitzkyGolay");
+  const size_t n = Ca.size();
+  const double h = (Tm[n - 1] - Tm[0]) / (n - 1);
+  ApplyFilter(Ca, SavitzkyGolayFilter(n, window, order), 1.0 / h, d);
+}
+
+///   :  , 
+/// var(d_i) = sum c_j^2 * sigma_j^2 / h^2.
+void SavitzkyGolayVariance(const std::vector<double>& sigma,
+                           const std::vector<double>& Tm, int window,
+                           int order, std::vector<double>& var) {
+  const size_t n = sigma.size();
+  const double h = (Tm[n - 1] - Tm[0]) / (n - 1);
+  std::vector<std::vector<double>> coef = SavitzkyGolayFilter(n, window, order);
+  for (auto& row : coef) {
+    for (double& c : row) c *= c;
+  }
+  std::vector<double> s2(n);
+  for (size_t i = 0; i < n; i++) s2[i] = sigma[i] * sigma[i];
+  ApplyFilter(s2, coef, 1.0 / (h * h), var);
+}
+
+/**
+ *    ( ): 
+ * sum (y_i - f_i)^2 / var_i + lambda * int f''^2.  
+ * (R + lambda * Q^T V Q) g = Q^T y  LDL^T-  O(N).
+ */
+void SmoothingSpline(const std::vector<double>& t, const std::vector<double>& y,
+                     double smoothing, const std::vector<double>* variance,
+                     std::vector<double>& d) {
+  TRACE_SCOPE("Rate::SmoothingSpline");
+  const size_t n = t.size();
+  const size_t k = n - 2;  //   
+  const double hMean = (t[n - 1] - t[0]) / (n - 1);
+  const double lambda = std::max(smoothing, 0.0) * hMean * hMean * hMean;
+
+  std::vector<double> h(n - 1);
+  for (size_t i = 0; i + 1 < n; i++) h[i] = t[i + 1] - t[i];
+  auto var = [variance](size_t i) {
+    return variance ? (*variance)[i] : 1.0;
+  };
+
+  //   : m0  , m1, m2   
+  std::vector<double> m0(k), m1(k, 0.0), m2(k, 0.0), rhs(k);
+  for (size_t c = 0; c < k; c++) {
+    const size_t j = c + 1;
+    const double qa = 1.0 / h[j - 1];
+    const double qc = 1.0 / h[j];
+    const double qb = -qa - qc;
+    m0[c] = (h[j - 1] + h[j]) / 3.0 +
+            lambda * (qa * qa * var(j - 1) + qb * qb * var(j) +
+                      qc * qc * var(j + 1));
+    if (c + 1 < k) {
+      const double na = 1.0 / h[j];
+      const double nc = 1.0 / h[j + 1];
+      const double nb = -na - nc;
+      m1[c] = h[j] / 6.0 + lambda * (qb * na * var(j) + qc * nb * var(j + 1));
+    }
+    if (c + 2 < k) {
+      m2[c] = lambda * qc * (1.0 / h[j + 1]) * var(j + 1);
+    }
+    rhs[c] = qa * y[j - 1] + qb * y[j] + qc * y[j + 1];
+  }
+
+  // LDL^T: l1[c] = L[c][c-1], l2[c] = L[c][c-2]
+  std::vector<double> dg(k), l1(k, 0.0), l2(k, 0.0);
+  for (size_t c = 0; c < k; c++) {
+    if (c >= 2) l2[c] = m2[c - 2] / dg[c - 2];
+    if (c >= 1) {
+      double v = m1[c - 1];
+      if (c >= 2) v -= l2[c] * dg[c - 2] * l1[c - 1];
+      l1[c] = v / dg[c - 1];
+    }
+    dg[c] = m0[c];
+    if (c >= 1) dg[c] -= l1[c] * l1[c] * dg[c - 1];
+    if (c >= 2) dg[c] -= l2[c] * l2[c] * dg[c - 2];
+  }
+  std::vector<double> g(k);
+  for (size_t c = 0; c < k; c++) {
+    double v = rhs[c];
+    if (c >= 1) v -= l1[c] * g[c - 1];
+    if (c >= 2) v -= l2[c] * g[c - 2];
+    g[c] = v;
+  }
+  for (size_t c = 0; c < k; c++) g[c] /= dg[c];
+  for (size_t c = k; c-- > 0;) {
+    if (c + 1 < k) g[c] -= l1[c + 1] * g[c + 1];
+    if (c + 2 < k) g[c] -= l2[c + 2] * g[c + 2];
+  }
+
+  //     (   0)   
+  std::vector<double> gam(n, 0.0);
+  for (size_t c = 0; c < k; c++) gam[c + 1] = g[c];
+  std::vector<double> f(n);
+  for (size_t i = 0; i < n; i++) {
+    double qg = 0.0;
+    if (i >= 1) qg += gam[i - 1] / h[i - 1];
+    if (i + 1 < n) qg += gam[i + 1] / h[i];
+    const double hl = (i >= 1) ? 1.0 / h[i - 1] : 0.0;
+    const double hr = (i + 1 < n) ? 1.0 / h[i] : 0.0;
+    qg -= gam[i] * (hl + hr);
+    f[i] = y[i] - lambda * var(i) * qg;
+  }
+
+  d.resize(n);
+  for (size_t i = 0; i + 1 < n; i++) {
+    d[i] = (f[i + 1] - f[i]) / h[i] - h[i] * (2.0 * gam[i] + gam[i + 1]) / 6.0;
+  }
+  d[n - 1] = (f[n - 1] - f[n - 2]) / h[n - 2] +
+             h[n - 2] * (gam[n - 2] + 2.0 * gam[n - 1]) / 6.0;
+}
+
+}  // namespace
+
+bool IsUniformGrid(const std::vector<double>& Tm) {
+  const size_t n = Tm.size();
+  if (n < 3) return true;
+  const double h = (Tm[n - 1] - Tm[0]) / (n - 1);
+  for (size_t i = 0; i + 1 < n; i++) {
+    if (std::fabs((Tm[i + 1] - Tm[i]) - h) > 1e-6 * std::fabs(h)) return false;
+  }
+  return true;
+}
+
+///     (   ).
+static bool UsesSavitzkyGolay(const std::vector<double>& Tm,
+                              const RateOptions& options) {
+  return options.method == RateMethod::SavitzkyGolay && IsUniformGrid(Tm);
+}
+
+void EstimateDerivative(const std::vector<double>& Ca,
+                        const std::vector<double>& Tm,
+                        const RateOptions& options, std::vector<double>& dCdt,
+                        const std::vector<double>* sigma) {
+  const size_t n = std::min(Ca.size(), Tm.size());
+  if (n < 3 || options.method == RateMethod::ForwardDifference) {
+    ForwardDifference(Ca, Tm, dCdt);
+    return;
+  }
+  if (UsesSavitzkyGolay(Tm, options)) {
+    SavitzkyGolay(Ca, Tm, options.window, options.polyOrder, dCdt);
+    return;
+  }
+  if (sigma == nullptr) {
+    SmoothingSpline(Tm, Ca, options.smoothing, nullptr, dCdt);
+    return;
+  }
+  //    ,    
+  //     
+  std::vector<double> variance(n);
+  double mean = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    variance[i] = (*sigma)[i] * (*sigma)[i];
+    mean += variance[i];
+  }
+  mean /= n;
+  for (double& v : variance) v /= mean;
+  SmoothingSpline(Tm, Ca, options.smoothing, &variance, dCdt);
+}
+
+void EstimateDerivativeVariance(const std::vector<double>& Tm,
+                                const std::vector<double>& sigma,
+                                const RateOptions& options,
+                                std::vector<double>& var) {
+  const size_t n = std::min(sigma.size(), Tm.size());
+  var.assign(n, 0.0);
+  if (n < 2) return;
+  auto diffVar = [&](size_t a, size_t b) {
+    const double dt = Tm[b] - Tm[a];
+    return (sigma[a] * sigma[a] + sigma[b] * sigma[b]) / (dt * dt);
+  };
+  if (n < 3 || options.method == RateMethod::ForwardDifference) {
+    for (size_t i = 0; i + 1 < n; i++) var[i] = diffVar(i, i + 1);
+    var[n - 1] = var[n - 2];
+    return;
+  }
+  if (UsesSavitzkyGolay(Tm, options)) {
+    SavitzkyGolayVariance(sigma, Tm, options.window, options.polyOrder, var);
+    return;
+  }
+  //        ;
+  //       
+  var[0] = diffVar(0, 1);
+  for (size_t i = 1; i + 1 < n; i++) var[i] = diffVar(i - 1, i + 1);
+  var[n - 1] = diffVar(n - 2, n - 1);
+}
+
+void BuildRateLogPoints(const std::vector<double>& Ca,
+                        const std::vector<double>& Tm,
+                        const RateOptions& options, std::vector<double>& x,
+                        std::vector<double>& y, std::vector<size_t>& source,
+                        const std::vector<double>* sigma) {
+  if (options.method == RateMethod::ForwardDifference) {
+    ChemCalculation::BuildLogPoints(Ca, Tm, x, y);
+    source.resize(x.size());
+    for (size_t i = 0; i < source.size(); i++) source[i] = i;
+    return;
+  }
+
+  std::vector<double> dCdt;
+  EstimateDerivative(Ca, Tm, options, dCdt, sigma);
+  x.clear();
+  y.clear();
+  source.clear();
+  for (size_t i = 0; i < dCdt.size(); i++) {
+    //   A (  )   :
+    //       
+    const double w = -dCdt[i];
+    if (!(w > 1e-15) || !(Ca[i] > 1e-15)) continue;
+    x.push_back(std::log(Ca[i]));
+    y.push_back(std::log(w));
+    source.push_back(i);
+  }
+}
+
+void BuildLogWeights(const std::vector<double>& Tm,
+                     const std::vector<double>& sigma,
+                     const RateOptions& options, const std::vector<double>& x,
+                     const std::vector<double>& y,
+                     const std::vector<size_t>& source, double slope,
+                     std::vector<double>& weights) {
+  std::vector<double> varD;
+  EstimateDerivativeVariance(Tm, sigma, options, varD);
+  const size_t m = x.size();
+  weights.resize(m);
+  double sum = 0.0;
+  for (size_t i = 0; i < m; i++) {
+    const size_t s = source[i];
+    //  : var(ln W) = var(W) / W^2, var(ln Ca) =
+    // sigma^2 / Ca^2;     
+    const double varY = varD[s] * std::exp(-2.0 * y[i]);
+    const double varX = sigma[s] * sigma[s] * std::exp(-2.0 * x[i]);
+    const double v = varY + slope * slope * varX;
+    weights[i] = (v > 0.0 && std::isfinite(v)) ? 1.0 / v : 0.0;
+    sum += weights[i];
+  }
+  //    1:   ,    m
+  if (sum > 0.0) {
+    const double scale = m / sum;
+    for (double& w : weights) w *= scale;
+  }
+}
@@ -0,0 +1,137 @@
+#ifndef RATEESTIMATOR_H
+#define RATEESTIMATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \file RateEstimator.h
+ * \brief    dCa/dt   .
+ *
+ *   \c ChemCalculation::Calculate    
+ *  |Ca[i+1] - Ca[i]| / dt.     
+ *        ,   
+ * ,   .     
+ * :
+ * -   ( );
+ * -       ( 
+ *     );
+ * -       (
+ *   ,   O(N)).
+ *
+ *   ln(W)  ln(Ca)   ,  
+ *   A ;  ,  
+ *  .
+ */
+
+/**
+ * \brief   .
+ */
+enum class RateMethod : uint32_t {
+  ForwardDifference = 0,  ///<     ( ).
+  SavitzkyGolay = 1,      ///<   ( ).
+  SmoothingSpline = 2,    ///<   .
+};
+
+/**
+ * \brief   .
+ */
+struct RateOptions {
+  RateMethod method = RateMethod::ForwardDifference;  ///<  .
+  int window = 7;     ///<    ().
+  int polyOrder = 2;  ///<   .
+  ///      ( )^3: 0 
+  /// ,      .
+  double smoothing = 1.0;
+};
+
+/**
+ * \brief ,      ( 
+ *         1e-6).
+ *
+ * \param Tm   ().
+ * \return \c true   .
+ */
+bool IsUniformGrid(const std::vector<double>& Tm);
+
+/**
+ * \brief   dCa/dt    .
+ *
+ *  \c RateMethod::ForwardDifference    i   
+ *  [i, i+1] (      ).
+ *       .
+ *
+ * \param Ca  .
+ * \param Tm   ( ).
+ * \param options .
+ * \param dCdt :    (N ).
+ * \param sigma   (  )  \c nullptr.
+ */
+void EstimateDerivative(const std::vector<double>& Ca,
+                        const std::vector<double>& Tm,
+                        const RateOptions& options, std::vector<double>& dCdt,
+                        const std::vector<double>* sigma = nullptr);
+
+/**
+ * \brief      .
+ *
+ *        (
+ *   Ca);      .
+ *
+ * \param Tm  .
+ * \param sigma    Ca.
+ * \param options  (  ,    ).
+ * \param var :  dCa/dt   .
+ */
+void EstimateDerivativeVariance(const std::vector<double>& Tm,
+                                const std::vector<double>& sigma,
+                                const RateOptions& options,
+                                std::vector<double>& var);
+
+/**
+ * \brief    ln(W)  ln(Ca)  .
+ *
+ *      
+ * \c ChemCalculation::BuildLogPoints (  i  
+ * [i, i+1]).        
+ *  ,  -dCa/dt > 0  Ca > 0.
+ *
+ * \param Ca  .
+ * \param Tm  .
+ * \param options .
+ * \param x : ln(Ca).
+ * \param y : ln(-dCa/dt).
+ * \param source :       .
+ * \param sigma   (  )  \c nullptr.
+ */
+void BuildRateLogPoints(const std::vector<double>& Ca,
+                        const std::vector<double>& Tm,
+                        const RateOptions& options, std::vector<double>& x,
+                        std::vector<double>& y, std::vector<size_t>& source,
+                        const std::vector<double>* sigma = nullptr);
+
+/**
+ * \brief       Ca.
+ *
+ *     ln(W)    ln(Ca), 
+ *  : 1 / (var(ln W) + n^2 * var(ln Ca)).   
+ *  1.
+ *
+ * \param Tm  .
+ * \param sigma    Ca ().
+ * \param options   .
+ * \param x  : ln(Ca).
+ * \param y  : ln(W).
+ * \param source    (. \c BuildRateLogPoints).
+ * \param slope     n.
+ * \param weights :   .
+ */
+void BuildLogWeights(const std::vector<double>& Tm,
+                     const std::vector<double>& sigma,
+                     const RateOptions& options, const std::vector<double>& x,
+                     const std::vector<double>& y,
+                     const std::vector<size_t>& source, double slope,
+                     std::vector<double>& weights);
+
+#endif  // RATEESTIMATOR_H
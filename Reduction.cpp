@@ -0,0 +1,91 @@
+/**
+ * \file Reduction.cpp
+ * \brief       .
+ */
+
+#include "Reduction.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+ReductionMode ModeFromEnvironment() {
+  const char* env = std::getenv("CHEM_REDUCTION");
+  if (env != nullptr) {
+    if (std::strcmp(env, "sequential") == 0) return ReductionMode::Sequential;
+    if (std::strcmp(env, "exact") == 0) return ReductionMode::Exact;
+  }
+  return ReductionMode::Pairwise;
+}
+
+std::atomic<int>& ModeStorage() {
+  static std::atomic<int> mode(static_cast<int>(ModeFromEnvironment()));
+  return mode;
+}
+
+}  // namespace
+
+ReductionMode GetReductionMode() {
+  return static_cast<ReductionMode>(ModeStorage().load());
+}
+
+void SetReductionMode(ReductionMode mode) {
+  ModeStorage().store(static_cast<int>(mode));
+}
+
+void ExactSum::Add(double x) {
+  if (!std::isfinite(x)) {
+    m_special += x;
+    return;
+  }
+  //   (x, partial)     hi + lo;
+  //      
+  size_t kept = 0;
+  for (size_t j = 0; j < m_partials.size(); j++) {
+    double y = m_partials[j];
+    if (std::fabs(x) < std::fabs(y)) std::swap(x, y);
+    const double hi = x + y;
+    const double lo = y - (hi - x);
+    if (lo != 0.0) m_partials[kept++] = lo;
+    x = hi;
+  }
+  m_partials.resize(kept);
+  m_partials.push_back(x);
+}
+
+void ExactSum::Add(const ExactSum& other) {
+  for (double p : other.m_partials) Add(p);
+  m_special += other.m_special;
+}
+
+double ExactSum::Value() const {
+  if (m_special != 0.0 || std::isnan(m_special)) return m_special;
+  size_t j = m_partials.size();
+  if (j == 0) return 0.0;
+  double hi = m_partials[--j];
+  double lo = 0.0;
+  while (j > 0) {
+    const double x = hi;
+    const double y = m_partials[--j];
+    hi = x + y;
+    lo = y - (hi - x);
+    if (lo != 0.0) break;
+  }
+  //         
+  if (j > 0 && ((lo < 0.0 && m_partials[j - 1] < 0.0) ||
+                (lo > 0.0 && m_partials[j - 1] > 0.0))) {
+    const double y = lo * 2.0;
+    const double x = hi + y;
+    if (y == x - hi) hi = x;
+  }
+  return hi;
+}
+
+void ExactSum::Clear() {
+  m_partials.clear();
+  m_special = 0.0;
+}
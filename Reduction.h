@@ -0,0 +1,178 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Parallel.h"
+
+/**
+ * \file Reduction.h
+ * \brief      .
+ *
+ *  double  :     
+ *  -,   n  k    .
+ *      :
+ * - \c ReductionMode::Pairwise ( )      
+ *   \c REDUCTION_LEAF ,   ,  
+ *      ,      
+ *   .   ,     . 
+ *             
+ *   ;       (O(log N)  O(N)).
+ *        ,  1%.
+ * - \c ReductionMode::Exact  ,    double (
+ *   ,  math.fsum).      ,   
+ *   ;       (
+ *   ;   \c ComputeDispersion   
+ *   ).
+ * - \c ReductionMode::Sequential       
+ *   .
+ *
+ *     \c CHEM_REDUCTION (sequential,
+ * pairwise, exact)   \c SetReductionMode.
+ */
+
+///      .
+constexpr size_t REDUCTION_LEAF = 256;
+
+///       .
+constexpr size_t REDUCTION_GRAIN = 16;
+
+/**
+ * \brief  .
+ */
+enum class ReductionMode {
+  Sequential,  ///<  ,  .
+  Pairwise,    ///<    , .
+  Exact        ///<   , .
+};
+
+/**
+ * \brief   .
+ */
+ReductionMode GetReductionMode();
+
+/**
+ * \brief       .
+ */
+void SetReductionMode(ReductionMode mode);
+
+/**
+ * \brief  :    ,
+ *             \c Value.
+ */
+class ExactSum {
+ public:
+  ///  .
+  void Add(double x);
+  ///     .
+  void Add(const ExactSum& other);
+  /// ,     double.
+  double Value() const;
+  ///  ,   .
+  void Clear();
+
+ private:
+  std::vector<double> m_partials;
+  double m_special = 0.0;  ///<  inf/NaN (  ).
+};
+
+/**
+ * \brief    \c ReduceSums,   .
+ *
+ *      ,   
+ *     .     
+ *  .
+ */
+struct ReductionScratch {
+  std::vector<double> level;    ///<    .
+  std::vector<ExactSum> exact;  ///<   .
+};
+
+/**
+ * \brief  K    \a n  .
+ *
+ * \param n  .
+ * \param term  term(i, v)   v[0..K-1] 
+ *         i;   .
+ * \param out  (K ; ).
+ * \param scratch     \c nullptr (  
+ *          ).
+ */
+template <size_t K, class Term>
+void ReduceSums(size_t n, const Term& term, double* out,
+                ReductionScratch* scratch = nullptr) {
+  const ReductionMode mode = GetReductionMode();
+  const size_t leaves = (n + REDUCTION_LEAF - 1) / REDUCTION_LEAF;
+  double v[K];
+  //        ,  
+  //     
+  if (mode == ReductionMode::Sequential ||
+      (mode == ReductionMode::Pairwise && leaves <= 1)) {
+    for (size_t k = 0; k < K; k++) out[k] = 0.0;
+    for (size_t i = 0; i < n; i++) {
+      term(i, v);
+      for (size_t k = 0; k < K; k++) out[k] += v[k];
+    }
+    return;
+  }
+
+  ReductionScratch local;
+  ReductionScratch& buffers = (scratch != nullptr) ? *scratch : local;
+  if (mode == ReductionMode::Exact) {
+    std::vector<ExactSum>& sums = buffers.exact;
+    if (sums.size() < leaves * K) sums.resize(leaves * K);
+    for (size_t j = 0; j < leaves * K; j++) sums[j].Clear();
+    ParallelFor(leaves, REDUCTION_GRAIN, [&](size_t begin, size_t end) {
+      double t[K];
+      for (size_t b = begin; b < end; b++) {
+        const size_t last = (b + 1) * REDUCTION_LEAF < n
+                                ? (b + 1) * REDUCTION_LEAF : n;
+        for (size_t i = b * REDUCTION_LEAF; i < last; i++) {
+          term(i, t);
+          for (size_t k = 0; k < K; k++) sums[b * K + k].Add(t[k]);
+        }
+      }
+    });
+    //  ,        
+    for (size_t k = 0; k < K; k++) {
+      for (size_t b = 1; b < leaves; b++) sums[k].Add(sums[b * K + k]);
+      out[k] = (leaves > 0) ? sums[k].Value() : 0.0;
+    }
+    return;
+  }
+
+  //   ,     
+  std::vector<double>& level = buffers.level;
+  level.assign(leaves * K, 0.0);
+  ParallelFor(leaves, REDUCTION_GRAIN, [&](size_t begin, size_t end) {
+    double t[K];
+    for (size_t b = begin; b < end; b++) {
+      const size_t last = (b + 1) * REDUCTION_LEAF < n
+                              ? (b + 1) * REDUCTION_LEAF : n;
+      double* s = level.data() + b * K;
+      for (size_t i = b * REDUCTION_LEAF; i < last; i++) {
+        term(i, t);
+        for (size_t k = 0; k < K; k++) s[k] += t[k];
+      }
+    }
+  });
+  size_t count = leaves;
+  while (count > 1) {
+    const size_t half = count / 2;
+    for (size_t j = 0; j < half; j++) {
+      for (size_t k = 0; k < K; k++) {
+        level[j * K + k] = level[2 * j * K + k] + level[(2 * j + 1) * K + k];
+      }
+    }
+    if (count % 2 != 0) {
+      for (size_t k = 0; k < K; k++) {
+        level[half * K + k] = level[(count - 1) * K + k];
+      }
+    }
+    count = half + count % 2;
+  }
+  for (size_t k = 0; k < K; k++) out[k] = (leaves > 0) ? level[k] : 0.0;
+}
+
+#endif  // REDUCTION_H
@@ -0,0 +1,118 @@
+/**
+ * \file ReductionTest.cpp
+ * \brief  : n, k, r  disp    
+ *        .
+ *
+ *   \c CHEM_THREADS  ,    
+ *  ( child)      
+ *  .
+ */
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ChemCalculation.h"
+#include "Parallel.h"
+#include "Reduction.h"
+
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace {
+
+///  :      ParallelFor.
+constexpr size_t kPoints = 200000;
+///     .
+const char* const kThreads[] = {"1", "2", "3", "8", "64"};
+
+int g_failed = 0;
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    g_failed++;
+  }
+}
+
+///    1.5   ;    
+///  (    1e-4).
+void MakeSeries(std::vector<double>& Ca, std::vector<double>& Tm) {
+  Ca.resize(kPoints);
+  Tm.resize(kPoints);
+  uint64_t state = 0x2545F4914F6CDD1Dull;
+  for (size_t i = 0; i < kPoints; i++) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    const double noise = static_cast<double>(state >> 11) * 0x1p-53 - 0.5;
+    Tm[i] = 0.01 * static_cast<double>(i);
+    const double c = 1.0 / std::pow(1.0 + 0.5 * 0.3 * Tm[i], 2.0);
+    Ca[i] = c * (1.0 + 0.05 * noise);
+  }
+}
+
+///   n, k, r, disp    .
+int RunChild() {
+  std::vector<double> Ca, Tm;
+  MakeSeries(Ca, Tm);
+  std::printf("threads %zu\n", ParallelWorkerCount());
+  for (ReductionMode mode : {ReductionMode::Pairwise, ReductionMode::Exact}) {
+    SetReductionMode(mode);
+    const CalculationResult r = ChemCalculation::Calculate(Ca, Tm, 0.0, 0.0);
+    for (double v : {r.n, r.k, r.r, r.disp}) {
+      uint64_t bits;
+      std::memcpy(&bits, &v, sizeof(bits));
+      std::printf("%016" PRIx64 " ", bits);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
+
+///     child  \a threads .
+std::string RunWithThreads(const char* self, const char* threads) {
+#if defined(_WIN32)
+  _putenv_s("CHEM_THREADS", threads);
+#else
+  setenv("CHEM_THREADS", threads, 1);
+#endif
+  const std::string command = std::string("\"") + self + "\" child";
+  FILE* pipe = popen(command.c_str(), "r");
+  if (pipe == nullptr) return std::string();
+  std::string output;
+  char buf[256];
+  while (std::fgets(buf, sizeof(buf), pipe) != nullptr) output += buf;
+  return pclose(pipe) == 0 ? output : std::string();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 1 && std::strcmp(argv[1], "child") == 0) return RunChild();
+
+  std::string reference;
+  for (const char* threads : kThreads) {
+    const std::string output = RunWithThreads(argv[0], threads);
+    const std::string header = std::string("threads ") + threads + "\n";
+    Check(output.compare(0, header.size(), header) == 0,
+          "child ran with the requested thread count");
+    const std::string values =
+        output.size() > header.size() ? output.substr(header.size()) : "";
+    Check(!values.empty(), "child printed results");
+    if (reference.empty()) {
+      reference = values;
+    } else if (values != reference) {
+      std::fprintf(stderr, "CHEM_THREADS=%s:\n%sCHEM_THREADS=%s:\n%s",
+                   kThreads[0], reference.c_str(), threads, values.c_str());
+      Check(false, "results are bit-identical across thread counts");
+    }
+  }
+
+  if (g_failed == 0) std::printf("reduction: all checks passed\n");
+  return g_failed == 0 ? 0 : 1;
+}
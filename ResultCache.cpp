@@ -0,0 +1,246 @@
+/**
+ * \file ResultCache.cpp
+ * \brief     .
+ */
+
+#include "ResultCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <system_error>
+
+#include "Reduction.h"
+#include "Trace.h"
+
+namespace {
+
+constexpr uint64_t kMul1 = 0x9E3779B97F4A7C15ull;
+constexpr uint64_t kMul2 = 0xBF58476D1CE4E5B9ull;
+constexpr uint64_t kMul3 = 0x94D049BB133111EBull;
+
+///   : , , ,  double, 
+///    (uint32)     .
+constexpr uint32_t kFileMagic = 0x43464843;  // "CHFC"
+constexpr uint32_t kFileVersion = 2;
+
+///      .   
+/// ,   \c ChemCalculation ( 
+/// ):      .
+constexpr uint64_t kAlgorithmVersion = 1;
+
+inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+///   (splitmix64).
+inline uint64_t Avalanche(uint64_t h) {
+  h ^= h >> 30;
+  h *= kMul2;
+  h ^= h >> 27;
+  h *= kMul3;
+  h ^= h >> 31;
+  return h;
+}
+
+///  64-    .
+class WordHasher {
+ public:
+  explicit WordHasher(uint64_t seed) : m_h(seed ^ kMul3) {}
+
+  void Add(uint64_t v) { m_h = Rotl(m_h ^ (v * kMul1), 27) * kMul2 + kMul1; }
+
+  void Add(double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    Add(bits);
+  }
+
+  void Add(const std::vector<double>& v) {
+    Add(static_cast<uint64_t>(v.size()));
+    for (double d : v) Add(d);
+  }
+
+  uint64_t Finish() const { return Avalanche(m_h); }
+
+ private:
+  uint64_t m_h;
+};
+
+///       .
+constexpr size_t kFileValues = 6;
+///     .
+constexpr uint32_t kMaxMaskSize = 1u << 28;
+
+void Pack(const CachedFit& v, double (&out)[kFileValues]) {
+  out[0] = v.fit.n;
+  out[1] = v.fit.k;
+  out[2] = v.fit.r;
+  out[3] = v.fit.disp;
+  out[4] = v.arrhenius.A;
+  out[5] = v.arrhenius.Ea;
+}
+
+void Unpack(const double (&in)[kFileValues], CachedFit& v) {
+  v.fit.n = in[0];
+  v.fit.k = in[1];
+  v.fit.r = in[2];
+  v.fit.disp = in[3];
+  v.arrhenius.A = in[4];
+  v.arrhenius.Ea = in[5];
+}
+
+}  // namespace
+
+ResultCache::ResultCache(size_t capacity)
+    : m_capacity(capacity > 0 ? capacity : 1) {}
+
+CacheKey ResultCache::MakeKey(const std::vector<double>& Ca,
+                              const std::vector<double>& Tm, double Cb,
+                              double Cc, FitMethod method,
+                              uint64_t optionsHash,
+                              const std::vector<double>& sigma) {
+  TRACE_SCOPE("ResultCache::MakeKey");
+  //  -      128- ,
+  //        
+  WordHasher a(0x6A09E667F3BCC908ull);
+  WordHasher b(0xBB67AE8584CAA73Bull);
+  for (WordHasher* h : {&a, &b}) {
+    h->Add(kAlgorithmVersion);
+    h->Add(Ca);
+    h->Add(Tm);
+    h->Add(Cb);
+    h->Add(Cc);
+    h->Add(static_cast<uint64_t>(method));
+    h->Add(optionsHash);
+    if (!sigma.empty()) h->Add(sigma);
+    //      ;  
+    //     ,      
+    if (GetReductionMode() != ReductionMode::Pairwise) {
+      h->Add(static_cast<uint64_t>(GetReductionMode()));
+    }
+  }
+  return {a.Finish(), b.Finish()};
+}
+
+bool ResultCache::Lookup(const CacheKey& key, CachedFit& out) {
+  TRACE_SCOPE("ResultCache::Lookup");
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    out = it->second->second;
+    return true;
+  }
+  if (!m_diskDir.empty() && ReadFile(key, out)) {
+    Insert(key, out);
+    return true;
+  }
+  return false;
+}
+
+void ResultCache::Store(const CacheKey& key, const CachedFit& value) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Insert(key, value);
+  if (!m_diskDir.empty()) {
+    WriteFile(key, value);
+  }
+}
+
+bool ResultCache::SetDiskDirectory(const std::string& dir) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_diskDir.clear();
+  if (dir.empty()) return true;
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (!std::filesystem::is_directory(dir, ec)) return false;
+  m_diskDir = dir;
+  return true;
+}
+
+void ResultCache::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_lru.clear();
+  m_index.clear();
+}
+
+size_t ResultCache::Size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_lru.size();
+}
+
+void ResultCache::Insert(const CacheKey& key, const CachedFit& value) {
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    it->second->second = value;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return;
+  }
+  m_lru.emplace_front(key, value);
+  m_index[key] = m_lru.begin();
+  if (m_lru.size() > m_capacity) {
+    m_index.erase(m_lru.back().first);
+    m_lru.pop_back();
+  }
+}
+
+std::string ResultCache::FilePath(const CacheKey& key) const {
+  char name[40];
+  std::snprintf(name, sizeof(name), "%016llx%016llx.fit",
+                static_cast<unsigned long long>(key.h1),
+                static_cast<unsigned long long>(key.h2));
+  return (std::filesystem::path(m_diskDir) / name).string();
+}
+
+bool ResultCache::ReadFile(const CacheKey& key, CachedFit& out) const {
+  FILE* f = std::fopen(FilePath(key).c_str(), "rb");
+  if (!f) return false;
+  uint32_t header[2] = {0, 0};
+  uint64_t storedKey[2] = {0, 0};
+  double values[kFileValues];
+  uint32_t maskSize = 0;
+  bool ok = std::fread(header, sizeof(header), 1, f) == 1 &&
+            std::fread(storedKey, sizeof(storedKey), 1, f) == 1 &&
+            std::fread(values, sizeof(values), 1, f) == 1 &&
+            std::fread(&maskSize, sizeof(maskSize), 1, f) == 1;
+  //      
+  ok = ok && header[0] == kFileMagic && header[1] == kFileVersion &&
+       storedKey[0] == key.h1 && storedKey[1] == key.h2 &&
+       maskSize <= kMaxMaskSize;
+  std::vector<unsigned char> mask(ok ? maskSize : 0);
+  ok = ok && (maskSize == 0 ||
+              std::fread(mask.data(), maskSize, 1, f) == 1);
+  std::fclose(f);
+  if (!ok) return false;
+  Unpack(values, out);
+  out.pointInliers = std::move(mask);
+  return true;
+}
+
+void ResultCache::WriteFile(const CacheKey& key, const CachedFit& value) const {
+  //      :    
+  //    
+  const std::string path = FilePath(key);
+  const std::string tmp =
+      path + "." + std::to_string(std::random_device{}()) + ".tmp";
+  FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (!f) return;
+  const uint32_t header[2] = {kFileMagic, kFileVersion};
+  const uint64_t storedKey[2] = {key.h1, key.h2};
+  double values[kFileValues];
+  Pack(value, values);
+  const uint32_t maskSize = static_cast<uint32_t>(value.pointInliers.size());
+  bool ok = std::fwrite(header, sizeof(header), 1, f) == 1 &&
+            std::fwrite(storedKey, sizeof(storedKey), 1, f) == 1 &&
+            std::fwrite(values, sizeof(values), 1, f) == 1 &&
+            std::fwrite(&maskSize, sizeof(maskSize), 1, f) == 1 &&
+            (maskSize == 0 ||
+             std::fwrite(value.pointInliers.data(), maskSize, 1, f) == 1);
+  ok = (std::fclose(f) == 0) && ok;
+  std::error_code ec;
+  if (ok) {
+    std::filesystem::rename(tmp, path, ec);
+  }
+  if (!ok || ec) {
+    std::filesystem::remove(tmp, ec);
+  }
+}
@@ -0,0 +1,143 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ChemCalculation.h"
+
+/**
+ * \file ResultCache.h
+ * \brief        .
+ *
+ *   128-    (Ca, Tm, Cb, Cc), , 
+ * ,   (. \c Reduction.h)   
+ * ,  ,    , 
+ * .     :
+ * -  :    ,  LRU;
+ * -   ():      ,
+ *      .
+ *
+ *        
+ * \c ChemCalculation::Calculate   .
+ */
+
+/**
+ * \brief  :   64- -  .
+ */
+struct CacheKey {
+  uint64_t h1;  ///<  -.
+  uint64_t h2;  ///<  - (  ).
+
+  bool operator==(const CacheKey& o) const { return h1 == o.h1 && h2 == o.h2; }
+};
+
+/**
+ * \brief  :      .
+ */
+struct CachedFit {
+  CalculationResult fit;       ///<  \c ChemCalculation::Calculate.
+  ArrheniusResult arrhenius;   ///<   .
+  ///      (   ).
+  std::vector<unsigned char> pointInliers;
+};
+
+/**
+ * \brief  ( + )   .
+ *
+ *   .
+ */
+class ResultCache {
+ public:
+  /**
+   * \brief  .
+   *
+   * \param capacity     .
+   */
+  explicit ResultCache(size_t capacity = 256);
+
+  /**
+   * \brief       .
+   *
+   *    ,   
+   *           .
+   *
+   * \param Ca    A.
+   * \param Tm   .
+   * \param Cb   B.
+   * \param Cc   C.
+   * \param method  .
+   * \param optionsHash    (0,   ).
+   * \param sigma   (    ;  
+   *            ).
+   * \return  .
+   */
+  static CacheKey MakeKey(const std::vector<double>& Ca,
+                          const std::vector<double>& Tm, double Cb, double Cc,
+                          FitMethod method, uint64_t optionsHash,
+                          const std::vector<double>& sigma =
+                              std::vector<double>());
+
+  /**
+   * \brief     ,   .
+   *
+   * ,   ,   .
+   *
+   * \param key .
+   * \param out  .
+   * \return \c true,   .
+   */
+  bool Lookup(const CacheKey& key, CachedFit& out);
+
+  /**
+   * \brief      (  )  .
+   *
+   * \param key .
+   * \param value  .
+   */
+  void Store(const CacheKey& key, const CachedFit& value);
+
+  /**
+   * \brief    .
+   *
+   *    .    
+   * .
+   *
+   * \param dir   .
+   * \return \c true,    (  ).
+   */
+  bool SetDiskDirectory(const std::string& dir);
+
+  /// \brief     (    ).
+  void Clear();
+
+  /// \brief    .
+  size_t Size() const;
+
+ private:
+  struct KeyHasher {
+    size_t operator()(const CacheKey& k) const {
+      return static_cast<size_t>(k.h1);
+    }
+  };
+  using Entry = std::pair<CacheKey, CachedFit>;
+
+  ///     LRU-;   .
+  void Insert(const CacheKey& key, const CachedFit& value);
+  std::string FilePath(const CacheKey& key) const;
+  bool ReadFile(const CacheKey& key, CachedFit& out) const;
+  void WriteFile(const CacheKey& key, const CachedFit& value) const;
+
+  mutable std::mutex m_mutex;
+  size_t m_capacity;
+  std::list<Entry> m_lru;  ///<     .
+  std::unordered_map<CacheKey, std::list<Entry>::iterator, KeyHasher> m_index;
+  std::string m_diskDir;  ///<    (  ).
+};
+
+#endif  // RESULTCACHE_H
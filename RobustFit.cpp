@@ -0,0 +1,499 @@
+/**
+ * \file RobustFit.cpp
+ * \brief  RANSAC  IRLS   ln()  ln(Ca).
+ */
+
+#include "RobustFit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace {
+
+///   MAD     .
+constexpr double kMadScale = 1.4826;
+///  inlier'    .
+constexpr double kInlierSigmas = 2.5;
+///   :      .
+constexpr double kMinThreshold = 1e-6;
+///   RANSAC    .
+constexpr size_t kBatchSize = 256;
+///       .
+constexpr size_t kHypothesisGrain = 16;
+
+///  y = lnk + n * x.
+struct Line {
+  double n;
+  double lnk;
+};
+
+/**
+ *        . 
+ *   sqrt(),      
+ *  ;     (  1).
+ */
+struct LogData {
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> prior;    ///<   ( 1)  .
+  std::vector<double> rscale;   ///< sqrt(prior)  .
+
+  double Prior(size_t i) const { return prior.empty() ? 1.0 : prior[i]; }
+};
+
+///  RANSAC:   (    s = 2).
+struct Sample {
+  size_t idx[3];
+};
+
+///  :   .
+struct Score {
+  double cost;
+  size_t inliers;
+  double scale;  ///<    ( LMedS).
+};
+
+inline uint64_t SplitMix64(uint64_t& state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+///  ( ).
+double MedianInPlace(std::vector<double>& v) {
+  if (v.empty()) return 0.0;
+  const size_t mid = v.size() / 2;
+  std::nth_element(v.begin(), v.begin() + mid, v.end());
+  double med = v[mid];
+  if (v.size() % 2 == 0) {
+    med = 0.5 * (med + *std::max_element(v.begin(), v.begin() + mid));
+  }
+  return med;
+}
+
+///    : 1.4826 * MAD.
+double MadSigma(const std::vector<double>& r) {
+  std::vector<double> tmp(r);
+  const double med = MedianInPlace(tmp);
+  for (double& v : tmp) v = std::fabs(v - med);
+  return kMadScale * MedianInPlace(tmp);
+}
+
+///   :   2     3.
+bool LineThrough(const std::vector<double>& x, const std::vector<double>& y,
+                 const Sample& s, int size, Line& out) {
+  if (size == 2) {
+    const size_t a = s.idx[0], b = s.idx[1];
+    const double dx = x[b] - x[a];
+    if (std::fabs(dx) < 1e-12) return false;
+    out.n = (y[b] - y[a]) / dx;
+    out.lnk = y[a] - out.n * x[a];
+    return true;
+  }
+  double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+  for (int j = 0; j < 3; j++) {
+    const double xv = x[s.idx[j]], yv = y[s.idx[j]];
+    sx += xv;
+    sy += yv;
+    sxx += xv * xv;
+    sxy += xv * yv;
+  }
+  const double denom = 3.0 * sxx - sx * sx;
+  if (std::fabs(denom) < 1e-12) return false;
+  out.n = (3.0 * sxy - sx * sy) / denom;
+  out.lnk = (sy * sxx - sx * sxy) / denom;
+  return true;
+}
+
+void Residuals(const LogData& d, const Line& line, std::vector<double>& r) {
+  r.resize(d.x.size());
+  for (size_t i = 0; i < d.x.size(); i++) {
+    r[i] = d.y[i] - (line.lnk + line.n * d.x[i]);
+  }
+  if (!d.rscale.empty()) {
+    for (size_t i = 0; i < r.size(); i++) r[i] *= d.rscale[i];
+  }
+}
+
+/**
+ *  .     MSAC ( min(r^2, T^2)),
+ *  LMedS ( r^2)     .
+ */
+Score Evaluate(const LogData& d, const Line& line, double threshold,
+               int sampleSize, std::vector<double>& scratch) {
+  const size_t m = d.x.size();
+  Residuals(d, line, scratch);
+  Score sc = {0.0, 0, 0.0};
+  if (threshold > 0.0) {
+    const double t2 = threshold * threshold;
+    for (size_t i = 0; i < m; i++) {
+      const double r2 = scratch[i] * scratch[i];
+      if (r2 <= t2) {
+        sc.cost += r2;
+        sc.inliers++;
+      } else {
+        sc.cost += t2;
+      }
+    }
+    sc.scale = threshold;
+    return sc;
+  }
+  for (double& v : scratch) v = v * v;
+  const size_t mid = (m - 1) / 2;
+  std::nth_element(scratch.begin(), scratch.begin() + mid, scratch.end());
+  sc.cost = scratch[mid];
+  const double dof = static_cast<double>(m) - sampleSize;
+  const double sigma =
+      kMadScale * (1.0 + 5.0 / (dof > 0.0 ? dof : 1.0)) * std::sqrt(sc.cost);
+  sc.scale = std::max(kInlierSigmas * sigma, kMinThreshold);
+  const double t2 = sc.scale * sc.scale;
+  for (double r2 : scratch) {
+    if (r2 <= t2) sc.inliers++;
+  }
+  return sc;
+}
+
+///    m  size   .
+void EnumerateSamples(size_t m, int size, std::vector<Sample>& out) {
+  Sample s = {{0, 1, 2}};
+  for (s.idx[0] = 0; s.idx[0] < m; s.idx[0]++) {
+    for (s.idx[1] = s.idx[0] + 1; s.idx[1] < m; s.idx[1]++) {
+      if (size == 2) {
+        out.push_back(s);
+        continue;
+      }
+      for (s.idx[2] = s.idx[1] + 1; s.idx[2] < m; s.idx[2]++) {
+        out.push_back(s);
+      }
+    }
+  }
+}
+
+double CombinationCount(size_t m, int size) {
+  double c = 1.0;
+  for (int j = 0; j < size; j++) {
+    c = c * static_cast<double>(m - j) / (j + 1);
+  }
+  return c;
+}
+
+///    .
+Sample RandomSample(size_t m, int size, uint64_t& state) {
+  Sample s = {{0, 0, 0}};
+  for (int j = 0; j < size; j++) {
+    bool repeat;
+    do {
+      s.idx[j] = static_cast<size_t>(SplitMix64(state) % m);
+      repeat = false;
+      for (int q = 0; q < j; q++) repeat = repeat || s.idx[q] == s.idx[j];
+    } while (repeat);
+  }
+  return s;
+}
+
+///  ,        p.
+double RequiredIterations(double inlierRatio, int size, double p) {
+  const double good = std::pow(inlierRatio, size);
+  if (good >= 1.0) return 0.0;
+  if (good <= 0.0) return std::numeric_limits<double>::infinity();
+  return std::log(1.0 - p) / std::log(1.0 - good);
+}
+
+///          .
+void FinishMasks(const std::vector<size_t>& source, bool intervals,
+                 size_t nPoints, RobustResult& res) {
+  res.pointInliers.assign(nPoints, 0);
+  res.inlierCount = 0;
+  for (size_t i = 0; i < res.intervalInliers.size(); i++) {
+    if (res.intervalInliers[i]) {
+      res.inlierCount++;
+      res.pointInliers[source[i]] = 1;
+      if (intervals) res.pointInliers[source[i] + 1] = 1;
+    }
+  }
+}
+
+///     (  1/sigma^2,  
+/// )   .
+void FinishFit(const std::vector<double>& Ca, const std::vector<double>& Tm,
+               const std::vector<double>& sigma, const LogLogFit& fit,
+               RobustResult& res) {
+  std::vector<double> pointWeights(res.pointInliers.begin(),
+                                   res.pointInliers.end());
+  for (size_t i = 0; i < sigma.size(); i++) {
+    pointWeights[i] /= sigma[i] * sigma[i];
+  }
+  res.fit.n = fit.n;
+  res.fit.k = fit.k;
+  res.fit.r = fit.r;
+  res.fit.disp =
+      ChemCalculation::ComputeDispersion(Ca, Tm, fit.k, fit.n, &pointWeights);
+  ChemCalculation::CheckFinite(res.fit);
+}
+
+///   ,   .
+LogLogFit FitMasked(const LogData& d, const std::vector<unsigned char>& mask) {
+  size_t count = 0;
+  std::vector<double> w(mask.size());
+  for (size_t i = 0; i < mask.size(); i++) {
+    w[i] = mask[i] ? d.Prior(i) : 0.0;
+    count += mask[i];
+  }
+  if (count < 2) {
+    throw std::runtime_error(
+        "      !");
+  }
+  return ChemCalculation::FitLogLog(d.x, d.y, &w);
+}
+
+bool Classify(const LogData& d, const Line& line, double threshold,
+              std::vector<unsigned char>& mask) {
+  std::vector<double> r;
+  Residuals(d, line, r);
+  bool changed = false;
+  mask.resize(d.x.size());
+  for (size_t i = 0; i < d.x.size(); i++) {
+    const unsigned char in = std::fabs(r[i]) <= threshold ? 1 : 0;
+    changed = changed || mask[i] != in;
+    mask[i] = in;
+  }
+  return changed;
+}
+
+void FitRansac(const LogData& d, const RobustOptions& opt, RobustResult& res,
+               LogLogFit& fit) {
+  TRACE_SCOPE("RobustFit::Ransac");
+  const size_t m = d.x.size();
+  const int size = opt.sampleSize == 3 ? 3 : 2;
+  const double threshold = opt.threshold > 0.0 ? opt.threshold : 0.0;
+  const double p = std::min(std::max(opt.confidence, 0.5), 0.999999);
+  const size_t maxIter =
+      static_cast<size_t>(std::max(opt.maxIterations, 1));
+
+  //          seed
+  const bool exhaustive = CombinationCount(m, size) <= maxIter;
+  std::vector<Sample> samples;
+  uint64_t rng = opt.seed;
+
+  Line best = {0.0, 0.0};
+  Score bestScore = {std::numeric_limits<double>::infinity(), 0, 0.0};
+  bool found = false;
+  size_t done = 0;
+
+  while (done < maxIter) {
+    samples.clear();
+    if (exhaustive) {
+      EnumerateSamples(m, size, samples);
+    } else {
+      const size_t batch = std::min(kBatchSize, maxIter - done);
+      for (size_t b = 0; b < batch; b++) {
+        samples.push_back(RandomSample(m, size, rng));
+      }
+    }
+
+    //   :  , 
+    //   (     ),
+    //       
+    std::vector<Line> lines(samples.size());
+    std::vector<Score> scores(samples.size());
+    std::vector<unsigned char> valid(samples.size());
+    ParallelFor(samples.size(), kHypothesisGrain,
+                [&](size_t begin, size_t end) {
+                  std::vector<double> scratch;
+                  for (size_t h = begin; h < end; h++) {
+                    valid[h] =
+                        LineThrough(d.x, d.y, samples[h], size, lines[h]);
+                    if (valid[h]) {
+                      scores[h] =
+                          Evaluate(d, lines[h], threshold, size, scratch);
+                    }
+                  }
+                });
+    for (size_t h = 0; h < samples.size(); h++) {
+      if (valid[h] && scores[h].cost < bestScore.cost) {
+        best = lines[h];
+        bestScore = scores[h];
+        found = true;
+      }
+    }
+    done += samples.size();
+    TRACE_COUNTER("Ransac.hypotheses", done);
+
+    if (exhaustive) break;
+    if (found) {
+      const double ratio = static_cast<double>(bestScore.inliers) / m;
+      if (static_cast<double>(done) >= RequiredIterations(ratio, size, p)) {
+        break;
+      }
+    }
+  }
+  res.iterations = static_cast<int>(done);
+  if (!found) {
+    throw std::runtime_error(
+        "   (  ).  !");
+  }
+
+  // :   inlier',   ,  
+  // ,   
+  Classify(d, best, bestScore.scale, res.intervalInliers);
+  fit = FitMasked(d, res.intervalInliers);
+  const Line refined = {fit.n, std::log(fit.k)};
+  std::vector<unsigned char> mask = res.intervalInliers;
+  if (Classify(d, refined, bestScore.scale, mask)) {
+    size_t count = 0;
+    for (unsigned char v : mask) count += v;
+    if (count >= 2) {
+      res.intervalInliers = mask;
+      fit = FitMasked(d, res.intervalInliers);
+    }
+  }
+}
+
+///  IRLS   .
+void IrlsWeights(const std::vector<double>& r, double scale, double c,
+                 bool tukey, std::vector<double>& w) {
+  w.resize(r.size());
+  for (size_t i = 0; i < r.size(); i++) {
+    const double u = std::fabs(r[i]) / (c * scale);
+    if (tukey) {
+      w[i] = (u < 1.0) ? (1.0 - u * u) * (1.0 - u * u) : 0.0;
+    } else {
+      w[i] = (u <= 1.0) ? 1.0 : 1.0 / u;
+    }
+  }
+}
+
+void FitIrls(const LogData& d, const RobustOptions& opt, RobustResult& res,
+             LogLogFit& fit) {
+  TRACE_SCOPE("RobustFit::Irls");
+  const bool tukey = opt.method == FitMethod::Tukey;
+  const double tuning = opt.tuning > 0.0 ? opt.tuning : (tukey ? 4.685 : 1.345);
+  const int maxIter = std::max(opt.irlsIterations, 1);
+
+  fit = ChemCalculation::FitLogLog(d.x, d.y, d.prior.empty() ? nullptr
+                                                             : &d.prior);
+  std::vector<double> r;
+  std::vector<double> w;
+  double scale = 0.0;
+
+  //   :    
+  const int phases = tukey ? 2 : 1;
+  for (int phase = 0; phase < phases; phase++) {
+    const bool useTukey = tukey && phase == 1;
+    const double c = useTukey ? tuning : (tukey ? 1.345 : tuning);
+    for (int it = 0; it < maxIter; it++) {
+      Residuals(d, {fit.n, std::log(fit.k)}, r);
+      scale = MadSigma(r);
+      if (scale < kMinThreshold) break;  //     
+      IrlsWeights(r, scale, c, useTukey, w);
+      for (size_t i = 0; i < w.size(); i++) w[i] *= d.Prior(i);
+      LogLogFit next;
+      if (ChemCalculation::TryFitLogLog(d.x, d.y, &w, next) !=
+          CalcStatus::Ok) {
+        break;  //  :   
+      }
+      res.iterations++;
+      const bool converged =
+          std::fabs(next.n - fit.n) <= 1e-10 * (1.0 + std::fabs(fit.n)) &&
+          std::fabs(std::log(next.k) - std::log(fit.k)) <=
+              1e-10 * (1.0 + std::fabs(std::log(fit.k)));
+      fit = next;
+      if (converged) break;
+    }
+  }
+
+  Residuals(d, {fit.n, std::log(fit.k)}, r);
+  scale = MadSigma(r);
+  Classify(d, {fit.n, std::log(fit.k)},
+           std::max(kInlierSigmas * scale, kMinThreshold),
+           res.intervalInliers);
+}
+
+}  // namespace
+
+RobustResult RobustCalculate(const std::vector<double>& Ca,
+                             const std::vector<double>& Tm, double Cb,
+                             double Cc, const RobustOptions& options,
+                             const std::vector<double>* sigma) {
+  TRACE_SCOPE("RobustCalculate");
+  RobustResult res;
+  ChemCalculation::ValidateInput(Ca, Tm, Cb, Cc);
+  std::vector<double> s;
+  const bool weighted = sigma != nullptr && !sigma->empty() &&
+                        ChemCalculation::PrepareSigma(Ca, *sigma, s);
+
+  LogData d;
+  std::vector<size_t> source;
+  BuildRateLogPoints(Ca, Tm, options.rates, d.x, d.y, source,
+                     weighted ? &s : nullptr);
+  const bool intervals = options.rates.method == RateMethod::ForwardDifference;
+  const size_t m = d.x.size();
+  const size_t minSamples = (options.method == FitMethod::Ransac)
+                                ? (options.sampleSize == 3 ? 4 : 3)
+                                : 3;
+
+  if (options.method == FitMethod::LeastSquares || m < minSamples) {
+    res.fit = ChemCalculation::Calculate(Ca, Tm, Cb, Cc, options.rates,
+                                         weighted ? &s : nullptr);
+    res.intervalInliers.assign(m, 1);
+    FinishMasks(source, intervals, Ca.size(), res);
+    return res;
+  }
+
+  if (weighted) {
+    const LogLogFit guess = ChemCalculation::FitLogLog(d.x, d.y);
+    BuildLogWeights(Tm, s, options.rates, d.x, d.y, source, guess.n,
+                    d.prior);
+    d.rscale.resize(m);
+    for (size_t i = 0; i < m; i++) d.rscale[i] = std::sqrt(d.prior[i]);
+  }
+
+  LogLogFit fit;
+  if (options.method == FitMethod::Ransac) {
+    FitRansac(d, options, res, fit);
+  } else {
+    FitIrls(d, options, res, fit);
+  }
+  FinishMasks(source, intervals, Ca.size(), res);
+  FinishFit(Ca, Tm, s, fit, res);
+  TRACE_COUNTER("Robust.inliers", res.inlierCount);
+  return res;
+}
+
+uint64_t HashOptions(const RobustOptions& options) {
+  if (options.method == FitMethod::LeastSquares &&
+      options.rates.method == RateMethod::ForwardDifference) {
+    return 0;
+  }
+  uint64_t state = 0x726F627573746669ull;
+  uint64_t h = 0;
+  auto add = [&](uint64_t v) {
+    h ^= SplitMix64(state) ^ (v * 0x9E3779B97F4A7C15ull);
+    h = (h << 27) | (h >> 37);
+  };
+  auto addDouble = [&](double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    add(bits);
+  };
+  add(static_cast<uint64_t>(options.method));
+  addDouble(options.threshold);
+  addDouble(options.confidence);
+  add(static_cast<uint64_t>(options.maxIterations));
+  add(static_cast<uint64_t>(options.sampleSize));
+  add(options.seed);
+  add(static_cast<uint64_t>(options.irlsIterations));
+  addDouble(options.tuning);
+  add(static_cast<uint64_t>(options.rates.method));
+  add(static_cast<uint64_t>(options.rates.window));
+  add(static_cast<uint64_t>(options.rates.polyOrder));
+  addDouble(options.rates.smoothing);
+  return SplitMix64(h) | 1;
+}
@@ -0,0 +1,93 @@
+#ifndef ROBUSTFIT_H
+#define ROBUSTFIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ChemCalculation.h"
+#include "RateEstimator.h"
+
+/**
+ * \file RobustFit.h
+ * \brief      .
+ *
+ *    Ca        
+ *    \c ChemCalculation::Calculate.   
+ *  ln|dCa/dt| = ln(k) + n * ln(Ca)   :
+ * - RANSAC:   / ,  MSAC, 
+ *       inlier';   
+ *    ;
+ * - IRLS          MAD.
+ *
+ *       ,  
+ * \c DrawChart   .
+ */
+
+/**
+ * \brief   .
+ */
+struct RobustOptions {
+  FitMethod method = FitMethod::Ransac;  ///<  .
+  ///   (  ln ); 0   MAD  .
+  double threshold = 0.0;
+  double confidence = 0.99;   ///<     .
+  int maxIterations = 2000;   ///<    RANSAC.
+  int sampleSize = 2;         ///<   RANSAC: 2  3 .
+  uint64_t seed = 0x5EED;     ///<    .
+  int irlsIterations = 50;    ///<    IRLS.
+  ///   ; 0  1.345 ()  4.685 ().
+  double tuning = 0.0;
+  RateOptions rates;  ///<    ( ).
+};
+
+/**
+ * \brief   .
+ */
+struct RobustResult {
+  CalculationResult fit;  ///< n, k, r     .
+  ///       (1  ).  
+  ///    i   [i, i+1].
+  std::vector<unsigned char> intervalInliers;
+  ///      .    
+  /// ,       ; 
+  ///         
+  ///  .
+  std::vector<unsigned char> pointInliers;
+  int iterations = 0;        ///<   RANSAC   IRLS.
+  size_t inlierCount = 0;    ///<    .
+};
+
+/**
+ * \brief    .
+ *
+ *  \c FitMethod::LeastSquares   
+ * \c ChemCalculation::Calculate      . 
+ *   ,   ,    .
+ *
+ * \param Ca     A.
+ * \param Tm   .
+ * \param Cb    B.
+ * \param Cc    C.
+ * \param options  .
+ * \param sigma    Ca  \c nullptr. 
+ *           ;     
+ *        ,    .
+ * \return       .
+ * \throw std::runtime_error      
+ *             .
+ */
+RobustResult RobustCalculate(const std::vector<double>& Ca,
+                             const std::vector<double>& Tm, double Cb,
+                             double Cc, const RobustOptions& options,
+                             const std::vector<double>* sigma = nullptr);
+
+/**
+ * \brief  ,    (  ).
+ *
+ * \param options .
+ * \return 64- ; 0     .
+ */
+uint64_t HashOptions(const RobustOptions& options);
+
+#endif  // ROBUSTFIT_H
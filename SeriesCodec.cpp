@@ -0,0 +1,462 @@
+/**
+ * \file SeriesCodec.cpp
+ * \brief  ,     SSE2.
+ */
+
+#include "SeriesCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// CODEC_NO_SSE2      x86 (
+//   UnpackBlock  )
+#if !defined(CODEC_NO_SSE2) && \
+    (defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define CODEC_USE_SSE2 1
+#endif
+
+#include "Trace.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'H', 'E', 'M', 'S', 'E', 'R', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderBytes = 24;
+constexpr size_t kColumnBytes = 40;
+constexpr size_t kBlockHeaderBytes = 8;
+///     .
+constexpr size_t kLane = SERIES_BLOCK / 2;
+///     .
+constexpr int kMaxTimeDigits = 9;
+///   ,    double.
+constexpr double kExactInteger = 9007199254740992.0;  // 2^53
+
+const double kPow10[kMaxTimeDigits + 1] = {1e0, 1e1, 1e2, 1e3, 1e4,
+                                           1e5, 1e6, 1e7, 1e8, 1e9};
+
+///   .
+enum ColumnKind : uint8_t {
+  kXor = 0,         ///< XOR    ( ).
+  kTicks = 1,       ///<  ,  .
+  kQuantized = 2,   ///<  ,  .
+};
+
+///   (40   ).
+struct ColumnHeader {
+  uint8_t kind = kXor;
+  uint8_t digits = 0;
+  uint64_t payload = 0;     ///<   .
+  uint64_t first = 0;       ///<   ( double  ).
+  uint64_t firstDelta = 0;  ///<   .
+  double step = 0.0;        ///<  .
+};
+
+uint64_t Bits(double v) {
+  uint64_t b;
+  std::memcpy(&b, &v, sizeof(b));
+  return b;
+}
+
+double FromBits(uint64_t b) {
+  double v;
+  std::memcpy(&v, &b, sizeof(v));
+  return v;
+}
+
+uint64_t ZigZag(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t UnZigZag(uint64_t v) {
+  return static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+}
+
+unsigned BitWidth(uint64_t v) {
+  unsigned w = 0;
+  while (v != 0) {
+    v >>= 1;
+    w++;
+  }
+  return w;
+}
+
+unsigned TrailingZeros(uint64_t v) {
+  if (v == 0) return 0;
+  unsigned n = 0;
+  while ((v & 1) == 0) {
+    v >>= 1;
+    n++;
+  }
+  return n;
+}
+
+void Put(std::vector<unsigned char>& out, const void* data, size_t size) {
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  out.insert(out.end(), p, p + size);
+}
+
+template <typename T>
+T Get(const unsigned char* p) {
+  T v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+[[noreturn]] void ThrowCorrupt() {
+  throw std::runtime_error("  !");
+}
+
+///      \a digits  (  )?
+bool FitsTicks(const double* Tm, size_t count, int digits) {
+  const double scale = kPow10[digits];
+  for (size_t i = 0; i < count; i++) {
+    const double t = Tm[i];
+    if (!(std::fabs(t) * scale < kExactInteger)) return false;
+    const double back =
+        static_cast<double>(std::llround(t * scale)) / scale;
+    if (Bits(back) != Bits(t)) return false;
+  }
+  return true;
+}
+
+///   ;  XOR    .
+void PackBlocks(const std::vector<uint64_t>& values, bool dropZeros,
+                std::vector<unsigned char>& out) {
+  uint64_t words[2 * 64];
+  for (size_t begin = 0; begin < values.size(); begin += SERIES_BLOCK) {
+    const size_t n = std::min(SERIES_BLOCK, values.size() - begin);
+    uint64_t any = 0;
+    for (size_t i = 0; i < n; i++) any |= values[begin + i];
+    const unsigned shift = dropZeros ? TrailingZeros(any) : 0;
+    const unsigned width = BitWidth(any >> shift);
+    const unsigned char header[kBlockHeaderBytes] = {
+        static_cast<unsigned char>(width), static_cast<unsigned char>(shift)};
+    Put(out, header, sizeof(header));
+    if (width == 0) continue;
+
+    //  i   i % 2,  i / 2;   
+    std::fill(words, words + 2 * width, 0);
+    for (size_t i = 0; i < n; i++) {
+      const uint64_t v = values[begin + i] >> shift;
+      const size_t lane = i & 1;
+      const size_t bit = (i >> 1) * width;
+      const size_t word = bit >> 6;
+      const unsigned off = bit & 63;
+      words[2 * word + lane] |= v << off;
+      if (off + width > 64) words[2 * (word + 1) + lane] |= v >> (64 - off);
+    }
+    Put(out, words, 2 * width * sizeof(uint64_t));
+  }
+}
+
+///    \a width  \c SERIES_BLOCK .
+void UnpackBlock(const unsigned char* src, unsigned width, uint64_t* out) {
+  if (width == 0) {
+    std::fill(out, out + SERIES_BLOCK, 0);
+    return;
+  }
+  const uint64_t mask =
+      width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+#ifdef CODEC_USE_SSE2
+  //    :    
+  const int maskLo = static_cast<int>(mask & 0xFFFFFFFFu);
+  const int maskHi = static_cast<int>(mask >> 32);
+  const __m128i vmask = _mm_set_epi32(maskHi, maskLo, maskHi, maskLo);
+  __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+  src += 16;
+  unsigned bit = 0;
+  for (size_t p = 0; p < kLane; p++) {
+    __m128i v = _mm_srl_epi64(cur, _mm_cvtsi32_si128(static_cast<int>(bit)));
+    bit += width;
+    if (bit >= 64 && p + 1 < kLane) {
+      bit -= 64;
+      cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      src += 16;
+      if (bit > 0) {
+        v = _mm_or_si128(v, _mm_sll_epi64(cur, _mm_cvtsi32_si128(
+                                                   static_cast<int>(width -
+                                                                    bit))));
+      }
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * p),
+                     _mm_and_si128(v, vmask));
+  }
+#else
+  for (size_t lane = 0; lane < 2; lane++) {
+    for (size_t p = 0; p < kLane; p++) {
+      const size_t bit = p * width;
+      const size_t word = bit >> 6;
+      const unsigned off = bit & 63;
+      uint64_t v = Get<uint64_t>(src + (2 * word + lane) * 8) >> off;
+      if (off + width > 64) {
+        v |= Get<uint64_t>(src + (2 * (word + 1) + lane) * 8) << (64 - off);
+      }
+      out[2 * p + lane] = v & mask;
+    }
+  }
+#endif
+}
+
+void WriteColumn(const ColumnHeader& column,
+                 const std::vector<unsigned char>& blocks,
+                 std::vector<unsigned char>& out) {
+  unsigned char header[kColumnBytes] = {column.kind, column.digits};
+  const uint64_t payload = blocks.size();
+  std::memcpy(header + 8, &payload, 8);
+  std::memcpy(header + 16, &column.first, 8);
+  std::memcpy(header + 24, &column.firstDelta, 8);
+  std::memcpy(header + 32, &column.step, 8);
+  Put(out, header, sizeof(header));
+  out.insert(out.end(), blocks.begin(), blocks.end());
+}
+
+///   : XOR   .
+void EncodeXor(const double* v, size_t count, ColumnHeader& column,
+               std::vector<uint64_t>& residuals) {
+  column.kind = kXor;
+  column.first = Bits(v[0]);
+  for (size_t i = 1; i < count; i++) {
+    residuals.push_back(Bits(v[i]) ^ Bits(v[i - 1]));
+  }
+}
+
+void EncodeTime(const double* Tm, size_t count, std::vector<unsigned char>& out,
+                SeriesCodecInfo& info) {
+  ColumnHeader column;
+  std::vector<uint64_t> residuals;
+  residuals.reserve(count);
+  int digits = -1;
+  for (int d = 0; d <= kMaxTimeDigits && digits < 0; d++) {
+    if (FitsTicks(Tm, count, d)) digits = d;
+  }
+  if (digits >= 0) {
+    const double scale = kPow10[digits];
+    column.kind = kTicks;
+    column.digits = static_cast<uint8_t>(digits);
+    int64_t prev = std::llround(Tm[0] * scale);
+    int64_t prevDelta = 0;
+    column.first = static_cast<uint64_t>(prev);
+    for (size_t i = 1; i < count; i++) {
+      const int64_t ticks = std::llround(Tm[i] * scale);
+      const int64_t delta = ticks - prev;
+      if (i == 1) {
+        column.firstDelta = static_cast<uint64_t>(delta);
+      } else {
+        residuals.push_back(ZigZag(delta - prevDelta));
+      }
+      prev = ticks;
+      prevDelta = delta;
+    }
+    info.timeTicks = true;
+    info.timeDigits = digits;
+  } else {
+    EncodeXor(Tm, count, column, residuals);
+  }
+  std::vector<unsigned char> blocks;
+  PackBlocks(residuals, column.kind == kXor, blocks);
+  WriteColumn(column, blocks, out);
+}
+
+void EncodeConcentration(const double* Ca, size_t count, double maxError,
+                         std::vector<unsigned char>& out,
+                         SeriesCodecInfo& info) {
+  ColumnHeader column;
+  std::vector<uint64_t> residuals;
+  residuals.reserve(count);
+  //   maxError:      maxError / 2,
+  //      
+  bool quantize = maxError > 0.0 && std::isfinite(maxError);
+  for (size_t i = 0; i < count && quantize; i++) {
+    const double q = Ca[i] / maxError;
+    quantize = std::fabs(q) < kExactInteger &&
+               std::fabs(static_cast<double>(std::llround(q)) * maxError -
+                         Ca[i]) <= maxError;
+  }
+  if (quantize) {
+    column.kind = kQuantized;
+    column.step = maxError;
+    int64_t prev = std::llround(Ca[0] / maxError);
+    column.first = static_cast<uint64_t>(prev);
+    for (size_t i = 1; i < count; i++) {
+      const int64_t q = std::llround(Ca[i] / maxError);
+      residuals.push_back(ZigZag(q - prev));
+      prev = q;
+    }
+    info.quantized = true;
+    info.maxError = maxError;
+  } else {
+    EncodeXor(Ca, count, column, residuals);
+  }
+  std::vector<unsigned char> blocks;
+  PackBlocks(residuals, column.kind == kXor, blocks);
+  WriteColumn(column, blocks, out);
+}
+
+ColumnHeader ReadColumnHeader(const unsigned char*& p,
+                              const unsigned char* end) {
+  if (static_cast<size_t>(end - p) < kColumnBytes) ThrowCorrupt();
+  ColumnHeader column;
+  column.kind = p[0];
+  column.digits = p[1];
+  column.payload = Get<uint64_t>(p + 8);
+  column.first = Get<uint64_t>(p + 16);
+  column.firstDelta = Get<uint64_t>(p + 24);
+  column.step = Get<double>(p + 32);
+  p += kColumnBytes;
+  if (column.kind > kQuantized || column.digits > kMaxTimeDigits ||
+      column.payload > static_cast<uint64_t>(end - p)) {
+    ThrowCorrupt();
+  }
+  return column;
+}
+
+///     ,    \a count ?
+bool PayloadFits(const ColumnHeader& column, uint64_t count) {
+  const uint64_t start = column.kind == kTicks ? 2 : 1;
+  const uint64_t blocks =
+      count > start ? (count - start + SERIES_BLOCK - 1) / SERIES_BLOCK : 0;
+  return column.payload / kBlockHeaderBytes >= blocks;
+}
+
+///    \a count   \a out.
+void DecodeColumn(const unsigned char*& p, const unsigned char* end,
+                  size_t count, double* out) {
+  const ColumnHeader column = ReadColumnHeader(p, end);
+  const unsigned char* blockEnd = p + column.payload;
+  if (count == 0) {
+    if (column.payload != 0) ThrowCorrupt();
+    return;
+  }
+
+  //  ;    ,   UB
+  const double scale = kPow10[column.digits];
+  uint64_t acc = column.first;
+  uint64_t delta = column.firstDelta;
+  size_t start = 1;
+  switch (column.kind) {
+    case kXor:
+      out[0] = FromBits(acc);
+      break;
+    case kTicks:
+      out[0] = static_cast<double>(static_cast<int64_t>(acc)) / scale;
+      if (count > 1) {
+        acc += delta;
+        out[1] = static_cast<double>(static_cast<int64_t>(acc)) / scale;
+        start = 2;
+      }
+      break;
+    default:
+      out[0] = static_cast<double>(static_cast<int64_t>(acc)) * column.step;
+      break;
+  }
+
+  uint64_t values[SERIES_BLOCK];
+  for (size_t i = start; i < count; i += SERIES_BLOCK) {
+    const size_t n = std::min(SERIES_BLOCK, count - i);
+    if (static_cast<size_t>(blockEnd - p) < kBlockHeaderBytes) {
+      ThrowCorrupt();
+    }
+    const unsigned width = p[0];
+    const unsigned shift = p[1];
+    p += kBlockHeaderBytes;
+    if (width > 64 || shift > 63 || width + shift > 64 ||
+        static_cast<size_t>(blockEnd - p) < 16 * width) {
+      ThrowCorrupt();
+    }
+    UnpackBlock(p, width, values);
+    p += 16 * width;
+    double* dst = out + i;
+    switch (column.kind) {
+      case kXor:
+        for (size_t k = 0; k < n; k++) {
+          acc ^= values[k] << shift;
+          dst[k] = FromBits(acc);
+        }
+        break;
+      case kTicks:
+        for (size_t k = 0; k < n; k++) {
+          delta += static_cast<uint64_t>(UnZigZag(values[k]));
+          acc += delta;
+          dst[k] = static_cast<double>(static_cast<int64_t>(acc)) / scale;
+        }
+        break;
+      default:
+        for (size_t k = 0; k < n; k++) {
+          acc += static_cast<uint64_t>(UnZigZag(values[k]));
+          dst[k] = static_cast<double>(static_cast<int64_t>(acc)) *
+                   column.step;
+        }
+        break;
+    }
+  }
+  if (p != blockEnd) ThrowCorrupt();
+}
+
+}  // namespace
+
+std::vector<unsigned char> EncodeSeries(const double* Tm, const double* Ca,
+                                        size_t count,
+                                        const SeriesCodecOptions& options) {
+  TRACE_SCOPE("EncodeSeries");
+  std::vector<unsigned char> out;
+  unsigned char header[kHeaderBytes] = {};
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  std::memcpy(header + 8, &kVersion, sizeof(kVersion));
+  const uint64_t n = count;
+  std::memcpy(header + 16, &n, sizeof(n));
+  Put(out, header, sizeof(header));
+  SeriesCodecInfo info;
+  if (count == 0) {
+    const ColumnHeader empty;
+    WriteColumn(empty, {}, out);
+    WriteColumn(empty, {}, out);
+    return out;
+  }
+  EncodeTime(Tm, count, out, info);
+  EncodeConcentration(Ca, count, options.maxError, out, info);
+  return out;
+}
+
+SeriesCodecInfo InspectSeries(const unsigned char* data, size_t size) {
+  if (size < kHeaderBytes || std::memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+      Get<uint32_t>(data + 8) != kVersion) {
+    throw std::runtime_error("    !");
+  }
+  const uint64_t count = Get<uint64_t>(data + 16);
+  const unsigned char* p = data + kHeaderBytes;
+  const unsigned char* end = data + size;
+  const ColumnHeader time = ReadColumnHeader(p, end);
+  p += time.payload;
+  const ColumnHeader conc = ReadColumnHeader(p, end);
+  //        
+  if (!PayloadFits(time, count) || !PayloadFits(conc, count)) ThrowCorrupt();
+  SeriesCodecInfo info;
+  info.count = static_cast<size_t>(count);
+  info.timeTicks = time.kind == kTicks;
+  info.timeDigits = info.timeTicks ? time.digits : 0;
+  info.quantized = conc.kind == kQuantized;
+  info.maxError = info.quantized ? conc.step : 0.0;
+  return info;
+}
+
+void DecodeSeries(const unsigned char* data, size_t size, double* Tm,
+                  double* Ca) {
+  TRACE_SCOPE("DecodeSeries");
+  const SeriesCodecInfo info = InspectSeries(data, size);
+  const unsigned char* p = data + kHeaderBytes;
+  const unsigned char* end = data + size;
+  DecodeColumn(p, end, info.count, Tm);
+  DecodeColumn(p, end, info.count, Ca);
+}
+
+void DecodeSeries(const std::vector<unsigned char>& data,
+                  std::vector<double>& Tm, std::vector<double>& Ca) {
+  const SeriesCodecInfo info = InspectSeries(data.data(), data.size());
+  Tm.resize(info.count);
+  Ca.resize(info.count);
+  DecodeSeries(data.data(), data.size(), Tm.data(), Ca.data());
+}
@@ -0,0 +1,106 @@
+#ifndef SERIESCODEC_H
+#define SERIESCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \file SeriesCodec.h
+ * \brief   (t, Ca)     .
+ *
+ *      :
+ * - ,           
+ *    (t =  / 10^d ,   ),   
+ *       (delta-of-delta):   
+ *     ;
+ * -      XOR   ,  
+ *   Gorilla:      ,   
+ *    ,   XOR    ;
+ * -        
+ *   \c SeriesCodecOptions::maxError   ; 
+ *           maxError.
+ *
+ *     \c SERIES_BLOCK    
+ *   ( XOR        ,
+ *   ).    Gorilla, 
+ *     ,    
+ *  64-    ,   
+ *  SSE2    ,   
+ *     XOR.
+ *
+ *  (  little-endian):  16  ("CHEMSER1",
+ *  uint32, ),   uint64,    t  Ca:
+ *  40    ( 8 : , , ;
+ * 16 *    ).
+ */
+
+///    .
+constexpr size_t SERIES_BLOCK = 128;
+
+/**
+ * \brief  .
+ */
+struct SeriesCodecOptions {
+  ///    Ca; 0   .   
+  ///  ( ,   ),  Ca
+  ///   .
+  double maxError = 0.0;
+};
+
+/**
+ * \brief    .
+ */
+struct SeriesCodecInfo {
+  size_t count = 0;          ///<  .
+  bool timeTicks = false;    ///<    10^-timeDigits.
+  int timeDigits = 0;        ///<   .
+  bool quantized = false;    ///< Ca  ( ).
+  double maxError = 0.0;     ///<   Ca (0   ).
+};
+
+/**
+ * \brief  .
+ *
+ * \param Tm  .
+ * \param Ca .
+ * \param count  .
+ * \param options .
+ * \return  .
+ */
+std::vector<unsigned char> EncodeSeries(const double* Tm, const double* Ca,
+                                        size_t count,
+                                        const SeriesCodecOptions& options =
+                                            {});
+
+/**
+ * \brief    .
+ *
+ * \param data  .
+ * \param size  , .
+ * \return   .
+ * \throw std::runtime_error      .
+ */
+SeriesCodecInfo InspectSeries(const unsigned char* data, size_t size);
+
+/**
+ * \brief     .
+ *
+ *     ,   
+ * \c ChemCalculation::TryCalculate  \c CalculateBatch, 
+ *  .
+ *
+ * \param data  .
+ * \param size  , .
+ * \param Tm    \c InspectSeries(...).count .
+ * \param Ca     .
+ * \throw std::runtime_error   .
+ */
+void DecodeSeries(const unsigned char* data, size_t size, double* Tm,
+                  double* Ca);
+
+/// \c DecodeSeries   (   ).
+void DecodeSeries(const std::vector<unsigned char>& data,
+                  std::vector<double>& Tm, std::vector<double>& Ca);
+
+#endif  // SERIESCODEC_H
@@ -0,0 +1,457 @@
+/**
+ * \file ShardRunner.cpp
+ * \brief      ,   .
+ */
+
+#include "ShardRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "BatchCalculation.h"
+#include "DataImport.h"
+#include "Trace.h"
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+///    .
+constexpr size_t kBatchLanes = 16;
+///     ,    .
+constexpr int kImportFailed = -1;
+///  ,     .
+constexpr int kPlanReadAttempts = 50;
+///      .
+constexpr std::chrono::milliseconds kPlanRetryDelay(20);
+
+///  .
+struct Manifest {
+  std::vector<std::string> paths;  ///< ,    .
+  std::filesystem::path base;      ///<  .
+  uint64_t hash = kFnvOffset;      ///< FNV-1a  .
+};
+
+Manifest ReadManifest(const std::filesystem::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) throw std::runtime_error("   !");
+  Manifest manifest;
+  manifest.base = path.parent_path();
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') continue;
+    const size_t last = line.find_last_not_of(" \t\r");
+    line = line.substr(first, last - first + 1);
+    for (unsigned char c : line) {
+      manifest.hash = (manifest.hash ^ c) * kFnvPrime;
+    }
+    manifest.hash = (manifest.hash ^ '\n') * kFnvPrime;
+    manifest.paths.push_back(line);
+  }
+  if (manifest.paths.empty()) {
+    throw std::runtime_error("   !");
+  }
+  return manifest;
+}
+
+std::filesystem::path ResolveRun(const Manifest& manifest, size_t index) {
+  const std::filesystem::path path(manifest.paths[index]);
+  return path.is_absolute() ? path : manifest.base / path;
+}
+
+std::filesystem::path ShardPath(const std::filesystem::path& workDir,
+                                const char* dir, size_t shard,
+                                const char* ext) {
+  char name[40];
+  std::snprintf(name, sizeof(name), "shard-%06zu%s", shard, ext);
+  return workDir / dir / name;
+}
+
+std::filesystem::path LockPath(const ShardOptions& options, size_t shard) {
+  return ShardPath(options.workDir, "locks", shard, ".lock");
+}
+
+std::filesystem::path OutputPath(const ShardOptions& options, size_t shard) {
+  return ShardPath(options.workDir, "out", shard, ".csv");
+}
+
+///     : ,   
+///  (      ).
+std::string OwnerTag() {
+#if defined(_WIN32)
+  const char* host = std::getenv("COMPUTERNAME");
+  const std::string name = host != nullptr ? host : "?";
+  const unsigned long pid = GetCurrentProcessId();
+#else
+  char host[256] = {0};
+  if (gethostname(host, sizeof(host) - 1) != 0) host[0] = '?';
+  const std::string name = host;
+  const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+  return name + " " + std::to_string(pid) + " " +
+         std::to_string(std::random_device{}()) + "\n";
+}
+
+std::string UniqueSuffix() {
+  return "." + std::to_string(std::random_device{}()) + ".tmp";
+}
+
+///      :   
+///     .
+bool WriteFileAtomically(const std::filesystem::path& path,
+                         const std::string& text) {
+  const std::string tmp = path.string() + UniqueSuffix();
+  FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (!f) return false;
+  bool ok = text.empty() || std::fwrite(text.data(), text.size(), 1, f) == 1;
+  ok = (std::fclose(f) == 0) && ok;
+  std::error_code ec;
+  if (ok) {
+    std::filesystem::rename(tmp, path, ec);
+  }
+  if (!ok || ec) {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
+
+///    ,      (fopen "wx"  
+///     ); false       
+///  (   ).
+bool CreateExclusively(const std::filesystem::path& path,
+                       const std::string& text) {
+  FILE* f = std::fopen(path.string().c_str(), "wx");
+  if (!f) return false;
+  bool ok = text.empty() || std::fwrite(text.data(), text.size(), 1, f) == 1;
+  ok = (std::fclose(f) == 0) && ok;
+  if (!ok) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+  return ok;
+}
+
+bool ReadWholeFile(const std::filesystem::path& path, std::string& text) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::ostringstream buffer;
+  buffer << in.rdbuf();
+  text = buffer.str();
+  return true;
+}
+
+/// :       .
+struct Job {
+  Manifest manifest;
+  size_t shardSize = 0;
+  size_t shards = 0;
+};
+
+///      (0    ).
+size_t PlanShardSize(const std::string& plan) {
+  const size_t pos = plan.find("\nshard_size ");
+  if (pos == std::string::npos) return 0;
+  return static_cast<size_t>(std::strtoull(plan.c_str() + pos + 12, nullptr,
+                                           10));
+}
+
+std::string FormatPlan(const Manifest& manifest, size_t shardSize) {
+  char plan[128];
+  std::snprintf(plan, sizeof(plan),
+                "chem-shards 1\nruns %zu\nshard_size %zu\nmanifest %016llx\n",
+                manifest.paths.size(), shardSize,
+                static_cast<unsigned long long>(manifest.hash));
+  return plan;
+}
+
+/**
+ *  ;       ,  .
+ * false   . ,      ,  
+ *     .
+ */
+bool ReadPlan(const std::filesystem::path& path, std::string& text) {
+  for (int attempt = 0; attempt < kPlanReadAttempts; attempt++) {
+    if (!ReadWholeFile(path, text)) return false;
+    if (!text.empty() && text.back() == '\n' &&
+        text.find("\nmanifest ") != std::string::npos) {
+      return true;
+    }
+    std::this_thread::sleep_for(kPlanRetryDelay);
+  }
+  return true;
+}
+
+/**
+ *  ,       , 
+ *   .
+ */
+Job OpenJob(const ShardOptions& options) {
+  Job job;
+  job.manifest = ReadManifest(options.manifest);
+  std::error_code ec;
+  std::filesystem::create_directories(options.workDir / "locks", ec);
+  std::filesystem::create_directories(options.workDir / "out", ec);
+  if (!std::filesystem::is_directory(options.workDir / "locks") ||
+      !std::filesystem::is_directory(options.workDir / "out")) {
+    throw std::runtime_error("     !");
+  }
+  const std::filesystem::path planPath = options.workDir / "plan.txt";
+  std::string stored;
+  if (!ReadPlan(planPath, stored)) {
+    //    (  ):  
+    //      ,  
+    //    
+    const std::string plan = FormatPlan(
+        job.manifest,
+        options.shardSize != 0 ? options.shardSize : SHARD_DEFAULT_SIZE);
+    if (CreateExclusively(planPath, plan)) {
+      stored = plan;
+    } else if (!ReadPlan(planPath, stored)) {
+      throw std::runtime_error("    !");
+    }
+  }
+  job.shardSize =
+      options.shardSize != 0 ? options.shardSize : PlanShardSize(stored);
+  if (job.shardSize == 0 || stored != FormatPlan(job.manifest, job.shardSize)) {
+    throw std::runtime_error(
+        "        !");
+  }
+  job.shards =
+      (job.manifest.paths.size() + job.shardSize - 1) / job.shardSize;
+  return job;
+}
+
+enum class LockState { Free, Held, Stale };
+
+LockState InspectLock(const std::filesystem::path& lock, int staleSeconds) {
+  std::error_code ec;
+  const auto modified = std::filesystem::last_write_time(lock, ec);
+  if (ec) return LockState::Free;
+  const auto age = std::filesystem::file_time_type::clock::now() - modified;
+  return age > std::chrono::seconds(staleSeconds) ? LockState::Stale
+                                                  : LockState::Held;
+}
+
+///    ; false    .
+bool TryClaim(const std::filesystem::path& lock, const std::string& owner) {
+  return CreateExclusively(lock, owner);
+}
+
+/**
+ *   :     
+ * ,   .    
+ *      ,  
+ *  ;  ,    ,
+ *      .
+ */
+bool Reclaim(const std::filesystem::path& lock, const std::string& owner) {
+  const std::filesystem::path moved = lock.string() + UniqueSuffix();
+  std::error_code ec;
+  std::filesystem::rename(lock, moved, ec);
+  if (ec) return false;
+  std::filesystem::remove(moved, ec);
+  return TryClaim(lock, owner);
+}
+
+/**
+ *  ,       \a owner. 
+ * ,   staleSeconds,   ;
+ *        
+ *   .
+ */
+void ReleaseLock(const std::filesystem::path& lock, const std::string& owner) {
+  std::string text;
+  if (!ReadWholeFile(lock, text) || text != owner) return;
+  std::error_code ec;
+  std::filesystem::remove(lock, ec);
+}
+
+///     ,   .
+class Heartbeat {
+ public:
+  Heartbeat(const std::filesystem::path& lock,
+            std::chrono::milliseconds period)
+      : m_lock(lock), m_period(period), m_thread([this] { Run(); }) {}
+
+  ~Heartbeat() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_cv.wait_for(lock, m_period, [this] { return m_stop; })) {
+      std::error_code ec;
+      std::filesystem::last_write_time(
+          m_lock, std::filesystem::file_time_type::clock::now(), ec);
+    }
+  }
+
+  std::filesystem::path m_lock;
+  std::chrono::milliseconds m_period;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_stop = false;
+  std::thread m_thread;  // :    
+};
+
+///   [begin, end)    .
+size_t ProcessShard(const ShardOptions& options, const Job& job,
+                    size_t shard, BatchWorkspace& workspace) {
+  TRACE_SCOPE("ProcessShard");
+  const Manifest& manifest = job.manifest;
+  const size_t begin = shard * job.shardSize;
+  const size_t end = std::min(begin + job.shardSize, manifest.paths.size());
+  const size_t count = end - begin;
+  std::vector<ImportedData> data(count);
+  std::vector<unsigned char> imported(count, 0);
+  std::vector<SeriesView> views;
+  views.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    try {
+      data[i] = ImportDelimitedFile(ResolveRun(manifest, begin + i));
+      imported[i] = 1;
+      views.push_back({data[i].Ca.data(), data[i].Tm.data(),
+                       data[i].Ca.size()});
+    } catch (const std::exception&) {
+      //         
+    }
+  }
+  std::vector<BatchFitResult> results(views.size());
+  CalculateBatch(views.data(), views.size(), results.data(), kBatchLanes,
+                 options.dispersion, workspace);
+
+  std::string text;
+  size_t failed = 0;
+  size_t next = 0;
+  char line[160];
+  for (size_t i = 0; i < count; i++) {
+    int status = kImportFailed;
+    CalculationResult fit = {0.0, 0.0, 0.0, 0.0};
+    if (imported[i]) {
+      status = static_cast<int>(results[next].status);
+      fit = results[next].fit;
+      next++;
+    }
+    if (status != static_cast<int>(CalcStatus::Ok)) failed++;
+    std::snprintf(line, sizeof(line), "%zu;%d;%.17g;%.17g;%.17g;%.17g;",
+                  begin + i, status, fit.n, fit.k, fit.r, fit.disp);
+    text += line;
+    text += manifest.paths[begin + i];
+    text += '\n';
+  }
+  if (!WriteFileAtomically(OutputPath(options, shard), text)) {
+    throw std::runtime_error("    !");
+  }
+  return failed;
+}
+
+///      .
+void ScanShards(const ShardOptions& options, ShardReport& report) {
+  report.finished = 0;
+  report.busy = 0;
+  std::error_code ec;
+  for (size_t shard = 0; shard < report.shards; shard++) {
+    if (std::filesystem::exists(OutputPath(options, shard), ec)) {
+      report.finished++;
+    } else if (InspectLock(LockPath(options, shard), options.staleSeconds) ==
+               LockState::Held) {
+      report.busy++;
+    }
+  }
+}
+
+}  // namespace
+
+ShardReport RunShardWorker(const ShardOptions& options) {
+  const Job job = OpenJob(options);
+  ShardReport report;
+  report.runs = job.manifest.paths.size();
+  report.shards = job.shards;
+
+  const std::string owner = OwnerTag();
+  const std::chrono::milliseconds period(
+      std::max(options.staleSeconds, 1) * 250);
+  BatchWorkspace workspace;
+  std::error_code ec;
+  for (size_t shard = 0; shard < report.shards; shard++) {
+    if (options.maxShards != 0 && report.processed >= options.maxShards) {
+      break;
+    }
+    if (std::filesystem::exists(OutputPath(options, shard), ec)) continue;
+    const std::filesystem::path lock = LockPath(options, shard);
+    bool claimed = TryClaim(lock, owner);
+    bool reclaimed = false;
+    if (!claimed &&
+        InspectLock(lock, options.staleSeconds) == LockState::Stale) {
+      claimed = reclaimed = Reclaim(lock, owner);
+    }
+    if (!claimed) continue;
+    //        
+    if (!std::filesystem::exists(OutputPath(options, shard), ec)) {
+      try {
+        Heartbeat heartbeat(lock, period);
+        report.failedRuns += ProcessShard(options, job, shard, workspace);
+      } catch (...) {
+        ReleaseLock(lock, owner);
+        throw;
+      }
+      report.processed++;
+      if (reclaimed) report.reclaimed++;
+    }
+    ReleaseLock(lock, owner);
+  }
+  ScanShards(options, report);
+  return report;
+}
+
+ShardReport QueryShards(const ShardOptions& options) {
+  const Job job = OpenJob(options);
+  ShardReport report;
+  report.runs = job.manifest.paths.size();
+  report.shards = job.shards;
+  ScanShards(options, report);
+  return report;
+}
+
+size_t MergeShardOutputs(const ShardOptions& options,
+                         const std::filesystem::path& output) {
+  const Job job = OpenJob(options);
+  std::string text = "index;status;n;k;r;disp;path\n";
+  std::string part;
+  for (size_t shard = 0; shard < job.shards; shard++) {
+    if (!ReadWholeFile(OutputPath(options, shard), part)) {
+      throw std::runtime_error("    !");
+    }
+    text += part;
+  }
+  if (!WriteFileAtomically(output, text)) {
+    throw std::runtime_error("    !");
+  }
+  return job.manifest.paths.size();
+}
@@ -0,0 +1,113 @@
+#ifndef SHARDRUNNER_H
+#define SHARDRUNNER_H
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+/**
+ * \file ShardRunner.h
+ * \brief       .
+ *
+ *    ,       
+ *   (   \c ImportDelimitedFile;  
+ *    ).    ,
+ *   '#', .     (shards) 
+ * \c ShardOptions::shardSize   .
+ *
+ *        (  
+ *   ):
+ * - plan.txt   ,     ; 
+ *    (fopen "wx")   , ,   
+ *    ,    ,    
+ *   ;
+ * - locks/shard-NNNNNN.lock   .   
+ *   (fopen "wx"),      . 
+ *    ,     \c ShardOptions::staleSeconds
+ *      ; ,   
+ *   \c staleSeconds,   (   ), 
+ *        .   
+ *    ;  ,   , 
+ *       ;
+ * - out/shard-NNNNNN.csv   .     
+ *   ,       :
+ *         .
+ *
+ *   (ASCII,  ';'):
+ *    ;  \c CalcStatus (-1    
+ * ); n; k; r; disp;   .
+ *
+ *  ,  ,     
+ *   \c staleSeconds.
+ */
+
+///      .
+constexpr size_t SHARD_DEFAULT_SIZE = 64;
+///   ,     , .
+constexpr int SHARD_STALE_SECONDS = 120;
+
+/**
+ * \brief  .
+ */
+struct ShardOptions {
+  std::filesystem::path manifest;  ///<  .
+  std::filesystem::path workDir;   ///<    .
+  ///   ; 0    ,    
+  /// \c SHARD_DEFAULT_SIZE.      .
+  size_t shardSize = 0;
+  int staleSeconds = SHARD_STALE_SECONDS;  ///<   .
+  bool dispersion = true;  ///<   (. \c CalculateBatch).
+  ///   ,    (0  ).
+  size_t maxShards = 0;
+};
+
+/**
+ * \brief      .
+ */
+struct ShardReport {
+  size_t runs = 0;       ///<   .
+  size_t shards = 0;     ///<  .
+  size_t finished = 0;   ///<   ( ).
+  size_t processed = 0;  ///< ,   .
+  size_t reclaimed = 0;  ///<      .
+  size_t busy = 0;       ///< ,   .
+  size_t failedRuns = 0;  ///<      .
+};
+
+/**
+ * \brief    ,   .
+ *
+ *      ,    
+ *     . ,  
+ *    (,   ,  )
+ *   \c ShardOptions::maxShards .
+ *
+ * \param options .
+ * \return  .
+ * \throw std::runtime_error    ,  
+ *                .
+ */
+ShardReport RunShardWorker(const ShardOptions& options);
+
+/**
+ * \brief   ,   .
+ *
+ * \param options  (    ).
+ * \return ; \c processed, \c reclaimed  \c failedRuns  0.
+ * \throw std::runtime_error   \c RunShardWorker.
+ */
+ShardReport QueryShards(const ShardOptions& options);
+
+/**
+ * \brief          .
+ *
+ * \param options  (    ).
+ * \param output   (  ).
+ * \return   .
+ * \throw std::runtime_error         
+ *        .
+ */
+size_t MergeShardOutputs(const ShardOptions& options,
+                         const std::filesystem::path& output);
+
+#endif  // SHARDRUNNER_H
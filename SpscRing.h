@@ -0,0 +1,93 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * \file SpscRing.h
+ * \brief         
+ *        .
+ *
+ *    ,    ;  
+ *        ,    
+ *  ().      ,   
+ *     .  :   
+ *   ,    .
+ */
+
+///      .
+constexpr size_t SPSC_CACHE_LINE = 64;
+
+/**
+ * \brief    ( )   .
+ *
+ * \c Push   -, \c Pop  
+ * -.
+ */
+template <class T>
+class SpscRing {
+ public:
+  ///      \a capacity .
+  explicit SpscRing(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+    m_items.resize(size);
+    m_mask = size - 1;
+  }
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  ///  .
+  size_t Capacity() const { return m_mask + 1; }
+
+  /**
+   * \brief   \a count  (-).
+   *
+   * \return    ( \a count,  
+   *         ).
+   */
+  size_t Push(const T* items, size_t count) {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    size_t free = Capacity() - (tail - m_cachedHead);
+    if (free < count) {
+      m_cachedHead = m_head.load(std::memory_order_acquire);
+      free = Capacity() - (tail - m_cachedHead);
+    }
+    const size_t n = (count < free) ? count : free;
+    for (size_t i = 0; i < n; i++) m_items[(tail + i) & m_mask] = items[i];
+    if (n > 0) m_tail.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  /**
+   * \brief   \a maxCount  (-).
+   *
+   * \return    (0,   ).
+   */
+  size_t Pop(T* out, size_t maxCount) {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    size_t ready = m_cachedTail - head;
+    if (ready < maxCount) {
+      m_cachedTail = m_tail.load(std::memory_order_acquire);
+      ready = m_cachedTail - head;
+    }
+    const size_t n = (maxCount < ready) ? maxCount : ready;
+    for (size_t i = 0; i < n; i++) out[i] = m_items[(head + i) & m_mask];
+    if (n > 0) m_head.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+ private:
+  std::vector<T> m_items;
+  size_t m_mask = 0;
+  ///  ()   ,  .
+  alignas(SPSC_CACHE_LINE) std::atomic<size_t> m_head{0};
+  size_t m_cachedTail = 0;
+  ///  ()   ,  .
+  alignas(SPSC_CACHE_LINE) std::atomic<size_t> m_tail{0};
+  size_t m_cachedHead = 0;
+};
+
+#endif  // SPSCRING_H
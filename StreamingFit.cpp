@@ -0,0 +1,71 @@
+/**
+ * \file StreamingFit.cpp
+ * \brief      .
+ */
+
+#include "StreamingFit.h"
+
+#include <cmath>
+
+void StreamingFit::Reset() { *this = StreamingFit(); }
+
+CalcStatus StreamingFit::Push(double t, double ca) {
+  if (m_status != CalcStatus::Ok) return m_status;
+  const int32_t index = static_cast<int32_t>(m_count);
+  if (ca < 0.0) {
+    m_status = CalcStatus::NegativeConcentration;
+    m_index = index;
+    return m_status;
+  }
+  if (m_count > 0) {
+    if (t <= m_lastT) {
+      m_status = CalcStatus::NonIncreasingTime;
+      m_index = index - 1;
+      return m_status;
+    }
+    //     ,    Calculate
+    const double Ca[2] = {m_lastC, ca};
+    const double Tm[2] = {m_lastT, t};
+    double x;
+    double y;
+    ChemCalculation::BuildLogPoints(Ca, Tm, 2, &x, &y);
+    m_sums[0] += x;
+    m_sums[1] += y;
+    m_sums[2] += x * x;
+    m_sums[3] += x * y;
+    m_sums[4] += y * y;
+  }
+  m_lastT = t;
+  m_lastC = ca;
+  m_count++;
+  return m_status;
+}
+
+CalcStatus StreamingFit::Push(const double* Tm, const double* Ca,
+                              size_t count) {
+  for (size_t i = 0; i < count && m_status == CalcStatus::Ok; i++) {
+    Push(Tm[i], Ca[i]);
+  }
+  return m_status;
+}
+
+CalcOutcome StreamingFit::Result() const {
+  CalcOutcome outcome = {{0.0, 0.0, 0.0, 0.0}, m_status, m_index};
+  if (!outcome) return outcome;
+  if (m_count < 2) {
+    outcome.status = CalcStatus::TooFewPoints;
+    return outcome;
+  }
+  const double sums[6] = {static_cast<double>(m_count - 1), m_sums[0],
+                          m_sums[1], m_sums[2], m_sums[3], m_sums[4]};
+  LogLogFit fit;
+  outcome.status = ChemCalculation::FitFromSums(sums, fit);
+  if (!outcome) return outcome;
+  if (!std::isfinite(fit.n) || !std::isfinite(fit.k) ||
+      !std::isfinite(fit.r)) {
+    outcome.status = CalcStatus::NonFinite;
+    return outcome;
+  }
+  outcome.value = {fit.n, fit.k, fit.r, 0.0};
+  return outcome;
+}
@@ -0,0 +1,68 @@
+#ifndef STREAMINGFIT_H
+#define STREAMINGFIT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ChemCalculation.h"
+
+/**
+ * \file StreamingFit.h
+ * \brief   n, k, r    .
+ *
+ *      ;    
+ *   ,      O(1).  
+ *  ,        .
+ *
+ *      ,   \c ChemCalculation::Calculate;
+ *   ,  n, k, r   \c Calculate 
+ *     \c ReductionMode::Sequential     
+ * \c REDUCTION_LEAF    \c ReductionMode::Pairwise.
+ *          
+ * (. \c ChemCalculation::ComputeDispersion).
+ */
+
+/**
+ * \brief      .
+ */
+class StreamingFit {
+ public:
+  ///   .
+  void Reset();
+
+  /**
+   * \brief   (t, Ca).
+   *
+   *      :    
+   *   \c Reset.    ,  
+   * \c ChemCalculation::CheckInput,      
+   * .
+   *
+   * \return    .
+   */
+  CalcStatus Push(double t, double ca);
+
+  ///  \a count  ;   .
+  CalcStatus Push(const double* Tm, const double* Ca, size_t count);
+
+  ///   .
+  size_t Count() const { return m_count; }
+
+  /**
+   * \brief   (value.disp  0).
+   *
+   * \return    ;    
+   *         \c CalcStatus::TooFewPoints.
+   */
+  CalcOutcome Result() const;
+
+ private:
+  size_t m_count = 0;
+  double m_lastT = 0.0;
+  double m_lastC = 0.0;
+  double m_sums[5] = {0.0, 0.0, 0.0, 0.0, 0.0};  ///< x, y, x*x, x*y, y*y.
+  CalcStatus m_status = CalcStatus::Ok;
+  int32_t m_index = -1;
+};
+
+#endif  // STREAMINGFIT_H
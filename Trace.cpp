@@ -0,0 +1,177 @@
+/**
+ * \file Trace.cpp
+ * \brief        Chrome trace.
+ */
+
+#include "Trace.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::s_enabled(false);
+
+namespace {
+
+///   .
+enum TraceKind : uint32_t { kKindScope = 0, kKindCounter = 1 };
+
+///   .
+struct TraceEvent {
+  const char* name;
+  uint64_t ts;   ///<  , .
+  uint64_t dur;  ///< ,  (   ).
+  double value;  ///<  .
+  uint32_t kind;
+};
+
+///    .   -.
+struct ThreadRing {
+  uint32_t tid = 0;
+  std::atomic<uint64_t> head{0};       ///<   .
+  std::atomic<uint64_t> dumpFrom{0};   ///<   \c Trace::Reset.
+  std::unique_ptr<TraceEvent[]> events;
+};
+
+constexpr uint64_t kRingMask = Trace::kRingCapacity - 1;
+static_assert((Trace::kRingCapacity & kRingMask) == 0,
+              "     ");
+
+std::mutex& RegistryMutex() {
+  static std::mutex m;
+  return m;
+}
+
+///      ,   
+///     .
+std::vector<std::unique_ptr<ThreadRing>>& Registry() {
+  static std::vector<std::unique_ptr<ThreadRing>> rings;
+  return rings;
+}
+
+thread_local ThreadRing* t_ring = nullptr;
+
+///   ;  ( )    
+///  .
+ThreadRing* LocalRing() {
+  if (t_ring == nullptr) {
+    auto ring = std::make_unique<ThreadRing>();
+    ring->events.reset(new TraceEvent[Trace::kRingCapacity]);
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    ring->tid = static_cast<uint32_t>(Registry().size() + 1);
+    t_ring = ring.get();
+    Registry().push_back(std::move(ring));
+  }
+  return t_ring;
+}
+
+void Push(const TraceEvent& ev) {
+  ThreadRing* ring = LocalRing();
+  const uint64_t h = ring->head.load(std::memory_order_relaxed);
+  ring->events[h & kRingMask] = ev;
+  ring->head.store(h + 1, std::memory_order_release);
+}
+
+void WriteJsonString(FILE* f, const char* s) {
+  fputc('"', f);
+  for (; *s; ++s) {
+    const unsigned char c = static_cast<unsigned char>(*s);
+    if (c == '"' || c == '\\') {
+      fputc('\\', f);
+      fputc(c, f);
+    } else if (c < 0x20) {
+      fprintf(f, "\\u%04x", c);
+    } else {
+      fputc(c, f);
+    }
+  }
+  fputc('"', f);
+}
+
+}  // namespace
+
+uint64_t Trace::NowNs() {
+  using Clock = std::chrono::steady_clock;
+  static const Clock::time_point epoch = Clock::now();
+  // +1:      
+  return static_cast<uint64_t>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 Clock::now() - epoch)
+                 .count()) +
+         1;
+}
+
+void Trace::RecordScope(const char* name, uint64_t startNs, uint64_t durNs) {
+  Push({name, startNs, durNs, 0.0, kKindScope});
+}
+
+void Trace::RecordCounter(const char* name, double value) {
+  Push({name, NowNs(), 0, value, kKindCounter});
+}
+
+void Trace::Reset() {
+  std::lock_guard<std::mutex> lock(RegistryMutex());
+  for (auto& ring : Registry()) {
+    ring->dumpFrom.store(ring->head.load(std::memory_order_acquire),
+                         std::memory_order_relaxed);
+  }
+}
+
+bool Trace::DumpChromeJson(const std::string& path) {
+  FILE* f = std::fopen(path.c_str(), "wb");
+  if (!f) return false;
+
+  fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", f);
+  bool first = true;
+  std::vector<TraceEvent> snapshot;
+
+  std::lock_guard<std::mutex> lock(RegistryMutex());
+  for (auto& ring : Registry()) {
+    //    ,   , 
+    // -     
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t from = ring->dumpFrom.load(std::memory_order_relaxed);
+    if (head > Trace::kRingCapacity && from < head - Trace::kRingCapacity) {
+      from = head - Trace::kRingCapacity;
+    }
+    snapshot.clear();
+    for (uint64_t i = from; i < head; i++) {
+      snapshot.push_back(ring->events[i & kRingMask]);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t headAfter = ring->head.load(std::memory_order_relaxed);
+    size_t skip = 0;
+    if (headAfter > Trace::kRingCapacity &&
+        headAfter - Trace::kRingCapacity > from) {
+      skip = static_cast<size_t>(headAfter - Trace::kRingCapacity - from);
+    }
+
+    fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+               "\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+            first ? "" : ",", ring->tid, ring->tid);
+    first = false;
+
+    for (size_t i = skip; i < snapshot.size(); i++) {
+      const TraceEvent& ev = snapshot[i];
+      // NaN      JSON:  Chrome
+      //    
+      if (ev.kind == kKindCounter && !std::isfinite(ev.value)) continue;
+      fputs(",{\"name\":", f);
+      WriteJsonString(f, ev.name);
+      if (ev.kind == kKindScope) {
+        fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+                   "\"dur\":%.3f}",
+                ring->tid, ev.ts / 1000.0, ev.dur / 1000.0);
+      } else {
+        fprintf(f, ",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+                   "\"args\":{\"value\":%.17g}}",
+                ring->tid, ev.ts / 1000.0, ev.value);
+      }
+    }
+  }
+  fputs("]}\n", f);
+  return std::fclose(f) == 0;
+}
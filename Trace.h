@@ -0,0 +1,117 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * \file Trace.h
+ * \brief         Chrome.
+ *
+ *    \c TRACE_SCOPE ( ) 
+ * \c TRACE_COUNTER ( ).     
+ *    ;    
+ * . \c Trace::DumpChromeJson    
+ *   Chrome trace / Perfetto (chrome://tracing, ui.perfetto.dev).
+ *
+ *   ,      
+ * .    \c CHEM_TRACE_DISABLED    .
+ */
+
+/**
+ * \brief   .
+ */
+class Trace {
+ public:
+  /// \brief       .
+  static constexpr uint32_t kRingCapacity = 1u << 16;
+
+  /// \brief     .
+  static void Enable(bool on) {
+    s_enabled.store(on, std::memory_order_relaxed);
+  }
+
+  /// \brief  \c true,    .
+  static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  /// \brief      .
+  static uint64_t NowNs();
+
+  /**
+   * \brief    ( "X").
+   *
+   * \param name  ;    .
+   * \param startNs   (. \c NowNs).
+   * \param durNs   .
+   */
+  static void RecordScope(const char* name, uint64_t startNs, uint64_t durNs);
+
+  /**
+   * \brief    ( "C").
+   *
+   * \param name  ;    .
+   * \param value ;   (NaN, ) 
+   *         .
+   */
+  static void RecordCounter(const char* name, double value);
+
+  /**
+   * \brief        Chrome trace.
+   *
+   *     : ,   
+   * , .
+   *
+   * \param path    JSON-.
+   * \return \c true    .
+   */
+  static bool DumpChromeJson(const std::string& path);
+
+  /// \brief    (  ).
+  static void Reset();
+
+ private:
+  static std::atomic<bool> s_enabled;
+};
+
+/**
+ * \brief   ;   \c TRACE_SCOPE.
+ */
+class TraceScope {
+ public:
+  explicit TraceScope(const char* name)
+      : m_name(name), m_start(Trace::IsEnabled() ? Trace::NowNs() : 0) {}
+
+  ~TraceScope() {
+    if (m_start != 0) {
+      Trace::RecordScope(m_name, m_start, Trace::NowNs() - m_start);
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const char* m_name;
+  uint64_t m_start;  ///< 0,      .
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef CHEM_TRACE_DISABLED
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+#else
+///       \a name.
+#define TRACE_SCOPE(name) \
+  TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+///    \a name.
+#define TRACE_COUNTER(name, value)                                  \
+  do {                                                              \
+    if (Trace::IsEnabled())                                         \
+      Trace::RecordCounter(name, static_cast<double>(value));       \
+  } while (0)
+#endif
+
+#endif  // TRACE_H
@@ -0,0 +1,138 @@
+/**
+ * \file Trajectory.cpp
+ * \brief        .
+ */
+
+#include "Trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Dual.h"
+#include "Trace.h"
+
+/// \brief    \a v,    \a t.
+static double Interpolate(const std::vector<double>& t,
+                          const std::vector<double>& v, double time) {
+  if (time <= t.front()) return v.front();
+  if (time >= t.back()) return v.back();
+
+  //     time;     
+  const size_t hi = static_cast<size_t>(
+      std::upper_bound(t.begin(), t.end(), time) - t.begin());
+  const size_t lo = hi - 1;
+  const double span = t[hi] - t[lo];
+  if (span <= 0.0) return v[hi];
+  const double w = (time - t[lo]) / span;
+  return v[lo] + (v[hi] - v[lo]) * w;
+}
+
+double Trajectory::ValueAt(double time) const {
+  if (t.empty()) return 0.0;
+  return Interpolate(t, A, time);
+}
+
+bool Trajectory::SensitivityAt(double time, double& sk, double& sn) const {
+  if (!HasSensitivities()) return false;
+  sk = Interpolate(t, dAdk, time);
+  sn = Interpolate(t, dAdn, time);
+  return true;
+}
+
+Trajectory BuildTrajectory(const std::vector<double>& Ca,
+                           const std::vector<double>& Tm, double Cb, double Cc,
+                           double k, double n, int subSteps,
+                           bool sensitivities) {
+  TRACE_SCOPE("BuildTrajectory");
+  Trajectory traj;
+  const size_t nPoints = std::min(Ca.size(), Tm.size());
+  if (nPoints < 2 || subSteps < 1) return traj;
+
+  const size_t steps = static_cast<size_t>(subSteps);
+  const size_t total = (nPoints - 1) * steps + 1;
+  traj.t.reserve(total);
+  traj.A.reserve(total);
+  traj.B.reserve(total);
+  traj.C.reserve(total);
+  if (!sensitivities) {
+    IntegrateTrajectory(Ca, Tm, Cb, Cc, k, n, steps,
+                        [&](double t, double A, double B, double C) {
+                          traj.t.push_back(t);
+                          traj.A.push_back(A);
+                          traj.B.push_back(B);
+                          traj.C.push_back(C);
+                        });
+    return traj;
+  }
+
+  //        k  n ( )
+  using Sens = Dual<2>;
+  traj.dAdk.reserve(total);
+  traj.dAdn.reserve(total);
+  IntegrateTrajectory(
+      Ca, Tm, Cb, Cc, Sens::Variable(k, 0), Sens::Variable(n, 1), steps,
+      [&](double t, const Sens& A, const Sens& B, const Sens& C) {
+        traj.t.push_back(t);
+        traj.A.push_back(A.v);
+        traj.B.push_back(B.v);
+        traj.C.push_back(C.v);
+        traj.dAdk.push_back(A.d[0]);
+        traj.dAdn.push_back(A.d[1]);
+      });
+  return traj;
+}
+
+FisherInfo ComputeFisherInfo(const Trajectory& traj,
+                             const std::vector<double>& Tm,
+                             const std::vector<double>* sigma, double sigma0) {
+  FisherInfo fi;
+  if (!traj.HasSensitivities()) return fi;
+  for (size_t i = 1; i < Tm.size(); i++) {
+    double sk = 0.0, sn = 0.0;
+    traj.SensitivityAt(Tm[i], sk, sn);
+    const double s =
+        (sigma != nullptr && i < sigma->size()) ? (*sigma)[i] : sigma0;
+    if (!(s > 0.0)) continue;
+    const double w = 1.0 / (s * s);
+    fi.F[0][0] += w * sk * sk;
+    fi.F[0][1] += w * sk * sn;
+    fi.F[1][1] += w * sn * sn;
+  }
+  fi.F[1][0] = fi.F[0][1];
+
+  //     
+  const double det = fi.F[0][0] * fi.F[1][1] - fi.F[0][1] * fi.F[1][0];
+  const double scale = fi.F[0][0] * fi.F[1][1];
+  if (std::isfinite(det) && scale > 0.0 && det > 1e-12 * scale) {
+    fi.regular = true;
+    fi.cov[0][0] = fi.F[1][1] / det;
+    fi.cov[1][1] = fi.F[0][0] / det;
+    fi.cov[0][1] = fi.cov[1][0] = -fi.F[0][1] / det;
+    fi.seK = std::sqrt(fi.cov[0][0]);
+    fi.seN = std::sqrt(fi.cov[1][1]);
+  }
+  return fi;
+}
+
+void ComputeSamplingInfo(const Trajectory& traj, const FisherInfo& fisher,
+                         std::vector<double>& info) {
+  info.clear();
+  if (!traj.HasSensitivities() || !fisher.regular) return;
+  info.resize(traj.t.size());
+  for (size_t i = 0; i < traj.t.size(); i++) {
+    const double sk = traj.dAdk[i];
+    const double sn = traj.dAdn[i];
+    info[i] = sk * (fisher.cov[0][0] * sk + fisher.cov[0][1] * sn) +
+              sn * (fisher.cov[1][0] * sk + fisher.cov[1][1] * sn);
+  }
+}
+
+size_t FindNearestIndex(const std::vector<double>& sorted, double x) {
+  if (sorted.empty()) return 0;
+  auto it = std::lower_bound(sorted.begin(), sorted.end(), x);
+  if (it == sorted.begin()) return 0;
+  if (it == sorted.end()) return sorted.size() - 1;
+  const size_t hi = static_cast<size_t>(it - sorted.begin());
+  const size_t lo = hi - 1;
+  return (x - sorted[lo] <= sorted[hi] - x) ? lo : hi;
+}
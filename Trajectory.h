@@ -0,0 +1,211 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/**
+ * \file Trajectory.h
+ * \brief   A(t), B(t), C(t)      .
+ *
+ *           
+ *    ,      (
+ *   ,   )  O(log N).
+ *
+ *     A(t)   
+ * dA/dk  dA/dn;        (k, n)
+ *   ,      .
+ */
+
+/**
+ * \brief   .
+ *
+ *     ;  \c t  .
+ */
+struct Trajectory {
+  std::vector<double> t;  ///<  .
+  std::vector<double> A;  ///<  A(t).
+  std::vector<double> B;  ///<  B(t).
+  std::vector<double> C;  ///<  C(t).
+  ///  dA/dk (,   ).
+  std::vector<double> dAdk;
+  ///  dA/dn (,   ).
+  std::vector<double> dAdn;
+
+  /// \brief  \c true,     .
+  bool Empty() const { return t.empty(); }
+
+  /**
+   * \brief  A(t)    .
+   *
+   *    ,   
+   *  .     
+   *  .
+   *
+   * \param time  .
+   * \return  A(time) (0.0   ).
+   */
+  double ValueAt(double time) const;
+
+  /// \brief  \c true,   .
+  bool HasSensitivities() const {
+    return !t.empty() && dAdk.size() == t.size() && dAdn.size() == t.size();
+  }
+
+  /**
+   * \brief  dA/dk  dA/dn    .
+   *
+   *   ,   \c ValueAt.
+   *
+   * \param time  .
+   * \param sk : dA/dk.
+   * \param sn : dA/dn.
+   * \return \c false,    .
+   */
+  bool SensitivityAt(double time, double& sk, double& sn) const;
+};
+
+/**
+ * \brief      (k, n).
+ *
+ * F = sum_i s_i * s_i^T / sigma_i^2,  s_i = (dA/dk, dA/dn)  
+ *  i.      .
+ */
+struct FisherInfo {
+  double F[2][2] = {};    ///<   ( k, n).
+  double cov[2][2] = {};  ///<   ( \c regular).
+  bool regular = false;   ///<   ( ).
+  double seK = 0.0;       ///<   k ( \c regular).
+  double seN = 0.0;       ///<   n ( \c regular).
+};
+
+///  B    A ( 3A = 7B + 3C).
+constexpr double TRAJ_B_PER_A = 7.0 / 3.0;
+///  C    A.
+constexpr double TRAJ_C_PER_A = 1.0;
+
+/**
+ * \brief      W = k * A^n   
+ *             \a sink(t, A, B, C).
+ *
+ *   \c BuildTrajectory  \c StreamTrajectory:  
+ *   ,   [Tm[i-1], Tm[i]] 
+ *  \a subSteps ;    .
+ *
+ *    :  \c double   ,  \c Dual  
+ *    ,   .   
+ *         .
+ *
+ * \param Ca    A ( Ca[0]).
+ * \param Tm    .
+ * \param Cb   B.
+ * \param Cc   C.
+ * \param k  .
+ * \param n  .
+ * \param subSteps    .
+ * \param sink  .
+ * \return    (0,     
+ *         \a subSteps  ).
+ */
+template <typename Scalar, typename Sink>
+size_t IntegrateTrajectory(const std::vector<double>& Ca,
+                           const std::vector<double>& Tm, double Cb,
+                           double Cc, const Scalar& k, const Scalar& n,
+                           size_t subSteps, Sink&& sink) {
+  using std::pow;
+  const size_t nPoints = std::min(Ca.size(), Tm.size());
+  if (nPoints < 2 || subSteps < 1) return 0;
+  Scalar A(Ca[0]);  // A0    
+  Scalar B(Cb);
+  Scalar C(Cc);
+  double t = Tm[0];
+  sink(t, A, B, C);
+  for (size_t i = 1; i < nPoints; i++) {
+    double dtFull = Tm[i] - Tm[i - 1];
+    if (dtFull < 0) dtFull = 0;
+    const double dtSub = dtFull / static_cast<double>(subSteps);
+    for (size_t s = 0; s < subSteps; s++) {
+      const Scalar rate = k * pow(A, n);
+      A -= rate * dtSub;
+      B += TRAJ_B_PER_A * rate * dtSub;
+      C += TRAJ_C_PER_A * rate * dtSub;
+      t += dtSub;
+      sink(t, A, B, C);
+    }
+  }
+  return (nPoints - 1) * subSteps + 1;
+}
+
+/**
+ * \brief   W = k * A^n   .
+ *
+ *   \c IntegrateTrajectory.  B  C 
+ *   3A = 7B + 3C.
+ *
+ * \param Ca    A ( Ca[0]).
+ * \param Tm    .
+ * \param Cb   B.
+ * \param Cc   C.
+ * \param k  .
+ * \param n  .
+ * \param subSteps    .
+ * \param sensitivities   dA/dk  dA/dn:   
+ *             (Dual.h), 
+ *             ( 
+ *        ); A(t), B(t), C(t)    .
+ * \return ; ,    .
+ */
+Trajectory BuildTrajectory(const std::vector<double>& Ca,
+                           const std::vector<double>& Tm, double Cb, double Cc,
+                           double k, double n, int subSteps = 20,
+                           bool sensitivities = false);
+
+/**
+ * \brief       
+ *        .
+ *
+ * \param traj   .
+ * \param Tm   (   A0   ).
+ * \param sigma    \c nullptr.
+ * \param sigma0  ,  \a sigma   (,
+ *           ).
+ * \return     .
+ */
+FisherInfo ComputeFisherInfo(const Trajectory& traj,
+                             const std::vector<double>& Tm,
+                             const std::vector<double>* sigma = nullptr,
+                             double sigma0 = 1.0);
+
+/**
+ * \brief      .
+ *
+ *  s(t)^T * cov * s(t)    A(t);
+ *     sigma   t 
+ *     (1 +  / sigma^2) 
+ * (D-).
+ *   ,      
+ * k  n.
+ *
+ * \param traj   .
+ * \param fisher   (  ).
+ * \param info :     \c traj.t (, 
+ *             ).
+ */
+void ComputeSamplingInfo(const Trajectory& traj, const FisherInfo& fisher,
+                         std::vector<double>& info);
+
+/**
+ * \brief    ,   \a x.
+ *
+ *    (\c std::lower_bound),  O(log N).
+ *
+ * \param sorted   .
+ * \param x  .
+ * \return   ; 0    (
+ *          ,    ).
+ */
+size_t FindNearestIndex(const std::vector<double>& sorted, double x);
+
+#endif  // TRAJECTORY_H
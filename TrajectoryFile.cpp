@@ -0,0 +1,326 @@
+/**
+ * \file TrajectoryFile.cpp
+ * \brief   ,     .
+ */
+
+#include "TrajectoryFile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "Trace.h"
+#include "Trajectory.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'H', 'E', 'M', 'T', 'R', 'J', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kHeaderBytes = 24;
+constexpr uint64_t kChunkHeaderBytes = 8;
+///   : t, A, B, C.
+constexpr size_t kColumns = 4;
+///        .
+constexpr size_t kMaxNumberChars = 32;
+
+uint64_t ChunkBytes(uint32_t points) {
+  return kChunkHeaderBytes + kColumns * sizeof(double) * points;
+}
+
+///     .
+void AddToBucket(LodBucket& b, double t, double v, size_t index, bool empty) {
+  if (empty) {
+    b = {t, t, v, v, v, v, index};
+    return;
+  }
+  b.tLast = t;
+  b.vLast = v;
+  b.vMin = std::min(b.vMin, v);
+  b.vMax = std::max(b.vMax, v);
+}
+
+}  // namespace
+
+TrajectoryWriter::~TrajectoryWriter() {
+  //   :   ,   
+  try {
+    if (m_file.is_open()) Close();
+  } catch (const std::exception&) {
+  }
+}
+
+void TrajectoryWriter::Open(const std::filesystem::path& path,
+                            uint32_t chunkPoints) {
+  if (m_file.is_open()) Close();
+  if (chunkPoints == 0) chunkPoints = TRAJ_CHUNK_POINTS;
+  m_file.open(path, std::ios::binary | std::ios::trunc);
+  char header[kHeaderBytes] = {};
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  std::memcpy(header + 8, &kVersion, sizeof(kVersion));
+  std::memcpy(header + 12, &chunkPoints, sizeof(chunkPoints));
+  if (!m_file ||
+      !m_file.write(header, static_cast<std::streamsize>(kHeaderBytes))) {
+    m_file.close();
+    throw std::runtime_error("    !");
+  }
+  m_chunkPoints = chunkPoints;
+  m_fill = 0;
+  m_points = 0;
+  m_buf.assign(kColumns * static_cast<size_t>(chunkPoints), 0.0);
+}
+
+void TrajectoryWriter::Append(double t, double A, double B, double C) {
+  const size_t cp = m_chunkPoints;
+  m_buf[m_fill] = t;
+  m_buf[cp + m_fill] = A;
+  m_buf[2 * cp + m_fill] = B;
+  m_buf[3 * cp + m_fill] = C;
+  m_points++;
+  if (++m_fill == m_chunkPoints) FlushChunk();
+}
+
+void TrajectoryWriter::Close() {
+  if (!m_file.is_open()) return;
+  if (m_fill > 0) FlushChunk();
+  m_file.close();
+  m_buf = std::vector<double>();
+  if (m_file.fail()) {
+    throw std::runtime_error("    !");
+  }
+}
+
+void TrajectoryWriter::FlushChunk() {
+  TRACE_SCOPE("TrajectoryWriter::FlushChunk");
+  const uint32_t header[2] = {m_fill, 0};
+  m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  //      
+  for (size_t c = 0; c < kColumns; c++) {
+    m_file.write(reinterpret_cast<const char*>(m_buf.data() +
+                                               c * m_chunkPoints),
+                 static_cast<std::streamsize>(m_fill * sizeof(double)));
+  }
+  m_fill = 0;
+  if (!m_file) {
+    throw std::runtime_error("    !");
+  }
+}
+
+void TrajectoryReader::Open(const std::filesystem::path& path) {
+  m_file.close();
+  m_file.clear();
+  m_chunks = 0;
+  m_points = 0;
+  m_next = 0;
+  std::error_code ec;
+  const uint64_t size = std::filesystem::file_size(path, ec);
+  m_file.open(path, std::ios::binary);
+  if (ec || !m_file) {
+    throw std::runtime_error("    !");
+  }
+  char header[kHeaderBytes] = {};
+  uint32_t version = 0;
+  if (size >= kHeaderBytes) {
+    m_file.read(header, static_cast<std::streamsize>(kHeaderBytes));
+  }
+  std::memcpy(&version, header + 8, sizeof(version));
+  std::memcpy(&m_chunkPoints, header + 12, sizeof(m_chunkPoints));
+  if (!m_file || size < kHeaderBytes ||
+      std::memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+      version != kVersion || m_chunkPoints == 0) {
+    throw std::runtime_error("    !");
+  }
+
+  //    , ,  
+  const uint64_t full = ChunkBytes(m_chunkPoints);
+  const uint64_t body = size - kHeaderBytes;
+  m_chunks = static_cast<size_t>(body / full);
+  m_points = m_chunks * m_chunkPoints;
+  m_lastPoints = m_chunkPoints;
+  const uint64_t rest = body % full;
+  if (rest >= kChunkHeaderBytes) {
+    uint32_t count = 0;
+    m_file.seekg(static_cast<std::streamoff>(ChunkOffset(m_chunks)));
+    m_file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (m_file && count > 0 && count < m_chunkPoints &&
+        rest >= ChunkBytes(count)) {
+      m_lastPoints = count;
+      m_chunks++;
+      m_points += count;
+    }
+  }
+  m_file.clear();
+}
+
+bool TrajectoryReader::Next(TrajectoryChunk& chunk) {
+  if (m_next >= m_chunks) return false;
+  const size_t index = m_next++;
+  const uint32_t expected =
+      (index + 1 == m_chunks) ? m_lastPoints : m_chunkPoints;
+  uint32_t header[2] = {0, 0};
+  m_file.seekg(static_cast<std::streamoff>(ChunkOffset(index)));
+  m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+  if (!m_file || header[0] != expected) {
+    throw std::runtime_error("  !");
+  }
+  chunk.first = index * static_cast<size_t>(m_chunkPoints);
+  std::vector<double>* columns[kColumns] = {&chunk.t, &chunk.A, &chunk.B,
+                                            &chunk.C};
+  for (std::vector<double>* column : columns) {
+    column->resize(expected);
+    m_file.read(reinterpret_cast<char*>(column->data()),
+                static_cast<std::streamsize>(expected * sizeof(double)));
+  }
+  if (!m_file) throw std::runtime_error("  !");
+  return true;
+}
+
+double TrajectoryReader::ChunkStart(size_t index) {
+  double t = 0.0;
+  m_file.seekg(
+      static_cast<std::streamoff>(ChunkOffset(index) + kChunkHeaderBytes));
+  m_file.read(reinterpret_cast<char*>(&t), sizeof(t));
+  if (!m_file) throw std::runtime_error("  !");
+  return t;
+}
+
+uint64_t TrajectoryReader::ChunkOffset(size_t index) const {
+  return kHeaderBytes + index * ChunkBytes(m_chunkPoints);
+}
+
+size_t StreamTrajectory(const std::vector<double>& Ca,
+                        const std::vector<double>& Tm, double Cb, double Cc,
+                        double k, double n, size_t subSteps,
+                        TrajectoryWriter& writer) {
+  TRACE_SCOPE("StreamTrajectory");
+  return IntegrateTrajectory(Ca, Tm, Cb, Cc, k, n, subSteps,
+                             [&](double t, double A, double B, double C) {
+                               writer.Append(t, A, B, C);
+                             });
+}
+
+void ReduceTrajectory(TrajectoryReader& reader, TrajColumn column, double t0,
+                      double t1, size_t maxBuckets,
+                      std::vector<LodBucket>& out) {
+  TRACE_SCOPE("ReduceTrajectory");
+  out.clear();
+  const size_t chunks = reader.Chunks();
+  if (chunks == 0 || maxBuckets == 0 || !(t1 >= t0)) return;
+
+  //  ,    t0:     
+  size_t lo = 0;
+  size_t hi = chunks;
+  while (hi - lo > 1) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (reader.ChunkStart(mid) <= t0) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  //         
+  reader.Seek(lo > 0 ? lo - 1 : 0);
+
+  const double span = t1 - t0;
+  std::vector<LodBucket> bins(maxBuckets);
+  std::vector<unsigned char> used(maxBuckets, 0);
+  bool haveBefore = false;
+  bool haveAfter = false;
+  LodBucket before = {};
+  LodBucket after = {};
+  TrajectoryChunk chunk;
+  while (!haveAfter && reader.Next(chunk)) {
+    const std::vector<double>& v = chunk.Column(column);
+    for (size_t i = 0; i < chunk.t.size(); i++) {
+      const double t = chunk.t[i];
+      const size_t index = chunk.first + i;
+      if (t < t0) {
+        AddToBucket(before, t, v[i], index, true);
+        haveBefore = true;
+        continue;
+      }
+      if (t > t1) {
+        AddToBucket(after, t, v[i], index, true);
+        haveAfter = true;
+        break;
+      }
+      size_t b = span > 0.0 ? static_cast<size_t>((t - t0) / span *
+                                                  maxBuckets)
+                            : 0;
+      if (b >= maxBuckets) b = maxBuckets - 1;
+      AddToBucket(bins[b], t, v[i], index, used[b] == 0);
+      used[b] = 1;
+    }
+  }
+  if (haveBefore) out.push_back(before);
+  for (size_t b = 0; b < maxBuckets; b++) {
+    if (used[b]) out.push_back(bins[b]);
+  }
+  if (haveAfter) out.push_back(after);
+}
+
+TrajectorySummary SummarizeTrajectory(TrajectoryReader& reader) {
+  TRACE_SCOPE("SummarizeTrajectory");
+  TrajectorySummary summary;
+  summary.tHalf = std::numeric_limits<double>::quiet_NaN();
+  reader.Seek(0);
+  TrajectoryChunk chunk;
+  while (reader.Next(chunk)) {
+    for (size_t i = 0; i < chunk.t.size(); i++) {
+      const double a = chunk.A[i];
+      if (summary.points == 0) {
+        summary.tFirst = chunk.t[i];
+        summary.aFirst = a;
+        summary.aMin = a;
+        summary.aMax = a;
+      }
+      summary.aMin = std::min(summary.aMin, a);
+      summary.aMax = std::max(summary.aMax, a);
+      if (std::isnan(summary.tHalf) && a <= 0.5 * summary.aFirst) {
+        summary.tHalf = chunk.t[i];
+      }
+      summary.points++;
+    }
+    if (!chunk.t.empty()) {
+      summary.tLast = chunk.t.back();
+      summary.aLast = chunk.A.back();
+    }
+  }
+  return summary;
+}
+
+size_t ExportTrajectoryCsv(TrajectoryReader& reader,
+                           const std::filesystem::path& output) {
+  TRACE_SCOPE("ExportTrajectoryCsv");
+  std::ofstream out(output, std::ios::binary | std::ios::trunc);
+  if (!out) throw std::runtime_error("    !");
+  out << "t;A;B;C\n";
+  reader.Seek(0);
+  TrajectoryChunk chunk;
+  std::string text;
+  size_t rows = 0;
+  while (reader.Next(chunk)) {
+    //  ,     (std::to_chars);
+    //        
+    text.resize(chunk.t.size() * kColumns * kMaxNumberChars);
+    char* p = &text[0];
+    for (size_t i = 0; i < chunk.t.size(); i++) {
+      const double values[kColumns] = {chunk.t[i], chunk.A[i], chunk.B[i],
+                                       chunk.C[i]};
+      for (size_t c = 0; c < kColumns; c++) {
+        p = std::to_chars(p, p + kMaxNumberChars - 1, values[c]).ptr;
+        *p++ = (c + 1 < kColumns) ? ';' : '\n';
+      }
+    }
+    out.write(text.data(), static_cast<std::streamsize>(p - text.data()));
+    rows += chunk.t.size();
+  }
+  out.close();
+  if (out.fail()) {
+    throw std::runtime_error("    !");
+  }
+  return rows;
+}
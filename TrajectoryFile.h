@@ -0,0 +1,240 @@
+#ifndef TRAJECTORYFILE_H
+#define TRAJECTORYFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "LodPyramid.h"
+
+/**
+ * \file TrajectoryFile.h
+ * \brief         .
+ *
+ *           
+ * . \c StreamTrajectory     , 
+ * \c BuildTrajectory,    \c TrajectoryWriter,   
+ *     (chunk)      .
+ *  (, , )     
+ * \c TrajectoryReader,     .
+ *
+ *   (   , . . little-endian 
+ * x86  ARM):
+ * -  24 : "CHEMTRJ1",  (uint32),   
+ *   (uint32), 8  ;
+ * -  :   (uint32), 4  ,  
+ *   t, A, B, C     double.
+ *
+ *  ,  , ,     i 
+ *    ,       
+ *  .   :   , 
+ *     .
+ */
+
+///       (2  ).
+constexpr uint32_t TRAJ_CHUNK_POINTS = 65536;
+
+///   .
+enum class TrajColumn { A = 0, B = 1, C = 2 };
+
+/**
+ * \brief  ,   .
+ */
+struct TrajectoryChunk {
+  size_t first = 0;       ///<      .
+  std::vector<double> t;  ///<  .
+  std::vector<double> A;  ///<  A(t).
+  std::vector<double> B;  ///<  B(t).
+  std::vector<double> C;  ///<  C(t).
+
+  ///     .
+  const std::vector<double>& Column(TrajColumn column) const {
+    return column == TrajColumn::A ? A : column == TrajColumn::B ? B : C;
+  }
+};
+
+/**
+ * \brief     .
+ */
+class TrajectoryWriter {
+ public:
+  TrajectoryWriter() = default;
+  ~TrajectoryWriter();
+  TrajectoryWriter(const TrajectoryWriter&) = delete;
+  TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+  /**
+   * \brief   ( ).
+   *
+   * \param path   .
+   * \param chunkPoints   .
+   * \throw std::runtime_error     .
+   */
+  void Open(const std::filesystem::path& path,
+            uint32_t chunkPoints = TRAJ_CHUNK_POINTS);
+
+  /**
+   * \brief  ;      .
+   *
+   * \throw std::runtime_error    .
+   */
+  void Append(double t, double A, double B, double C);
+
+  /**
+   * \brief       .
+   *
+   * \throw std::runtime_error    .
+   */
+  void Close();
+
+  ///   .
+  size_t Points() const { return m_points; }
+
+ private:
+  void FlushChunk();
+
+  std::ofstream m_file;
+  uint32_t m_chunkPoints = 0;
+  uint32_t m_fill = 0;        ///<    .
+  std::vector<double> m_buf;  ///<  :  t, A, B, C.
+  size_t m_points = 0;
+};
+
+/**
+ * \brief      .
+ */
+class TrajectoryReader {
+ public:
+  /**
+   * \brief     .
+   *
+   * \param path   .
+   * \throw std::runtime_error       
+   *         .
+   */
+  void Open(const std::filesystem::path& path);
+
+  ///     .
+  size_t Chunks() const { return m_chunks; }
+
+  ///     .
+  size_t Points() const { return m_points; }
+
+  ///    .
+  uint32_t ChunkPoints() const { return m_chunkPoints; }
+
+  /**
+   * \brief      \a index ( \c Next 
+   *        ).
+   */
+  void Seek(size_t index) { m_next = index; }
+
+  /**
+   * \brief   .
+   *
+   * \param chunk  (   ).
+   * \return \c false,   .
+   * \throw std::runtime_error    .
+   */
+  bool Next(TrajectoryChunk& chunk);
+
+  /**
+   * \brief     \a index (  8 ).
+   *
+   * \throw std::runtime_error    .
+   */
+  double ChunkStart(size_t index);
+
+ private:
+  uint64_t ChunkOffset(size_t index) const;
+
+  std::ifstream m_file;
+  uint32_t m_chunkPoints = 0;
+  uint32_t m_lastPoints = 0;  ///<    .
+  size_t m_chunks = 0;
+  size_t m_points = 0;
+  size_t m_next = 0;
+};
+
+/**
+ * \brief   ,      .
+ */
+struct TrajectorySummary {
+  size_t points = 0;    ///<  .
+  double tFirst = 0.0;  ///<   .
+  double tLast = 0.0;   ///<   .
+  double aFirst = 0.0;  ///< A  .
+  double aLast = 0.0;   ///< A  .
+  double aMin = 0.0;    ///<  A.
+  double aMax = 0.0;    ///<  A.
+  ///  ,  A     
+  /// (NaN   ).
+  double tHalf = 0.0;
+};
+
+/**
+ * \brief   W = k * A^n     .
+ *
+ *     \c IntegrateTrajectory,   \c BuildTrajectory,
+ *      ,     
+ * .    
+ *     : Tm = {t0, t1}, Ca = {A0, }.
+ *
+ * \param Ca    A ( Ca[0]).
+ * \param Tm    .
+ * \param Cb   B.
+ * \param Cc   C.
+ * \param k  .
+ * \param n  .
+ * \param subSteps    .
+ * \param writer    ( ).
+ * \return   ; 0,    .
+ * \throw std::runtime_error    .
+ */
+size_t StreamTrajectory(const std::vector<double>& Ca,
+                        const std::vector<double>& Tm, double Cb, double Cc,
+                        double k, double n, size_t subSteps,
+                        TrajectoryWriter& writer);
+
+/**
+ * \brief      [t0, t1]  .
+ *
+ *    \a maxBuckets  ;   
+ *          ,  
+ * \c LodPyramid::Query   .   
+ *      .     
+ * (   \c TrajectoryReader::ChunkStart).
+ *
+ * \param reader   .
+ * \param column .
+ * \param t0  .
+ * \param t1  .
+ * \param maxBuckets   (    ).
+ * \param out   (  ).
+ * \throw std::runtime_error    .
+ */
+void ReduceTrajectory(TrajectoryReader& reader, TrajColumn column, double t0,
+                      double t1, size_t maxBuckets,
+                      std::vector<LodBucket>& out);
+
+/**
+ * \brief       .
+ *
+ * \throw std::runtime_error    .
+ */
+TrajectorySummary SummarizeTrajectory(TrajectoryReader& reader);
+
+/**
+ * \brief     CSV (t;A;B;C)  .
+ *
+ * \param reader   .
+ * \param output  CSV.
+ * \return   .
+ * \throw std::runtime_error      .
+ */
+size_t ExportTrajectoryCsv(TrajectoryReader& reader,
+                           const std::filesystem::path& output);
+
+#endif  // TRAJECTORYFILE_H
@@ -15,19 +15,29 @@
 #include <string>
 #include <cwchar>
 
+#include "DataImport.h"
+
 /**
  * \brief       EDIT.
  *
- *      ,   \c GetWindowText, 
- *        \c double    \c _wtof.
+ *      ,   \c GetWindowText,
+ *     \c ParseNumber (   ), 
+ *   . ,   ,  0.
  *
  * \param hEdit    EDIT.
  * \return   \c double,    .
  */
 double GetEditDouble(HWND hEdit) {
   wchar_t buf[128] = {0};
-  GetWindowText(hEdit, buf, 128);
-  return _wtof(buf);
+  const int len = GetWindowText(hEdit, buf, 128);
+  //     ASCII;      
+  char text[128];
+  for (int i = 0; i < len; i++) {
+    text[i] = (buf[i] < 0x80) ? static_cast<char>(buf[i]) : '?';
+  }
+  double value = 0.0;
+  ParseNumber(text, text + (len > 0 ? len : 0), value);
+  return value;
 }
 
 /**
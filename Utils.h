@@ -19,7 +19,8 @@
  * \brief      EDIT    double.
  *
  *      ,   \a hEdit,
- *      \c double    \c _wtof.
+ *      \c double  \c ParseNumber (
+ *  ; ,   ,  0).
  *
  * \param hEdit    EDIT.
  * \return    \c double,    .